@@ -9,30 +9,32 @@
  * Functions prefix for public functions in this file: audioP_
  */
 #include <stdlib.h>
+#include <string.h>
 
 #include <audio/microphone.h>
 #include <audio_processing.h>
 
 #include <fft.h>
 #include <arm_math.h>
+#include <numeric.h>
+#include <telemetry.h>
+#include <profiling.h>
+#include <systemMonitor.h>
+#include <micCapture.h>
 
 /*===========================================================================*/
 /* Constants definition for this file						               */
 /*===========================================================================*/
 
 //Program parameters
-#define FFT_FREQ_MAX						1011						//Corresponding to 200Hz, upper limit of scanned freq.
-#define FFT_FREQ_MIN						945						//Corresponding to 1200Hz, lower limit of scanned freq
-#define PHASE_DIF_LIMIT					75.569					//Max arg dif for all freq. below 1200Hz, in deg
+#define FFT_FREQ_MAX						AUDIOP__FFT_FREQ_MAX
+#define FFT_FREQ_MIN						AUDIOP__FFT_FREQ_MIN
+#define PHASE_DIF_LIMIT					75.569f					//Max arg dif for all freq. below 1200Hz, in deg
 #define KILLER_FREQ						959						//Corresponding to 1000Hz, freq for killer whale
-#define	FREQ_THD							3						//Threshold corresponding to 45Hz
-#define AMPLI_THD						15000					//Threshold for peak-ampli
-#define NB_ERROR_DETECTED_MAX			15						//Nb. of error scans before we assume that a source is not anymore available
-#define EMA_WEIGHT						0.2						//range [0,1], if smaller past angles have more weight
 
 //Microphone constants
-#define FFT_SIZE 						1024
-#define CMPX_VAL							2
+#define FFT_SIZE 						AUDIOP__FFT_SIZE
+#define CMPX_VAL							AUDIOP__CMPX_VAL
 #define CMPX_PART						1
 #define LEFT_MIC							1
 #define BACK_MIC							2
@@ -40,99 +42,66 @@
 #define NB_OF_MIC						4
 #define NB_MIC_PAIR						2						//Two pairs of mic: left-right, back-front
 
-//Physical constants
-#define SPEED_SOUND						343						//[m/s]
-#define EPUCK_MIC_DISTANCE				0.06						//Distance between two mic in [m]
+//Peak detection constants
+#define NB_HEAP_CHILDREN					2						//binary min-heap for the loudest peaks
 
-#define CONVERT_FREQ_CONST				15611					//Conversion of the freq from the FFT-domain to a real freq:
-#define CONVERT_FREQ_PARAM				15.244					//freq[real]=15611-freq[FFT-domain]*15.244
+//Physical constants
+#define SPEED_SOUND						343.0f					//[m/s]
+#define EPUCK_MIC_DISTANCE				0.06f					//Distance between two mic in [m]
+#define PHASE_TO_ANGLE_GAIN				((SPEED_SOUND*DEG90)/(EPUCK_MIC_DISTANCE*DEG360))	//angle=arg*PHASE_TO_ANGLE_GAIN/freq, folded at compile time
+
+#define CONVERT_FREQ_CONST				15611.0f					//Conversion of the freq from the FFT-domain to a real freq:
+#define CONVERT_FREQ_PARAM				15.244f					//freq[real]=15611-freq[FFT-domain]*15.244
+
+//Telemetry constants
+#define TELEM_SPECTRUM_BINS				AUDIOP__SCAN_BINS			//the scanned band is sent, not the whole spectrum
+#define TELEM_SPECTRUM_MAX				UINT16_MAX
+#define TELEM_SOURCE_SIZE				(sizeof(uint16_t)+sizeof(float))
+#define TELEM_SOURCES_MAX				((TELEM__MAX_PAYLOAD-sizeof(uint32_t)-sizeof(uint8_t))/TELEM_SOURCE_SIZE)	//more sources are not sent
+#define TELEM_BAND_KEY_INTERVAL			16						//a key frame every 16 band frames, approx. once per second
+#define TELEM_BAND_VALUE_MAX				UINT8_MAX
+#define TELEM_BAND_PEAKS_MAX				32						//more peaks are not sent with the band
 
 //Number constants
 #define ZERO								0
 #define ONE								1
-#define TWO_PI							6.2832
 #define DEG90							90
 #define DEG270							270
 #define DEG360							360
 
-//Scanning and writing mode constants
-#define PEAK_MODE_SMALLER				0
-#define PEAK_MODE_EXCHANGE				1
-#define PEAK_MODE_REPLACE				2
-#define PEAK_MODE_DO_NOTHING				3
-#define WRITING_MODE_HIGHER				0
-#define WRITING_MODE_LOWER				1
-#define WRITING_MODE_EQUAL				2
-#define WRITING_MODE_SOURCE				3
-#define WRITING_MODE_ZERO				4
-
 //Angle calculation constants
 #define GO_TOWARDS_SOURCE				1
 #define GO_AWAY_FROM_SOURCE				0
 
 
-/*===========================================================================*/
-/* Structures						 			                            */
-/*===========================================================================*/
-
-/*
- * Structure for sources
- * @note: Freq is not in Hz!
- */
-typedef struct Sources {
-	uint16_t freq;
-	float ampli;
-} Source;
-
-/*===========================================================================*/
-/* Semaphore							 			                            */
-/*===========================================================================*/
-
-static BSEMAPHORE_DECL(audioBufferIsReady, ONE);
-
-
 /*===========================================================================*/
 /* Static variables definitions 		 			                            */
 /*===========================================================================*/
 
-//Audio buffer: 2*FFT_SIZE because arrays contain complex numbers (real + imaginary)
-static float mic_buffer_left[CMPX_VAL*FFT_SIZE];
-static float mic_buffer_right[CMPX_VAL*FFT_SIZE];
-static float mic_buffer_back[CMPX_VAL*FFT_SIZE];
-static float mic_buffer_front[CMPX_VAL*FFT_SIZE];
-
-//arrays used to save the state of the mic audio buffer (double buffering)
-//to avoid modifications of the buffer while analyzing it
-static float mic_data_right[CMPX_VAL * FFT_SIZE];
-static float mic_data_left[CMPX_VAL * FFT_SIZE];
-static float mic_data_front[CMPX_VAL * FFT_SIZE];
-static float mic_data_back[CMPX_VAL * FFT_SIZE];
-
-
-//Static variables to memories freq, ampli and number of sources
-static Source source[AUDIOP__NB_SOURCES_MAX];
-static uint8_t nb_sources;
+/* @note mainCtx
+ * Pipeline of the microphones of the robot, used by the functions without a context. It is initialised here
+ * as audioP_ctxInit would, so that its parameters can be set before audioP_init. */
+static audioP_ctx mainCtx = {
+	.audioBufferIsReady = _BSEMAPHORE_DATA(mainCtx.audioBufferIsReady, ONE),
+	.nb_sources_max = AUDIOP__NB_SOURCES_DEFAULT,
+	.tuning = {AUDIOP__AMPLI_THD_DEFAULT, AUDIOP__FREQ_THD_DEFAULT, AUDIOP__NB_ERROR_DETECTED_DEFAULT, AUDIOP__EMA_WEIGHT_DEFAULT},
+	.band_key_needed = true,
+};
 
 /*===========================================================================*/
 /* Internal functions definitions             */
 /*===========================================================================*/
 
 /*
-* @brief Callback for when the demodulation of the four microphones is done.
-* @note : Sampling freq of mic: 16kHz. Every 10ms we get 160 samples per mic
-*			We fill the samples buffers to reach 1024 samples to calculate the FFTs
-*
-* @parameter [in] data  			Buffer containing 4 times 160 samples. the samples are sorted by mic:
-*							 		[micRight1, micLeft1, micBack1, micFront1, micRight2, etc...]
-* @parameter [in] num_samples	Tells how many data we get in total (should always be 640)
+* @brief Callback of mic_start: gives the samples to the raw capture (micCapture.h), then to the pipeline of the robot
 */
-void audio_processAudioData(int16_t *data, uint16_t num_samples);
+void audio_MicCallback(int16_t *data, uint16_t num_samples);
 
 /*
  * @brief Copies the mic buffer and calculates FFT, determines sound peaks and writes them into source-array
  * @note : Waits until a buffer is full with 1024 samples
  */
-void audio_analyseSpectre(void);
+void audio_analyseSpectre(audioP_ctx *ctx);
 
 /*
  * @brief Calculates FFT and its amplitude of the for mic
@@ -140,11 +109,11 @@ void audio_analyseSpectre(void);
  * @param[out] mic_data_xxx		4 audio data clip from the four mics, real sound values will be replaced by the complex fft values
  * @param[out] mic_ampli_left	1 empty arrays, to store the amplitudes of the fft
  */
-void audio_CalculateFFT(float *mic_ampli_left);
+void audio_CalculateFFT(audioP_ctx *ctx, float *mic_ampli_left);
 
 /*
  * @brief 	finds loudest audio sources in sound clip, and their frequencies and amplitudes
- * @note 	this function updates file scope vars nb_sources and source (array) for later functions,
+ * @note 	this function updates the context vars nb_sources and source (array) for later functions,
  * @note		Sources are first memorized in source_initial-array and then put in source-array if no error occured
  * @note		lowest_freq[FFTspace] is in source[0] ,highest_freq[FFTspace] is in source[nb]
  *
@@ -152,80 +121,51 @@ void audio_CalculateFFT(float *mic_ampli_left);
  *
  * @return	error codes AUDIOP__SUCCESS if all good, AUDIOP__ERROR otherwise
  */
-uint16_t audio_Peak(float *mic_ampli);
+uint16_t audio_Peak(audioP_ctx *ctx, float *mic_ampli);
 
 /*
- * @brief 	Will search for peak amplitudes and puts them into source_initial-array
- * @note		source_initial-array is still sorted by its amplitude:
- * 			lowest_ampli is in source_init[0] ,highest_ampli[FFTspace] is in source[nb]
+ * @brief 	Will search for peak amplitudes and puts the nb_sources_max loudest ones into source_initial-array
+ * @note		Frequencies closer than tuning->freqThd belong to the same peak, only the loudest one is kept.
+ * @note		source_initial-array is a min-heap on the amplitude: the quietest source is in source_init[0],
+ * 			so that it can be replaced in O(log n) when a louder peak is found and the array is full
  *
+ * @param[in] tuning				detection parameters
+ * @param[in] nb_sources_max			capacity of source_initial-array
  * @param[out] source_init 			pointer to a source_initial-array, where the found sources will be stored
  * @param[out] nb_sources_init 		pointer to where the number corresponding to how many sources were found should be stored.
  * @param[in] mic_ampli				array of amplitudes for all frequencies
  *
  * @return 					error codes AUDIOP__SUCCESS if all ok, AUDIOP__ERROR if error somewhere...
  */
-int16_t audio_PeakScan(Source *source_init, uint8_t *nb_sources_init, float *mic_ampli);
+int16_t audio_PeakScan(const AudioPTuning *tuning, uint8_t nb_sources_max, Source *source_init, uint8_t *nb_sources_init,
+		const float *mic_ampli);
 
 /*
- * @brief	Changes source_initial-array corresponding to peak_mode and source_exchange
- *
- *  	@param[in] source_exchange 	indicates position of replacement (useful only if exchange or replace needed)
- *  	@param[in] freq_counter		indicates frequency of new source
- *  	@paraim[in] mic_ampli		amplitude at frequency: mic_ampli[freq_counter]
- *  @param[in] peak_mode			indicates which type of manipulation on the source_initial-array needs to be done. Possible cases are :
- *  								peak_mode=PEAK_MODE_EXCHANGE:	new ampli is bigger than smallest one of source array,
- *  																source_exchange indicates new position
- *  								peak_mode=PEAK_MODE_SMALLER: 	new ampli is smaller than all of source array,
- *  																should shift all array members to insert new one at index 0
- *  								peak_mode=PEAK_MODE_REPLACE: 	freq_difference<FREQ_THD and one value of source array has to be replaced
- *  																source_exchange indicates position of replacement
- *  	@param[out] source_init 		pointer to source_initial-array
- *  	@param[ou] nb_sources_init	point to number of sources stored in source_init array, if the new source is in fact added it will be incremented !
+ * @brief	Inserts a peak into the source_initial min-heap, if it is full the quietest source is replaced
+ * 			(or the peak is dropped if it is quieter than all sources)
  *
- *  	@return						error codes AUDIOP__SUCCESS if all ok, AUDIOP__ERROR if error somewhere...
+ *  @param[in] nb_sources_max		capacity of source_initial-array
+ *  @param[in] peak				peak to insert
+ *  @param[out] source_init 		pointer to source_initial-array (min-heap on amplitude)
+ *  @param[out] nb_sources_init	point to number of sources stored in source_init array, incremented if the heap was not full
  */
-int16_t audio_PeakChange(int8_t source_exchange, uint16_t freq_counter, float mic_ampli, uint8_t peak_mode, Source *source_init, uint8_t *nb_sources_init);
+void audio_PeakHeapPush(uint8_t nb_sources_max, const Source *peak, Source *source_init, uint8_t *nb_sources_init);
 
 /*
- * @brief	Writes the changes evaluated in audio_PeakScan into source_initial-array
- * @note		Only fct that writes into source_init-array !
+ * @brief	Restores the min-heap property of source_initial-array from source_index downwards
  *
- *  @param[in] source_counter 	indicates position of replacement
- *  @param[in] writing_mode		executes changes depending on peak_mode from audio_PeakScan
- *  @param[in] freq_counter		indicates frequency of new source
- *  @paraim[in] mic_ampli		amplitude at frequency: mic_ampli[freq_counter]
  *  @param[out] source_init 		pointer to source_initial-array
- *
- * @return		AUDIOP__SUCCESS if no errors, AUDIOP__ERROR if error occurred
+ *  @param[in] nb_sources_init	number of sources of source_initial-array
+ *  @param[in] source_index		index of the source that might be louder than its children
  */
-int16_t audio_PeakWriteInit(uint8_t source_counter, uint8_t writing_mode, uint16_t freq_counter, float mic_ampli, Source *source_init);
+void audio_PeakHeapSiftDown(Source *source_init, uint8_t nb_sources_init, uint8_t source_index);
 
 /*
- * @brief	Writes the changes evaluated in audio_Peak into source-array
- * @note		Only fct that writes into source-array !
- *
- *  @param[in] source_counter 	indicates position of writing
- *  @param[in] writing_mode		indicates which type of manipulation on the source_initial-array needs to be done. Possible cases are :
- *  								writing_mode=WRITING_MODE_ZERO:		writes a zero for freq and ampli
- *  								writing_mode=WRITING_MODE_SOURCE:	writes corresponding value of source_init-array into source-array
- *  	@param[out] source_init 		pointer to source_initial-array
+ * @brief	Compares two sources by their frequency, for qsort
  *
- * @return		AUDIOP__SUCCESS if no errors, AUDIOP__ERROR if error occurred
+ * @return	<0 if source1 has a smaller freq than source2, >0 if bigger, 0 if equal
  */
-int16_t audio_PeakWriteSource(uint8_t source_counter, uint8_t writing_mode,  Source *source_init);
-
-/*
- * @brief	Sorts soure_initial-array by its frequency
- * @note		source_init[ZERO]=smallest_freq, source_init[NB_SOURCES]=highest_freq in FFT-space
- *
- * 	@param[out] source_init 		pointer to source_initial-array
- * 	@param[out] nb_source_init 	number of sources of source_initial-array
- * 	@param[in] mic_ampli			array of amplitudes for all frequencies
- *
- * @return		AUDIOP__SUCCESS if no errors, AUDIOP__ERROR if error occurred in audio_peakWriteInit
- */
-int16_t audio_PeakBubblesort(Source *source_init, uint8_t nb_sources_init, float *mic_ampli);
+int audio_PeakCompareFreq(const void *source1, const void *source2);
 
 /*
  * @brief calculates the angle of a given source
@@ -237,7 +177,17 @@ int16_t audio_PeakBubblesort(Source *source_init, uint8_t nb_sources_init, float
  *
  * @return	direction angle of source_index, between -180° and 180°, or AUDIOP__ERROR if there was an error
  */
-int16_t audio_determineAngle(uint8_t source_index, bool go_towards_source);
+int16_t audio_determineAngle(audioP_ctx *ctx, uint8_t source_index, bool go_towards_source);
+
+/*
+ * @brief calculates the angle of a given source in the current frame only, without the moving average of audio_determineAngle
+ *
+ *  @param[in] source_index		index of source of which the angle is calculated
+ *  @param[in] go_towards_source	GO_TOWARDS_SOURCE or GO_AWAY_FROM_SOURCE, as for audio_determineAngle
+ *
+ * @return	direction angle of source_index in this frame, between -180° and 180°, or AUDIOP__ERROR if there was an error
+ */
+int16_t audio_DetermineRawAngle(const audioP_ctx *ctx, uint8_t source_index, bool go_towards_source);
 
 /*
  * @brief	Calculates the phase shift between mic one and mic two
@@ -248,7 +198,7 @@ int16_t audio_determineAngle(uint8_t source_index, bool go_towards_source);
  *
  * @return	AUDIOP__ERROR if error was detected, phase difference in degree if no error was detected
  */
-int16_t audio_DeterminePhase(float *mic_data1, float *mic_data2, uint8_t source_index);
+int16_t audio_DeterminePhase(const audioP_ctx *ctx, const float *mic_data1, const float *mic_data2, uint8_t source_index);
 
 /*
  * @brief	Convert angle from radians into degrees
@@ -260,15 +210,39 @@ int16_t audio_DeterminePhase(float *mic_data1, float *mic_data2, uint8_t source_
 uint16_t audio_ConvertRad(float rad);
 
 /*
- * @brief	Converts phase shift into angle
- * @note		freq is in Hz!
+ * @brief	Sends the magnitudes of the scanned band as TELEM__MSG_SPECTRUM, if this stream is enabled
  *
- *  @param[in] arg		phase shift that has to be converted
- *  @param[in] freq		frequency of the source in Hz
+ *  @param[in] mic_ampli		array of amplitudes for all frequencies
+ */
+void audio_SendSpectrum(const audioP_ctx *ctx, const float *mic_ampli);
+
+/*
+ * @brief	stamps an angle computed from the frame in mic_data_xxx: frame, capture time and analysis time (now)
  *
- * @return		angle in degrees
+ *  @param[out] stamp		stamp of the Destination the angle is written to
  */
-uint16_t audio_ConvertPhase(int16_t arg, uint16_t freq);
+void audio_StampAngle(const audioP_ctx *ctx, TraceStamp *stamp);
+
+/*
+ * @brief	Sends the sources of the last frame as TELEM__MSG_SOURCES, if this stream is enabled
+ */
+void audio_SendSources(const audioP_ctx *ctx);
+
+/*
+ * @brief	Sends a source with its angle as TELEM__MSG_DESTINATION, if this stream is enabled
+ *
+ *  @param[in] destination		source with a valid angle
+ */
+void audio_SendDestination(const Destination *destination);
+
+/*
+ * @brief	Sends the scanned band quantized on 8 bits and compressed, with the peaks of this frame and their angles,
+ * 			as TELEM__MSG_BAND, if this stream is enabled
+ *
+ *  @param[in] mic_ampli		array of amplitudes for all frequencies
+ *  @param[in] peaks_valid	true if audio_Peak updated the sources with this frame
+ */
+void audio_SendBand(audioP_ctx *ctx, const float *mic_ampli, bool peaks_valid);
 
 
 /*===========================================================================*/
@@ -279,33 +253,104 @@ void audioP_init()
 {
 	//starts the microphones processing thread.
 	//it calls the callback given in parameter when samples are ready
-	mic_start(&audio_processAudioData);
+	mic_start(&audio_MicCallback);
+}
+
+uint16_t audioP_analyseSources(Destination *destination_scan, uint8_t frameBudget)
+{
+	return audioP_ctxAnalyseSources(&mainCtx, destination_scan, frameBudget);
+}
+
+uint16_t audioP_analyseDestination(Destination *destination)
+{
+	return audioP_ctxAnalyseDestination(&mainCtx, destination);
 }
 
-uint16_t audioP_analyseSources(Destination *destination_scan)
+uint16_t audioP_analyseKiller(Destination *killer)
 {
-	bool errorDetected = true;
+	return audioP_ctxAnalyseKiller(&mainCtx, killer);
+}
 
-	while(errorDetected){
+void audioP_setNbSourcesMax(uint8_t nbSourcesMax)
+{
+	audioP_ctxSetNbSourcesMax(&mainCtx, nbSourcesMax);
+}
+
+uint8_t audioP_getNbSourcesMax(void)
+{
+	return audioP_ctxGetNbSourcesMax(&mainCtx);
+}
+
+void audioP_setTuning(const AudioPTuning *newTuning)
+{
+	audioP_ctxSetTuning(&mainCtx, newTuning);
+}
+
+void audioP_getTuning(AudioPTuning *currentTuning)
+{
+	audioP_ctxGetTuning(&mainCtx, currentTuning);
+}
+
+void audioP_ctxInit(audioP_ctx *ctx)
+{
+	memset(ctx, ZERO, sizeof(audioP_ctx));
+	chBSemObjectInit(&ctx->audioBufferIsReady, true);
+	ctx->nb_sources_max = AUDIOP__NB_SOURCES_DEFAULT;
+	ctx->tuning.ampliThd = AUDIOP__AMPLI_THD_DEFAULT;
+	ctx->tuning.freqThd = AUDIOP__FREQ_THD_DEFAULT;
+	ctx->tuning.nbErrorDetectedMax = AUDIOP__NB_ERROR_DETECTED_DEFAULT;
+	ctx->tuning.emaWeight = AUDIOP__EMA_WEIGHT_DEFAULT;
+	ctx->band_key_needed = true;
+}
+
+uint16_t audioP_ctxAnalyseSources(audioP_ctx *ctx, Destination *destination_scan, uint8_t frameBudget)
+{
+	bool errorDetected 			= true;
+	uint8_t nb_scanned 			= ZERO;
+	uint8_t scan_index			= ZERO;
+	int16_t angle				= ZERO;
+
+	for(uint8_t frame_counter = ZERO; (frame_counter < frameBudget) && errorDetected; frame_counter++){
 		errorDetected = false;
 
-		audio_analyseSpectre();
+		audio_analyseSpectre(ctx);
 
-		for (uint8_t source_counter = ZERO; source_counter < nb_sources; source_counter++) {
+		for (uint8_t source_counter = ZERO; source_counter < ctx->nb_sources; source_counter++) {
 
-			if(abs(KILLER_FREQ-source[source_counter].freq) < FREQ_THD){
-				if(audio_determineAngle(source_counter, GO_AWAY_FROM_SOURCE) != AUDIOP__ERROR){
+			if(abs(KILLER_FREQ-ctx->source[source_counter].freq) < ctx->tuning.freqThd){
+				if(audio_determineAngle(ctx, source_counter, GO_AWAY_FROM_SOURCE) != AUDIOP__ERROR){
 					return AUDIOP__KILLER_WHALE_DETECTED;
 				}
-				else{
-					errorDetected = true;
+				errorDetected = true;
+				continue;
+			}
+
+			//Find this source in the results of the previous frames, or add it if there is space left
+			for(scan_index = ZERO; scan_index < nb_scanned; scan_index++){
+				if(abs(destination_scan[scan_index].freq-ctx->source[source_counter].freq) < ctx->tuning.freqThd){
 					break;
 				}
 			}
+			if(scan_index == nb_scanned){
+				if(nb_scanned >= ctx->nb_sources_max){
+					continue;
+				}
+				destination_scan[scan_index].freq = ctx->source[source_counter].freq;
+				destination_scan[scan_index].angle = ZERO;
+				destination_scan[scan_index].valid = false;
+				destination_scan[scan_index].ampli = ZERO;
+				nb_scanned++;
+			}
 
-			destination_scan[source_counter].angle = audio_determineAngle(source_counter, GO_TOWARDS_SOURCE);
-			if(destination_scan[source_counter].angle != AUDIOP__ERROR){
-				destination_scan[source_counter].freq = source[source_counter].freq;
+			//Only a valid angle replaces the best estimate so far, an error only marks the frame as incomplete
+			angle = audio_determineAngle(ctx, source_counter, GO_TOWARDS_SOURCE);
+			if(angle != AUDIOP__ERROR){
+				destination_scan[scan_index].freq = ctx->source[source_counter].freq;
+				destination_scan[scan_index].angle = angle;
+				destination_scan[scan_index].valid = true;
+				audio_StampAngle(ctx, &destination_scan[scan_index].stamp);
+				destination_scan[scan_index].ampli = ctx->source[source_counter].ampli;
+				audio_SendDestination(&destination_scan[scan_index]);
 			}
 			else{
 				errorDetected = true;
@@ -313,27 +358,31 @@ uint16_t audioP_analyseSources(Destination *destination_scan)
 		}
 	}
 
-	return nb_sources;
+	return nb_scanned;
 }
 
-uint16_t audioP_analyseDestination(Destination *destination)
+uint16_t audioP_ctxAnalyseDestination(audioP_ctx *ctx, Destination *destination)
 {
-	for(uint8_t error_counter = ZERO; error_counter<NB_ERROR_DETECTED_MAX; error_counter++){
+	for(uint8_t error_counter = ZERO; error_counter<ctx->tuning.nbErrorDetectedMax; error_counter++){
 
-		audio_analyseSpectre();
+		audio_analyseSpectre(ctx);
 
-		for (uint8_t source_counter = ZERO; source_counter < nb_sources; source_counter++){
+		for (uint8_t source_counter = ZERO; source_counter < ctx->nb_sources; source_counter++){
 
-			if(abs(KILLER_FREQ-source[source_counter].freq) < FREQ_THD){
-				if(audio_determineAngle(source_counter, GO_AWAY_FROM_SOURCE) != AUDIOP__ERROR){
+			if(abs(KILLER_FREQ-ctx->source[source_counter].freq) < ctx->tuning.freqThd){
+				if(audio_determineAngle(ctx, source_counter, GO_AWAY_FROM_SOURCE) != AUDIOP__ERROR){
 					return AUDIOP__KILLER_WHALE_DETECTED;
 				}
 			}
 
-			if(abs(destination->freq-source[source_counter].freq) < FREQ_THD){
-				destination->angle = audio_determineAngle(source_counter, GO_TOWARDS_SOURCE);
+			if(abs(destination->freq-ctx->source[source_counter].freq) < ctx->tuning.freqThd){
+				destination->angle = audio_determineAngle(ctx, source_counter, GO_TOWARDS_SOURCE);
 				if(destination->angle != AUDIOP__ERROR){
-					destination->freq = source[source_counter].freq;
+					destination->freq = ctx->source[source_counter].freq;
+					destination->valid = true;
+					audio_StampAngle(ctx, &destination->stamp);
+					destination->ampli = ctx->source[source_counter].ampli;
+					audio_SendDestination(destination);
 					return AUDIOP__SUCCESS;
 				}
 			}
@@ -344,18 +393,22 @@ uint16_t audioP_analyseDestination(Destination *destination)
 	return AUDIOP__SOURCE_NOT_FOUND;
 }
 
-uint16_t audioP_analyseKiller(Destination *killer)
+uint16_t audioP_ctxAnalyseKiller(audioP_ctx *ctx, Destination *killer)
 {
-	for(uint8_t error_counter = ZERO; error_counter<NB_ERROR_DETECTED_MAX; error_counter++){
+	for(uint8_t error_counter = ZERO; error_counter<ctx->tuning.nbErrorDetectedMax; error_counter++){
 
-		audio_analyseSpectre();
+		audio_analyseSpectre(ctx);
 
-		for (uint8_t source_counter = ZERO; source_counter < nb_sources; source_counter++){
+		for (uint8_t source_counter = ZERO; source_counter < ctx->nb_sources; source_counter++){
 
-			if(abs(KILLER_FREQ-source[source_counter].freq) < FREQ_THD){
-				killer->angle = audio_determineAngle(source_counter, GO_AWAY_FROM_SOURCE);
+			if(abs(KILLER_FREQ-ctx->source[source_counter].freq) < ctx->tuning.freqThd){
+				killer->angle = audio_determineAngle(ctx, source_counter, GO_AWAY_FROM_SOURCE);
 				if(killer->angle != AUDIOP__ERROR){
-					killer->freq = source[source_counter].freq;
+					killer->freq = ctx->source[source_counter].freq;
+					killer->valid = true;
+					audio_StampAngle(ctx, &killer->stamp);
+					killer->ampli = ctx->source[source_counter].ampli;
+					audio_SendDestination(killer);
 					return AUDIOP__SUCCESS;
 				}
 				else{
@@ -368,306 +421,334 @@ uint16_t audioP_analyseKiller(Destination *killer)
 	return AUDIOP__SOURCE_NOT_FOUND;
 }
 
+void audioP_ctxSetNbSourcesMax(audioP_ctx *ctx, uint8_t nbSourcesMax)
+{
+	if(nbSourcesMax < ONE){
+		nbSourcesMax = ONE;
+	}
+	else if(nbSourcesMax > AUDIOP__NB_SOURCES_MAX){
+		nbSourcesMax = AUDIOP__NB_SOURCES_MAX;
+	}
+	ctx->nb_sources_max = nbSourcesMax;
+}
+
+uint8_t audioP_ctxGetNbSourcesMax(const audioP_ctx *ctx)
+{
+	return ctx->nb_sources_max;
+}
+
+void audioP_ctxSetTuning(audioP_ctx *ctx, const AudioPTuning *newTuning)
+{
+	AudioPTuning clamped 		= *newTuning;
+
+	if(clamped.ampliThd < ZERO){
+		clamped.ampliThd = ZERO;
+	}
+	clamped.freqThd = (uint8_t) num_ClampI32(clamped.freqThd, ONE, FFT_FREQ_MAX-FFT_FREQ_MIN);
+	clamped.nbErrorDetectedMax = (uint8_t) num_ClampI32(clamped.nbErrorDetectedMax, ONE, UINT8_MAX);
+	clamped.emaWeight = num_ClampF(clamped.emaWeight, ZERO, ONE);
+
+	//The analysis thread reads the parameters one by one, they change together
+	chSysLock();
+	ctx->tuning = clamped;
+	chSysUnlock();
+}
+
+void audioP_deinterleave(const int16_t *data, uint16_t nbSamples, float *micRight, float *micLeft, float *micBack,
+		float *micFront)
+{
+	for(uint16_t sample_counter = ZERO; sample_counter < nbSamples; sample_counter++){
+		micRight[CMPX_VAL*sample_counter] = data[NB_OF_MIC*sample_counter];
+		micRight[CMPX_VAL*sample_counter+CMPX_PART] = ZERO;
+		micLeft[CMPX_VAL*sample_counter] = data[NB_OF_MIC*sample_counter+LEFT_MIC];
+		micLeft[CMPX_VAL*sample_counter+CMPX_PART] = ZERO;
+		micBack[CMPX_VAL*sample_counter] = data[NB_OF_MIC*sample_counter+BACK_MIC];
+		micBack[CMPX_VAL*sample_counter+CMPX_PART] = ZERO;
+		micFront[CMPX_VAL*sample_counter] = data[NB_OF_MIC*sample_counter+FRONT_MIC];
+		micFront[CMPX_VAL*sample_counter+CMPX_PART] = ZERO;
+	}
+}
+
+uint16_t audioP_findPeaks(const float *mic_ampli, const AudioPTuning *tuning, uint8_t nbSourcesMax, Source *sources,
+		uint8_t *nbSources)
+{
+   	//Find the loudest sources, they are stored as a min-heap on their amplitudes
+	if(audio_PeakScan(tuning, nbSourcesMax, sources, nbSources, mic_ampli)==AUDIOP__ERROR){
+		return AUDIOP__ERROR;
+	}
+
+   	//sort the sources according to frequencies, smallest frequency: sources[0].freq
+	qsort(sources, *nbSources, sizeof(Source), audio_PeakCompareFreq);
+
+	return AUDIOP__SUCCESS;
+}
+
+void audioP_ctxGetTuning(const audioP_ctx *ctx, AudioPTuning *currentTuning)
+{
+	chSysLock();
+	*currentTuning = ctx->tuning;
+	chSysUnlock();
+}
+
 uint16_t audioP_convertFreq(uint16_t freq)
 {
-	freq = (int) (CONVERT_FREQ_CONST - CONVERT_FREQ_PARAM*freq);
+	freq = (uint16_t) num_ScaleF(freq, -CONVERT_FREQ_PARAM, CONVERT_FREQ_CONST);
 	return freq;
 }
 
+int16_t audioP_convertPhase(int16_t arg, uint16_t freq)
+{
+	/*Set max angle if arg overshoots 90° which is physical not possible*/
+	arg = (int16_t) num_ClampF((PHASE_TO_ANGLE_GAIN*arg)/freq, -DEG90, DEG90);
+
+	return arg;
+}
+
 
 /*===========================================================================*/
 /* Private functions              											*/
 /*===========================================================================*/
 
-void audio_processAudioData(int16_t *data, uint16_t num_samples)
+void audio_MicCallback(int16_t *data, uint16_t num_samples)
 {
-	static uint16_t samples_gathered 	= ZERO;
-	uint16_t sample_counter				= ZERO;
+	micCap_onBlock(data, num_samples);
+	audioP_ctxProcessAudioData(&mainCtx, data, num_samples);
+}
 
-	while(sample_counter<num_samples){
-		if(samples_gathered<FFT_SIZE){
-			mic_buffer_right[CMPX_VAL*samples_gathered] = data[sample_counter];
-			mic_buffer_right[CMPX_VAL*samples_gathered+CMPX_PART] = ZERO;
-			mic_buffer_left[CMPX_VAL*samples_gathered] = data[sample_counter+LEFT_MIC];
-			mic_buffer_left[CMPX_VAL*samples_gathered+CMPX_PART] = ZERO;
-			mic_buffer_back[CMPX_VAL*samples_gathered] = data[sample_counter+BACK_MIC];
-			mic_buffer_back[CMPX_VAL*samples_gathered+CMPX_PART] = ZERO;
-			mic_buffer_front[CMPX_VAL*samples_gathered] = data[sample_counter+FRONT_MIC];
-			mic_buffer_front[CMPX_VAL*samples_gathered+CMPX_PART] = ZERO;
-			sample_counter += NB_OF_MIC;
-			samples_gathered++;
+void audioP_ctxProcessAudioData(audioP_ctx *ctx, const int16_t *data, uint16_t num_samples)
+{
+	uint16_t sample_counter				= ZERO;
+	uint16_t nb_copied					= ZERO;
+	uint16_t offset						= ZERO;
+
+	PROF__BEGIN(PROF__STAGE_DEINTERLEAVE);
+	while(sample_counter+NB_OF_MIC<=num_samples){
+		if(ctx->samples_gathered<FFT_SIZE){
+			//the samples of this block, up to the end of the frame
+			nb_copied = (num_samples-sample_counter)/NB_OF_MIC;
+			if(nb_copied > FFT_SIZE-ctx->samples_gathered){
+				nb_copied = FFT_SIZE-ctx->samples_gathered;
+			}
+			offset = CMPX_VAL*ctx->samples_gathered;
+			audioP_deinterleave(&data[sample_counter], nb_copied, &ctx->mic_buffer_right[offset], &ctx->mic_buffer_left[offset],
+					&ctx->mic_buffer_back[offset], &ctx->mic_buffer_front[offset]);
+			sample_counter += NB_OF_MIC*nb_copied;
+			ctx->samples_gathered += nb_copied;
 		}
 		else{
-			samples_gathered = ZERO;
-			chBSemSignal(&audioBufferIsReady);
+			ctx->samples_gathered = ZERO;
+			ctx->mic_buffer_time = chVTGetSystemTimeX();
+			ctx->mic_buffer_frame++;
+			chBSemSignal(&ctx->audioBufferIsReady);
 		}
 	}
+	PROF__END(PROF__STAGE_DEINTERLEAVE);
 }
 
-void audio_analyseSpectre(void)
+void audio_analyseSpectre(audioP_ctx *ctx)
 {
-	static float mic_ampli_left[FFT_SIZE];
+	float *mic_ampli_left 					= ctx->mic_ampli_left;
+	uint16_t peak_result					= AUDIOP__ERROR;
+	uint32_t wait_start					= 0;
 
 	while(true){
 
 		//Waits until enough sound samples are collected
-		chBSemWait(&audioBufferIsReady);
+		wait_start = prof_now();
+		chBSemWait(&ctx->audioBufferIsReady);
+		sysmon_recordWait(SYSMON__WAIT_AUDIO_BUFFER, prof_now() - wait_start);
 
 		//Copy buffer to avoid conflicts
-		arm_copy_f32(mic_buffer_left, mic_data_left, CMPX_VAL * FFT_SIZE);
-		arm_copy_f32(mic_buffer_right, mic_data_right, CMPX_VAL * FFT_SIZE);
-		arm_copy_f32(mic_buffer_back, mic_data_back, CMPX_VAL * FFT_SIZE);
-		arm_copy_f32(mic_buffer_front, mic_data_front, CMPX_VAL * FFT_SIZE);
-
-		//Calculate FFT of sound signal, stores back inside mic_data_xxx for frequencies, and mic_ampli_xxx for amplitudes
-		audio_CalculateFFT(mic_ampli_left);
-
-		if(audio_Peak(mic_ampli_left) != AUDIOP__ERROR){	//Peak calculation was successful: source array was calculated with success
+		PROF__BEGIN(PROF__STAGE_COPY);
+		arm_copy_f32(ctx->mic_buffer_left, ctx->mic_data_left, CMPX_VAL * FFT_SIZE);
+		arm_copy_f32(ctx->mic_buffer_right, ctx->mic_data_right, CMPX_VAL * FFT_SIZE);
+		arm_copy_f32(ctx->mic_buffer_back, ctx->mic_data_back, CMPX_VAL * FFT_SIZE);
+		arm_copy_f32(ctx->mic_buffer_front, ctx->mic_data_front, CMPX_VAL * FFT_SIZE);
+		ctx->mic_data_time = ctx->mic_buffer_time;
+		ctx->mic_data_frame = ctx->mic_buffer_frame;
+		PROF__END(PROF__STAGE_COPY);
+
+		//Calculate FFT of sound signal, stores back inside ctx->mic_data_xxx for frequencies, and mic_ampli_xxx for amplitudes
+		audio_CalculateFFT(ctx, mic_ampli_left);
+		audio_SendSpectrum(ctx, mic_ampli_left);
+
+		PROF__BEGIN(PROF__STAGE_PEAK);
+		peak_result = audio_Peak(ctx, mic_ampli_left);
+		PROF__END(PROF__STAGE_PEAK);
+
+		if(peak_result != AUDIOP__ERROR){	//Peak calculation was successful: source array was calculated with success
+			audio_SendBand(ctx, mic_ampli_left, true);
+			audio_SendSources(ctx);
 			break;
 		}
+		audio_SendBand(ctx, mic_ampli_left, false);
 	}
 }
 
-void audio_CalculateFFT(float *mic_ampli_left)
+void audio_CalculateFFT(audioP_ctx *ctx, float *mic_ampli_left)
 {
-	doFFT_optimized(FFT_SIZE, mic_data_left);
-	doFFT_optimized(FFT_SIZE, mic_data_right);
-	doFFT_optimized(FFT_SIZE, mic_data_back);
-	doFFT_optimized(FFT_SIZE, mic_data_front);
-	arm_cmplx_mag_f32(mic_data_left, mic_ampli_left, FFT_SIZE);
+	float *mic_data[NB_OF_MIC]							= {ctx->mic_data_left, ctx->mic_data_right, ctx->mic_data_back, ctx->mic_data_front};
+
+	for(uint8_t mic_counter = ZERO; mic_counter < NB_OF_MIC; mic_counter++){
+		PROF__BEGIN(PROF__STAGE_FFT);
+		doFFT_optimized(FFT_SIZE, mic_data[mic_counter]);
+		PROF__END(PROF__STAGE_FFT);
+	}
+
+	PROF__BEGIN(PROF__STAGE_MAGNITUDE);
+	arm_cmplx_mag_f32(ctx->mic_data_left, mic_ampli_left, FFT_SIZE);
+	PROF__END(PROF__STAGE_MAGNITUDE);
 }
 
-uint16_t audio_Peak(float *mic_ampli)
+uint16_t audio_Peak(audioP_ctx *ctx, float *mic_ampli)
 {
-	uint8_t source_counter						= ZERO;
 	uint8_t nb_sources_init						= ZERO;
-   	Source source_init[AUDIOP__NB_SOURCES_MAX]	= {0};
+   	Source source_init[AUDIOP__NB_SOURCES_MAX];
 
-   	//Find sources and sort them by their peak amplitudes
-   	if(audio_PeakScan(source_init, &nb_sources_init, mic_ampli)==AUDIOP__ERROR){
+   	//Find the loudest sources, sorted by frequency
+   	if(audioP_findPeaks(mic_ampli, &ctx->tuning, ctx->nb_sources_max, source_init, &nb_sources_init)==AUDIOP__ERROR){
 		return AUDIOP__ERROR;
 	}
 
-	if (nb_sources_init > AUDIOP__NB_SOURCES_MAX) {
+	if (nb_sources_init > ctx->nb_sources_max) {
 		return AUDIOP__ERROR;
 	}
 
-   	//Bubblesort: sort source_init array according to frequencies, smallest frequency: source_init[0]->freq, max frequency: source_init[nb_sources_init]
-   	if(audio_PeakBubblesort(source_init, nb_sources_init, mic_ampli)==AUDIOP__ERROR){
-   		return AUDIOP__ERROR;
-   	}
-
-   	//update file scoped source array with new sources in source_init and clear rest of array
-   	nb_sources=nb_sources_init;
-	for(source_counter=ZERO; source_counter<AUDIOP__NB_SOURCES_MAX; source_counter++){
-		if(source_counter<nb_sources_init){
-			audio_PeakWriteSource(source_counter, WRITING_MODE_SOURCE,  source_init);
-		}
-		else{
-			audio_PeakWriteSource(source_counter, WRITING_MODE_ZERO,  source_init);
-		}
-	}
+   	//update the source array of the context with new sources in source_init and clear rest of array
+	memcpy(ctx->source, source_init, nb_sources_init*sizeof(Source));
+	memset(&ctx->source[nb_sources_init], ZERO, (AUDIOP__NB_SOURCES_MAX-nb_sources_init)*sizeof(Source));
+   	ctx->nb_sources=nb_sources_init;
 
 	return AUDIOP__SUCCESS;
 }
 
-int16_t audio_PeakScan(Source *source_init, uint8_t *nb_sources_init, float *mic_ampli)
+int16_t audio_PeakScan(const AudioPTuning *tuning, uint8_t nb_sources_max, Source *source_init, uint8_t *nb_sources_init,
+		const float *mic_ampli)
 {
-	uint8_t source_counter						= ZERO;
-	uint8_t source_exchange						= ZERO;
-	uint8_t peak_mode							= ZERO;
+	Source peak									= {ZERO, ZERO};		//loudest frequency of the peak currently scanned
+	bool peak_open								= false;
 
 	*nb_sources_init=ZERO;
 	for(uint16_t freq_counter=FFT_FREQ_MIN; freq_counter<FFT_FREQ_MAX; freq_counter++){
 
-		peak_mode=PEAK_MODE_DO_NOTHING;
-		if(mic_ampli[freq_counter]>AMPLI_THD){
-			source_exchange=ZERO;
-			peak_mode=PEAK_MODE_SMALLER;
-			for(source_counter=ZERO; source_counter<*nb_sources_init; source_counter++){
-				if((freq_counter-(&source_init[source_counter])->freq)>FREQ_THD){
-					if(mic_ampli[freq_counter]>(&source_init[source_counter])->ampli){
-						source_exchange++;
-						peak_mode=PEAK_MODE_EXCHANGE;
-					}
-				}
-				else{
-					if(mic_ampli[freq_counter]>(&source_init[source_counter])->ampli){
-						source_exchange = source_counter;
-						peak_mode=PEAK_MODE_REPLACE;
-					}
-					else{
-						peak_mode=PEAK_MODE_DO_NOTHING;
-					}
-					break;
-				}
-			}
+		if(mic_ampli[freq_counter]<=tuning->ampliThd){
+			continue;
 		}
 
-		if(peak_mode != PEAK_MODE_DO_NOTHING){
-			if(audio_PeakChange(source_exchange, freq_counter, mic_ampli[freq_counter], peak_mode, source_init, nb_sources_init)==AUDIOP__ERROR){
-				return AUDIOP__ERROR;
+		//Frequencies are scanned in increasing order, so only the current peak can be closer than tuning->freqThd
+		if(peak_open && (freq_counter-peak.freq)<=tuning->freqThd){
+			if(mic_ampli[freq_counter]>peak.ampli){
+				peak.freq = freq_counter;
+				peak.ampli = mic_ampli[freq_counter];
+			}
+		}
+		else{
+			if(peak_open){
+				audio_PeakHeapPush(nb_sources_max, &peak, source_init, nb_sources_init);
 			}
+			peak.freq = freq_counter;
+			peak.ampli = mic_ampli[freq_counter];
+			peak_open = true;
 		}
 	} //end for
 
+	if(peak_open){
+		audio_PeakHeapPush(nb_sources_max, &peak, source_init, nb_sources_init);
+	}
+
 	return AUDIOP__SUCCESS;
 }
 
-int16_t audio_PeakChange(int8_t source_exchange, uint16_t freq_counter, float mic_ampli, uint8_t peak_mode, Source *source_init, uint8_t *nb_sources_init)
+void audio_PeakHeapPush(uint8_t nb_sources_max, const Source *peak, Source *source_init, uint8_t *nb_sources_init)
 {
-
-	if(source_exchange<ZERO){
-		return AUDIOP__ERROR;
-	}
-	else if(source_exchange>AUDIOP__NB_SOURCES_MAX){
-		return AUDIOP__ERROR;
+	uint8_t source_index 			= *nb_sources_init;
+	uint8_t parent_index			= ZERO;
+
+	//Heap is full: the new peak replaces the quietest source if it is louder
+	if(*nb_sources_init >= nb_sources_max){
+		if(peak->ampli > source_init[ZERO].ampli){
+			source_init[ZERO] = *peak;
+			audio_PeakHeapSiftDown(source_init, *nb_sources_init, ZERO);
+		}
+		return;
 	}
 
-	switch(peak_mode){
-		case PEAK_MODE_EXCHANGE:
-			//if array is full, we will shift all sources under source_exchange down (deleting lowest one), and insert new at source_exchange
-			//otherwise, if array is not full, we will go to case PEAK_MODE_SMALLER, to insert one and shift all up !
-			if(*nb_sources_init==AUDIOP__NB_SOURCES_MAX){
-				source_exchange--;
-				for(uint8_t source_counter=ZERO; source_counter<source_exchange; source_counter++){
-					if(audio_PeakWriteInit(source_counter, WRITING_MODE_LOWER, freq_counter, mic_ampli, source_init)==AUDIOP__ERROR){
-						return AUDIOP__ERROR;
-					}
-				}
-				if(audio_PeakWriteInit(source_exchange, WRITING_MODE_EQUAL, freq_counter, mic_ampli, source_init)==AUDIOP__ERROR){
-					return AUDIOP__ERROR;
-				}
-			} // no break
-		case PEAK_MODE_SMALLER:
-			//we need to insert new source at bottom of array, shifting all up, if it is not already full.
-			if(*nb_sources_init<AUDIOP__NB_SOURCES_MAX){
-				for(uint8_t source_counter=*nb_sources_init; source_counter>source_exchange; source_counter--){
-					if(audio_PeakWriteInit(source_counter, WRITING_MODE_HIGHER, freq_counter, mic_ampli, source_init)==AUDIOP__ERROR){
-						return AUDIOP__ERROR;
-					}
-				}
-				if(audio_PeakWriteInit(source_exchange, WRITING_MODE_EQUAL, freq_counter, mic_ampli, source_init)==AUDIOP__ERROR){
-					return AUDIOP__ERROR;
-				}
-				*nb_sources_init = *nb_sources_init + ONE;
-			}
-			break;
-
-		case PEAK_MODE_REPLACE:
-			//we shift all sources up from source exchange
-			while((source_exchange<(*nb_sources_init-ONE)) && (mic_ampli>(&source_init[source_exchange+ONE])->ampli)){
-				if(audio_PeakWriteInit(source_exchange, WRITING_MODE_LOWER, freq_counter, mic_ampli, source_init)==AUDIOP__ERROR){
-					return AUDIOP__ERROR;
-				}
-
-				source_exchange++;
-			}
-			if(audio_PeakWriteInit(source_exchange, WRITING_MODE_EQUAL, freq_counter, mic_ampli, source_init)==AUDIOP__ERROR){
-				return AUDIOP__ERROR;
-			}
+	//Heap is not full: append and sift up
+	while(source_index > ZERO){
+		parent_index = (source_index-ONE)/NB_HEAP_CHILDREN;
+		if(source_init[parent_index].ampli <= peak->ampli){
 			break;
-
-		default:
-			return AUDIOP__ERROR;
+		}
+		source_init[source_index] = source_init[parent_index];
+		source_index = parent_index;
 	}
-	return AUDIOP__SUCCESS;
+	source_init[source_index] = *peak;
+	*nb_sources_init = *nb_sources_init + ONE;
 }
 
-int16_t audio_PeakWriteInit(uint8_t source_counter, uint8_t writing_mode, uint16_t freq_counter, float mic_ampli, Source *source_init)
+void audio_PeakHeapSiftDown(Source *source_init, uint8_t nb_sources_init, uint8_t source_index)
 {
-	switch(writing_mode){
-		case WRITING_MODE_HIGHER:
-			if(source_counter>AUDIOP__NB_SOURCES_MAX){
-				return AUDIOP__ERROR;
-			}
-
-			(&source_init[source_counter])->freq = (&source_init[source_counter-ONE])->freq;
-			(&source_init[source_counter])->ampli = (&source_init[source_counter-ONE])->ampli;
-
-			break;
-
-		case WRITING_MODE_LOWER:
-			if(source_counter>=AUDIOP__NB_SOURCES_MAX){
-				return AUDIOP__ERROR;
-			}
-
-			(&source_init[source_counter])->freq = (&source_init[source_counter+ONE])->freq;
-			(&source_init[source_counter])->ampli = (&source_init[source_counter+ONE])->ampli;
-
-			break;
+	Source sifted				= source_init[source_index];
+	uint16_t child_index			= ZERO;
 
-		case WRITING_MODE_EQUAL:
-			if(source_counter>AUDIOP__NB_SOURCES_MAX){
-				return AUDIOP__ERROR;
-			}
-
-			(&source_init[source_counter])->freq = freq_counter;
-			(&source_init[source_counter])->ampli = mic_ampli;
+	while((child_index = NB_HEAP_CHILDREN*source_index+ONE) < nb_sources_init){
+		//Take the quietest of both children
+		if((child_index+ONE) < nb_sources_init && source_init[child_index+ONE].ampli < source_init[child_index].ampli){
+			child_index++;
+		}
+		if(sifted.ampli <= source_init[child_index].ampli){
 			break;
-		default:
-			return AUDIOP__ERROR;
-
+		}
+		source_init[source_index] = source_init[child_index];
+		source_index = child_index;
 	}
-	return AUDIOP__SUCCESS;
+	source_init[source_index] = sifted;
 }
 
-int16_t audio_PeakWriteSource(uint8_t source_counter, uint8_t writing_mode,  Source *source_init)
+int audio_PeakCompareFreq(const void *source1, const void *source2)
 {
-	if(source_counter>AUDIOP__NB_SOURCES_MAX){
-		return AUDIOP__ERROR;
-	}
+	return (int) ((const Source *) source1)->freq - (int) ((const Source *) source2)->freq;
+}
 
-	switch(writing_mode){
-		case WRITING_MODE_SOURCE:
-			source[source_counter].freq = (&source_init[source_counter])->freq;
-			source[source_counter].ampli = (&source_init[source_counter])->ampli;
-			break;
+int16_t audio_determineAngle(audioP_ctx *ctx, uint8_t source_index, bool go_towards_source)
+{
+	int16_t angle										= ZERO;
+	bool *ema_initialized								= ctx->ema_initialized;
+	int16_t *ema_angle									= ctx->ema_angle;
 
-		case WRITING_MODE_ZERO:
-			source[source_counter].freq = ZERO;
-			source[source_counter].ampli = ZERO;
-			break;
+	PROF__BEGIN(PROF__STAGE_ANGLE);
+	angle = audio_DetermineRawAngle(ctx, source_index, go_towards_source);
+	PROF__END(PROF__STAGE_ANGLE);
 
-		default:
-			return AUDIOP__ERROR;
+	if(angle == AUDIOP__ERROR){
+		return AUDIOP__ERROR;
 	}
 
-	return AUDIOP__SUCCESS;
-}
-
-int16_t audio_PeakBubblesort(Source *source_init, uint8_t nb_sources_init, float *mic_ampli)
-{
-	uint16_t tmp_freq							= ZERO;
-	float tmp_ampli								= ZERO;
-
-	for (uint8_t source_counter=ONE; source_counter<nb_sources_init ; source_counter++){
-		for (uint8_t i=ZERO; i<nb_sources_init-source_counter ; i++){
-			if ((&source_init[i])->freq > (&source_init[i+ONE])->freq){
-				tmp_freq = (&source_init[i])->freq;
-				tmp_ampli = (&source_init[i])->ampli;
-				if(audio_PeakWriteInit(i, WRITING_MODE_LOWER, i, mic_ampli[i], source_init)==AUDIOP__ERROR){
-					return AUDIOP__ERROR;
-				}
-				(&source_init[i+ONE])->freq = tmp_freq;
-				(&source_init[i+ONE])->ampli = tmp_ampli;
-			}
-		}
+	/*Exponential Moving Average (EMA); tuning.emaWeight range: [0,1], if smaller past results have more weight*/
+	if(!ema_initialized[source_index]){			//Initialization
+		ema_angle[source_index] = angle;
+		ema_initialized[source_index] = true;
 	}
-	return AUDIOP__SUCCESS;
+	//Jump from positive angle to negative or vis-versa
+	else if(((ema_angle[source_index]<-DEG90) && (angle>DEG90)) || ((ema_angle[source_index]>DEG90) && (angle<-DEG90))){				//Jump from 180° to -180° or inverse
+		ema_angle[source_index] = angle;
+	}
+	else{										//Moving average
+		ema_angle[source_index] = (int16_t) num_EmaF(ema_angle[source_index], angle, ctx->tuning.emaWeight);
+	}
+
+	return ema_angle[source_index];
 }
 
-int16_t audio_determineAngle(uint8_t source_index, bool go_towards_source)
+int16_t audio_DetermineRawAngle(const audioP_ctx *ctx, uint8_t source_index, bool go_towards_source)
 {
 	int16_t arg_dif_left_right							= ZERO;
 	int16_t arg_dif_back_front							= ZERO;
 	int16_t angle										= ZERO;
-	static uint8_t ema_counter[AUDIOP__NB_SOURCES_MAX];
-	static int16_t ema_angle[AUDIOP__NB_SOURCES_MAX];
 
 	/*Calculate the angle shift with respect to the central axe of the robot*/
-	arg_dif_left_right = audio_DeterminePhase(mic_data_left, mic_data_right, source_index);
-	arg_dif_back_front = audio_DeterminePhase(mic_data_back, mic_data_front, source_index) ;
+	arg_dif_left_right = audio_DeterminePhase(ctx, ctx->mic_data_left, ctx->mic_data_right, source_index);
+	arg_dif_back_front = audio_DeterminePhase(ctx, ctx->mic_data_back, ctx->mic_data_front, source_index) ;
 
 	/*Verify if there was an error in audio_DeterminePhase*/
 	if(arg_dif_left_right==AUDIOP__ERROR || arg_dif_back_front==AUDIOP__ERROR){
@@ -675,8 +756,8 @@ int16_t audio_determineAngle(uint8_t source_index, bool go_towards_source)
 	}
 
 	/*Convert phase shift into angle, provide freq in Hz to audioConvertFreq*/
-	arg_dif_left_right = audio_ConvertPhase(arg_dif_left_right, audioP_convertFreq(source[source_index].freq));
-	arg_dif_back_front = audio_ConvertPhase(arg_dif_back_front, audioP_convertFreq(source[source_index].freq));
+	arg_dif_left_right = audioP_convertPhase(arg_dif_left_right, audioP_convertFreq(ctx->source[source_index].freq));
+	arg_dif_back_front = audioP_convertPhase(arg_dif_back_front, audioP_convertFreq(ctx->source[source_index].freq));
 
 	/* Two calculation modes: GO_TOWARDS_SOURCE (if) and GO_AWAY_FROM_SOURCE (else)
 	 * 	GO_TOWARDS_SOURCE:		Robot moves in direction of the source -> 0° is in the front of the robot.
@@ -713,31 +794,18 @@ int16_t audio_determineAngle(uint8_t source_index, bool go_towards_source)
 		}
 	}
 
-	/*Exponential Moving Average (EMA); EMA_WEIGHT range: [0,1], if smaller past results have more weight*/
-	if(ema_counter[source_index]==ZERO){			//Initialization
-		ema_angle[source_index] = angle;
-		ema_counter[source_index]++;
-	}
-	//Jump from positive angle to negative or vis-versa
-	else if(((ema_angle[source_index]<-DEG90) && (angle>DEG90)) || ((ema_angle[source_index]>DEG90) && (angle<-DEG90))){				//Jump from 180° to -180° or inverse
-		ema_angle[source_index] = angle;
-	}
-	else{										//Moving average
-		ema_angle[source_index] = (int16_t) (angle*EMA_WEIGHT + ema_angle[source_index]*(ONE-EMA_WEIGHT));
-	}
-
-	return ema_angle[source_index];
+	return angle;
 }
 
-int16_t audio_DeterminePhase(float *mic_data1, float *mic_data2, uint8_t source_index)
+int16_t audio_DeterminePhase(const audioP_ctx *ctx, const float *mic_data1, const float *mic_data2, uint8_t source_index)
 {
 	float phase1						=ZERO;								//in rad [-pi,+pi]
 	float phase2						=ZERO;								//in rad [-pi,+pi]
 	int16_t phase_dif				=ZERO;								//in degrees [-180°,+180°]
 
 	/*Calculate phase shift between the signal of mic1 and mic2; atan2f(float y, float x) returns float arctan(y/x) in rad [-pi,+pi]*/
-	phase1 = atan2f(mic_data1[ ((CMPX_VAL*source[source_index].freq)+ONE) ], mic_data1[ (CMPX_VAL*source[source_index].freq) ]);
-	phase2 = atan2f(mic_data2[ ((CMPX_VAL*source[source_index].freq)+ONE) ], mic_data2[ (CMPX_VAL*source[source_index].freq) ]);
+	phase1 = atan2f(mic_data1[ ((CMPX_VAL*ctx->source[source_index].freq)+ONE) ], mic_data1[ (CMPX_VAL*ctx->source[source_index].freq) ]);
+	phase2 = atan2f(mic_data2[ ((CMPX_VAL*ctx->source[source_index].freq)+ONE) ], mic_data2[ (CMPX_VAL*ctx->source[source_index].freq) ]);
 	phase_dif = audio_ConvertRad(phase1-phase2);
 
 	/*Error: Phase out of range; Outside of [-pi,+pi]*/
@@ -756,21 +824,126 @@ int16_t audio_DeterminePhase(float *mic_data1, float *mic_data2, uint8_t source_
 uint16_t audio_ConvertRad(float rad)
 {
 	uint16_t degree = ZERO;
-	degree = (int16_t) (360*(rad)/TWO_PI);
+	degree = (int16_t) num_RadToDeg(rad);
 	return degree;
 }
 
-uint16_t audio_ConvertPhase(int16_t arg, uint16_t freq)
+void audio_StampAngle(const audioP_ctx *ctx, TraceStamp *stamp)
 {
-	arg = (int16_t) ((SPEED_SOUND*DEG90*arg)/(freq*EPUCK_MIC_DISTANCE*DEG360));
+	stamp->frame = ctx->mic_data_frame;
+	stamp->capture = ctx->mic_data_time;
+	stamp->analysis = chVTGetSystemTime();
+	stamp->command = stamp->analysis;
+}
 
-	/*Set max angle if arg overshoots 90° which is physical not possible*/
-	if(arg>DEG90){
-		arg = DEG90;
+void audio_SendSpectrum(const audioP_ctx *ctx, const float *mic_ampli)
+{
+	uint8_t payload[sizeof(uint32_t)+sizeof(uint16_t)+sizeof(uint8_t)+TELEM_SPECTRUM_BINS*sizeof(uint16_t)];
+	uint8_t *write = payload;
+	float magnitude = ZERO;
+
+	if(telem_isStreaming(TELEM__MSG_SPECTRUM) == false){
+		return;
 	}
-	if(arg<-DEG90){
-		arg = -DEG90;
+
+	write = telem_PutU32(write, (uint32_t) ctx->mic_data_time);
+	write = telem_PutU16(write, FFT_FREQ_MIN);
+	write = telem_PutU8(write, TELEM_SPECTRUM_BINS);
+	for(uint16_t freq_counter = FFT_FREQ_MIN; freq_counter < FFT_FREQ_MAX; freq_counter++){
+		magnitude = num_ClampF(mic_ampli[freq_counter]/TELEM__SPECTRUM_SCALE, ZERO, TELEM_SPECTRUM_MAX);
+		write = telem_PutU16(write, (uint16_t) magnitude);
 	}
+	telem_send(TELEM__MSG_SPECTRUM, payload, (uint16_t) (write - payload));
+}
 
-	return arg;
+void audio_SendSources(const audioP_ctx *ctx)
+{
+	uint8_t payload[TELEM__MAX_PAYLOAD];
+	uint8_t *write = payload;
+	uint8_t nb_sent = ctx->nb_sources;
+
+	if(telem_isStreaming(TELEM__MSG_SOURCES) == false){
+		return;
+	}
+
+	if(nb_sent > TELEM_SOURCES_MAX){
+		nb_sent = TELEM_SOURCES_MAX;
+	}
+	write = telem_PutU32(write, (uint32_t) ctx->mic_data_time);
+	write = telem_PutU8(write, nb_sent);
+	for(uint8_t source_counter = ZERO; source_counter < nb_sent; source_counter++){
+		write = telem_PutU16(write, ctx->source[source_counter].freq);
+		write = telem_PutF32(write, ctx->source[source_counter].ampli);
+	}
+	telem_send(TELEM__MSG_SOURCES, payload, (uint16_t) (write - payload));
+}
+
+void audio_SendDestination(const Destination *destination)
+{
+	uint8_t payload[sizeof(uint32_t)+sizeof(uint16_t)+sizeof(int16_t)+sizeof(uint8_t)+sizeof(float)];
+	uint8_t *write = payload;
+
+	if(telem_isStreaming(TELEM__MSG_DESTINATION) == false){
+		return;
+	}
+
+	write = telem_PutU32(write, (uint32_t) destination->stamp.capture);
+	write = telem_PutU16(write, destination->freq);
+	write = telem_PutU16(write, (uint16_t) destination->angle);
+	write = telem_PutU8(write, destination->valid);
+	write = telem_PutF32(write, destination->ampli);
+	telem_send(TELEM__MSG_DESTINATION, payload, (uint16_t) (write - payload));
+}
+
+void audio_SendBand(audioP_ctx *ctx, const float *mic_ampli, bool peaks_valid)
+{
+	uint8_t *reference 					= ctx->band_reference;		//band as the receiver has it after the last band frame sent
+	uint8_t band[TELEM_SPECTRUM_BINS];
+	uint8_t payload[TELEM__MAX_PAYLOAD];
+	uint8_t *write 						= payload;
+	uint8_t nb_peaks 					= ZERO;
+	int16_t angle						= ZERO;
+	bool key_frame						= false;
+
+	if(telem_isStreaming(TELEM__MSG_BAND) == false){
+		ctx->band_key_needed = true;					//the receiver has nothing to apply differences to when the stream restarts
+		return;
+	}
+
+	//Quantize on a logarithmic scale, magnitudes below 1 are 0
+	for(uint16_t bin = ZERO; bin < TELEM_SPECTRUM_BINS; bin++){
+		band[bin] = (uint8_t) num_ClampF(TELEM__BAND_STEPS_PER_OCTAVE*log2f(mic_ampli[FFT_FREQ_MIN+bin]), ZERO, TELEM_BAND_VALUE_MAX);
+	}
+
+	key_frame = ctx->band_key_needed || (ctx->band_frames_since_key >= TELEM_BAND_KEY_INTERVAL);
+	if(key_frame){
+		memset(reference, ZERO, TELEM_SPECTRUM_BINS);
+	}
+
+	if(peaks_valid){
+		nb_peaks = (ctx->nb_sources > TELEM_BAND_PEAKS_MAX) ? TELEM_BAND_PEAKS_MAX : ctx->nb_sources;
+	}
+	write = telem_PutU32(write, (uint32_t) ctx->mic_data_time);
+	write = telem_PutU8(write, ctx->band_index);
+	write = telem_PutU8(write, key_frame ? TELEM__BAND_KEY_FRAME : ZERO);
+	write = telem_PutU16(write, FFT_FREQ_MIN);
+	write = telem_PutU8(write, TELEM_SPECTRUM_BINS);
+	write = telem_PutU8(write, nb_peaks);
+	for(uint8_t source_counter = ZERO; source_counter < nb_peaks; source_counter++){
+		angle = audio_DetermineRawAngle(ctx, source_counter, GO_TOWARDS_SOURCE);
+		write = telem_PutU8(write, (uint8_t) (ctx->source[source_counter].freq - FFT_FREQ_MIN));
+		write = telem_PutU16(write, (uint16_t) ((angle == AUDIOP__ERROR) ? TELEM__ANGLE_UNKNOWN : angle));
+	}
+	write += telem_EncodeBand(band, reference, TELEM_SPECTRUM_BINS, write);
+
+	//Only a band the receiver got can be the reference of the next one, otherwise the next one is a key frame
+	if(telem_send(TELEM__MSG_BAND, payload, (uint16_t) (write - payload))){
+		memcpy(reference, band, TELEM_SPECTRUM_BINS);
+		ctx->band_index++;
+		ctx->band_frames_since_key = key_frame ? ONE : ctx->band_frames_since_key + ONE;
+		ctx->band_key_needed = false;
+	}
+	else{
+		ctx->band_key_needed = true;
+	}
 }
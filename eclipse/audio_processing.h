@@ -12,12 +12,35 @@
 #ifndef AUDIO_PROCESSING_H
 #define AUDIO_PROCESSING_H
 
+#include <latencyTrace.h>
+
 /*===========================================================================*/
 /* Constants definition for this library						               */
 /*===========================================================================*/
 
 //Program parameters
-#define AUDIOP__NB_SOURCES_MAX				5						//Max 255 sources because nb_sources is uint8_t
+#ifndef AUDIOP__NB_SOURCES_MAX
+#define AUDIOP__NB_SOURCES_MAX				64						//Storage capacity, max 255 sources because nb_sources is uint8_t
+#endif
+#define AUDIOP__NB_SOURCES_DEFAULT			5						//Runtime capacity at start, see audioP_setNbSourcesMax
+
+#if AUDIOP__NB_SOURCES_MAX > 255
+#error "AUDIOP__NB_SOURCES_MAX must fit in an uint8_t"
+#endif
+#define AUDIOP__SCAN_FRAME_BUDGET			8						//Default nb. of frames (64ms each) audioP_analyseSources may use
+
+//FFT and scanned band, sizes of the buffers of audioP_ctx
+#define AUDIOP__FFT_SIZE						1024
+#define AUDIOP__CMPX_VAL						2						//arrays of complex numbers (real + imaginary)
+#define AUDIOP__FFT_FREQ_MAX					1011						//Corresponding to 200Hz, upper limit of scanned freq.
+#define AUDIOP__FFT_FREQ_MIN					945						//Corresponding to 1200Hz, lower limit of scanned freq
+#define AUDIOP__SCAN_BINS					(AUDIOP__FFT_FREQ_MAX-AUDIOP__FFT_FREQ_MIN)
+
+//Detection parameters at start, see audioP_setTuning
+#define AUDIOP__AMPLI_THD_DEFAULT			15000.0f					//Threshold for peak-ampli
+#define AUDIOP__FREQ_THD_DEFAULT				3						//Threshold corresponding to 45Hz
+#define AUDIOP__NB_ERROR_DETECTED_DEFAULT	15						//Nb. of error scans before we assume that a source is not anymore available
+#define AUDIOP__EMA_WEIGHT_DEFAULT			0.2f						//range [0,1], if smaller past angles have more weight
 
 //Returning state constants
 #define AUDIOP__ERROR						9999						//Error number
@@ -28,6 +51,9 @@
 //Initialization constant
 #define AUDIOP__UNINITIALIZED_FREQ			0
 
+//Amplitude above which a source is considered close to the robot (10 times the detection threshold), to be tuned on site
+#define AUDIOP__AMPLI_SOURCE_CLOSE			150000.0f
+
 
 /*===========================================================================*/
 /* Structures						 			                            */
@@ -36,12 +62,84 @@
 /*
  * Structure for destination source
  * Freq is not in Hz!
+ * @note valid is false as long as no angle could be calculated for this source, angle is then meaningless
+ * @note stamp identifies the audio frame used for angle, with its capture and analysis times, the angle is relative
+ * 			to the heading of the robot at the capture time (see latencyTrace.h)
+ * @note ampli is the FFT amplitude of the source in the same frame, it grows when the robot gets closer
  */
 typedef struct Destinations {
 	uint16_t freq;
 	int16_t angle;
+	bool valid;
+	TraceStamp stamp;
+	float ampli;
 } Destination;
 
+/*
+ * Detection parameters, hand-tuned, changed at runtime with audioP_setTuning
+ * @note freqThd is in bins of the FFT (about 15Hz each): closer peaks are the same source
+ */
+typedef struct AudioPTunings {
+	float ampliThd;						//FFT amplitude under which a frequency is not a peak
+	uint8_t freqThd;
+	uint8_t nbErrorDetectedMax;			//frames scanned before a source is declared not found
+	float emaWeight;					//weight of a new angle in its moving average, range [0,1]
+} AudioPTuning;
+
+/*
+ * Structure for sources
+ * @note: Freq is not in Hz!
+ */
+typedef struct Sources {
+	uint16_t freq;
+	float ampli;
+} Source;
+
+/*
+ * Audio pipeline: buffers of the four mics, sources of the last frame, parameters and smoothing state
+ * @note the fields are private to audio_processing.c, a context is only used through the audioP_ctxXxx functions
+ * @note the functions without a context use the pipeline of the robot, fed by the microphones. Any other context
+ * 			is fed by its owner with audioP_ctxProcessAudioData, e.g. recorded or synthetic samples
+ */
+typedef struct AudioPContexts {
+	//Audio buffer: 2*FFT_SIZE because arrays contain complex numbers (real + imaginary)
+	float mic_buffer_left[AUDIOP__CMPX_VAL*AUDIOP__FFT_SIZE];
+	float mic_buffer_right[AUDIOP__CMPX_VAL*AUDIOP__FFT_SIZE];
+	float mic_buffer_back[AUDIOP__CMPX_VAL*AUDIOP__FFT_SIZE];
+	float mic_buffer_front[AUDIOP__CMPX_VAL*AUDIOP__FFT_SIZE];
+
+	//copies of the mic buffers (double buffering) to avoid modifications of the buffer while analyzing it
+	float mic_data_right[AUDIOP__CMPX_VAL*AUDIOP__FFT_SIZE];
+	float mic_data_left[AUDIOP__CMPX_VAL*AUDIOP__FFT_SIZE];
+	float mic_data_front[AUDIOP__CMPX_VAL*AUDIOP__FFT_SIZE];
+	float mic_data_back[AUDIOP__CMPX_VAL*AUDIOP__FFT_SIZE];
+	float mic_ampli_left[AUDIOP__FFT_SIZE];
+
+	//Capture time and sequence number of the frame being filled in mic_buffer_xxx, and of the frame copied into mic_data_xxx
+	systime_t mic_buffer_time;
+	systime_t mic_data_time;
+	uint32_t mic_buffer_frame;
+	uint32_t mic_data_frame;
+	uint16_t samples_gathered;
+	binary_semaphore_t audioBufferIsReady;			//taken until a frame is full in mic_buffer_xxx
+
+	//freq, ampli and number of sources of the last frame
+	Source source[AUDIOP__NB_SOURCES_MAX];
+	uint8_t nb_sources;
+	uint8_t nb_sources_max;							//runtime capacity, at most AUDIOP__NB_SOURCES_MAX
+	AudioPTuning tuning;
+
+	//moving average of the angle of each source
+	bool ema_initialized[AUDIOP__NB_SOURCES_MAX];
+	int16_t ema_angle[AUDIOP__NB_SOURCES_MAX];
+
+	//band as the receiver of TELEM__MSG_BAND has it after the last band frame sent
+	uint8_t band_reference[AUDIOP__SCAN_BINS];
+	uint8_t band_index;
+	uint8_t band_frames_since_key;
+	bool band_key_needed;
+} audioP_ctx;
+
 
 /*===========================================================================*/
 /* Public functions definitions            									 */
@@ -54,13 +152,18 @@ void audioP_init(void);
 
 /*
  * @brief		scans the sound data and fills the destination_scan-array with all available sources
+ * @details		Scans at most frameBudget frames. Sources found in any of the frames are kept, matched by frequency,
+ * 				and for each of them the last valid angle is kept. The scan stops early as soon as one frame
+ * 				gave a valid angle for all its sources, so the latency is bounded by frameBudget frames.
  * @note			verifies if there is a killer whale
  *
- *  @pram[out] destination_scan		array of structure Destination to pass over available sources to main
+ *  @pram[out] destination_scan		array of structure Destination to pass over available sources to main,
+ *  									sources for which no angle could be calculated have valid set to false
+ *  @param[in] frameBudget			max number of frames to scan, AUDIOP__SCAN_FRAME_BUDGET is a good default
  *
  * @return	number of sources if no killer whale is detected and AUDIOP__KILLER_WHALE_DETECTED otherwise
  */
-uint16_t audioP_analyseSources(Destination *destination_scan);
+uint16_t audioP_analyseSources(Destination *destination_scan, uint8_t frameBudget);
 
 /*
  * brief		scans the sound data and updates the destination-structure of the target to which the robot is moving
@@ -68,7 +171,7 @@ uint16_t audioP_analyseSources(Destination *destination_scan);
  *  @pram[out] destination		structure Destination to update the freq and the angle of the destination in main
  *
  * return	SUCCES_AUDIO if angle calculations were successful,
- * 			AUDIOP__SOURCE_NOT_FOUND if the source could not be found or angle calculations had errors for NB_ERROR_DETECTED_MAX times,
+ * 			AUDIOP__SOURCE_NOT_FOUND if the source could not be found or angle calculations had errors for nbErrorDetectedMax frames (AudioPTuning),
  * 			AUDIOP__KILLER_WHALE_DETECTED if a killer whale was detected
  */
 uint16_t audioP_analyseDestination(Destination *destination);
@@ -79,10 +182,35 @@ uint16_t audioP_analyseDestination(Destination *destination);
  *  @pram[out] killer		structure Destination to update the freq and the angle of the killer whale in main
  *
  * return	SUCCES_AUDIO if angle calculations were successful,
- * 			AUDIOP__SOURCE_NOT_FOUND if the source could not be found or angle calculations had errors for NB_ERROR_DETECTED_MAX times,
+ * 			AUDIOP__SOURCE_NOT_FOUND if the source could not be found or angle calculations had errors for nbErrorDetectedMax frames (AudioPTuning),
  */
 uint16_t audioP_analyseKiller(Destination *killer);
 
+/*
+ * @brief	sets how many sources are tracked at most, the loudest ones are kept
+ *
+ *  @param[in] nbSourcesMax		new capacity, clamped between 1 and AUDIOP__NB_SOURCES_MAX
+ */
+void audioP_setNbSourcesMax(uint8_t nbSourcesMax);
+
+/*
+ * @brief	returns how many sources are tracked at most
+ */
+uint8_t audioP_getNbSourcesMax(void);
+
+/*
+ * @brief	sets the detection parameters, used from the next frame analysed
+ * @note 	freqThd and nbErrorDetectedMax are at least 1, emaWeight is clamped to [0,1]
+ *
+ *  @param[in] newTuning		parameters, AUDIOP__XXX_DEFAULT at start
+ */
+void audioP_setTuning(const AudioPTuning *newTuning);
+
+/*
+ * @brief	returns the detection parameters in use
+ */
+void audioP_getTuning(AudioPTuning *currentTuning);
+
 /*
  * @brief	converts the frequency from the FFT-domain into a real frequency in Hz
  *
@@ -92,5 +220,70 @@ uint16_t audioP_analyseKiller(Destination *killer);
  */
 uint16_t audioP_convertFreq(uint16_t freq);
 
+/*
+ * @brief	splits samples of the four microphones into four buffers of complex numbers, the imaginary parts are 0
+ * @note 	the kernel of audioP_ctxProcessAudioData, public for the benchmarks (dspBench.h)
+ *
+ *  @param[in] data  			samples sorted by mic: [micRight1, micLeft1, micBack1, micFront1, micRight2, etc...]
+ *  @param[in] nbSamples			nb. of samples per mic
+ *  @param[out] micXxx			2*nbSamples values each
+ */
+void audioP_deinterleave(const int16_t *data, uint16_t nbSamples, float *micRight, float *micLeft, float *micBack,
+		float *micFront);
+
+/*
+ * @brief	finds the nbSourcesMax loudest peaks of the scanned band of a spectrum, as for each frame analysed
+ * @note 	the kernel of the frame analysis, public for the benchmarks (dspBench.h)
+ *
+ *  @param[in] mic_ampli			amplitudes of the AUDIOP__FFT_SIZE frequencies
+ *  @param[in] tuning			detection parameters
+ *  @param[in] nbSourcesMax		capacity of sources, at most AUDIOP__NB_SOURCES_MAX
+ *  @param[out] sources			sources found, sorted by increasing frequency
+ *  @param[out] nbSources		nb. of sources found
+ *
+ * @return	AUDIOP__SUCCESS, or AUDIOP__ERROR if the spectrum could not be scanned
+ */
+uint16_t audioP_findPeaks(const float *mic_ampli, const AudioPTuning *tuning, uint8_t nbSourcesMax, Source *sources,
+		uint8_t *nbSources);
+
+/*
+ * @brief	converts the phase shift of a pair of microphones into an angle, clamped to [-90,90] degrees
+ * @note 	public for the benchmarks (dspBench.h)
+ *
+ *  @param[in] arg		phase shift in degrees
+ *  @param[in] freq		frequency of the source in Hz
+ *
+ * @return	angle in degrees
+ */
+int16_t audioP_convertPhase(int16_t arg, uint16_t freq);
+
+/*
+ * @brief	initialises a context with the parameters at start, its pipeline is then empty
+ * @note 	the functions without a context use a context already initialised
+ */
+void audioP_ctxInit(audioP_ctx *ctx);
+
+/*
+ * @brief	feeds samples of the four microphones to a context, a frame is ready to be analysed every 1024 samples
+ * @note 	Sampling freq of mic: 16kHz. Every 10ms we get 160 samples per mic
+ *
+ *  @param[in] data  			samples sorted by mic: [micRight1, micLeft1, micBack1, micFront1, micRight2, etc...]
+ *  @param[in] num_samples		nb. of values in data, 4 per sample (640 from the microphones)
+ */
+void audioP_ctxProcessAudioData(audioP_ctx *ctx, const int16_t *data, uint16_t num_samples);
+
+/*
+ * @brief	same as the functions without a context, on the pipeline of ctx
+ * @note 	the analyse functions wait for the next frame fed to ctx, several contexts can be analysed by
+ * 			different threads at the same time
+ */
+uint16_t audioP_ctxAnalyseSources(audioP_ctx *ctx, Destination *destination_scan, uint8_t frameBudget);
+uint16_t audioP_ctxAnalyseDestination(audioP_ctx *ctx, Destination *destination);
+uint16_t audioP_ctxAnalyseKiller(audioP_ctx *ctx, Destination *killer);
+void audioP_ctxSetNbSourcesMax(audioP_ctx *ctx, uint8_t nbSourcesMax);
+uint8_t audioP_ctxGetNbSourcesMax(const audioP_ctx *ctx);
+void audioP_ctxSetTuning(audioP_ctx *ctx, const AudioPTuning *newTuning);
+void audioP_ctxGetTuning(const audioP_ctx *ctx, AudioPTuning *currentTuning);
+
 
 #endif /* AUDIO_PROCESSING_H */
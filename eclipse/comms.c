@@ -10,6 +10,8 @@
  *
  * Functions prefix for public functions in this file: comms_
  */
+#include <string.h>
+
 #include <hal.h>
 
 #include <chstreams.h>
@@ -29,12 +31,26 @@
  * From https://upload.wikimedia.org/wikipedia/commons/d/dd/ASCII-Table.svg
  * we define the different bounds and characters needed
  */
-#define ASCII_NORMAL_TEXT_BEGIN 	33
+#define ASCII_BACKSPACE			8
+#define ASCII_SPACE				32
 #define ASCII_NORMAL_TEXT_END 	126
 #define ASCII_DELETE_CHARACTER	127
 
-//Number constants
-#define TWO						2
+/* @note Transmission queue
+ * comms_printf formats into a line buffer and copies the line into a ring buffer, the drain thread
+ * then writes the ring buffer to the UART. The calling thread thus never waits for the 115200 baud link.
+ * When the ring buffer is full, the whole line is dropped and counted. COMMS_TX_BUFFER_SIZE must be a power of 2. */
+#define COMMS_TX_BUFFER_SIZE		2048
+#define COMMS_TX_LINE_SIZE		256			//longest formatted message, longer ones are truncated
+#define COMMS_TX_WORKING_AREA_SIZE	256
+
+/* @note Reception
+ * The reception thread takes the characters from the serial driver input queue as they arrive, edits the
+ * line and only echoes what changed (the character typed, or "\b \b" to erase one). A finished line is either
+ * executed as a command, in this thread, or put in the queue of lines read by comms_readf. */
+#define COMMS_RX_QUEUE_LINES		4			//lines waiting for comms_readf, more are dropped
+#define COMMS_MAX_COMMANDS		16
+#define COMMS_RX_WORKING_AREA_SIZE	1024			//command handlers run in this thread and use comms_printf
 
 
 /*===========================================================================*/
@@ -43,6 +59,119 @@
 
 static bool comms_started = false;
 
+/* @note Ring buffer
+ * txHead is only written by the producers (serialised by txProducerLock) and txTail only by the drain thread,
+ * so the drain thread never takes a lock. Indexes are free running and wrapped with COMMS_TX_BUFFER_SIZE-1. */
+static uint8_t txBuffer[COMMS_TX_BUFFER_SIZE];
+static volatile uint32_t txHead = 0;
+static volatile uint32_t txTail = 0;
+static MUTEX_DECL(txProducerLock);
+static BSEMAPHORE_DECL(txDataReady, TRUE);
+
+static uint32_t txDroppedBytes = 0;
+static uint32_t txDroppedMessages = 0;
+
+//Queue of lines for comms_readf: rxLineHead is only written by the reception thread, rxLineTail by the readers
+static char rxLines[COMMS_RX_QUEUE_LINES][COMMS__LINE_SIZE];
+static volatile uint32_t rxLineHead = 0;
+static volatile uint32_t rxLineTail = 0;
+static SEMAPHORE_DECL(rxLinesReady, 0);
+static MUTEX_DECL(rxReaderLock);
+static uint32_t rxDroppedLines = 0;
+
+/*
+ * Entry of the command table
+ */
+typedef struct CommsCommands {
+	const char *name;
+	const char *help;
+	comms_commandHandler handler;
+} CommsCommand;
+
+static CommsCommand commands[COMMS_MAX_COMMANDS];
+static uint8_t nbCommands = 0;
+static MUTEX_DECL(commandsLock);
+
+
+/*===========================================================================*/
+/* Private functions definitions                                             */
+/*===========================================================================*/
+
+/**
+ * @brief   Copies bytes into the transmission ring buffer and wakes the drain thread
+ * @note 	The caller must hold txProducerLock. Nothing is copied if there is not enough space.
+ *
+ * @return	true if the bytes were queued, false if they were dropped
+*/
+bool commsTxEnqueue(const uint8_t *data, uint32_t size);
+
+/**
+ * @brief   Edits the line being typed with a received character, echoes the change and handles finished lines
+ *
+ * @parameter[in] readChar		character received
+*/
+void commsRxEditLine(char readChar);
+
+/**
+ * @brief   Executes a finished line if it starts with a command, or queues it for comms_readf otherwise
+ *
+ * @parameter[in] line			finished line, \0 terminated
+*/
+void commsRxDispatch(const char *line);
+
+/**
+ * @brief   Lists the commands, handler of the built-in help command
+*/
+void commsHelpCommand(uint8_t argc, char *argv[]);
+
+
+/*===========================================================================*/
+/* Threads used in comms                  										*/
+/*===========================================================================*/
+
+/* Drain thread: writes the ring buffer to the UART. It has a low priority as output is never urgent,
+ * and only it blocks while the serial driver sends the bytes. */
+static THD_WORKING_AREA(waCommsTxThd, COMMS_TX_WORKING_AREA_SIZE);
+static THD_FUNCTION(CommsTxThd, arg)
+{
+	(void)arg;
+	chRegSetThreadName(__FUNCTION__);
+
+	uint32_t tail 		= 0;
+	uint32_t chunkSize 	= 0;
+
+	while(true){
+		chBSemWait(&txDataReady);
+
+		tail = txTail;
+		while(tail != txHead){
+			//write the contiguous part up to the end of the buffer, then the wrapped part
+			chunkSize = txHead - tail;
+			if((tail & (COMMS_TX_BUFFER_SIZE-1)) + chunkSize > COMMS_TX_BUFFER_SIZE){
+				chunkSize = COMMS_TX_BUFFER_SIZE - (tail & (COMMS_TX_BUFFER_SIZE-1));
+			}
+			sdWrite(&UART_PORT, &txBuffer[tail & (COMMS_TX_BUFFER_SIZE-1)], chunkSize);
+
+			tail += chunkSize;
+			__sync_synchronize();				//bytes are sent before the space is given back to the producers
+			txTail = tail;
+		}
+	}
+}
+
+
+/* Reception thread: edits and dispatches the lines typed by the user, so no other thread waits for the characters */
+static THD_WORKING_AREA(waCommsRxThd, COMMS_RX_WORKING_AREA_SIZE);
+static THD_FUNCTION(CommsRxThd, arg)
+{
+	(void)arg;
+	chRegSetThreadName(__FUNCTION__);
+
+	while(true){
+		commsRxEditLine((char) chSequentialStreamGet(UART_PORT_STREAM));
+	}
+}
+
 
 /*===========================================================================*/
 /* Public functions for setting/getting internal parameters           	  */
@@ -60,52 +189,233 @@ void comms_start(void)
 
 			//starts the serial communication on UART
 			sdStart(&UART_PORT, &ser_cfg);
+
+			chThdCreateStatic(waCommsTxThd, sizeof(waCommsTxThd), NORMALPRIO-1, CommsTxThd, NULL);
+
+			comms_registerCommand("help", "lists the commands", commsHelpCommand);
+			chThdCreateStatic(waCommsRxThd, sizeof(waCommsRxThd), NORMALPRIO, CommsRxThd, NULL);
 	}
 	comms_started = true;
 }
 
 int comms_printf(const char *fmt, ...) {
+	static char line[COMMS_TX_LINE_SIZE];			//only used while holding txProducerLock
 	va_list ap;
 	int formatted_bytes;
 
+	chMtxLock(&txProducerLock);
+
 	va_start(ap, fmt);
-	formatted_bytes = chvprintf(UART_PORT_STREAM, fmt, ap);
+	formatted_bytes = chvsnprintf(line, COMMS_TX_LINE_SIZE, fmt, ap);
 	va_end(ap);
 
+	commsTxEnqueue((uint8_t *) line, strnlen(line, COMMS_TX_LINE_SIZE));
+
+	chMtxUnlock(&txProducerLock);
+
 	return formatted_bytes;
 }
 
-uint16_t comms_readf(char *readText, uint16_t arraySize){
-	uint16_t numOfCharsRead = 0;
-	char readChar;
-
-	for(uint16_t i = 0; i<arraySize-1;i++){
-		readChar = chSequentialStreamGet(UART_PORT_STREAM);
-		switch(readChar){
-		case '\n': 									//for either \n or \n end string and return
-		case '\r':
-			readText[i] = '\0';
-			comms_printf(" \n\r");
-			return numOfCharsRead = i-1;				// we do not count \0
-		case ASCII_DELETE_CHARACTER:					//ASCII special delete character
-			readText[i-1] = '\0';
-			readText[i] = '\0';
-			i-=TWO;								//-2 because we want to re read i-1 and for will increment i
-			comms_printf("\r                                   \r%s",readText);	//erase line
+bool comms_write(const uint8_t *data, uint32_t size)
+{
+	bool queued = false;
+
+	chMtxLock(&txProducerLock);
+	queued = commsTxEnqueue(data, size);
+	chMtxUnlock(&txProducerLock);
+
+	return queued;
+}
+
+void comms_getTxStats(uint32_t *droppedBytes, uint32_t *droppedMessages)
+{
+	chMtxLock(&txProducerLock);
+	*droppedBytes = txDroppedBytes;
+	*droppedMessages = txDroppedMessages;
+	chMtxUnlock(&txProducerLock);
+}
+
+uint32_t comms_getTxFree(void)
+{
+	return COMMS_TX_BUFFER_SIZE - (txHead - txTail);
+}
+
+uint16_t comms_readf(char *readText, uint16_t arraySize)
+{
+	return comms_readfTimeout(readText, arraySize, TIME_INFINITE);
+}
+
+uint16_t comms_readfTimeout(char *readText, uint16_t arraySize, systime_t timeout)
+{
+	if(chSemWaitTimeout(&rxLinesReady, timeout) != MSG_OK){
+		return COMMS__TIMEOUT;
+	}
+
+	chMtxLock(&rxReaderLock);
+	strncpy(readText, rxLines[rxLineTail % COMMS_RX_QUEUE_LINES], arraySize);
+	readText[arraySize-1] = '\0';
+	__sync_synchronize();						//the line is copied before the reception thread can reuse its place
+	rxLineTail++;
+	chMtxUnlock(&rxReaderLock);
+
+	return (uint16_t) strlen(readText);
+}
+
+bool comms_registerCommand(const char *name, const char *help, comms_commandHandler handler)
+{
+	bool registered = false;
+
+	chMtxLock(&commandsLock);
+	if(nbCommands < COMMS_MAX_COMMANDS){
+		commands[nbCommands].name = name;
+		commands[nbCommands].help = help;
+		commands[nbCommands].handler = handler;
+		nbCommands++;
+		registered = true;
+	}
+	chMtxUnlock(&commandsLock);
+
+	return registered;
+}
+
+uint32_t comms_getRxDroppedLines(void)
+{
+	return rxDroppedLines;
+}
+
+/*===========================================================================*/
+/* Private functions	 code												   */
+/*===========================================================================*/
+
+bool commsTxEnqueue(const uint8_t *data, uint32_t size)
+{
+	uint32_t head 		= txHead;
+	uint32_t firstPart 	= 0;
+
+	if(size > COMMS_TX_BUFFER_SIZE - (head - txTail)){
+		txDroppedBytes += size;
+		txDroppedMessages++;
+		return false;
+	}
+
+	//copy up to the end of the buffer, then the wrapped part at its beginning
+	firstPart = COMMS_TX_BUFFER_SIZE - (head & (COMMS_TX_BUFFER_SIZE-1));
+	if(firstPart > size){
+		firstPart = size;
+	}
+	memcpy(&txBuffer[head & (COMMS_TX_BUFFER_SIZE-1)], data, firstPart);
+	memcpy(txBuffer, data + firstPart, size - firstPart);
+
+	__sync_synchronize();						//bytes are in the buffer before the drain thread can see them
+	txHead = head + size;
+
+	chBSemSignal(&txDataReady);
+	return true;
+}
+
+void commsRxEditLine(char readChar)
+{
+	static char line[COMMS__LINE_SIZE];
+	static uint8_t lineLength 	= 0;
+	static bool lastWasReturn 	= false;		//to take \r\n as a single end of line
+	bool isReturn 				= false;
+
+	switch(readChar){
+	case '\n': 									//for either \n or \r end the line
+	case '\r':
+		isReturn = true;
+		if(lastWasReturn && lineLength == 0){
 			break;
+		}
+		line[lineLength] = '\0';
+		lineLength = 0;
+		comms_printf("\n\r");
+		commsRxDispatch(line);
+		break;
+	case ASCII_BACKSPACE:
+	case ASCII_DELETE_CHARACTER:					//ASCII special delete character
+		if(lineLength > 0){
+			lineLength--;
+			comms_printf("\b \b");				//erase only the last character on the terminal
+		}
+		break;
+	default:
+		//We protect against special ASCII characters so we do nothing for them
+		if(ASCII_SPACE <= readChar && readChar <= ASCII_NORMAL_TEXT_END && lineLength < COMMS__LINE_SIZE-1){
+			line[lineLength++] = readChar;
+			comms_write((uint8_t *) &readChar, sizeof(readChar));
+		}
+		break;
+	}
+	lastWasReturn = isReturn;
+}
 
-		default:
-			//We protect against special ASCII characters so we do nothing for them
-			if( ASCII_NORMAL_TEXT_BEGIN <= readChar && readChar <= ASCII_NORMAL_TEXT_END){
-				readText[i] = readChar;
-				readText[i+1]= '\0';
-				//we erase line before writing because comms_printf adds space between characters otherwise
-				comms_printf("\r                                    \r%s",readText);
-			}
+void commsRxDispatch(const char *line)
+{
+	static char words[COMMS__LINE_SIZE];		//only used by the reception thread
+	char *argv[COMMS__MAX_ARGS];
+	uint8_t argc 		= 0;
+	char *read 			= words;
+	bool tooManyWords 	= false;
+	size_t length 		= strnlen(line, COMMS__LINE_SIZE-1);
+
+	//Split a copy of the line in words separated by spaces
+	memcpy(words, line, length);
+	words[length] = '\0';
+	while(true){
+		while(*read == ASCII_SPACE){
+			*read++ = '\0';
+		}
+		if(*read == '\0'){
 			break;
 		}
+		if(argc == COMMS__MAX_ARGS){
+			tooManyWords = true;
+			break;
+		}
+		argv[argc++] = read;
+		while(*read != '\0' && *read != ASCII_SPACE){
+			read++;
+		}
+	}
+
+	if(argc > 0){
+		chMtxLock(&commandsLock);
+		for(uint8_t command = 0; command < nbCommands; command++){
+			if(strcmp(argv[0], commands[command].name) == 0){
+				comms_commandHandler handler = commands[command].handler;
+				chMtxUnlock(&commandsLock);
+				//a command never gets a shortened line
+				if(tooManyWords){
+					comms_printf("%s: at most %u words, the command is ignored\n\r", argv[0], COMMS__MAX_ARGS);
+					return;
+				}
+				handler(argc, argv);
+				return;
+			}
+		}
+		chMtxUnlock(&commandsLock);
 	}
 
-	comms_printf(" \n\r");
-	return numOfCharsRead;
+	//Not a command: the line is for comms_readf
+	if(rxLineHead - rxLineTail >= COMMS_RX_QUEUE_LINES){
+		rxDroppedLines++;
+		return;
+	}
+	strncpy(rxLines[rxLineHead % COMMS_RX_QUEUE_LINES], line, COMMS__LINE_SIZE);
+	__sync_synchronize();						//the line is complete before the readers can see it
+	rxLineHead++;
+	chSemSignal(&rxLinesReady);
+}
+
+void commsHelpCommand(uint8_t argc, char *argv[])
+{
+	(void) argc;
+	(void) argv;
+
+	chMtxLock(&commandsLock);
+	for(uint8_t command = 0; command < nbCommands; command++){
+		comms_printf("%s : %s\n\r", commands[command].name, commands[command].help);
+	}
+	chMtxUnlock(&commandsLock);
 }
@@ -10,6 +10,26 @@
 #ifndef COMMS_H_
 #define COMMS_H_
 
+/*===========================================================================*/
+/* Constants definition for this library						               */
+/*===========================================================================*/
+
+#define COMMS__LINE_SIZE					64				//longest line the user can type, including \0
+#define COMMS__MAX_ARGS					10				//words of a command line, including the command name (mission list takes 8 frequencies)
+#define COMMS__TIMEOUT					UINT16_MAX		//returned by comms_readfTimeout when no line arrived in time
+
+
+/*===========================================================================*/
+/* Types						 			                           			 */
+/*===========================================================================*/
+
+/*
+ * Handler of a command typed by the user. argv[0] is the command name, the other words are its arguments.
+ * It runs in the reception thread, so it must not block for long: it should only set parameters or post requests.
+ */
+typedef void (*comms_commandHandler)(uint8_t argc, char *argv[]);
+
+
 /*===========================================================================*/
 /* Public functions definitions            									 */
 /*===========================================================================*/
@@ -23,6 +43,9 @@ void comms_start(void);
  * @brief   use same function as chprintf() from chibios for sending information : System formatted output function.
  * @details This function implements a minimal @p printf() like functionality
  *          with output on a @p BaseSequentialStream.
+ *          The text is formatted into a queue and sent by a low priority thread, so this function never waits
+ *          for the serial link. If the queue is full the message is dropped (see comms_getTxStats),
+ *          messages longer than 255 characters are truncated.
  *          The general parameters format is: %[-][width|*][.precision|*][l|L]p.
  *          The following parameter types (p) are supported:
  *          - <b>x</b> hexadecimal integer.
@@ -44,11 +67,37 @@ void comms_start(void);
 int comms_printf(const char *fmt, ...);
 
 /**
- * @brief  	read from  USB_PORT or UART_PORT and store in char array
- * @note 	this function will print back what the user enters as he enters
- * 				so that he sees what he inputs
- * @warning	this function is blocking for the calling thread until either
- * 				the end char is met or the user presses enter
+ * @brief   queues raw bytes for transmission, used for binary telemetry frames
+ * @note 	The bytes are queued atomically with respect to comms_printf, so they are never mixed with text.
+ * 			As for comms_printf, nothing is queued if the queue has not enough space.
+ *
+ * @param[in] data		bytes to send
+ * @param[in] size		number of bytes
+ *
+ * @return	true if the bytes were queued, false if they were dropped
+ */
+bool comms_write(const uint8_t *data, uint32_t size);
+
+/**
+ * @brief   returns how much output was dropped because the transmission queue was full
+ *
+ * @param[out] droppedBytes		number of bytes dropped since start
+ * @param[out] droppedMessages	number of messages dropped since start
+ */
+void comms_getTxStats(uint32_t *droppedBytes, uint32_t *droppedMessages);
+
+/**
+ * @brief   returns how many bytes the transmission queue can take now, so that a bulk sender can wait for space
+ * 			instead of having its messages dropped
+ */
+uint32_t comms_getTxFree(void);
+
+/**
+ * @brief  	waits for the next line typed by the user that is not a command, and stores it in a char array
+ * @note 	The characters are received and echoed by the reception thread as they are typed, so the user sees
+ * 				what they input, whether a thread is waiting in this function or not. Lines whose first word is a
+ * 				registered command are executed and never returned here.
+ * @warning	this function is blocking for the calling thread until a line is entered
  *
  * @param[out] readText				pointer to char array where characters should be stored
  * 										\0 will be put at the end of table after reading
@@ -58,5 +107,30 @@ int comms_printf(const char *fmt, ...);
  */
 uint16_t comms_readf(char *readText, uint16_t arraySize);
 
+/**
+ * @brief  	same as comms_readf, but waits at most timeout
+ *
+ * @param[in] timeout				system ticks to wait at most, TIME_INFINITE or TIME_IMMEDIATE are possible
+ *
+ *@return	Number of chars read and stored in array (not counting \0), COMMS__TIMEOUT if no line was entered in time
+ */
+uint16_t comms_readfTimeout(char *readText, uint16_t arraySize, systime_t timeout);
+
+/**
+ * @brief  	adds a command to the command table, it is executed as soon as a line starting with its name is entered
+ *
+ * @param[in] name		first word of the line, must stay valid (a string literal)
+ * @param[in] help		one line description printed by the help command, must stay valid
+ * @param[in] handler	function called with the words of the line, not called (the user is told) if there are more than COMMS__MAX_ARGS
+ *
+ *@return	false if the table is full
+ */
+bool comms_registerCommand(const char *name, const char *help, comms_commandHandler handler);
+
+/**
+ * @brief   returns how many complete lines were dropped because nobody read them
+ */
+uint32_t comms_getRxDroppedLines(void);
+
 
 #endif /* COMMS_H_ */
@@ -0,0 +1,836 @@
+/*
+ * dspBench.c
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Micro-benchmarks of the DSP kernels, see dspBench.h. The cases are not stored: they are enumerated
+ * 		from the groups, by size, then input, then kernel, so that the first kernel of a group comes first.
+ * 		The alternatives to the kernels of the pipeline are written here, they are only candidates.
+ *
+ * Functions prefix for public functions in this file: bench_
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <arm_math.h>
+#include <arm_const_structs.h>
+
+#include <dspBench.h>
+#include <fft.h>
+#include <audio_processing.h>
+#include <profiling.h>
+#include <numeric.h>
+
+//the benchmarks take about 20kB of RAM, they are only built on request (see dspBench.h)
+#if BENCH__ENABLED
+
+/*===========================================================================*/
+/* Constants definition for this file						               */
+/*===========================================================================*/
+
+#define CMPX_VAL								2			//a complex number is a real and an imaginary part
+#define NB_MICS								4
+#define SIZE_MAX_VALUES						1024			//largest FFT and largest nb. of values compared
+#define DEINTERLEAVE_SIZE_MAX				256			//the four microphones must fit in the work buffer
+#define PPM									1000000.0f
+
+//Kernels, those of a group are consecutive, the first one is the kernel of the pipeline or the reference
+#define KERNEL_CFFT							0
+#define KERNEL_DOFFT_OPTIMIZED				1
+#define KERNEL_FFT_C							2
+#define KERNEL_RFFT							3
+#define KERNEL_MAG							4
+#define KERNEL_MAG_SQUARED					5
+#define KERNEL_FIND_PEAKS					6
+#define KERNEL_PEAKS_SORT_ALL				7
+#define KERNEL_PEAKS_INSERTION				8
+#define KERNEL_ATAN2F						9
+#define KERNEL_ATAN2_APPROX					10
+#define KERNEL_ATAN2_POLY					11
+#define KERNEL_DEINTERLEAVE					12
+#define KERNEL_DEINTERLEAVE_PER_MIC			13
+#define KERNEL_EMA_DOUBLE					14
+#define KERNEL_EMA_FLOAT						15
+#define KERNEL_EMA_Q15						16
+#define KERNEL_PHASE_DOUBLE					17
+#define KERNEL_PHASE_FLOAT					18
+#define KERNEL_FREQ_DOUBLE					19
+#define KERNEL_FREQ_FLOAT					20
+#define NB_KERNELS							21
+
+//Groups
+#define GROUP_FFT							0
+#define GROUP_MAGNITUDE						1
+#define GROUP_PEAKS							2
+#define GROUP_ANGLE							3
+#define GROUP_DEINTERLEAVE					4
+#define GROUP_EMA							5
+#define GROUP_PHASE							6
+#define GROUP_FREQ							7
+#define NB_GROUPS							8
+#define GROUP_INPUTS_MAX						3
+#define GROUP_SIZES_MAX						3
+
+//Inputs
+#define INPUT_NOISE							0			//uniform white noise
+#define INPUT_TONES							1			//three tones (fft) or three peaks (peaks) over a low noise
+#define INPUT_FLOOR							2			//noise around the detection threshold, many small peaks
+#define INPUT_DENSE							3			//a peak every PEAK_DENSE_SPACING bins
+#define INPUT_CIRCLE							4			//points on a circle, at regular angles
+#define INPUT_BAND							5			//the bins of the scanned band, in turn
+#define NB_INPUTS							6
+
+//Input levels
+#define NOISE_AMPLI							1000.0f		//in microphone units
+#define TONES_NOISE_AMPLI					20.0f
+#define TONES_AMPLI							2000.0f		//of the first tone, the next ones are twice quieter each
+#define NB_TONES								3
+#define PEAK_DENSE_SPACING					5			//more than AUDIOP__FREQ_THD_DEFAULT, the peaks stay distinct
+#define PEAK_TONES_SPACING					20
+
+//Polynomial approximations of atan on [0,1]
+#define ATAN_APPROX_GAIN						0.273f		//atan(z) = z*(pi/4 + 0.273*(1-z)), error 0.0038 rad
+#define ATAN_POLY_C1							0.9998660f	//Abramowitz & Stegun 4.4.49, error 1e-5 rad
+#define ATAN_POLY_C3							(-0.3302995f)
+#define ATAN_POLY_C5							0.1801410f
+#define ATAN_POLY_C7							(-0.0851330f)
+#define ATAN_POLY_C9							0.0208351f
+
+/* @note Double versions
+ * The numeric code before numeric.h: double constants, so emulated double operations on the Cortex-M4F.
+ * The constants are cast to double, they stay double even if the literals are built as float. */
+#define EMA_WEIGHT							AUDIOP__EMA_WEIGHT_DEFAULT
+#define EMA_WEIGHT_Q15						NUM__Q15(EMA_WEIGHT)
+#define ANGLE_MAX_DEG						180.0f
+#define PHASE_DEG90							90
+#define PHASE_DEG360							360
+#define PHASE_SPEED_SOUND					343			//[m/s], as audio_processing.c
+#define PHASE_MIC_DISTANCE					((double) 0.06)	//[m]
+#define PHASE_FREQ_MIN_HZ					200.0f		//scanned band
+#define PHASE_FREQ_MAX_HZ					1230.0f
+#define CONVERT_FREQ_CONST					15611
+#define CONVERT_FREQ_PARAM					((double) 15.244)
+
+
+/*===========================================================================*/
+/* Structures						 			                            */
+/*===========================================================================*/
+
+/*
+ * Kernel benchmarked
+ */
+typedef struct BenchKernels {
+	const char *name;
+	uint8_t group;
+	uint16_t onlySize;				//0 if the kernel takes all the sizes of its group
+} BenchKernel;
+
+/*
+ * Group of kernels computing the same thing, with the inputs and sizes they are benchmarked on
+ */
+typedef struct BenchGroups {
+	uint8_t firstKernel;
+	uint8_t nbKernels;
+	uint8_t inputs[GROUP_INPUTS_MAX];
+	uint8_t nbInputs;
+	uint16_t sizes[GROUP_SIZES_MAX];
+	uint8_t nbSizes;
+} BenchGroup;
+
+/*
+ * Case: a kernel on an input and a size
+ */
+typedef struct BenchCases {
+	uint8_t kernel;
+	uint8_t input;
+	uint16_t size;
+} BenchCase;
+
+
+/*===========================================================================*/
+/* Static variables definitions 		 			                            */
+/*===========================================================================*/
+
+static const BenchKernel kernels[NB_KERNELS] = {
+	{"arm_cfft_f32", GROUP_FFT, 0},
+	{"doFFT_optimized", GROUP_FFT, AUDIOP__FFT_SIZE},
+	{"fft_c", GROUP_FFT, 0},
+	{"arm_rfft_fast_f32", GROUP_FFT, 0},
+	{"arm_cmplx_mag_f32", GROUP_MAGNITUDE, 0},
+	{"arm_cmplx_mag_squared_f32", GROUP_MAGNITUDE, 0},
+	{"audioP_findPeaks", GROUP_PEAKS, 0},
+	{"peaks_sort_all", GROUP_PEAKS, 0},
+	{"peaks_insertion", GROUP_PEAKS, 0},
+	{"atan2f", GROUP_ANGLE, 0},
+	{"atan2_approx", GROUP_ANGLE, 0},
+	{"atan2_poly", GROUP_ANGLE, 0},
+	{"audioP_deinterleave", GROUP_DEINTERLEAVE, 0},
+	{"deinterleave_per_mic", GROUP_DEINTERLEAVE, 0},
+	{"ema_double", GROUP_EMA, 0},
+	{"num_EmaF", GROUP_EMA, 0},
+	{"num_EmaQ15", GROUP_EMA, 0},
+	{"convert_phase_double", GROUP_PHASE, 0},
+	{"audioP_convertPhase", GROUP_PHASE, 0},
+	{"convert_freq_double", GROUP_FREQ, 0},
+	{"audioP_convertFreq", GROUP_FREQ, 0},
+};
+
+static const BenchGroup groups[NB_GROUPS] = {
+	{KERNEL_CFFT, 4, {INPUT_NOISE, INPUT_TONES}, 2, {256, 512, 1024}, 3},
+	{KERNEL_MAG, 2, {INPUT_NOISE}, 1, {AUDIOP__FFT_SIZE}, 1},
+	{KERNEL_FIND_PEAKS, 3, {INPUT_FLOOR, INPUT_TONES, INPUT_DENSE}, 3, {AUDIOP__NB_SOURCES_DEFAULT, AUDIOP__NB_SOURCES_MAX}, 2},
+	{KERNEL_ATAN2F, 3, {INPUT_NOISE, INPUT_CIRCLE}, 2, {SIZE_MAX_VALUES}, 1},
+	{KERNEL_DEINTERLEAVE, 2, {INPUT_NOISE}, 1, {160, DEINTERLEAVE_SIZE_MAX}, 2},
+	{KERNEL_EMA_DOUBLE, 3, {INPUT_NOISE}, 1, {SIZE_MAX_VALUES}, 1},
+	{KERNEL_PHASE_DOUBLE, 2, {INPUT_NOISE}, 1, {SIZE_MAX_VALUES}, 1},
+	{KERNEL_FREQ_DOUBLE, 2, {INPUT_BAND}, 1, {SIZE_MAX_VALUES}, 1},
+};
+
+static const char *inputNames[NB_INPUTS] = {"noise", "tones", "floor", "dense", "circle", "band"};
+
+static const AudioPTuning tuning = {AUDIOP__AMPLI_THD_DEFAULT, AUDIOP__FREQ_THD_DEFAULT, AUDIOP__NB_ERROR_DETECTED_DEFAULT,
+		AUDIOP__EMA_WEIGHT_DEFAULT};
+
+//Buffers shared by the cases: the input and output of the kernels, and the output of the first kernel of the group
+static union {
+	float values[CMPX_VAL*SIZE_MAX_VALUES];
+	complex_float cmpx[SIZE_MAX_VALUES];			//same memory layout, for fft_c
+} work;
+static float out[SIZE_MAX_VALUES];
+static float reference[SIZE_MAX_VALUES];
+static int16_t samples[NB_MICS*DEINTERLEAVE_SIZE_MAX];
+static arm_rfft_fast_instance_f32 rfft;
+
+static Source sources[AUDIOP__NB_SOURCES_MAX];
+static uint8_t nbSources;
+static Source referenceSources[AUDIOP__NB_SOURCES_MAX];
+static uint8_t nbReferenceSources;
+static Source allPeaks[AUDIOP__SCAN_BINS];
+
+
+/*===========================================================================*/
+/* Private functions definitions                                             */
+/*===========================================================================*/
+
+/**
+ * @brief   Enumerates the cases, and gives the one at caseIndex
+ *
+ * @parameter[out] found		case at caseIndex, not written if there is none
+ *
+ * @return	the number of cases
+*/
+uint8_t benchCases(uint8_t caseIndex, BenchCase *found);
+
+/**
+ * @brief   Builds the input of a kernel, it is the same at each call
+*/
+void benchPrepare(const BenchCase *benchCase);
+
+/**
+ * @brief   Runs a kernel on the input built by benchPrepare
+*/
+void benchKernel(uint8_t kernel, uint16_t size);
+
+/**
+ * @brief   Returns the number of values of the output of a kernel compared by benchError, 0 for the peaks
+*/
+uint16_t benchNbValues(uint8_t kernel, uint16_t size);
+
+/**
+ * @brief   Returns a value of the output of a kernel, converted to what the first kernel of its group gives
+*/
+float benchValue(uint8_t kernel, uint16_t size, uint16_t index);
+
+/**
+ * @brief   Runs the first kernel of the group and the kernel of a case on the input of the case, and compares them
+ *
+ * @return	error in ppm, see dspBench.h
+*/
+uint32_t benchError(const BenchCase *benchCase);
+
+/**
+ * @brief   Returns a pseudo random number in [-1,1], the sequence restarts at each benchPrepare
+*/
+float benchRandom(uint32_t *state);
+
+/**
+ * @brief   Alternatives to audioP_findPeaks: all the peaks of the band are listed, then the loudest ones are
+ * 			selected by sorting them all, or by an insertion sort in an array of nbSourcesMax sources
+*/
+uint8_t benchCollectPeaks(const float *mic_ampli);
+void benchPeaksSortAll(const float *mic_ampli, uint8_t nbSourcesMax);
+void benchPeaksInsertion(const float *mic_ampli, uint8_t nbSourcesMax);
+int benchCompareAmpliDesc(const void *source1, const void *source2);
+int benchCompareFreq(const void *source1, const void *source2);
+
+/**
+ * @brief   Alternatives to atan2f, the approximation of atan on [0,1] is extended to all the quadrants
+*/
+float benchAtan2Approx(float y, float x);
+float benchAtan2Poly(float y, float x);
+float benchAtan2Quadrants(float y, float x, float (*atanUnit)(float z));
+float benchAtanApprox(float z);
+float benchAtanPoly(float z);
+
+/**
+ * @brief   Alternative to audioP_deinterleave, one microphone after the other
+*/
+void benchDeinterleavePerMic(const int16_t *data, uint16_t nbSamples, float *micBuffers);
+
+/**
+ * @brief   Double versions of the numeric code, as before numeric.h: moving average of the angles, phase shift
+ * 			to angle (audioP_convertPhase) and bin to Hz (audioP_convertFreq)
+*/
+int16_t benchEmaDouble(int16_t past, int16_t sample);
+int16_t benchConvertPhaseDouble(int16_t arg, uint16_t freq);
+uint16_t benchConvertFreqDouble(uint16_t freq);
+
+
+/*===========================================================================*/
+/* Public functions              											*/
+/*===========================================================================*/
+
+uint8_t bench_getNbCases(void)
+{
+	return benchCases(0, NULL);
+}
+
+bool bench_run(uint8_t caseIndex, uint16_t repetitions, BenchResult *result)
+{
+	BenchCase benchCase;
+	uint32_t start 			= 0;
+	uint32_t ticks 			= 0;
+	uint32_t minTicks 		= UINT32_MAX;
+	uint64_t sumTicks 		= 0;
+
+	if(caseIndex >= benchCases(caseIndex, &benchCase) || repetitions == 0){
+		return false;
+	}
+
+	//a first run not timed, to load the code and the tables in the caches
+	benchPrepare(&benchCase);
+	benchKernel(benchCase.kernel, benchCase.size);
+
+	for(uint16_t repetition_counter = 0; repetition_counter < repetitions; repetition_counter++){
+		benchPrepare(&benchCase);
+		start = prof_now();
+		benchKernel(benchCase.kernel, benchCase.size);
+		ticks = prof_now() - start;
+
+		minTicks = (ticks < minTicks) ? ticks : minTicks;
+		sumTicks += ticks;
+	}
+
+	result->kernel = kernels[benchCase.kernel].name;
+	result->input = inputNames[benchCase.input];
+	result->size = benchCase.size;
+	result->repetitions = repetitions;
+	result->minNs = prof_ticksToNs(minTicks);
+	result->meanNs = prof_ticksToNs(sumTicks/repetitions);
+	result->errorPpm = benchError(&benchCase);
+	return true;
+}
+
+
+/*===========================================================================*/
+/* Private functions	 code												   */
+/*===========================================================================*/
+
+uint8_t benchCases(uint8_t caseIndex, BenchCase *found)
+{
+	uint8_t nb_cases 		= 0;
+
+	for(uint8_t group_counter = 0; group_counter < NB_GROUPS; group_counter++){
+		const BenchGroup *group 	= &groups[group_counter];
+
+		for(uint8_t size_counter = 0; size_counter < group->nbSizes; size_counter++){
+			for(uint8_t input_counter = 0; input_counter < group->nbInputs; input_counter++){
+				for(uint8_t kernel = group->firstKernel; kernel < group->firstKernel + group->nbKernels; kernel++){
+					if(kernels[kernel].onlySize != 0 && kernels[kernel].onlySize != group->sizes[size_counter]){
+						continue;
+					}
+					if(nb_cases == caseIndex && found != NULL){
+						found->kernel = kernel;
+						found->input = group->inputs[input_counter];
+						found->size = group->sizes[size_counter];
+					}
+					nb_cases++;
+				}
+			}
+		}
+	}
+	return nb_cases;
+}
+
+void benchPrepare(const BenchCase *benchCase)
+{
+	uint32_t state 			= 1;
+	uint16_t size 			= benchCase->size;
+	float sample 			= 0;
+
+	switch(kernels[benchCase->kernel].group){
+		case GROUP_FFT:
+			//real samples, as complex numbers for the complex FFTs
+			for(uint16_t sample_counter = 0; sample_counter < size; sample_counter++){
+				sample = NOISE_AMPLI*benchRandom(&state);
+				if(benchCase->input == INPUT_TONES){
+					sample = TONES_NOISE_AMPLI*benchRandom(&state);
+					for(uint8_t tone_counter = 0; tone_counter < NB_TONES; tone_counter++){
+						sample += (TONES_AMPLI/(1 << tone_counter))
+								*sinf(2*PI*sample_counter*(size/(8 - 2*tone_counter))/size);
+					}
+				}
+				if(benchCase->kernel == KERNEL_RFFT){
+					work.values[sample_counter] = sample;
+				}
+				else{
+					work.values[CMPX_VAL*sample_counter] = sample;
+					work.values[CMPX_VAL*sample_counter + 1] = 0;
+				}
+			}
+			if(benchCase->kernel == KERNEL_RFFT){
+				arm_rfft_fast_init_f32(&rfft, size);
+			}
+			break;
+
+		case GROUP_MAGNITUDE:
+			for(uint16_t value_counter = 0; value_counter < CMPX_VAL*size; value_counter++){
+				work.values[value_counter] = NOISE_AMPLI*benchRandom(&state);
+			}
+			break;
+
+		case GROUP_PEAKS:
+			//amplitude spectrum, only the scanned band is not 0
+			memset(out, 0, sizeof(out));
+			for(uint16_t freq = AUDIOP__FFT_FREQ_MIN; freq < AUDIOP__FFT_FREQ_MAX; freq++){
+				if(benchCase->input == INPUT_FLOOR){
+					out[freq] = tuning.ampliThd*(0.85f + 0.35f*benchRandom(&state));
+				}
+				else{
+					out[freq] = tuning.ampliThd*(0.2f + 0.2f*benchRandom(&state));
+				}
+				if(benchCase->input == INPUT_DENSE && (freq - AUDIOP__FFT_FREQ_MIN) % PEAK_DENSE_SPACING == 0){
+					out[freq] = tuning.ampliThd*(4.0f + 2.0f*benchRandom(&state));
+				}
+				if(benchCase->input == INPUT_TONES && (freq - AUDIOP__FFT_FREQ_MIN) % PEAK_TONES_SPACING == PEAK_TONES_SPACING/2){
+					out[freq] = tuning.ampliThd*(10.0f + 5.0f*benchRandom(&state));
+				}
+			}
+			break;
+
+		case GROUP_ANGLE:
+			//(y, x) pairs
+			for(uint16_t point_counter = 0; point_counter < size; point_counter++){
+				if(benchCase->input == INPUT_CIRCLE){
+					float angle 	= -PI + 2*PI*point_counter/size;
+
+					work.values[CMPX_VAL*point_counter] = sinf(angle);
+					work.values[CMPX_VAL*point_counter + 1] = cosf(angle);
+				}
+				else{
+					work.values[CMPX_VAL*point_counter] = NOISE_AMPLI*benchRandom(&state);
+					work.values[CMPX_VAL*point_counter + 1] = NOISE_AMPLI*benchRandom(&state);
+				}
+			}
+			break;
+
+		case GROUP_DEINTERLEAVE:
+			for(uint16_t sample_counter = 0; sample_counter < NB_MICS*size; sample_counter++){
+				samples[sample_counter] = (int16_t) (NOISE_AMPLI*benchRandom(&state));
+			}
+			break;
+
+		case GROUP_EMA:
+			//angles in degrees, as given to the moving average of audio_determineAngle
+			for(uint16_t sample_counter = 0; sample_counter < size; sample_counter++){
+				work.values[sample_counter] = (float) (int16_t) (ANGLE_MAX_DEG*benchRandom(&state));
+			}
+			break;
+
+		case GROUP_PHASE:
+			//(phase shift, frequency in Hz) pairs
+			for(uint16_t pair_counter = 0; pair_counter < size; pair_counter++){
+				work.values[CMPX_VAL*pair_counter] = (float) (int16_t) (ANGLE_MAX_DEG*benchRandom(&state));
+				work.values[CMPX_VAL*pair_counter + 1] = (float) (uint16_t) (PHASE_FREQ_MIN_HZ
+						+ (PHASE_FREQ_MAX_HZ - PHASE_FREQ_MIN_HZ)*(1 + benchRandom(&state))/2);
+			}
+			break;
+
+		case GROUP_FREQ:
+			for(uint16_t bin_counter = 0; bin_counter < size; bin_counter++){
+				work.values[bin_counter] = (float) (AUDIOP__FFT_FREQ_MIN + bin_counter % AUDIOP__SCAN_BINS);
+			}
+			break;
+
+		default:
+			break;
+	}
+}
+
+void benchKernel(uint8_t kernel, uint16_t size)
+{
+	int16_t ema 				= 0;
+
+	switch(kernel){
+		case KERNEL_CFFT:
+			if(size == 256){
+				arm_cfft_f32(&arm_cfft_sR_f32_len256, work.values, 0, 1);
+			}
+			else if(size == 512){
+				arm_cfft_f32(&arm_cfft_sR_f32_len512, work.values, 0, 1);
+			}
+			else{
+				arm_cfft_f32(&arm_cfft_sR_f32_len1024, work.values, 0, 1);
+			}
+			break;
+		case KERNEL_DOFFT_OPTIMIZED:
+			doFFT_optimized(size, work.values);
+			break;
+		case KERNEL_FFT_C:
+			doFFT_c(size, work.cmpx);
+			break;
+		case KERNEL_RFFT:
+			arm_rfft_fast_f32(&rfft, work.values, out, 0);
+			break;
+
+		case KERNEL_MAG:
+			arm_cmplx_mag_f32(work.values, out, size);
+			break;
+		case KERNEL_MAG_SQUARED:
+			arm_cmplx_mag_squared_f32(work.values, out, size);
+			break;
+
+		case KERNEL_FIND_PEAKS:
+			audioP_findPeaks(out, &tuning, (uint8_t) size, sources, &nbSources);
+			break;
+		case KERNEL_PEAKS_SORT_ALL:
+			benchPeaksSortAll(out, (uint8_t) size);
+			break;
+		case KERNEL_PEAKS_INSERTION:
+			benchPeaksInsertion(out, (uint8_t) size);
+			break;
+
+		case KERNEL_ATAN2F:
+			for(uint16_t point_counter = 0; point_counter < size; point_counter++){
+				out[point_counter] = atan2f(work.values[CMPX_VAL*point_counter], work.values[CMPX_VAL*point_counter + 1]);
+			}
+			break;
+		case KERNEL_ATAN2_APPROX:
+			for(uint16_t point_counter = 0; point_counter < size; point_counter++){
+				out[point_counter] = benchAtan2Approx(work.values[CMPX_VAL*point_counter], work.values[CMPX_VAL*point_counter + 1]);
+			}
+			break;
+		case KERNEL_ATAN2_POLY:
+			for(uint16_t point_counter = 0; point_counter < size; point_counter++){
+				out[point_counter] = benchAtan2Poly(work.values[CMPX_VAL*point_counter], work.values[CMPX_VAL*point_counter + 1]);
+			}
+			break;
+
+		case KERNEL_DEINTERLEAVE:
+			audioP_deinterleave(samples, size, &work.values[0], &work.values[CMPX_VAL*size], &work.values[2*CMPX_VAL*size],
+					&work.values[3*CMPX_VAL*size]);
+			break;
+		case KERNEL_DEINTERLEAVE_PER_MIC:
+			benchDeinterleavePerMic(samples, size, work.values);
+			break;
+
+		//the averages are int16_t, as ema_angle of audio_processing.c
+		case KERNEL_EMA_DOUBLE:
+			ema = (int16_t) work.values[0];
+			for(uint16_t sample_counter = 0; sample_counter < size; sample_counter++){
+				ema = benchEmaDouble(ema, (int16_t) work.values[sample_counter]);
+				out[sample_counter] = ema;
+			}
+			break;
+		case KERNEL_EMA_FLOAT:
+			ema = (int16_t) work.values[0];
+			for(uint16_t sample_counter = 0; sample_counter < size; sample_counter++){
+				ema = (int16_t) num_EmaF(ema, (int16_t) work.values[sample_counter], EMA_WEIGHT);
+				out[sample_counter] = ema;
+			}
+			break;
+		case KERNEL_EMA_Q15:
+			ema = (int16_t) work.values[0];
+			for(uint16_t sample_counter = 0; sample_counter < size; sample_counter++){
+				ema = (int16_t) num_EmaQ15(ema, (int16_t) work.values[sample_counter], EMA_WEIGHT_Q15);
+				out[sample_counter] = ema;
+			}
+			break;
+
+		case KERNEL_PHASE_DOUBLE:
+			for(uint16_t pair_counter = 0; pair_counter < size; pair_counter++){
+				out[pair_counter] = benchConvertPhaseDouble((int16_t) work.values[CMPX_VAL*pair_counter],
+						(uint16_t) work.values[CMPX_VAL*pair_counter + 1]);
+			}
+			break;
+		case KERNEL_PHASE_FLOAT:
+			for(uint16_t pair_counter = 0; pair_counter < size; pair_counter++){
+				out[pair_counter] = audioP_convertPhase((int16_t) work.values[CMPX_VAL*pair_counter],
+						(uint16_t) work.values[CMPX_VAL*pair_counter + 1]);
+			}
+			break;
+
+		case KERNEL_FREQ_DOUBLE:
+			for(uint16_t bin_counter = 0; bin_counter < size; bin_counter++){
+				out[bin_counter] = benchConvertFreqDouble((uint16_t) work.values[bin_counter]);
+			}
+			break;
+		case KERNEL_FREQ_FLOAT:
+			for(uint16_t bin_counter = 0; bin_counter < size; bin_counter++){
+				out[bin_counter] = audioP_convertFreq((uint16_t) work.values[bin_counter]);
+			}
+			break;
+
+		default:
+			break;
+	}
+}
+
+uint16_t benchNbValues(uint8_t kernel, uint16_t size)
+{
+	switch(kernels[kernel].group){
+		case GROUP_FFT:
+			return size/2;
+		case GROUP_DEINTERLEAVE:
+			return NB_MICS*size;
+		case GROUP_PEAKS:
+			return 0;
+		default:
+			return size;
+	}
+}
+
+float benchValue(uint8_t kernel, uint16_t size, uint16_t index)
+{
+	switch(kernel){
+		case KERNEL_CFFT:
+		case KERNEL_DOFFT_OPTIMIZED:
+		case KERNEL_FFT_C:
+			//fft_c turns the other way, its spectrum is the conjugate one: the magnitudes are compared
+			return hypotf(work.values[CMPX_VAL*index], work.values[CMPX_VAL*index + 1]);
+		case KERNEL_RFFT:
+			return (index == 0) ? fabsf(out[0]) : hypotf(out[CMPX_VAL*index], out[CMPX_VAL*index + 1]);
+		case KERNEL_MAG_SQUARED:
+			return sqrtf(out[index]);
+		case KERNEL_DEINTERLEAVE:
+		case KERNEL_DEINTERLEAVE_PER_MIC:
+			//real parts of the four microphones one after the other
+			return work.values[CMPX_VAL*size*(index/size) + CMPX_VAL*(index%size)];
+		default:
+			return out[index];
+	}
+}
+
+uint32_t benchError(const BenchCase *benchCase)
+{
+	BenchCase referenceCase 	= *benchCase;
+	uint16_t nb_values 		= benchNbValues(benchCase->kernel, benchCase->size);
+	float full_scale 		= 0;
+	float max_difference 	= 0;
+	uint8_t mismatches 		= 0;
+
+	referenceCase.kernel = groups[kernels[benchCase->kernel].group].firstKernel;
+	benchPrepare(&referenceCase);
+	benchKernel(referenceCase.kernel, referenceCase.size);
+	for(uint16_t value_counter = 0; value_counter < nb_values; value_counter++){
+		reference[value_counter] = benchValue(referenceCase.kernel, referenceCase.size, value_counter);
+		full_scale = fmaxf(full_scale, fabsf(reference[value_counter]));
+	}
+	memcpy(referenceSources, sources, sizeof(sources));
+	nbReferenceSources = nbSources;
+
+	benchPrepare(benchCase);
+	benchKernel(benchCase->kernel, benchCase->size);
+
+	if(kernels[benchCase->kernel].group == GROUP_PEAKS){
+		mismatches = (uint8_t) abs(nbSources - nbReferenceSources);
+		for(uint8_t source_counter = 0; source_counter < nbSources && source_counter < nbReferenceSources; source_counter++){
+			if(sources[source_counter].freq != referenceSources[source_counter].freq){
+				mismatches++;
+			}
+		}
+		return (uint32_t) (mismatches*PPM/((nbReferenceSources > 0) ? nbReferenceSources : 1));
+	}
+
+	for(uint16_t value_counter = 0; value_counter < nb_values; value_counter++){
+		max_difference = fmaxf(max_difference, fabsf(benchValue(benchCase->kernel, benchCase->size, value_counter)
+				- reference[value_counter]));
+	}
+	if(full_scale == 0){
+		return (max_difference == 0) ? 0 : (uint32_t) PPM;
+	}
+	return (uint32_t) (max_difference/full_scale*PPM);
+}
+
+float benchRandom(uint32_t *state)
+{
+	//xorshift32, the state must not be 0
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return (float) (int32_t) *state/(float) INT32_MAX;
+}
+
+uint8_t benchCollectPeaks(const float *mic_ampli)
+{
+	Source peak 				= {0, 0};
+	bool peak_open 			= false;
+	uint8_t nb_peaks 		= 0;
+
+	//same peaks as audioP_findPeaks, in the order of the frequencies
+	for(uint16_t freq = AUDIOP__FFT_FREQ_MIN; freq < AUDIOP__FFT_FREQ_MAX; freq++){
+		if(mic_ampli[freq] <= tuning.ampliThd){
+			continue;
+		}
+		if(peak_open && (freq - peak.freq) <= tuning.freqThd){
+			if(mic_ampli[freq] > peak.ampli){
+				peak.freq = freq;
+				peak.ampli = mic_ampli[freq];
+			}
+			continue;
+		}
+		if(peak_open){
+			allPeaks[nb_peaks++] = peak;
+		}
+		peak.freq = freq;
+		peak.ampli = mic_ampli[freq];
+		peak_open = true;
+	}
+	if(peak_open){
+		allPeaks[nb_peaks++] = peak;
+	}
+	return nb_peaks;
+}
+
+void benchPeaksSortAll(const float *mic_ampli, uint8_t nbSourcesMax)
+{
+	uint8_t nb_peaks 		= benchCollectPeaks(mic_ampli);
+
+	qsort(allPeaks, nb_peaks, sizeof(Source), benchCompareAmpliDesc);
+	nbSources = (nb_peaks < nbSourcesMax) ? nb_peaks : nbSourcesMax;
+	memcpy(sources, allPeaks, nbSources*sizeof(Source));
+	qsort(sources, nbSources, sizeof(Source), benchCompareFreq);
+}
+
+void benchPeaksInsertion(const float *mic_ampli, uint8_t nbSourcesMax)
+{
+	uint8_t nb_peaks 		= benchCollectPeaks(mic_ampli);
+	uint8_t position 		= 0;
+
+	//sources sorted by decreasing amplitude, a peak quieter than all of them is dropped when the array is full
+	nbSources = 0;
+	for(uint8_t peak_counter = 0; peak_counter < nb_peaks; peak_counter++){
+		position = nbSources;
+		while(position > 0 && sources[position - 1].ampli < allPeaks[peak_counter].ampli){
+			if(position < nbSourcesMax){
+				sources[position] = sources[position - 1];
+			}
+			position--;
+		}
+		if(position < nbSourcesMax){
+			sources[position] = allPeaks[peak_counter];
+			nbSources = (nbSources < nbSourcesMax) ? nbSources + 1 : nbSources;
+		}
+	}
+	qsort(sources, nbSources, sizeof(Source), benchCompareFreq);
+}
+
+int benchCompareAmpliDesc(const void *source1, const void *source2)
+{
+	float ampli1 			= ((const Source *) source1)->ampli;
+	float ampli2 			= ((const Source *) source2)->ampli;
+
+	return (ampli1 < ampli2) - (ampli1 > ampli2);
+}
+
+int benchCompareFreq(const void *source1, const void *source2)
+{
+	return (int) ((const Source *) source1)->freq - (int) ((const Source *) source2)->freq;
+}
+
+float benchAtan2Approx(float y, float x)
+{
+	return benchAtan2Quadrants(y, x, benchAtanApprox);
+}
+
+float benchAtan2Poly(float y, float x)
+{
+	return benchAtan2Quadrants(y, x, benchAtanPoly);
+}
+
+float benchAtan2Quadrants(float y, float x, float (*atanUnit)(float z))
+{
+	float abs_x 				= fabsf(x);
+	float abs_y 				= fabsf(y);
+	float angle 				= 0;
+
+	if(abs_x == 0 && abs_y == 0){
+		return 0;
+	}
+	//atan of the smallest over the largest, in [0,1]
+	if(abs_x >= abs_y){
+		angle = atanUnit(abs_y/abs_x);
+	}
+	else{
+		angle = PI/2 - atanUnit(abs_x/abs_y);
+	}
+	if(x < 0){
+		angle = PI - angle;
+	}
+	return (y < 0) ? -angle : angle;
+}
+
+float benchAtanApprox(float z)
+{
+	return z*(PI/4 + ATAN_APPROX_GAIN*(1 - z));
+}
+
+float benchAtanPoly(float z)
+{
+	float z2 				= z*z;
+
+	return z*(ATAN_POLY_C1 + z2*(ATAN_POLY_C3 + z2*(ATAN_POLY_C5 + z2*(ATAN_POLY_C7 + z2*ATAN_POLY_C9))));
+}
+
+void benchDeinterleavePerMic(const int16_t *data, uint16_t nbSamples, float *micBuffers)
+{
+	for(uint8_t mic_counter = 0; mic_counter < NB_MICS; mic_counter++){
+		float *mic 			= &micBuffers[CMPX_VAL*nbSamples*mic_counter];
+		const int16_t *read 	= &data[mic_counter];
+
+		for(uint16_t sample_counter = 0; sample_counter < nbSamples; sample_counter++){
+			*mic++ = *read;
+			*mic++ = 0;
+			read += NB_MICS;
+		}
+	}
+}
+
+int16_t benchEmaDouble(int16_t past, int16_t sample)
+{
+	return (int16_t) (sample*(double) EMA_WEIGHT + past*(1 - (double) EMA_WEIGHT));
+}
+
+int16_t benchConvertPhaseDouble(int16_t arg, uint16_t freq)
+{
+	arg = (int16_t) ((PHASE_SPEED_SOUND*PHASE_DEG90*arg)/(freq*PHASE_MIC_DISTANCE*PHASE_DEG360));
+
+	if(arg > PHASE_DEG90){
+		arg = PHASE_DEG90;
+	}
+	if(arg < -PHASE_DEG90){
+		arg = -PHASE_DEG90;
+	}
+	return arg;
+}
+
+uint16_t benchConvertFreqDouble(uint16_t freq)
+{
+	return (uint16_t) (int) (CONVERT_FREQ_CONST - CONVERT_FREQ_PARAM*freq);
+}
+
+#endif /* BENCH__ENABLED */
@@ -0,0 +1,90 @@
+/*
+ * dspBench.h
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Micro-benchmarks of the DSP kernels of the audio pipeline, with the clock of profiling.h: the DWT
+ * 		cycle counter on the robot (bench command) and clock_gettime on a Linux host (host/dsp_bench.c).
+ * 		The kernels are grouped by what they compute, the first kernel of a group is the one of the pipeline
+ * 		(or its reference), the others are alternatives. Each case is a kernel on an input distribution and a size:
+ * 			fft:			arm_cfft_f32, doFFT_optimized (1024 only), fft_c, arm_rfft_fast_f32 on noise and tones
+ * 			magnitude:		arm_cmplx_mag_f32, arm_cmplx_mag_squared_f32
+ * 			peaks:			audioP_findPeaks, a sort of all the peaks, an insertion sort, size is the nb. of sources kept
+ * 			angle:			atan2f and two polynomial approximations
+ * 			deinterleave:	audioP_deinterleave and a loop per microphone, size is the nb. of samples per mic
+ * 			ema:			the moving average of the angles in double (before numeric.h), num_EmaF and num_EmaQ15
+ * 			phase:			phase shift to angle in double (before numeric.h) and audioP_convertPhase
+ * 			freq:			bin to Hz in double (before numeric.h) and audioP_convertFreq
+ * 		The input of a case is rebuilt before each repetition, only the kernel is timed, after a first run not timed. The error of a kernel is its
+ * 		largest difference with the first kernel of its group on the same input, in ppm of the largest value of the
+ * 		first kernel (for the FFTs: on the magnitudes of the first half of the spectrum; for the peaks: the share of
+ * 		sources which differ). The buffers take about 20kB of RAM.
+ * 		The benchmarks are disabled by default, this file then compiles to nothing and the bench command does not exist.
+ * 		Build with -DBENCH__ENABLED=1 (e.g. UDEFS += -DBENCH__ENABLED=1 in the makefile) to enable them, the host
+ * 		makefile does.
+ * Function prefix for public functions in this file: bench_
+ * Constant prefix for public constants in this file: BENCH__
+ */
+#ifndef DSPBENCH_H_
+#define DSPBENCH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*===========================================================================*/
+/* Constants definition for this library						               */
+/*===========================================================================*/
+
+#ifndef BENCH__ENABLED
+#define BENCH__ENABLED						0
+#endif
+
+#define BENCH__REPETITIONS_DEFAULT			20
+#define BENCH__CSV_HEADER					"kernel,input,size,repetitions,min_ns,mean_ns,error_ppm"
+
+
+/*===========================================================================*/
+/* Structures						 			                            */
+/*===========================================================================*/
+
+/*
+ * Result of a case, durations in ns
+ * @note kernel and input are constant strings of the benchmark
+ */
+typedef struct BenchResults {
+	const char *kernel;
+	const char *input;
+	uint16_t size;
+	uint16_t repetitions;
+	uint32_t minNs;
+	uint32_t meanNs;
+	uint32_t errorPpm;
+} BenchResult;
+
+
+/*===========================================================================*/
+/* Public functions definitions            									 */
+/*===========================================================================*/
+
+/*
+ * @brief	Returns the number of cases
+ */
+uint8_t bench_getNbCases(void);
+
+/*
+ * @brief	Runs a case, it blocks the calling thread for repetitions times the duration of the kernel
+ * @note 	Not reentrant, the cases share their buffers. The durations include the time the thread was preempted,
+ * 			the minimum is the one to compare.
+ *
+ *  @param[in] caseIndex		0 to bench_getNbCases()-1
+ *  @param[in] repetitions	at least 1
+ *  @param[out] result		result of the case
+ *
+ * @return	false if the case does not exist
+ */
+bool bench_run(uint8_t caseIndex, uint16_t repetitions, BenchResult *result);
+
+
+#endif /* DSPBENCH_H_ */
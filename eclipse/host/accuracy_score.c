@@ -0,0 +1,742 @@
+/*
+ * accuracy_score.c
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Command line tool that scores the accuracy of the audio processing of the firmware on a labeled
+ * 		corpus of scenes (corpus/accuracy.txt): synthetic scenes of sceneGen.h and recorded capture files, with the
+ * 		frequency and bearing of each penguin. Each scene is given to a pipeline of its own (audioP_ctx) as in
+ * 		capture_replay, the analyses are those of the main of the firmware (audioP_ctxAnalyseSources). The result
+ * 		only depends on the corpus and on the code, one csv line per scene and a total line:
+ * 			precision			share of the sources found which are a penguin of the scene (closer than FREQ_MATCH_HZ)
+ * 			recall				share of the penguins of the scene found, over all the analyses
+ * 			freq_error_hz		mean frequency error of the sources found
+ * 			bearing_rmse_deg		rms bearing error of the sources found with an angle
+ * 			first_valid_frames	mean audio frame (64ms) of the first angle closer than BEARING_VALID_DEG of each
+ * 								penguin, the frames of the scene if there is none
+ * 		The total is over all the analyses and penguins of the corpus. With a baseline, a scene regresses if one of
+ * 		them is worse than in the baseline by more than its tolerance, scaled by -t:
+ *
+ * 			accuracy_score -o baseline.csv corpus/accuracy.txt
+ * 			(change the code, make)
+ * 			accuracy_score -b baseline.csv corpus/accuracy.txt
+ *
+ * 		usage: accuracy_score [-o output] [-b baseline] [-t scale] <corpus>
+ * 			-o output			file of the csv (default the standard output)
+ * 			-b baseline			compares the scores to this csv, exits with 1 if a scene regressed
+ * 			-t scale			of the tolerances (default 1)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+#include <ch.h>
+#include <hal.h>
+
+#include <audio_processing.h>
+#include <telemetry.h>
+#include <hostShim.h>
+#include <sceneGen.h>
+#include <captureFile.h>
+
+
+/*===========================================================================*/
+/* Constants definition for this file						               */
+/*===========================================================================*/
+
+#define ANALYSIS_WORKING_AREA_SIZE			4096
+
+#define NB_SCENES_MAX						64
+#define NAME_MAX_LENGTH						64
+#define LINE_MAX_LENGTH						512
+#define PATH_MAX_LENGTH						512
+#define NB_TOKENS_MAX						48
+#define TOTAL_NAME							"total"
+
+//Scenes
+#define DEFAULT_SECONDS						3.0
+#define DEFAULT_AMPLITUDE					2000.0			//as scene_generate
+#define DEFAULT_SEED							1
+
+//Scoring
+#define FREQ_MATCH_HZ						45.0			//as FREQ_SELECT_TOLERANCE_HZ of main.c, 3 bins
+#define BEARING_VALID_DEG					20.0			//an angle closer to the truth can be followed by the robot
+
+//Tolerances of the comparison to a baseline, multiplied by -t
+#define TOLERANCE_PRECISION					0.02
+#define TOLERANCE_RECALL						0.02
+#define TOLERANCE_FREQ_HZ					2.0
+#define TOLERANCE_BEARING_DEG				2.0
+#define TOLERANCE_FIRST_FRAMES				2.0
+
+#define CSV_RATIO_UNIT						1e-4			//the scores are rounded as in the csv, to compare them to a baseline
+#define CSV_VALUE_UNIT						1e-2
+
+#define CSV_HEADER							"scene,analyses,truths,detections,precision,recall,freq_error_hz," \
+												"bearing_rmse_deg,first_valid_frames"
+#define USAGE								"usage: %s [-o output] [-b baseline] [-t scale] <corpus>\n"
+
+
+/*===========================================================================*/
+/* Structures						 			                            */
+/*===========================================================================*/
+
+/*
+ * Penguin of a scene
+ */
+typedef struct ScoreTruths {
+	double freqHz;
+	double bearingDeg;					//as the angles of audio_processing.c, 0 in front and positive to the right
+} ScoreTruth;
+
+/*
+ * Counts of a scene, or of the whole corpus, accumulated over its analyses
+ */
+typedef struct ScoreCounts {
+	uint32_t analyses;
+	uint32_t truths;						//penguins expected, summed over the analyses
+	uint32_t detections;
+	uint32_t matches;					//detections of a penguin
+	double freqErrorSumHz;
+	double bearingSquareSum;
+	uint32_t nbBearings;
+	double firstValidSum;				//in frames, summed over the penguins
+	uint32_t nbFirstValid;
+} ScoreCount;
+
+/*
+ * Scene being scored
+ */
+typedef struct ScoreScenes {
+	ScoreTruth truths[SCENE__NB_SOURCES_MAX];
+	uint8_t nbTruths;
+	uint32_t firstValidFrame[SCENE__NB_SOURCES_MAX];	//0 until the penguin is found with a valid angle
+	ScoreCount count;
+} ScoreScene;
+
+/*
+ * Scores of a scene, as in the csv
+ */
+typedef struct ScoreRows {
+	char name[NAME_MAX_LENGTH];
+	unsigned analyses;
+	unsigned truths;
+	unsigned detections;
+	double precision;
+	double recall;
+	double freqErrorHz;
+	double bearingRmseDeg;
+	double firstValidFrames;
+} ScoreRow;
+
+
+/*===========================================================================*/
+/* Static variables definitions 		 			                            */
+/*===========================================================================*/
+
+static audioP_ctx scoreCtx;
+static ScoreScene scene;
+static volatile bool sceneRunning 			= false;		//the analyses are scored
+static volatile bool analysisStopped 		= true;		//the analysis thread waits for the next scene
+static binary_semaphore_t sceneStart;
+
+static ScoreRow rows[NB_SCENES_MAX + 1];
+static ScoreRow baseline[NB_SCENES_MAX + 1];
+
+
+/*===========================================================================*/
+/* Private functions definitions                                             */
+/*===========================================================================*/
+
+/**
+ * @brief   Reads a scene line of the corpus, generates or reads its samples and scores it
+ *
+ * @return	false if the line is not valid, the reason is printed
+*/
+bool scoreLine(char *line, const char *corpusDir, ScoreRow *row);
+
+/**
+ * @brief   Generates a synthetic scene from the options of scene_generate and scores it
+*/
+bool scoreGenerated(char *tokens[], uint8_t nbTokens);
+
+/**
+ * @brief   Reads a capture file and its truth and scores it
+*/
+bool scoreCaptured(char *tokens[], uint8_t nbTokens, const char *corpusDir);
+
+/**
+ * @brief   Starts the analysis of a new scene, on a new pipeline
+*/
+void scoreStart(void);
+
+/**
+ * @brief   Gives a block of samples in the order of mic_start to the pipeline, and waits until it is processed
+*/
+void scoreFeed(const int16_t *data, uint16_t nbFrames);
+
+/**
+ * @brief   Stops the analysis of the scene, and counts the first valid frame of the penguins
+ *
+ *  @param[in] nbFrames		samples of each microphone given to the pipeline
+*/
+void scoreStop(uint32_t nbFrames);
+
+/**
+ * @brief   Matches the sources found by an analysis to the penguins of the scene
+*/
+void scoreAnalysis(uint16_t nb_sources, const Destination *destination_scan);
+
+/**
+ * @brief   Adds the counts of a scene to the total
+*/
+void scoreAdd(ScoreCount *total, const ScoreCount *count);
+
+/**
+ * @brief   Computes the scores from the counts
+*/
+void scoreRow(const char *name, const ScoreCount *count, ScoreRow *row);
+
+/**
+ * @brief   Writes the rows as csv
+*/
+void scoreWrite(FILE *output, const ScoreRow *scores, uint16_t nbScores);
+
+/**
+ * @brief   Reads the rows of a csv written by scoreWrite
+ *
+ * @return	the number of rows, -1 if the file cannot be opened
+*/
+int scoreReadCsv(const char *path, ScoreRow *scores);
+
+/**
+ * @brief   Compares the rows to the baseline, prints the regressions on stderr
+ *
+ * @return	the number of regressions
+*/
+uint16_t scoreCompare(const ScoreRow *scores, uint16_t nbScores, const ScoreRow *base, uint16_t nbBase, double scale);
+
+/**
+ * @brief   Returns the difference of two angles in degrees, in [-180,180[
+*/
+double scoreAngleDiff(double angle1, double angle2);
+
+/**
+ * @brief   Rounds a score to a multiple of unit
+*/
+double scoreRound(double value, double unit);
+
+
+/*===========================================================================*/
+/* Threads used in accuracy_score                  							*/
+/*===========================================================================*/
+
+/* Analysis thread: scans the sources as the main of the firmware does, for each scene */
+static THD_WORKING_AREA(waScoreAnalysisThd, ANALYSIS_WORKING_AREA_SIZE);
+static THD_FUNCTION(ScoreAnalysisThd, arg)
+{
+	(void)arg;
+	chRegSetThreadName(__FUNCTION__);
+
+	static Destination destination_scan[AUDIOP__NB_SOURCES_MAX];
+	uint16_t nb_sources 		= 0;
+
+	while(true){
+		chBSemWait(&sceneStart);
+		while(sceneRunning){
+			nb_sources = audioP_ctxAnalyseSources(&scoreCtx, destination_scan, AUDIOP__SCAN_FRAME_BUDGET);
+			if(sceneRunning){
+				scoreAnalysis(nb_sources, destination_scan);
+			}
+		}
+		analysisStopped = true;
+	}
+}
+
+
+/*===========================================================================*/
+/* Main					 										            */
+/*===========================================================================*/
+
+int main(int argc, char *argv[])
+{
+	char line[LINE_MAX_LENGTH];
+	char corpusDir[PATH_MAX_LENGTH];
+	ScoreCount total;
+	const char *outputPath 		= NULL;
+	const char *baselinePath 	= NULL;
+	double scale 				= 1;
+	uint16_t nbRows 				= 0;
+	int nbBaseline 				= 0;
+	uint16_t nbRegressions 		= 0;
+	uint32_t lineNumber 			= 0;
+	FILE *corpus 				= NULL;
+	FILE *output 				= stdout;
+	char *slash 					= NULL;
+	int option 					= 0;
+
+	while((option = getopt(argc, argv, "o:b:t:")) != -1){
+		switch(option){
+		case 'o':
+			outputPath = optarg;
+			break;
+		case 'b':
+			baselinePath = optarg;
+			break;
+		case 't':
+			scale = atof(optarg);
+			break;
+		default:
+			fprintf(stderr, USAGE, argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if(optind != argc-1 || scale < 0){
+		fprintf(stderr, USAGE, argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	corpus = fopen(argv[optind], "r");
+	if(corpus == NULL){
+		perror(argv[optind]);
+		return EXIT_FAILURE;
+	}
+	//the capture files are relative to the corpus
+	snprintf(corpusDir, sizeof(corpusDir), "%s", argv[optind]);
+	slash = strrchr(corpusDir, '/');
+	if(slash != NULL){
+		slash[1] = '\0';
+	}
+	else{
+		corpusDir[0] = '\0';
+	}
+
+	halInit();
+	chSysInit();
+
+	//Nothing is sent on the serial link, the analysis would otherwise send its spectra
+	telem_setStreams(0);
+	chBSemObjectInit(&sceneStart, true);
+	chThdCreateStatic(waScoreAnalysisThd, sizeof(waScoreAnalysisThd), NORMALPRIO, ScoreAnalysisThd, NULL);
+	shim_waitIdle();
+
+	memset(&total, 0, sizeof(total));
+	while(fgets(line, sizeof(line), corpus) != NULL){
+		lineNumber++;
+		if(strchr(line, '#') != NULL){
+			*strchr(line, '#') = '\0';
+		}
+		if(strspn(line, " \t\r\n") == strlen(line)){
+			continue;
+		}
+		if(nbRows >= NB_SCENES_MAX){
+			fprintf(stderr, "%s: at most %d scenes\n", argv[optind], NB_SCENES_MAX);
+			return EXIT_FAILURE;
+		}
+		if(!scoreLine(line, corpusDir, &rows[nbRows])){
+			fprintf(stderr, "%s:%u: not a valid scene\n", argv[optind], lineNumber);
+			return EXIT_FAILURE;
+		}
+		scoreAdd(&total, &scene.count);
+		nbRows++;
+	}
+	fclose(corpus);
+	scoreRow(TOTAL_NAME, &total, &rows[nbRows++]);
+
+	if(outputPath != NULL){
+		output = fopen(outputPath, "w");
+		if(output == NULL){
+			perror(outputPath);
+			return EXIT_FAILURE;
+		}
+	}
+	scoreWrite(output, rows, nbRows);
+	if(output != stdout){
+		fclose(output);
+	}
+
+	if(baselinePath != NULL){
+		nbBaseline = scoreReadCsv(baselinePath, baseline);
+		if(nbBaseline < 0){
+			perror(baselinePath);
+			return EXIT_FAILURE;
+		}
+		nbRegressions = scoreCompare(rows, nbRows, baseline, (uint16_t) nbBaseline, scale);
+		fprintf(stderr, "%u scenes, precision %.3f, recall %.3f, bearing rmse %.2f deg, %u regressions\n", nbRows - 1,
+				rows[nbRows - 1].precision, rows[nbRows - 1].recall, rows[nbRows - 1].bearingRmseDeg, nbRegressions);
+		if(nbRegressions > 0){
+			return EXIT_FAILURE;
+		}
+	}
+	return EXIT_SUCCESS;
+}
+
+
+/*===========================================================================*/
+/* Private functions	 code												   */
+/*===========================================================================*/
+
+bool scoreLine(char *line, const char *corpusDir, ScoreRow *row)
+{
+	char *tokens[NB_TOKENS_MAX];
+	uint8_t nbTokens 			= 0;
+	char *token 					= strtok(line, " \t\r\n");
+
+	while(token != NULL && nbTokens < NB_TOKENS_MAX){
+		tokens[nbTokens++] = token;
+		token = strtok(NULL, " \t\r\n");
+	}
+	if(nbTokens < 2 || token != NULL || strlen(tokens[0]) >= NAME_MAX_LENGTH || strcmp(tokens[0], TOTAL_NAME) == 0){
+		return false;
+	}
+
+	memset(&scene, 0, sizeof(scene));
+	if(strcmp(tokens[1], "generate") == 0){
+		if(!scoreGenerated(&tokens[2], nbTokens - 2)){
+			return false;
+		}
+	}
+	else if(strcmp(tokens[1], "capture") == 0){
+		if(!scoreCaptured(&tokens[2], nbTokens - 2, corpusDir)){
+			return false;
+		}
+	}
+	else{
+		return false;
+	}
+	scoreRow(tokens[0], &scene.count, row);
+	return true;
+}
+
+bool scoreGenerated(char *tokens[], uint8_t nbTokens)
+{
+	static Scene generated;
+	int16_t block[SCENE__NB_MICS*SCENE__BLOCK_FRAMES];
+	double seconds 			= DEFAULT_SECONDS;
+	double values[4] 		= {0};
+	double noiseRms 			= 0;
+	double pose[3] 			= {0};
+	uint64_t seed 			= DEFAULT_SEED;
+
+	//the sources are added once the pose is known, their options are read twice
+	if(nbTokens % 2 != 0){
+		return false;
+	}
+	for(uint8_t token_counter = 0; token_counter < nbTokens; token_counter += 2){
+		const char *option 	= tokens[token_counter];
+		const char *value 	= tokens[token_counter + 1];
+
+		if(strcmp(option, "-d") == 0){
+			seconds = atof(value);
+		}
+		else if(strcmp(option, "-e") == 0){
+			seed = strtoull(value, NULL, 0);
+		}
+		else if(strcmp(option, "-n") == 0){
+			noiseRms = atof(value);
+		}
+		else if(strcmp(option, "-p") == 0){
+			if(sscanf(value, "%lf,%lf,%lf", &pose[0], &pose[1], &pose[2]) != 3){
+				return false;
+			}
+		}
+		else if(strcmp(option, "-s") == 0){
+			if(sscanf(value, "%lf,%lf,%lf,%lf", &values[0], &values[1], &values[2], &values[3]) < 3){
+				return false;
+			}
+		}
+		else if(strcmp(option, "-r") == 0){
+			if(sscanf(value, "%lf,%lf", &values[0], &values[1]) != 2){
+				return false;
+			}
+		}
+		else{
+			return false;
+		}
+	}
+	if(seconds <= 0){
+		return false;
+	}
+
+	scene_init(&generated, seed);
+	scene_setNoise(&generated, noiseRms);
+	scene_setRobotPose(&generated, pose[0], pose[1], pose[2]);
+	for(uint8_t token_counter = 0; token_counter < nbTokens; token_counter += 2){
+		if(strcmp(tokens[token_counter], "-s") == 0){
+			values[3] = DEFAULT_AMPLITUDE;
+			sscanf(tokens[token_counter + 1], "%lf,%lf,%lf,%lf", &values[0], &values[1], &values[2], &values[3]);
+			if(scene_addSource(&generated, values[0], values[1], values[2], values[3]) < 0){
+				return false;
+			}
+		}
+		else if(strcmp(tokens[token_counter], "-r") == 0){
+			sscanf(tokens[token_counter + 1], "%lf,%lf", &values[0], &values[1]);
+			if(!scene_addTap(&generated, values[0], values[1])){
+				return false;
+			}
+		}
+	}
+
+	//the robot does not move, the bearings stay those of the start
+	for(uint8_t source = 0; source < generated.nbSources; source++){
+		scene.truths[source].freqHz = generated.sources[source].freqHz;
+		scene.truths[source].bearingDeg = scene_getBearingDeg(&generated, source);
+	}
+	scene.nbTruths = generated.nbSources;
+
+	uint32_t nbBlocks 		= (uint32_t) ((seconds*SCENE__SAMPLING_HZ + SCENE__BLOCK_FRAMES - 1)/SCENE__BLOCK_FRAMES);
+
+	scoreStart();
+	for(uint32_t block_counter = 0; block_counter < nbBlocks; block_counter++){
+		scene_fill(block, SCENE__BLOCK_FRAMES, &generated);
+		scoreFeed(block, SCENE__BLOCK_FRAMES);
+	}
+	scoreStop(nbBlocks*SCENE__BLOCK_FRAMES);
+	return true;
+}
+
+bool scoreCaptured(char *tokens[], uint8_t nbTokens, const char *corpusDir)
+{
+	static CapFile capture;
+	static int16_t samples[CAPFILE__NB_MICS*CAPFILE__BLOCK_FRAMES_MAX];
+	static int16_t data[CAPFILE__NB_MICS*CAPFILE__BLOCK_FRAMES_MAX];
+	char path[PATH_MAX_LENGTH];
+	uint32_t index 			= 0;
+	uint32_t time 			= 0;
+	uint32_t nbFrames 		= 0;
+
+	if(nbTokens < 1 || nbTokens - 1 > SCENE__NB_SOURCES_MAX){
+		return false;
+	}
+	for(uint8_t token_counter = 1; token_counter < nbTokens; token_counter++){
+		if(sscanf(tokens[token_counter], "%lf,%lf", &scene.truths[scene.nbTruths].freqHz,
+				&scene.truths[scene.nbTruths].bearingDeg) != 2){
+			return false;
+		}
+		scene.nbTruths++;
+	}
+
+	snprintf(path, sizeof(path), "%s%s", (tokens[0][0] == '/') ? "" : corpusDir, tokens[0]);
+	if(!capFile_open(&capture, path)){
+		fprintf(stderr, "%s: not a capture file\n", path);
+		return false;
+	}
+	if(capture.header.samplingHz != CAPFILE__SAMPLING_HZ){
+		fprintf(stderr, "warning: %s sampled at %u Hz, the firmware expects %u Hz\n", path,
+				capture.header.samplingHz, CAPFILE__SAMPLING_HZ);
+	}
+
+	//a gap in the capture is given as if there was none, as capture_replay does
+	scoreStart();
+	while(capFile_readBlock(&capture, &index, &time, samples)){
+		capFile_reorderBlock(&capture.header, samples, data);
+		scoreFeed(data, capture.header.blockFrames);
+		nbFrames += capture.header.blockFrames;
+	}
+	capFile_close(&capture);
+	scoreStop(nbFrames);
+	return true;
+}
+
+void scoreStart(void)
+{
+	audioP_ctxInit(&scoreCtx);
+	analysisStopped = false;
+	sceneRunning = true;
+	chBSemSignal(&sceneStart);
+	shim_waitIdle();
+}
+
+void scoreFeed(const int16_t *data, uint16_t nbFrames)
+{
+	audioP_ctxProcessAudioData(&scoreCtx, data, (uint16_t) (SCENE__NB_MICS*nbFrames));
+	shim_waitIdle();
+}
+
+void scoreStop(uint32_t nbFrames)
+{
+	static const int16_t silence[SCENE__NB_MICS*SCENE__BLOCK_FRAMES];
+	uint32_t sceneFrames 	= nbFrames/AUDIOP__FFT_SIZE;
+
+	//the analysis in progress needs more frames to return, they are not scored
+	sceneRunning = false;
+	while(!analysisStopped){
+		scoreFeed(silence, SCENE__BLOCK_FRAMES);
+	}
+
+	for(uint8_t truth_counter = 0; truth_counter < scene.nbTruths; truth_counter++){
+		scene.count.firstValidSum += (scene.firstValidFrame[truth_counter] != 0) ? scene.firstValidFrame[truth_counter]
+				: sceneFrames;
+		scene.count.nbFirstValid++;
+	}
+}
+
+void scoreAnalysis(uint16_t nb_sources, const Destination *destination_scan)
+{
+	bool truthFound[SCENE__NB_SOURCES_MAX] 	= {false};
+	double freqHz 							= 0;
+	double freqError 						= 0;
+	double bearingError 						= 0;
+	int8_t best 								= -1;
+
+	//a killer whale hides the penguins, the corpus has none
+	if(nb_sources == AUDIOP__KILLER_WHALE_DETECTED){
+		nb_sources = 0;
+	}
+	scene.count.analyses++;
+	scene.count.truths += scene.nbTruths;
+	scene.count.detections += nb_sources;
+
+	for(uint16_t source_counter = 0; source_counter < nb_sources; source_counter++){
+		const Destination *destination 	= &destination_scan[source_counter];
+
+		//closest penguin not found yet by this analysis
+		freqHz = audioP_convertFreq(destination->freq);
+		best = -1;
+		for(uint8_t truth_counter = 0; truth_counter < scene.nbTruths; truth_counter++){
+			freqError = fabs(freqHz - scene.truths[truth_counter].freqHz);
+			if(!truthFound[truth_counter] && freqError <= FREQ_MATCH_HZ
+					&& (best < 0 || freqError < fabs(freqHz - scene.truths[best].freqHz))){
+				best = (int8_t) truth_counter;
+			}
+		}
+		if(best < 0){
+			continue;
+		}
+
+		truthFound[best] = true;
+		scene.count.matches++;
+		scene.count.freqErrorSumHz += fabs(freqHz - scene.truths[best].freqHz);
+		if(destination->valid){
+			bearingError = scoreAngleDiff(destination->angle, scene.truths[best].bearingDeg);
+			scene.count.bearingSquareSum += bearingError*bearingError;
+			scene.count.nbBearings++;
+			if(scene.firstValidFrame[best] == 0 && fabs(bearingError) <= BEARING_VALID_DEG){
+				scene.firstValidFrame[best] = destination->stamp.frame;
+			}
+		}
+	}
+}
+
+void scoreAdd(ScoreCount *total, const ScoreCount *count)
+{
+	total->analyses += count->analyses;
+	total->truths += count->truths;
+	total->detections += count->detections;
+	total->matches += count->matches;
+	total->freqErrorSumHz += count->freqErrorSumHz;
+	total->bearingSquareSum += count->bearingSquareSum;
+	total->nbBearings += count->nbBearings;
+	total->firstValidSum += count->firstValidSum;
+	total->nbFirstValid += count->nbFirstValid;
+}
+
+void scoreRow(const char *name, const ScoreCount *count, ScoreRow *row)
+{
+	//nothing found is nothing wrong, no penguin is nothing missed: the other scores tell the difference
+	snprintf(row->name, NAME_MAX_LENGTH, "%s", name);
+	row->analyses = count->analyses;
+	row->truths = count->truths;
+	row->detections = count->detections;
+	row->precision = scoreRound((count->detections > 0) ? (double) count->matches/count->detections : 1, CSV_RATIO_UNIT);
+	row->recall = scoreRound((count->truths > 0) ? (double) count->matches/count->truths : 1, CSV_RATIO_UNIT);
+	row->freqErrorHz = scoreRound((count->matches > 0) ? count->freqErrorSumHz/count->matches : 0, CSV_VALUE_UNIT);
+	row->bearingRmseDeg = scoreRound((count->nbBearings > 0) ? sqrt(count->bearingSquareSum/count->nbBearings) : 0,
+			CSV_VALUE_UNIT);
+	row->firstValidFrames = scoreRound((count->nbFirstValid > 0) ? count->firstValidSum/count->nbFirstValid : 0,
+			CSV_VALUE_UNIT);
+}
+
+void scoreWrite(FILE *output, const ScoreRow *scores, uint16_t nbScores)
+{
+	fprintf(output, "%s\n", CSV_HEADER);
+	for(uint16_t score_counter = 0; score_counter < nbScores; score_counter++){
+		const ScoreRow *score 	= &scores[score_counter];
+
+		fprintf(output, "%s,%u,%u,%u,%.4f,%.4f,%.2f,%.2f,%.2f\n", score->name, score->analyses, score->truths,
+				score->detections, score->precision, score->recall, score->freqErrorHz, score->bearingRmseDeg,
+				score->firstValidFrames);
+	}
+}
+
+int scoreReadCsv(const char *path, ScoreRow *scores)
+{
+	char line[LINE_MAX_LENGTH];
+	ScoreRow row;
+	int nb_scores 			= 0;
+	FILE *file 				= fopen(path, "r");
+
+	if(file == NULL){
+		return -1;
+	}
+	while(fgets(line, sizeof(line), file) != NULL && nb_scores < NB_SCENES_MAX + 1){
+		if(sscanf(line, "%63[^,],%u,%u,%u,%lf,%lf,%lf,%lf,%lf", row.name, &row.analyses, &row.truths, &row.detections,
+				&row.precision, &row.recall, &row.freqErrorHz, &row.bearingRmseDeg, &row.firstValidFrames) == 9){
+			scores[nb_scores++] = row;
+		}
+	}
+	fclose(file);
+	return nb_scores;
+}
+
+uint16_t scoreCompare(const ScoreRow *scores, uint16_t nbScores, const ScoreRow *base, uint16_t nbBase, double scale)
+{
+	const ScoreRow *reference 	= NULL;
+	uint16_t nb_regressions 		= 0;
+
+	for(uint16_t score_counter = 0; score_counter < nbScores; score_counter++){
+		const ScoreRow *score 	= &scores[score_counter];
+
+		reference = NULL;
+		for(uint16_t base_counter = 0; base_counter < nbBase && reference == NULL; base_counter++){
+			if(strcmp(base[base_counter].name, score->name) == 0){
+				reference = &base[base_counter];
+			}
+		}
+		if(reference == NULL){
+			fprintf(stderr, "new: %s\n", score->name);
+			continue;
+		}
+
+		if(score->precision < reference->precision - scale*TOLERANCE_PRECISION){
+			fprintf(stderr, "%s: precision %.4f instead of %.4f\n", score->name, score->precision, reference->precision);
+			nb_regressions++;
+		}
+		if(score->recall < reference->recall - scale*TOLERANCE_RECALL){
+			fprintf(stderr, "%s: recall %.4f instead of %.4f\n", score->name, score->recall, reference->recall);
+			nb_regressions++;
+		}
+		if(score->freqErrorHz > reference->freqErrorHz + scale*TOLERANCE_FREQ_HZ){
+			fprintf(stderr, "%s: frequency error %.2f Hz instead of %.2f Hz\n", score->name, score->freqErrorHz,
+					reference->freqErrorHz);
+			nb_regressions++;
+		}
+		if(score->bearingRmseDeg > reference->bearingRmseDeg + scale*TOLERANCE_BEARING_DEG){
+			fprintf(stderr, "%s: bearing rmse %.2f deg instead of %.2f deg\n", score->name, score->bearingRmseDeg,
+					reference->bearingRmseDeg);
+			nb_regressions++;
+		}
+		if(score->firstValidFrames > reference->firstValidFrames + scale*TOLERANCE_FIRST_FRAMES){
+			fprintf(stderr, "%s: first valid angle after %.2f frames instead of %.2f\n", score->name,
+					score->firstValidFrames, reference->firstValidFrames);
+			nb_regressions++;
+		}
+	}
+	return nb_regressions;
+}
+
+double scoreAngleDiff(double angle1, double angle2)
+{
+	double difference 		= fmod(angle1 - angle2 + 180.0, 360.0);
+
+	return (difference < 0) ? difference + 180.0 : difference - 180.0;
+}
+
+double scoreRound(double value, double unit)
+{
+	return round(value/unit)*unit;
+}
@@ -0,0 +1,269 @@
+/*
+ * captureFile.c
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Raw microphone capture files, see captureFile.h for the layout.
+ * 		The fields are written with the little endian helpers of telemetryFrame.h, as the frames of the robot.
+ *
+ * Functions prefix for public functions in this file: capFile_
+ */
+
+#include <string.h>
+
+#include <captureFile.h>
+
+
+/*===========================================================================*/
+/* Constants definition for this file						               */
+/*===========================================================================*/
+
+#define MAGIC_SIZE							4
+#define SAMPLE_SIZE							2
+#define BLOCK_SIZE_MAX						(CAPFILE__BLOCK_HEADER_SIZE + SAMPLE_SIZE*CAPFILE__NB_MICS*CAPFILE__BLOCK_FRAMES_MAX)
+#define NB_CHUNKS_MAX						32			//bits of chunksReceived
+
+
+/*===========================================================================*/
+/* Private functions definitions                                             */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the size of a block in the file, in bytes
+*/
+long capFileBlockSize(const CapFileHeader *header);
+
+/**
+ * @brief   Checks that a header can be written and read with the buffers of this file
+*/
+bool capFileHeaderIsValid(const CapFileHeader *header);
+
+
+/*===========================================================================*/
+/* Public functions for setting/getting internal parameters					  */
+/* Descriptions  are only in the header file (to have a single source of truth) */
+/*===========================================================================*/
+
+void capFile_defaultHeader(CapFileHeader *header)
+{
+	header->samplingHz = CAPFILE__SAMPLING_HZ;
+	header->tickHz = CAPFILE__TICK_HZ;
+	header->blockFrames = CAPFILE__BLOCK_FRAMES;
+	header->nbMics = CAPFILE__NB_MICS;
+	header->micOrder[0] = CAPFILE__MIC_RIGHT;
+	header->micOrder[1] = CAPFILE__MIC_LEFT;
+	header->micOrder[2] = CAPFILE__MIC_BACK;
+	header->micOrder[3] = CAPFILE__MIC_FRONT;
+}
+
+bool capFile_create(CapFile *capture, const char *path, const CapFileHeader *header)
+{
+	uint8_t bytes[CAPFILE__HEADER_SIZE] 	= {0};
+	uint8_t *write 						= bytes;
+
+	memset(capture, 0, sizeof(CapFile));
+	if(!capFileHeaderIsValid(header)){
+		return false;
+	}
+	capture->header = *header;
+	capture->firstBlock = CAPFILE__HEADER_SIZE;
+
+	memcpy(write, CAPFILE__MAGIC, MAGIC_SIZE);
+	write += MAGIC_SIZE;
+	write = telem_PutU16(write, CAPFILE__VERSION);
+	write = telem_PutU16(write, CAPFILE__HEADER_SIZE);
+	write = telem_PutU32(write, header->samplingHz);
+	write = telem_PutU32(write, header->tickHz);
+	write = telem_PutU16(write, header->blockFrames);
+	write = telem_PutU8(write, header->nbMics);
+	for(uint8_t mic = 0; mic < header->nbMics; mic++){
+		write = telem_PutU8(write, header->micOrder[mic]);
+	}
+
+	capture->file = fopen(path, "wb");
+	if(capture->file == NULL){
+		return false;
+	}
+	return fwrite(bytes, sizeof(bytes), 1, capture->file) == 1;
+}
+
+bool capFile_open(CapFile *capture, const char *path)
+{
+	uint8_t bytes[CAPFILE__HEADER_SIZE];
+	const uint8_t *read 		= bytes + MAGIC_SIZE;
+	uint16_t version 		= 0;
+	uint16_t headerSize 		= 0;
+	long fileSize 			= 0;
+
+	memset(capture, 0, sizeof(CapFile));
+	capture->file = fopen(path, "rb");
+	if(capture->file == NULL){
+		return false;
+	}
+	if(fread(bytes, sizeof(bytes), 1, capture->file) != 1 || memcmp(bytes, CAPFILE__MAGIC, MAGIC_SIZE) != 0){
+		capFile_close(capture);
+		return false;
+	}
+
+	read = telem_GetU16(read, &version);
+	read = telem_GetU16(read, &headerSize);
+	read = telem_GetU32(read, &capture->header.samplingHz);
+	read = telem_GetU32(read, &capture->header.tickHz);
+	read = telem_GetU16(read, &capture->header.blockFrames);
+	read = telem_GetU8(read, &capture->header.nbMics);
+	if(version != CAPFILE__VERSION || headerSize < CAPFILE__HEADER_SIZE || !capFileHeaderIsValid(&capture->header)){
+		capFile_close(capture);
+		return false;
+	}
+	for(uint8_t mic = 0; mic < capture->header.nbMics; mic++){
+		read = telem_GetU8(read, &capture->header.micOrder[mic]);
+	}
+
+	//A block cut at the end of the file, by a tool killed while writing, is ignored
+	capture->firstBlock = headerSize;
+	fseek(capture->file, 0, SEEK_END);
+	fileSize = ftell(capture->file);
+	capture->nbBlocks = (fileSize > headerSize) ? (uint32_t) ((fileSize - headerSize)/capFileBlockSize(&capture->header)) : 0;
+	fseek(capture->file, headerSize, SEEK_SET);
+	return true;
+}
+
+void capFile_close(CapFile *capture)
+{
+	if(capture->chunksReceived != 0){
+		capture->incompleteBlocks++;
+		capture->chunksReceived = 0;
+	}
+	if(capture->file != NULL){
+		fclose(capture->file);
+		capture->file = NULL;
+	}
+}
+
+bool capFile_writeBlock(CapFile *capture, uint32_t index, uint32_t time, const int16_t *samples)
+{
+	static uint8_t bytes[BLOCK_SIZE_MAX];
+	uint8_t *write 			= bytes;
+	uint32_t nbSamples 		= (uint32_t) capture->header.nbMics*capture->header.blockFrames;
+
+	write = telem_PutU32(write, index);
+	write = telem_PutU32(write, time);
+	for(uint32_t sample_counter = 0; sample_counter < nbSamples; sample_counter++){
+		write = telem_PutU16(write, (uint16_t) samples[sample_counter]);
+	}
+	if(fwrite(bytes, (size_t) (write - bytes), 1, capture->file) != 1){
+		return false;
+	}
+	capture->nbBlocks++;
+	return true;
+}
+
+bool capFile_readBlock(CapFile *capture, uint32_t *index, uint32_t *time, int16_t *samples)
+{
+	static uint8_t bytes[BLOCK_SIZE_MAX];
+	const uint8_t *read 		= bytes;
+	uint32_t nbSamples 		= (uint32_t) capture->header.nbMics*capture->header.blockFrames;
+	uint16_t sample 			= 0;
+
+	if(fread(bytes, (size_t) capFileBlockSize(&capture->header), 1, capture->file) != 1){
+		return false;
+	}
+	read = telem_GetU32(read, index);
+	read = telem_GetU32(read, time);
+	for(uint32_t sample_counter = 0; sample_counter < nbSamples; sample_counter++){
+		read = telem_GetU16(read, &sample);
+		samples[sample_counter] = (int16_t) sample;
+	}
+	return true;
+}
+
+bool capFile_seek(CapFile *capture, uint32_t block)
+{
+	if(block >= capture->nbBlocks){
+		return false;
+	}
+	return fseek(capture->file, capture->firstBlock + (long) block*capFileBlockSize(&capture->header), SEEK_SET) == 0;
+}
+
+void capFile_reorderBlock(const CapFileHeader *header, const int16_t *samples, int16_t *data)
+{
+	memset(data, 0, CAPFILE__NB_MICS*header->blockFrames*sizeof(int16_t));
+
+	for(uint16_t frame_counter = 0; frame_counter < header->blockFrames; frame_counter++){
+		for(uint8_t mic = 0; mic < header->nbMics; mic++){
+			if(header->micOrder[mic] < CAPFILE__NB_MICS){
+				data[CAPFILE__NB_MICS*frame_counter + header->micOrder[mic]] = samples[header->nbMics*frame_counter + mic];
+			}
+		}
+	}
+}
+
+bool capFile_pushAudioFrame(CapFile *capture, const TelemFrame *frame)
+{
+	const uint8_t *read 		= frame->payload;
+	uint32_t time 			= 0;
+	uint32_t index 			= 0;
+	uint16_t blockFrames 	= 0;
+	uint8_t chunk 			= 0;
+	uint8_t nbChunks 		= 0;
+	uint16_t sample 			= 0;
+	uint32_t chunkSamples 	= 0;
+
+	if(frame->type != TELEM__MSG_AUDIO || frame->size < TELEM__AUDIO_HEADER_SIZE){
+		capture->badFrames++;
+		return false;
+	}
+	read = telem_GetU32(read, &time);
+	read = telem_GetU32(read, &index);
+	read = telem_GetU16(read, &blockFrames);
+	read = telem_GetU8(read, &chunk);
+	read = telem_GetU8(read, &nbChunks);
+	if(blockFrames != capture->header.blockFrames || capture->header.nbMics != CAPFILE__NB_MICS
+			|| nbChunks == 0 || nbChunks > NB_CHUNKS_MAX || chunk >= nbChunks || blockFrames % nbChunks != 0){
+		capture->badFrames++;
+		return false;
+	}
+	chunkSamples = (uint32_t) CAPFILE__NB_MICS*(blockFrames/nbChunks);
+	if(frame->size != TELEM__AUDIO_HEADER_SIZE + SAMPLE_SIZE*chunkSamples){
+		capture->badFrames++;
+		return false;
+	}
+
+	//A chunk of another block means the block being assembled will never be complete
+	if(capture->chunksReceived != 0 && index != capture->chunkIndex){
+		capture->incompleteBlocks++;
+		capture->chunksReceived = 0;
+	}
+	capture->chunkIndex = index;
+	capture->chunkTime = time;
+	for(uint32_t sample_counter = 0; sample_counter < chunkSamples; sample_counter++){
+		read = telem_GetU16(read, &sample);
+		capture->chunkSamples[chunk*chunkSamples + sample_counter] = (int16_t) sample;
+	}
+	capture->chunksReceived |= 1UL << chunk;
+
+	if(capture->chunksReceived == (uint32_t) ((1ULL << nbChunks) - 1)){
+		capture->chunksReceived = 0;
+		return capFile_writeBlock(capture, capture->chunkIndex, capture->chunkTime, capture->chunkSamples);
+	}
+	return true;
+}
+
+
+/*===========================================================================*/
+/* Private functions	 code												   */
+/*===========================================================================*/
+
+long capFileBlockSize(const CapFileHeader *header)
+{
+	return CAPFILE__BLOCK_HEADER_SIZE + SAMPLE_SIZE*(long) header->nbMics*header->blockFrames;
+}
+
+bool capFileHeaderIsValid(const CapFileHeader *header)
+{
+	return header->nbMics > 0 && header->nbMics <= CAPFILE__NB_MICS
+			&& header->blockFrames > 0 && header->blockFrames <= CAPFILE__BLOCK_FRAMES_MAX
+			&& header->samplingHz > 0 && header->tickHz > 0;
+}
@@ -0,0 +1,151 @@
+/*
+ * captureFile.h
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Raw microphone capture files, written from the TELEM__MSG_AUDIO frames of the robot (micCapture.h)
+ * 		or by scene_generate, and read by capture_replay. All the blocks have the same size, so a block is found
+ * 		without reading the ones before it.
+ * Function prefix for public functions in this file: capFile_
+ * Constant prefix for public constants in this file: CAPFILE__
+ */
+#ifndef CAPTUREFILE_H_
+#define CAPTUREFILE_H_
+
+#include <stdio.h>
+
+#include <telemetryFrame.h>
+
+/*===========================================================================*/
+/* Constants definition for this library						               */
+/*===========================================================================*/
+
+/* @note File layout, little endian
+ * header:	"PGMC", u16 version, u16 headerSize, u32 samplingHz, u32 tickHz, u16 blockFrames, u8 nbMics,
+ * 			nbMics x u8 micOrder (CAPFILE__MIC_XXX of each sample of a frame), zeros up to headerSize
+ * blocks:	u32 index, u32 time (in 1/tickHz s), blockFrames frames of nbMics x i16 samples
+ * Block k is at headerSize + k*(CAPFILE__BLOCK_HEADER_SIZE + 2*nbMics*blockFrames). The indexes count the blocks
+ * of the microphones since the start of the robot, a gap between two indexes are blocks that were not captured.
+ */
+#define CAPFILE__MAGIC						"PGMC"
+#define CAPFILE__VERSION						1
+#define CAPFILE__HEADER_SIZE					32
+#define CAPFILE__BLOCK_HEADER_SIZE			8
+
+#define CAPFILE__MIC_RIGHT					0
+#define CAPFILE__MIC_LEFT					1
+#define CAPFILE__MIC_BACK					2
+#define CAPFILE__MIC_FRONT					3
+#define CAPFILE__NB_MICS						4
+
+//Defaults of the e-puck2: mic_start gives 160 frames at 16kHz, ChibiOS counts 10000 ticks per second
+#define CAPFILE__SAMPLING_HZ					16000
+#define CAPFILE__TICK_HZ						10000
+#define CAPFILE__BLOCK_FRAMES				160
+#define CAPFILE__BLOCK_FRAMES_MAX			1024
+
+
+/*===========================================================================*/
+/* Structures						 			                            */
+/*===========================================================================*/
+
+/*
+ * Description of the samples of a capture
+ */
+typedef struct CapFileHeaders {
+	uint32_t samplingHz;
+	uint32_t tickHz;
+	uint16_t blockFrames;
+	uint8_t nbMics;
+	uint8_t micOrder[CAPFILE__NB_MICS];
+} CapFileHeader;
+
+/*
+ * Open capture, with the block being assembled from TELEM__MSG_AUDIO frames
+ */
+typedef struct CapFiles {
+	FILE *file;
+	CapFileHeader header;
+	long firstBlock;						//offset of the first block in the file
+	uint32_t nbBlocks;
+	uint32_t chunkIndex;					//block being assembled
+	uint32_t chunkTime;
+	uint32_t chunksReceived;				//bit of each chunk of this block
+	int16_t chunkSamples[CAPFILE__NB_MICS*CAPFILE__BLOCK_FRAMES_MAX];
+	uint32_t incompleteBlocks;			//blocks of which a chunk was lost
+	uint32_t badFrames;					//audio frames which do not match the header
+} CapFile;
+
+
+/*===========================================================================*/
+/* Public functions definitions            									 */
+/*===========================================================================*/
+
+/*
+ * @brief	Fills a header with the defaults of the e-puck2, microphones in the order of mic_start
+ */
+void capFile_defaultHeader(CapFileHeader *header);
+
+/*
+ * @brief	Creates a capture file, an existing file is replaced
+ *
+ * @return	false on error (errno is set)
+ */
+bool capFile_create(CapFile *capture, const char *path, const CapFileHeader *header);
+
+/*
+ * @brief	Opens a capture file for reading, at its first block
+ *
+ * @return	false on error or if it is not a capture file
+ */
+bool capFile_open(CapFile *capture, const char *path);
+
+/*
+ * @brief	Closes a capture file, a block being assembled is dropped and counted as incomplete
+ */
+void capFile_close(CapFile *capture);
+
+/*
+ * @brief	Appends a block
+ *
+ *  @param[in] samples		nbMics*blockFrames interleaved samples
+ */
+bool capFile_writeBlock(CapFile *capture, uint32_t index, uint32_t time, const int16_t *samples);
+
+/*
+ * @brief	Reads the next block
+ *
+ *  @param[out] samples		nbMics*blockFrames interleaved samples, in the order of header.micOrder
+ *
+ * @return	false at the end of the file
+ */
+bool capFile_readBlock(CapFile *capture, uint32_t *index, uint32_t *time, int16_t *samples);
+
+/*
+ * @brief	Moves to a block, the next capFile_readBlock reads it
+ *
+ * @return	false if there is no such block
+ */
+bool capFile_seek(CapFile *capture, uint32_t block);
+
+/*
+ * @brief	Puts the samples of a block in the order of mic_start (CAPFILE__MIC_XXX), absent microphones are silent
+ *
+ *  @param[in] samples		nbMics*blockFrames samples, as read by capFile_readBlock
+ *  @param[out] data			CAPFILE__NB_MICS*blockFrames samples, for audioP_processAudioData
+ */
+void capFile_reorderBlock(const CapFileHeader *header, const int16_t *samples, int16_t *data);
+
+/*
+ * @brief	Adds the samples of a TELEM__MSG_AUDIO frame to the block being assembled, and appends the block once
+ * 			all its chunks were received
+ * @note 	The frame must match the header (4 microphones, blockFrames), otherwise it is counted in badFrames
+ *
+ * @return	false if the frame could not be used
+ */
+bool capFile_pushAudioFrame(CapFile *capture, const TelemFrame *frame);
+
+
+#endif /* CAPTUREFILE_H_ */
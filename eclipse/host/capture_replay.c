@@ -0,0 +1,201 @@
+/*
+ * capture_replay.c
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Command line tool that replays a capture file (captureFile.h) through the audio processing of the
+ * 		firmware, built for the host with the stand-ins of shim/, in a pipeline of its own (audioP_ctx). The blocks are given to the processing as fast as
+ * 		it can take them: the next block is only given once the analysis waits for it (shim_waitIdle), so the output
+ * 		only depends on the capture and on the code, never on the speed of the host. One line is printed per analysis,
+ * 		with the sources found, which makes the outputs of two versions of the code directly comparable:
+ *
+ * 			capture_replay field.pgmc > before.txt
+ * 			(change the code, make)
+ * 			capture_replay field.pgmc > after.txt
+ * 			diff before.txt after.txt
+ *
+ * 		usage: capture_replay [-b budget] [-n sources] [-s first block] [-l blocks] <capture>
+ * 			-b budget			frames of each audioP_ctxAnalyseSources (default AUDIOP__SCAN_FRAME_BUDGET)
+ * 			-n sources			runtime capacity of sources, audioP_ctxSetNbSourcesMax (default AUDIOP__NB_SOURCES_DEFAULT)
+ * 			-s first block		block of the file to start with (default 0)
+ * 			-l blocks			number of blocks to replay (default all)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <ch.h>
+#include <hal.h>
+
+#include <audio_processing.h>
+#include <telemetry.h>
+#include <hostShim.h>
+#include <captureFile.h>
+
+
+/*===========================================================================*/
+/* Constants definition for this file						               */
+/*===========================================================================*/
+
+#define ANALYSIS_WORKING_AREA_SIZE			4096
+
+#define USAGE								"usage: %s [-b budget] [-n sources] [-s first block] [-l blocks] <capture>\n"
+
+
+/*===========================================================================*/
+/* Static variables definitions 		 			                            */
+/*===========================================================================*/
+
+static audioP_ctx replayCtx;
+static uint8_t frameBudget 					= AUDIOP__SCAN_FRAME_BUDGET;
+static volatile uint32_t replayedBlock 		= 0;		//index of the block being given to the processing
+static uint32_t nbAnalyses 					= 0;
+
+
+/*===========================================================================*/
+/* Private functions definitions                                             */
+/*===========================================================================*/
+
+/**
+ * @brief   Prints the result of an analysis on one line
+*/
+void replayPrint(uint16_t nb_sources, const Destination *destination_scan);
+
+
+/*===========================================================================*/
+/* Threads used in capture_replay                  							*/
+/*===========================================================================*/
+
+/* Analysis thread: scans the sources as the main of the firmware does, as long as there are blocks */
+static THD_WORKING_AREA(waReplayAnalysisThd, ANALYSIS_WORKING_AREA_SIZE);
+static THD_FUNCTION(ReplayAnalysisThd, arg)
+{
+	(void)arg;
+	chRegSetThreadName(__FUNCTION__);
+
+	static Destination destination_scan[AUDIOP__NB_SOURCES_MAX];
+	uint16_t nb_sources 		= 0;
+
+	while(true){
+		nb_sources = audioP_ctxAnalyseSources(&replayCtx, destination_scan, frameBudget);
+		replayPrint(nb_sources, destination_scan);
+	}
+}
+
+
+/*===========================================================================*/
+/* Main					 										            */
+/*===========================================================================*/
+
+int main(int argc, char *argv[])
+{
+	static CapFile capture;
+	static int16_t samples[CAPFILE__NB_MICS*CAPFILE__BLOCK_FRAMES_MAX];
+	static int16_t data[CAPFILE__NB_MICS*CAPFILE__BLOCK_FRAMES_MAX];
+	uint32_t firstBlock 		= 0;
+	uint32_t nbBlocks 		= UINT32_MAX;
+	uint32_t index 			= 0;
+	uint32_t time 			= 0;
+	uint32_t nbReplayed 		= 0;
+	uint32_t nbGaps 			= 0;
+	bool started 			= false;
+	int option 				= 0;
+
+	halInit();
+	chSysInit();
+	audioP_ctxInit(&replayCtx);
+
+	while((option = getopt(argc, argv, "b:n:s:l:")) != -1){
+		switch(option){
+		case 'b':
+			frameBudget = (uint8_t) atoi(optarg);
+			break;
+		case 'n':
+			audioP_ctxSetNbSourcesMax(&replayCtx, (uint8_t) atoi(optarg));
+			break;
+		case 's':
+			firstBlock = (uint32_t) strtoul(optarg, NULL, 0);
+			break;
+		case 'l':
+			nbBlocks = (uint32_t) strtoul(optarg, NULL, 0);
+			break;
+		default:
+			fprintf(stderr, USAGE, argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if(optind != argc-1 || frameBudget == 0){
+		fprintf(stderr, USAGE, argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if(!capFile_open(&capture, argv[optind])){
+		fprintf(stderr, "%s: not a capture file\n", argv[optind]);
+		return EXIT_FAILURE;
+	}
+	if(capture.header.samplingHz != CAPFILE__SAMPLING_HZ){
+		fprintf(stderr, "warning: sampled at %u Hz, the firmware expects %u Hz\n",
+				capture.header.samplingHz, CAPFILE__SAMPLING_HZ);
+	}
+	if(firstBlock > 0 && !capFile_seek(&capture, firstBlock)){
+		fprintf(stderr, "%s: only %u blocks\n", argv[optind], capture.nbBlocks);
+		return EXIT_FAILURE;
+	}
+
+	//Nothing is sent on the serial link, the analysis would otherwise send its spectra
+	telem_setStreams(0);
+	chThdCreateStatic(waReplayAnalysisThd, sizeof(waReplayAnalysisThd), NORMALPRIO, ReplayAnalysisThd, NULL);
+	shim_waitIdle();
+
+	while(nbReplayed < nbBlocks && capFile_readBlock(&capture, &index, &time, samples)){
+		//The audio processing does not know about gaps, a window across a gap mixes two bursts of the robot
+		if(started && index != replayedBlock + 1){
+			printf("gap: blocks %u to %u missing\n", replayedBlock + 1, index - 1);
+			nbGaps++;
+		}
+		started = true;
+		replayedBlock = index;
+
+		capFile_reorderBlock(&capture.header, samples, data);
+		audioP_ctxProcessAudioData(&replayCtx, data, (uint16_t) (CAPFILE__NB_MICS*capture.header.blockFrames));
+		shim_waitIdle();
+		nbReplayed++;
+	}
+	capFile_close(&capture);
+
+	fprintf(stderr, "blocks %u, gaps %u, analyses %u\n", nbReplayed, nbGaps, nbAnalyses);
+	return EXIT_SUCCESS;
+}
+
+
+/*===========================================================================*/
+/* Private functions	 code												   */
+/*===========================================================================*/
+
+void replayPrint(uint16_t nb_sources, const Destination *destination_scan)
+{
+	nbAnalyses++;
+
+	//The times of the stamps depend on the host, only the frame numbers are printed
+	if(nb_sources == AUDIOP__KILLER_WHALE_DETECTED){
+		printf("block %u: killer whale\n", replayedBlock);
+		return;
+	}
+
+	printf("block %u: %u sources", replayedBlock, nb_sources);
+	for(uint16_t source_counter = 0; source_counter < nb_sources; source_counter++){
+		const Destination *destination 	= &destination_scan[source_counter];
+
+		if(destination->valid){
+			printf(" | %u Hz, frame %u, angle %d, ampli %.0f", audioP_convertFreq(destination->freq),
+					destination->stamp.frame, destination->angle, destination->ampli);
+		}
+		else{
+			printf(" | %u Hz, no angle", audioP_convertFreq(destination->freq));
+		}
+	}
+	printf("\n");
+}
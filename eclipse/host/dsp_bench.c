@@ -0,0 +1,322 @@
+/*
+ * dsp_bench.c
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Command line tool that runs the DSP micro-benchmarks (dspBench.h) on the host, or reads the results
+ * 		of the bench command of the robot, and compares them to a baseline. The results are written as csv (the format of
+ * 		the robot) or json. With a baseline, a case regresses if its min_ns is more than the tolerance (and 100ns) above
+ * 		the one of the baseline, or its error_ppm more than the tolerance (and 1ppm) above it. The cases missing from the baseline
+ * 		are only listed. The baseline is the csv output of a previous run, on the same machine:
+ *
+ * 			dsp_bench -o baseline.csv
+ * 			(change the code, make)
+ * 			dsp_bench -b baseline.csv
+ *
+ * 		or for the robot, with robot.log a copy of the output of the bench command (the other lines are ignored):
+ *
+ * 			dsp_bench -i robot.log -b robot_baseline.csv
+ *
+ * 		usage: dsp_bench [-r repetitions] [-k kernel] [-i results] [-f csv|json] [-o output] [-b baseline] [-t tolerance]
+ * 			-r repetitions		of each case (default BENCH__REPETITIONS_DEFAULT)
+ * 			-k kernel			only the kernels whose name starts with kernel
+ * 			-i results			reads the results from this file instead of running the cases
+ * 			-f csv|json			format of the output (default csv)
+ * 			-o output			file of the output (default the standard output)
+ * 			-b baseline			compares the results to this csv, exits with 1 if a case regressed
+ * 			-t tolerance			in % (default TOLERANCE_DEFAULT)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <dspBench.h>
+
+
+/*===========================================================================*/
+/* Constants definition for this file						               */
+/*===========================================================================*/
+
+#define NB_ROWS_MAX							256
+#define NAME_MAX_LENGTH						32
+#define LINE_MAX_LENGTH						256
+#define TOLERANCE_DEFAULT					10.0			//in %, the minimum of 20 repetitions varies by a few %
+#define TIME_NS_MARGIN						100				//the shortest kernels take a few 100ns, close to the clock resolution
+#define ERROR_PPM_MARGIN						1				//the error of an approximation can change by rounding
+
+#define FORMAT_CSV							0
+#define FORMAT_JSON							1
+
+#define USAGE								"usage: %s [-r repetitions] [-k kernel] [-i results] [-f csv|json] [-o output] " \
+												"[-b baseline] [-t tolerance]\n"
+
+
+/*===========================================================================*/
+/* Structures						 			                            */
+/*===========================================================================*/
+
+/*
+ * Result of a case, BenchResult with its own strings to be read from a file
+ */
+typedef struct BenchRows {
+	char kernel[NAME_MAX_LENGTH];
+	char input[NAME_MAX_LENGTH];
+	unsigned size;
+	unsigned repetitions;
+	unsigned long minNs;
+	unsigned long meanNs;
+	unsigned long errorPpm;
+} BenchRow;
+
+
+/*===========================================================================*/
+/* Static variables definitions 		 			                            */
+/*===========================================================================*/
+
+static BenchRow rows[NB_ROWS_MAX];
+static BenchRow baseline[NB_ROWS_MAX];
+
+
+/*===========================================================================*/
+/* Private functions definitions                                             */
+/*===========================================================================*/
+
+/**
+ * @brief   Runs the cases of the kernels whose name starts with kernelPrefix
+ *
+ * @return	the number of rows
+*/
+uint16_t benchRunCases(uint16_t repetitions, const char *kernelPrefix, BenchRow *results);
+
+/**
+ * @brief   Reads the csv lines of results of a file, the other lines are ignored
+ *
+ * @return	the number of rows, -1 if the file cannot be opened
+*/
+int benchReadCsv(const char *path, const char *kernelPrefix, BenchRow *results);
+
+/**
+ * @brief   Writes the rows as csv or json
+*/
+void benchWrite(FILE *output, uint8_t format, const BenchRow *results, uint16_t nbResults);
+
+/**
+ * @brief   Compares the rows to the baseline, prints the regressions on stderr
+ *
+ * @return	the number of regressions
+*/
+uint16_t benchCompare(const BenchRow *results, uint16_t nbResults, const BenchRow *base, uint16_t nbBase, double tolerance);
+
+
+/*===========================================================================*/
+/* Main					 										            */
+/*===========================================================================*/
+
+int main(int argc, char *argv[])
+{
+	const char *kernelPrefix 	= "";
+	const char *inputPath 		= NULL;
+	const char *outputPath 		= NULL;
+	const char *baselinePath 	= NULL;
+	uint16_t repetitions 		= BENCH__REPETITIONS_DEFAULT;
+	uint8_t format 				= FORMAT_CSV;
+	double tolerance 			= TOLERANCE_DEFAULT;
+	int nbRows 					= 0;
+	int nbBaseline 				= 0;
+	uint16_t nbRegressions 		= 0;
+	FILE *output 				= stdout;
+	int option 					= 0;
+
+	while((option = getopt(argc, argv, "r:k:i:f:o:b:t:")) != -1){
+		switch(option){
+		case 'r':
+			repetitions = (uint16_t) atoi(optarg);
+			break;
+		case 'k':
+			kernelPrefix = optarg;
+			break;
+		case 'i':
+			inputPath = optarg;
+			break;
+		case 'f':
+			if(strcmp(optarg, "csv") == 0){
+				format = FORMAT_CSV;
+			}
+			else if(strcmp(optarg, "json") == 0){
+				format = FORMAT_JSON;
+			}
+			else{
+				fprintf(stderr, USAGE, argv[0]);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'o':
+			outputPath = optarg;
+			break;
+		case 'b':
+			baselinePath = optarg;
+			break;
+		case 't':
+			tolerance = atof(optarg);
+			break;
+		default:
+			fprintf(stderr, USAGE, argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if(optind != argc || repetitions == 0 || tolerance < 0){
+		fprintf(stderr, USAGE, argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if(inputPath != NULL){
+		nbRows = benchReadCsv(inputPath, kernelPrefix, rows);
+		if(nbRows < 0){
+			fprintf(stderr, "%s: cannot open %s\n", argv[0], inputPath);
+			return EXIT_FAILURE;
+		}
+	}
+	else{
+		nbRows = benchRunCases(repetitions, kernelPrefix, rows);
+	}
+
+	if(outputPath != NULL){
+		output = fopen(outputPath, "w");
+		if(output == NULL){
+			fprintf(stderr, "%s: cannot write %s\n", argv[0], outputPath);
+			return EXIT_FAILURE;
+		}
+	}
+	benchWrite(output, format, rows, (uint16_t) nbRows);
+	if(output != stdout){
+		fclose(output);
+	}
+
+	if(baselinePath != NULL){
+		nbBaseline = benchReadCsv(baselinePath, "", baseline);
+		if(nbBaseline < 0){
+			fprintf(stderr, "%s: cannot open %s\n", argv[0], baselinePath);
+			return EXIT_FAILURE;
+		}
+		nbRegressions = benchCompare(rows, (uint16_t) nbRows, baseline, (uint16_t) nbBaseline, tolerance);
+		fprintf(stderr, "%d cases, %u regressions over a tolerance of %.1f%%\n", nbRows, nbRegressions, tolerance);
+		if(nbRegressions > 0){
+			return EXIT_FAILURE;
+		}
+	}
+	return EXIT_SUCCESS;
+}
+
+
+/*===========================================================================*/
+/* Private functions	 code												   */
+/*===========================================================================*/
+
+uint16_t benchRunCases(uint16_t repetitions, const char *kernelPrefix, BenchRow *results)
+{
+	BenchResult result;
+	uint16_t nb_results 		= 0;
+
+	for(uint8_t case_counter = 0; case_counter < bench_getNbCases() && nb_results < NB_ROWS_MAX; case_counter++){
+		if(!bench_run(case_counter, repetitions, &result)
+				|| strncmp(result.kernel, kernelPrefix, strlen(kernelPrefix)) != 0){
+			continue;
+		}
+		snprintf(results[nb_results].kernel, NAME_MAX_LENGTH, "%s", result.kernel);
+		snprintf(results[nb_results].input, NAME_MAX_LENGTH, "%s", result.input);
+		results[nb_results].size = result.size;
+		results[nb_results].repetitions = result.repetitions;
+		results[nb_results].minNs = result.minNs;
+		results[nb_results].meanNs = result.meanNs;
+		results[nb_results].errorPpm = result.errorPpm;
+		nb_results++;
+	}
+	return nb_results;
+}
+
+int benchReadCsv(const char *path, const char *kernelPrefix, BenchRow *results)
+{
+	char line[LINE_MAX_LENGTH];
+	BenchRow row;
+	int nb_results 			= 0;
+	FILE *file 				= fopen(path, "r");
+
+	if(file == NULL){
+		return -1;
+	}
+	//the lines of the robot end with \n\r, the \r starts the next line: the header and the other lines do not match
+	while(fgets(line, sizeof(line), file) != NULL && nb_results < NB_ROWS_MAX){
+		if(sscanf(line, " %31[^,],%31[^,],%u,%u,%lu,%lu,%lu", row.kernel, row.input, &row.size, &row.repetitions,
+				&row.minNs, &row.meanNs, &row.errorPpm) != 7){
+			continue;
+		}
+		if(strncmp(row.kernel, kernelPrefix, strlen(kernelPrefix)) == 0){
+			results[nb_results++] = row;
+		}
+	}
+	fclose(file);
+	return nb_results;
+}
+
+void benchWrite(FILE *output, uint8_t format, const BenchRow *results, uint16_t nbResults)
+{
+	if(format == FORMAT_CSV){
+		fprintf(output, "%s\n", BENCH__CSV_HEADER);
+		for(uint16_t result_counter = 0; result_counter < nbResults; result_counter++){
+			fprintf(output, "%s,%s,%u,%u,%lu,%lu,%lu\n", results[result_counter].kernel, results[result_counter].input,
+					results[result_counter].size, results[result_counter].repetitions, results[result_counter].minNs,
+					results[result_counter].meanNs, results[result_counter].errorPpm);
+		}
+		return;
+	}
+
+	//the names are identifiers of the benchmark, they need no escaping
+	fprintf(output, "[\n");
+	for(uint16_t result_counter = 0; result_counter < nbResults; result_counter++){
+		fprintf(output, "  {\"kernel\": \"%s\", \"input\": \"%s\", \"size\": %u, \"repetitions\": %u, \"min_ns\": %lu, "
+				"\"mean_ns\": %lu, \"error_ppm\": %lu}%s\n", results[result_counter].kernel, results[result_counter].input,
+				results[result_counter].size, results[result_counter].repetitions, results[result_counter].minNs,
+				results[result_counter].meanNs, results[result_counter].errorPpm,
+				(result_counter + 1 < nbResults) ? "," : "");
+	}
+	fprintf(output, "]\n");
+}
+
+uint16_t benchCompare(const BenchRow *results, uint16_t nbResults, const BenchRow *base, uint16_t nbBase, double tolerance)
+{
+	const BenchRow *reference 	= NULL;
+	uint16_t nb_regressions 		= 0;
+
+	for(uint16_t result_counter = 0; result_counter < nbResults; result_counter++){
+		const BenchRow *result 	= &results[result_counter];
+
+		reference = NULL;
+		for(uint16_t base_counter = 0; base_counter < nbBase && reference == NULL; base_counter++){
+			if(strcmp(base[base_counter].kernel, result->kernel) == 0 && strcmp(base[base_counter].input, result->input) == 0
+					&& base[base_counter].size == result->size){
+				reference = &base[base_counter];
+			}
+		}
+		if(reference == NULL){
+			fprintf(stderr, "new: %s %s %u\n", result->kernel, result->input, result->size);
+			continue;
+		}
+
+		if(result->minNs > reference->minNs*(1 + tolerance/100) + TIME_NS_MARGIN){
+			fprintf(stderr, "slower: %s %s %u, min %lu ns instead of %lu ns (%+.1f%%)\n", result->kernel, result->input,
+					result->size, result->minNs, reference->minNs,
+					100.0*((double) result->minNs - (double) reference->minNs)/(double) (reference->minNs ? reference->minNs : 1));
+			nb_regressions++;
+		}
+		if(result->errorPpm > reference->errorPpm*(1 + tolerance/100) + ERROR_PPM_MARGIN){
+			fprintf(stderr, "less accurate: %s %s %u, error %lu ppm instead of %lu ppm\n", result->kernel, result->input,
+					result->size, result->errorPpm, reference->errorPpm);
+			nb_regressions++;
+		}
+	}
+	return nb_regressions;
+}
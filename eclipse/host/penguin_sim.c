@@ -0,0 +1,397 @@
+/*
+ * penguin_sim.c
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Closed loop simulator of the robot: the whole firmware, main.c included, runs against the stand-ins
+ * 		of shim/ in a simulated world (robotSim.h). The motors drive the robot in the world, the distance sensors
+ * 		and the microphones give what the robot sees and hears from where it is. The ChibiOS clock is virtual: it
+ * 		jumps to the next time a thread waits for when all the threads wait, so the simulation runs as fast as the
+ * 		host computes, many times faster than real time, with the timings of the robot.
+ *
+ * 		The commands are typed on the serial link at start (by default "mission nearest", the robot then goes to the
+ * 		penguin in front of it alone). The simulation stops when the robot reached the penguins (body LED on) and
+ * 		escaped the killer whale, or at the time limit, and prints on stdout, one "name value" per line:
+ * 			sim_s, wall_s, speedup			simulated and host times
+ * 			arrivals						destinations reached by the firmware
+ * 			time_to_target_s				time of the first arrival, -1 if none
+ * 			target_hz, target_gap_mm			penguin closest to the robot at the first arrival, and the gap between them
+ * 			path_mm, collisions				distance driven, times the robot drove into an obstacle or a wall
+ * 			killer_detect_s					time from the onset of the killer whale to the warning LEDs, -1 if none
+ * 			killer_escape_s					time from the onset to the robot driving away from it once detected, -1 if none
+ * 			pipeline_ms_per_s				host time spent in the stages of profiling.h per simulated second, the
+ * 											cost of the processing (the simulator is built with PROF__ENABLED)
+ *
+ * 		usage: penguin_sim [-t seconds] [-s freq,x,y[,ampli]]... [-k x,y,onset[,seconds[,ampli]]] [-o x,y,radius]...
+ * 				[-a half size] [-p x,y,heading] [-n rms] [-e seed] [-c command]... [-v visits] [-l file]
+ * 			-t seconds			simulated time limit (default 60)
+ * 			-s freq,x,y,ampli	penguin in Hz at (x,y) mm, heard with ampli LSB at start (default 2000)
+ * 			-k x,y,onset,seconds,ampli	killer whale at (x,y) mm, heard from onset s for seconds (default 5) with ampli
+ * 								LSB (default 4000)
+ * 			-o x,y,radius		round obstacle, in mm
+ * 			-a half size			square walls at +-half size mm around (0,0) (default none)
+ * 			-p x,y,heading		start pose of the robot in mm and degrees (default 0,0,0: facing +x)
+ * 			-n rms				white noise of each microphone, in LSB (default 0)
+ * 			-e seed				seed of the noise (default 1)
+ * 			-c command			line typed on the serial link at start, in order (default "mission nearest")
+ * 			-v visits			arrivals after which the simulation stops (default 1)
+ * 			-l file				serial output of the firmware, text and telemetry (default discarded)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <ch.h>
+#include <hal.h>
+#include <hostShim.h>
+#include <profiling.h>
+#include <robotSim.h>
+
+
+/*===========================================================================*/
+/* Constants definition for this file						               */
+/*===========================================================================*/
+
+#define DEFAULT_LIMIT_S						60.0
+#define DEFAULT_AMPLITUDE					2000.0
+#define DEFAULT_KILLER_S						5.0
+#define DEFAULT_KILLER_AMPLITUDE				4000.0
+#define DEFAULT_SEED							1
+#define DEFAULT_COMMAND						"mission nearest"
+#define DEFAULT_VISITS						1
+
+#define INPUT_SIZE							512
+#define NO_TIME								-1.0
+#define ESCAPE_MMPS							10.0		//the robot escapes once it drives away from the killer this fast
+#define NS_PER_S								1e9
+#define NS_PER_MS							1e6
+
+#define USAGE								"usage: %s [-t seconds] [-s freq,x,y[,ampli]]... [-k x,y,onset[,seconds[,ampli]]] " \
+											"[-o x,y,radius]... [-a half size] [-p x,y,heading] [-n rms] [-e seed] " \
+											"[-c command]... [-v visits] [-l file]\n"
+
+
+/*===========================================================================*/
+/* Structures						 			                            */
+/*===========================================================================*/
+
+/*
+ * Simulation in progress, updated at each move of the virtual clock
+ */
+typedef struct SimRuns {
+	SimWorld world;
+	double limitS;
+	uint8_t visits;
+	struct timespec wallStart;
+	systime_t lastTime;
+	double timeS;
+	bool bodyLed;
+	uint8_t arrivals;
+	double arrivalS;
+	int8_t arrivalSource;
+	double arrivalGapMm;
+	int8_t killer;						//source of the killer whale, -1 if none
+	double killerOnsetS;
+	double killerEndS;
+	bool killerHeard;
+	bool warningLed;
+	double killerDistanceMm;
+	double killerDetectS;
+	double killerEscapeS;
+} SimRun;
+
+
+/*===========================================================================*/
+/* Private functions definitions                                             */
+/*===========================================================================*/
+
+/*
+ * main of main.c, renamed when it is built for the simulator
+ */
+int penguins_main(void);
+
+/**
+ * @brief   Moves the world to the time of the virtual clock, records the measures and ends the simulation
+ * @note 	shim_clockHook of the virtual clock
+*/
+void simOnClock(systime_t now, void *context);
+
+/**
+ * @brief   Gives the distance sensors of the world to the shim
+*/
+void simApplySensors(const SimWorld *world);
+
+/**
+ * @brief   Returns the time spent in all the profiled stages since start, in ms
+*/
+double simPipelineMs(void);
+
+/**
+ * @brief   Prints the measures and exits
+*/
+void simEnd(SimRun *run);
+
+
+/*===========================================================================*/
+/* Main					 										            */
+/*===========================================================================*/
+
+int main(int argc, char *argv[])
+{
+	static SimRun run;
+	static char input[INPUT_SIZE];
+	double values[5] 		= {0};
+	double pose[3] 			= {0};
+	double noiseRms 			= 0;
+	double arenaHalfMm 		= 0;
+	uint64_t seed 			= DEFAULT_SEED;
+	const char *logPath 		= NULL;
+	int option 				= 0;
+	int outFd 				= 0;
+
+	run.limitS = DEFAULT_LIMIT_S;
+	run.visits = DEFAULT_VISITS;
+	run.killer = -1;
+
+	//the sources are added once the pose is known, their options are parsed twice
+	while((option = getopt(argc, argv, "t:s:k:o:a:p:n:e:c:v:l:")) != -1){
+		switch(option){
+		case 't':
+			run.limitS = atof(optarg);
+			break;
+		case 's':
+			if(sscanf(optarg, "%lf,%lf,%lf,%lf", &values[0], &values[1], &values[2], &values[3]) < 3){
+				fprintf(stderr, USAGE, argv[0]);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'k':
+			if(sscanf(optarg, "%lf,%lf,%lf,%lf,%lf", &values[0], &values[1], &values[2], &values[3], &values[4]) < 3){
+				fprintf(stderr, USAGE, argv[0]);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'o':
+			if(sscanf(optarg, "%lf,%lf,%lf", &values[0], &values[1], &values[2]) != 3){
+				fprintf(stderr, USAGE, argv[0]);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'a':
+			arenaHalfMm = atof(optarg);
+			break;
+		case 'p':
+			if(sscanf(optarg, "%lf,%lf,%lf", &pose[0], &pose[1], &pose[2]) != 3){
+				fprintf(stderr, USAGE, argv[0]);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'n':
+			noiseRms = atof(optarg);
+			break;
+		case 'e':
+			seed = strtoull(optarg, NULL, 0);
+			break;
+		case 'c':
+			if(strlen(input) + strlen(optarg) + 2 > sizeof(input)){
+				fprintf(stderr, "at most %d characters of commands\n", INPUT_SIZE);
+				return EXIT_FAILURE;
+			}
+			strcat(input, optarg);
+			strcat(input, "\r");
+			break;
+		case 'v':
+			run.visits = (uint8_t) atoi(optarg);
+			break;
+		case 'l':
+			logPath = optarg;
+			break;
+		default:
+			fprintf(stderr, USAGE, argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if(optind != argc || run.limitS <= 0){
+		fprintf(stderr, USAGE, argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	sim_init(&run.world, seed);
+	sim_setArena(&run.world, arenaHalfMm);
+	scene_setNoise(&run.world.scene, noiseRms);
+	scene_setRobotPose(&run.world.scene, pose[0], pose[1], pose[2]);
+
+	optind = 1;
+	while((option = getopt(argc, argv, "t:s:k:o:a:p:n:e:c:v:l:")) != -1){
+		int8_t source 		= 0;
+
+		if(option == 's'){
+			values[3] = DEFAULT_AMPLITUDE;
+			sscanf(optarg, "%lf,%lf,%lf,%lf", &values[0], &values[1], &values[2], &values[3]);
+			source = sim_addSource(&run.world, values[0], values[1], values[2], values[3], true);
+		}
+		else if(option == 'k'){
+			values[3] = DEFAULT_KILLER_S;
+			values[4] = DEFAULT_KILLER_AMPLITUDE;
+			sscanf(optarg, "%lf,%lf,%lf,%lf,%lf", &values[0], &values[1], &values[2], &values[3], &values[4]);
+			source = sim_addSource(&run.world, SIM__KILLER_FREQ_HZ, values[0], values[1], values[4], false);
+			if(source >= 0){
+				run.killer = source;
+				run.killerOnsetS = values[2];
+				run.killerEndS = values[2] + values[3];
+				scene_setSourceActive(&run.world.scene, (uint8_t) source, false);
+			}
+		}
+		else if(option == 'o'){
+			sscanf(optarg, "%lf,%lf,%lf", &values[0], &values[1], &values[2]);
+			source = sim_addObstacle(&run.world, values[0], values[1], values[2]) ? 0 : -1;
+		}
+		if(source < 0){
+			fprintf(stderr, "at most %d sources and %d obstacles, penguins included\n",
+					SCENE__NB_SOURCES_MAX, SIM__NB_OBSTACLES_MAX);
+			return EXIT_FAILURE;
+		}
+	}
+
+	//The serial output of the firmware is only kept on demand, the measures are printed on stdout
+	outFd = open((logPath != NULL) ? logPath : "/dev/null", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if(outFd < 0){
+		perror(logPath);
+		return EXIT_FAILURE;
+	}
+	SD3.outFd = outFd;
+	shim_setSerialInput((input[0] != '\0') ? input : DEFAULT_COMMAND "\r");
+
+	run.arrivalS = NO_TIME;
+	run.arrivalSource = -1;
+	run.killerDetectS = NO_TIME;
+	run.killerEscapeS = NO_TIME;
+	simApplySensors(&run.world);
+	shim_setMicSource(scene_fill, &run.world.scene);
+	shim_useVirtualClock(simOnClock, &run);
+	clock_gettime(CLOCK_MONOTONIC, &run.wallStart);
+
+	//It never returns, simOnClock ends the simulation
+	return penguins_main();
+}
+
+
+/*===========================================================================*/
+/* Private functions	 code												   */
+/*===========================================================================*/
+
+void simOnClock(systime_t now, void *context)
+{
+	SimRun *run 				= (SimRun *) context;
+	SimWorld *world 			= &run->world;
+	double stepS 			= (double) (systime_t) (now - run->lastTime)/CH_CFG_ST_FREQUENCY;
+	int rightSps 			= 0;
+	int leftSps 				= 0;
+
+	//The speeds were set before the previous move of the clock, they were kept until now
+	shim_getMotorSpeeds(&rightSps, &leftSps);
+	sim_step(world, rightSps, leftSps, stepS);
+	simApplySensors(world);
+	run->lastTime = now;
+	run->timeS += stepS;
+
+	//Arrival: main.c turns the body LED on when it reached its destination
+	if(shim_getPad(GPIOB, GPIOB_LED_BODY) && !run->bodyLed){
+		run->arrivals++;
+		if(run->arrivalS == NO_TIME){
+			run->arrivalS = run->timeS;
+			for(uint8_t source_counter = 0; source_counter < world->scene.nbSources; source_counter++){
+				double gapMm 	= sim_getSourceGapMm(world, source_counter);
+
+				if((int8_t) source_counter != run->killer && (run->arrivalSource < 0 || gapMm < run->arrivalGapMm)){
+					run->arrivalSource = (int8_t) source_counter;
+					run->arrivalGapMm = gapMm;
+				}
+			}
+		}
+	}
+	run->bodyLed = shim_getPad(GPIOB, GPIOB_LED_BODY);
+
+	//Killer whale: the warning LEDs start blinking when it is detected, then the robot drives away from it
+	if(run->killer >= 0 && !run->killerHeard && run->timeS >= run->killerOnsetS){
+		scene_setSourceActive(&world->scene, (uint8_t) run->killer, true);
+		run->killerHeard = true;
+		run->killerDistanceMm = scene_getDistanceMm(&world->scene, (uint8_t) run->killer);
+		run->warningLed = shim_getPad(GPIOD, GPIOD_LED1);
+	}
+	else if(run->killerHeard && stepS > 0){
+		double distanceMm 	= scene_getDistanceMm(&world->scene, (uint8_t) run->killer);
+
+		if(run->timeS >= run->killerEndS){
+			scene_setSourceActive(&world->scene, (uint8_t) run->killer, false);
+		}
+		if(run->killerDetectS == NO_TIME && run->warningLed && !shim_getPad(GPIOD, GPIOD_LED1)){
+			run->killerDetectS = run->timeS - run->killerOnsetS;
+		}
+		if(run->killerEscapeS == NO_TIME && run->killerDetectS != NO_TIME
+				&& (distanceMm - run->killerDistanceMm)/stepS > ESCAPE_MMPS){
+			run->killerEscapeS = run->timeS - run->killerOnsetS;
+		}
+		run->warningLed = shim_getPad(GPIOD, GPIOD_LED1);
+		run->killerDistanceMm = distanceMm;
+	}
+
+	if(run->timeS >= run->limitS
+			|| (run->arrivals >= run->visits && (run->killer < 0 || run->killerEscapeS != NO_TIME))){
+		simEnd(run);
+	}
+}
+
+void simApplySensors(const SimWorld *world)
+{
+	shim_setTofMm(sim_getTofMm(world));
+	for(uint8_t sensor_counter = 0; sensor_counter < SIM__NB_IR; sensor_counter++){
+		shim_setProximity(sensor_counter, sim_getProximity(world, sensor_counter));
+	}
+}
+
+double simPipelineMs(void)
+{
+	ProfStat stats;
+	double totalMs 			= 0;
+
+	for(uint8_t stage_counter = 0; stage_counter < PROF__NB_STAGES; stage_counter++){
+		if(prof_getStats(stage_counter, &stats)){
+			totalMs += (double) stats.count*stats.meanNs/NS_PER_MS;
+		}
+	}
+	return totalMs;
+}
+
+void simEnd(SimRun *run)
+{
+	struct timespec wallEnd;
+	double wallS 			= 0;
+	bool reached 			= run->arrivals >= run->visits && (run->killer < 0 || run->killerEscapeS != NO_TIME);
+
+	clock_gettime(CLOCK_MONOTONIC, &wallEnd);
+	wallS = (double) (wallEnd.tv_sec - run->wallStart.tv_sec) + (wallEnd.tv_nsec - run->wallStart.tv_nsec)/NS_PER_S;
+
+	printf("sim_s %.3f\n", run->timeS);
+	printf("wall_s %.3f\n", wallS);
+	printf("speedup %.1f\n", (wallS > 0) ? run->timeS/wallS : 0);
+	printf("arrivals %u\n", run->arrivals);
+	printf("time_to_target_s %.3f\n", run->arrivalS);
+	printf("target_hz %.0f\n", (run->arrivalSource >= 0) ? run->world.scene.sources[run->arrivalSource].freqHz : 0);
+	printf("target_gap_mm %.1f\n", (run->arrivalSource >= 0) ? run->arrivalGapMm : -1);
+	printf("path_mm %.1f\n", run->world.pathMm);
+	printf("collisions %u\n", run->world.collisions);
+	printf("killer_detect_s %.3f\n", run->killerDetectS);
+	printf("killer_escape_s %.3f\n", run->killerEscapeS);
+	printf("pipeline_ms_per_s %.3f\n", (run->timeS > 0) ? simPipelineMs()/run->timeS : 0);
+	fflush(stdout);
+
+	//The firmware threads never end, the whole process does
+	exit(reached ? EXIT_SUCCESS : EXIT_FAILURE);
+}
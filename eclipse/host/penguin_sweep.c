@@ -0,0 +1,703 @@
+/*
+ * penguin_sweep.c
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Monte Carlo sweep of the hand-tuned parameters of the firmware, on the closed loop simulator
+ * 		(penguin_sim.c). Random sets of parameters (configurations) are each run on the same random scenes: one to
+ * 		three penguins around the robot, sometimes a killer whale, noisy microphones. Every run is its own
+ * 		penguin_sim process, so every run has its own copy of the state of the modules, and as many runs as cores
+ * 		are run at the same time. The parameters are given to the firmware with its "set" commands before
+ * 		"mission nearest": the robot must reach the penguin with the smallest bearing at start.
+ *
+ * 		Each configuration gets three measures over its scenes, written on stdout, one line per configuration:
+ * 			accuracy						share of the runs where the robot reached the right penguin (within the gap
+ * 											limit) and escaped the killer whale
+ * 			pipeline_ms_per_s				mean cost of the processing, pipeline_ms_per_s of penguin_sim
+ * 			time_to_target_s				mean time to the first arrival, the time limit for the runs without any
+ * 		and pareto is 1 for the configurations no other one beats on all three measures at once. Configuration 0
+ * 		always has the parameters of the firmware, to compare the front with.
+ *
+ * 		usage: penguin_sweep [-c configs] [-r scenes] [-j jobs] [-e seed] [-t seconds] [-w share] [-n rms]
+ * 				[-g gap] [-m prop|pid] [-p name=min[:max]]... [-o runs] [-x simulator]
+ * 			-c configs			number of configurations (default 32)
+ * 			-r scenes			scenes each configuration runs (default 16)
+ * 			-j jobs				simulations at the same time (default the number of cores), more jobs than cores
+ * 								inflate the cost, it is measured in host time
+ * 			-e seed				seed of the scenes and of the parameters (default 1)
+ * 			-t seconds			simulated time limit of each run (default 40)
+ * 			-w share			share of the scenes with a killer whale (default 0.3)
+ * 			-n rms				highest white noise of the microphones in LSB, each scene draws its own (default 50)
+ * 			-g gap				largest gap in mm between the robot and the penguin at arrival (default 60)
+ * 			-m prop|pid			controller of the motors, the motor parameters only exist in prop (default prop)
+ * 			-p name=min:max		range of a parameter, name=value fixes it, see the names below
+ * 			-o runs				writes every run as CSV in this file
+ * 			-x simulator		path of penguin_sim (default next to penguin_sweep)
+ *
+ * 		parameters (default range): ampli_thd (8000:30000), freq_thd (1:6 bins), errors_max (3:30), ema_weight
+ * 		(0.05:0.8) of audio_processing.c, set audio; mot_max_angle (10:90 deg), ema_weight_mot (0.5:0.97) of the
+ * 		proportional controller of travelController.c, set prop.
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+
+/*===========================================================================*/
+/* Constants definition for this file						               */
+/*===========================================================================*/
+
+#define DEFAULT_CONFIGS						32
+#define DEFAULT_SCENES						16
+#define DEFAULT_SEED							1
+#define DEFAULT_LIMIT_S						40.0
+#define DEFAULT_KILLER_SHARE					0.3
+#define DEFAULT_NOISE_RMS					50.0
+#define DEFAULT_GAP_MM						60.0
+#define SIMULATOR_NAME						"penguin_sim"
+
+//Random scenes, the robot is at (0,0) facing +x
+#define NB_PENGUINS_MAX						3
+#define PENGUIN_FREQS_HZ						{450, 550, 650, 750, 850}	//inside the scanned band, away from the killer whale
+#define NB_PENGUIN_FREQS						5
+#define PENGUIN_BEARING_MAX_DEG				150.0
+#define PENGUIN_BEARING_GAP_DEG				30.0		//the nearest bearing is never ambiguous
+#define PENGUIN_DISTANCE_MIN_MM				400.0
+#define PENGUIN_DISTANCE_MAX_MM				900.0
+#define KILLER_DISTANCE_MIN_MM				500.0
+#define KILLER_DISTANCE_MAX_MM				900.0
+#define KILLER_ONSET_MIN_S					2.0
+#define KILLER_ONSET_MAX_S					6.0
+#define ARENA_HALF_MM						1200.0
+#define DRAWS_MAX							100			//draws of a bearing before giving up a penguin
+
+#define NB_PARAMS							6
+#define NB_AUDIO_PARAMS						4			//the first ones, the others are of the motors
+#define COMMAND_SIZE							64			//COMMS__LINE_SIZE of the firmware
+#define ARGS_MAX								32
+#define OUTPUT_SIZE							4096		//whole output of a penguin_sim, it fits in a pipe
+#define PATH_SIZE							1024
+#define SIM_EXIT_REACHED						0			//exit codes of penguin_sim
+#define SIM_EXIT_NOT_REACHED					1
+#define NO_TIME								-1.0
+#define DEG_PER_RAD							(180.0/M_PI)
+
+#define USAGE								"usage: %s [-c configs] [-r scenes] [-j jobs] [-e seed] [-t seconds] [-w share] " \
+											"[-n rms] [-g gap] [-m prop|pid] [-p name=min[:max]]... [-o runs] [-x simulator]\n"
+
+
+/*===========================================================================*/
+/* Structures						 			                            */
+/*===========================================================================*/
+
+/*
+ * Parameter of the firmware which is swept
+ */
+typedef struct SweepParams {
+	const char *name;
+	double firmwareValue;				//hand-tuned value of the firmware
+	double min;
+	double max;
+	bool integer;
+} SweepParam;
+
+/*
+ * Random scene, the same for all the configurations
+ */
+typedef struct SweepScenes {
+	uint64_t seed;						//of the noise of the microphones
+	uint8_t nbPenguins;
+	double freqHz[NB_PENGUINS_MAX];
+	double xMm[NB_PENGUINS_MAX];
+	double yMm[NB_PENGUINS_MAX];
+	uint8_t expected;					//penguin of the smallest bearing, where "mission nearest" goes
+	bool killer;
+	double killerXMm;
+	double killerYMm;
+	double killerOnsetS;
+	double noiseRms;
+} SweepScene;
+
+/*
+ * Measures of one run, read from the output of penguin_sim
+ */
+typedef struct SweepRuns {
+	int exitCode;						//-1 if penguin_sim did not end by itself
+	bool correct;
+	double timeToTargetS;
+	double targetHz;
+	double targetGapMm;
+	double collisions;
+	double killerDetectS;
+	double killerEscapeS;
+	double pipelineMsPerS;
+} SweepRun;
+
+/*
+ * Measures of a configuration over all the scenes
+ */
+typedef struct SweepScores {
+	double accuracy;
+	double pipelineMsPerS;
+	double timeToTargetS;
+	bool pareto;
+} SweepScore;
+
+/*
+ * Options of the sweep
+ */
+typedef struct SweepOptions {
+	uint32_t nbConfigs;
+	uint32_t nbScenes;
+	long nbJobs;
+	double limitS;
+	double gapMm;
+	bool propMode;
+	char simulator[PATH_SIZE];
+} SweepOption;
+
+
+/*===========================================================================*/
+/* Static variables definitions 		 			                            */
+/*===========================================================================*/
+
+//Values of the firmware: AUDIOP__XXX_DEFAULT of audio_processing.h, MOT_MAX_ANGLE_TO_CORRECT and EMA_WEIGHT_MOT
+static SweepParam params[NB_PARAMS] = {
+	{"ampli_thd", 15000, 8000, 30000, true},
+	{"freq_thd", 3, 1, 6, true},
+	{"errors_max", 15, 3, 30, true},
+	{"ema_weight", 0.2, 0.05, 0.8, false},
+	{"mot_max_angle", 40, 10, 90, true},
+	{"ema_weight_mot", 0.9, 0.5, 0.97, false},
+};
+
+static uint64_t randomState 					= DEFAULT_SEED;
+
+
+/*===========================================================================*/
+/* Private functions definitions                                             */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns a uniform random number in [0,1[ (splitmix64)
+*/
+double sweepRandom(void);
+
+/**
+ * @brief   Parses a -p option into the range of its parameter
+ *
+ * @return	false if the parameter does not exist or the range is not a number
+*/
+bool sweepParseRange(const char *option);
+
+/**
+ * @brief   Draws a random scene
+ *
+ *  @param[in] killerShare		probability of a killer whale
+ *  @param[in] noiseRms			highest noise of the microphones
+*/
+void sweepDrawScene(SweepScene *scene, double killerShare, double noiseRms);
+
+/**
+ * @brief   Starts penguin_sim for a configuration on a scene, its stdout goes to a pipe
+ *
+ *  @param[out] outFd			read end of the pipe
+ *
+ * @return	pid of penguin_sim, -1 if it could not be started
+*/
+pid_t sweepStart(const SweepOption *options, const double *values, const SweepScene *scene, int *outFd);
+
+/**
+ * @brief   Reads the measures of a finished penguin_sim and scores them
+*/
+void sweepRead(const SweepOption *options, const SweepScene *scene, int outFd, int status, SweepRun *run);
+
+/**
+ * @brief   Scores the configurations from their runs and marks their Pareto front
+*/
+void sweepScore(const SweepOption *options, const SweepRun *runs, SweepScore *scores);
+
+
+/*===========================================================================*/
+/* Main					 										            */
+/*===========================================================================*/
+
+int main(int argc, char *argv[])
+{
+	SweepOption options;
+	SweepScene *scenes 		= NULL;
+	double *values 			= NULL;
+	SweepRun *runs 			= NULL;
+	SweepScore *scores 		= NULL;
+	pid_t *pids 				= NULL;		//of each job, 0 if it is free
+	int *outFds 				= NULL;
+	uint32_t *jobRuns 		= NULL;		//run of each job
+	FILE *runsFile 			= NULL;
+	const char *slash 		= strrchr(argv[0], '/');
+	double killerShare 		= DEFAULT_KILLER_SHARE;
+	double noiseRms 			= DEFAULT_NOISE_RMS;
+	uint32_t nbRuns 			= 0;
+	uint32_t nextRun 		= 0;
+	uint32_t nbRunning 		= 0;
+	uint32_t nbFailed 		= 0;
+	uint32_t nbPareto 		= 0;
+	struct timespec wallStart, wallEnd;
+	int option 				= 0;
+
+	memset(&options, 0, sizeof(options));
+	options.nbConfigs = DEFAULT_CONFIGS;
+	options.nbScenes = DEFAULT_SCENES;
+	options.nbJobs = sysconf(_SC_NPROCESSORS_ONLN);
+	options.limitS = DEFAULT_LIMIT_S;
+	options.gapMm = DEFAULT_GAP_MM;
+	options.propMode = true;
+	snprintf(options.simulator, sizeof(options.simulator), "%.*s%s",
+			(slash != NULL) ? (int) (slash - argv[0] + 1) : 0, argv[0], SIMULATOR_NAME);
+
+	while((option = getopt(argc, argv, "c:r:j:e:t:w:n:g:m:p:o:x:")) != -1){
+		switch(option){
+		case 'c':
+			options.nbConfigs = (uint32_t) strtoul(optarg, NULL, 0);
+			break;
+		case 'r':
+			options.nbScenes = (uint32_t) strtoul(optarg, NULL, 0);
+			break;
+		case 'j':
+			options.nbJobs = atol(optarg);
+			break;
+		case 'e':
+			randomState = strtoull(optarg, NULL, 0);
+			break;
+		case 't':
+			options.limitS = atof(optarg);
+			break;
+		case 'w':
+			killerShare = atof(optarg);
+			break;
+		case 'n':
+			noiseRms = atof(optarg);
+			break;
+		case 'g':
+			options.gapMm = atof(optarg);
+			break;
+		case 'm':
+			if(strcmp(optarg, "prop") != 0 && strcmp(optarg, "pid") != 0){
+				fprintf(stderr, USAGE, argv[0]);
+				return EXIT_FAILURE;
+			}
+			options.propMode = (strcmp(optarg, "prop") == 0);
+			break;
+		case 'p':
+			if(!sweepParseRange(optarg)){
+				fprintf(stderr, "%s: unknown parameter or bad range\n", optarg);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'o':
+			runsFile = fopen(optarg, "w");
+			if(runsFile == NULL){
+				perror(optarg);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'x':
+			snprintf(options.simulator, sizeof(options.simulator), "%s", optarg);
+			break;
+		default:
+			fprintf(stderr, USAGE, argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if(optind != argc || options.nbConfigs == 0 || options.nbScenes == 0 || options.limitS <= 0){
+		fprintf(stderr, USAGE, argv[0]);
+		return EXIT_FAILURE;
+	}
+	if(access(options.simulator, X_OK) != 0){
+		fprintf(stderr, "%s: not found, give it with -x\n", options.simulator);
+		return EXIT_FAILURE;
+	}
+	if(options.nbJobs < 1){
+		options.nbJobs = 1;
+	}
+
+	nbRuns = options.nbConfigs*options.nbScenes;
+	scenes = calloc(options.nbScenes, sizeof(SweepScene));
+	values = calloc(options.nbConfigs*NB_PARAMS, sizeof(double));
+	runs = calloc(nbRuns, sizeof(SweepRun));
+	scores = calloc(options.nbConfigs, sizeof(SweepScore));
+	pids = calloc((size_t) options.nbJobs, sizeof(pid_t));
+	outFds = calloc((size_t) options.nbJobs, sizeof(int));
+	jobRuns = calloc((size_t) options.nbJobs, sizeof(uint32_t));
+	if(scenes == NULL || values == NULL || runs == NULL || scores == NULL || pids == NULL || outFds == NULL
+			|| jobRuns == NULL){
+		fprintf(stderr, "out of memory\n");
+		return EXIT_FAILURE;
+	}
+
+	//The scenes, then the parameters, are drawn first: the same seed always gives the same sweep
+	for(uint32_t scene_counter = 0; scene_counter < options.nbScenes; scene_counter++){
+		sweepDrawScene(&scenes[scene_counter], killerShare, noiseRms);
+	}
+	for(uint32_t config_counter = 0; config_counter < options.nbConfigs; config_counter++){
+		for(uint8_t param_counter = 0; param_counter < NB_PARAMS; param_counter++){
+			const SweepParam *param 		= &params[param_counter];
+			double value 				= param->min + (param->max - param->min)*sweepRandom();
+
+			if(config_counter == 0){
+				value = param->firmwareValue;
+			}
+			values[config_counter*NB_PARAMS + param_counter] = param->integer ? round(value) : value;
+		}
+	}
+
+	/* Runs are started as long as a job is free, and read once they ended: the output of penguin_sim is
+	 * less than OUTPUT_SIZE, it waits in the pipe without blocking the process */
+	clock_gettime(CLOCK_MONOTONIC, &wallStart);
+	while(nextRun < nbRuns || nbRunning > 0){
+		int status 			= 0;
+		pid_t pid 			= 0;
+
+		while(nextRun < nbRuns && nbRunning < options.nbJobs){
+			uint32_t config 	= nextRun/options.nbScenes;
+			uint32_t scene 	= nextRun%options.nbScenes;
+			int outFd 		= -1;
+
+			pid = sweepStart(&options, &values[config*NB_PARAMS], &scenes[scene], &outFd);
+			if(pid < 0){
+				perror(options.simulator);
+				return EXIT_FAILURE;
+			}
+			for(long job_counter = 0; job_counter < options.nbJobs; job_counter++){
+				if(pids[job_counter] == 0){
+					pids[job_counter] = pid;
+					outFds[job_counter] = outFd;
+					jobRuns[job_counter] = nextRun;
+					break;
+				}
+			}
+			nextRun++;
+			nbRunning++;
+		}
+
+		pid = wait(&status);
+		if(pid < 0){
+			if(errno == EINTR){
+				continue;
+			}
+			perror("wait");
+			return EXIT_FAILURE;
+		}
+		for(long job_counter = 0; job_counter < options.nbJobs; job_counter++){
+			SweepRun *run 			= &runs[jobRuns[job_counter]];
+
+			if(pids[job_counter] != pid){
+				continue;
+			}
+			sweepRead(&options, &scenes[jobRuns[job_counter]%options.nbScenes], outFds[job_counter], status, run);
+			if(run->exitCode != SIM_EXIT_REACHED && run->exitCode != SIM_EXIT_NOT_REACHED){
+				nbFailed++;
+			}
+			close(outFds[job_counter]);
+			pids[job_counter] = 0;
+			nbRunning--;
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &wallEnd);
+
+	sweepScore(&options, runs, scores);
+
+	printf("config");
+	for(uint8_t param_counter = 0; param_counter < NB_PARAMS; param_counter++){
+		printf(",%s", params[param_counter].name);
+	}
+	printf(",accuracy,pipeline_ms_per_s,time_to_target_s,pareto\n");
+	for(uint32_t config_counter = 0; config_counter < options.nbConfigs; config_counter++){
+		printf("%u", config_counter);
+		for(uint8_t param_counter = 0; param_counter < NB_PARAMS; param_counter++){
+			printf(",%g", values[config_counter*NB_PARAMS + param_counter]);
+		}
+		printf(",%.3f,%.3f,%.3f,%d\n", scores[config_counter].accuracy, scores[config_counter].pipelineMsPerS,
+				scores[config_counter].timeToTargetS, scores[config_counter].pareto);
+		nbPareto += scores[config_counter].pareto;
+	}
+
+	if(runsFile != NULL){
+		fprintf(runsFile, "config,scene,exit,correct,time_to_target_s,target_hz,target_gap_mm,collisions,"
+				"killer_detect_s,killer_escape_s,pipeline_ms_per_s\n");
+		for(uint32_t run_counter = 0; run_counter < nbRuns; run_counter++){
+			const SweepRun *run 		= &runs[run_counter];
+
+			fprintf(runsFile, "%u,%u,%d,%d,%.3f,%.0f,%.1f,%.0f,%.3f,%.3f,%.3f\n", run_counter/options.nbScenes,
+					run_counter%options.nbScenes, run->exitCode, run->correct, run->timeToTargetS, run->targetHz,
+					run->targetGapMm, run->collisions, run->killerDetectS, run->killerEscapeS, run->pipelineMsPerS);
+		}
+		fclose(runsFile);
+	}
+
+	fprintf(stderr, "runs %u on %ld jobs in %.1f s, failed %u, pareto front %u of %u configurations\n", nbRuns,
+			options.nbJobs, (double) (wallEnd.tv_sec - wallStart.tv_sec) + (wallEnd.tv_nsec - wallStart.tv_nsec)/1e9,
+			nbFailed, nbPareto, options.nbConfigs);
+	return (nbFailed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+/*===========================================================================*/
+/* Private functions	 code												   */
+/*===========================================================================*/
+
+double sweepRandom(void)
+{
+	uint64_t value 			= (randomState += 0x9E3779B97F4A7C15ULL);
+
+	value = (value ^ (value >> 30))*0xBF58476D1CE4E5B9ULL;
+	value = (value ^ (value >> 27))*0x94D049BB133111EBULL;
+	value ^= value >> 31;
+	return (double) (value >> 11)/(double) (1ULL << 53);
+}
+
+bool sweepParseRange(const char *option)
+{
+	const char *equal 		= strchr(option, '=');
+	double min 				= 0;
+	double max 				= 0;
+	int nbValues 			= 0;
+
+	if(equal == NULL){
+		return false;
+	}
+	nbValues = sscanf(equal + 1, "%lf:%lf", &min, &max);
+	if(nbValues < 1){
+		return false;
+	}
+	if(nbValues == 1){
+		max = min;
+	}
+
+	for(uint8_t param_counter = 0; param_counter < NB_PARAMS; param_counter++){
+		if(strlen(params[param_counter].name) == (size_t) (equal - option)
+				&& strncmp(params[param_counter].name, option, (size_t) (equal - option)) == 0){
+			params[param_counter].min = fmin(min, max);
+			params[param_counter].max = fmax(min, max);
+			return true;
+		}
+	}
+	return false;
+}
+
+void sweepDrawScene(SweepScene *scene, double killerShare, double noiseRms)
+{
+	static const double freqsHz[NB_PENGUIN_FREQS] = PENGUIN_FREQS_HZ;
+	double bearingsDeg[NB_PENGUINS_MAX];
+	bool freqUsed[NB_PENGUIN_FREQS] 	= {false};
+	uint8_t nbWanted 				= 1 + (uint8_t) (sweepRandom()*NB_PENGUINS_MAX);
+
+	memset(scene, 0, sizeof(SweepScene));
+	scene->seed = 1 + (uint64_t) (sweepRandom()*UINT32_MAX);
+	scene->noiseRms = noiseRms*sweepRandom();
+
+	for(uint8_t penguin_counter = 0; penguin_counter < nbWanted; penguin_counter++){
+		uint8_t freq 				= (uint8_t) (sweepRandom()*NB_PENGUIN_FREQS);
+		double bearingDeg 			= 0;
+		double distanceMm 			= 0;
+		bool separated 				= false;
+
+		for(uint8_t draw_counter = 0; draw_counter < DRAWS_MAX && !separated; draw_counter++){
+			bearingDeg = (2*sweepRandom() - 1)*PENGUIN_BEARING_MAX_DEG;
+			separated = true;
+			for(uint8_t other_counter = 0; other_counter < scene->nbPenguins; other_counter++){
+				separated = separated && fabs(bearingDeg - bearingsDeg[other_counter]) >= PENGUIN_BEARING_GAP_DEG
+						&& fabs(fabs(bearingDeg) - fabs(bearingsDeg[other_counter])) >= PENGUIN_BEARING_GAP_DEG;
+			}
+		}
+		if(!separated){
+			continue;
+		}
+		while(freqUsed[freq]){
+			freq = (uint8_t) ((freq + 1)%NB_PENGUIN_FREQS);
+		}
+		freqUsed[freq] = true;
+
+		//Bearings are positive to the right of the robot, y is to its left
+		distanceMm = PENGUIN_DISTANCE_MIN_MM + (PENGUIN_DISTANCE_MAX_MM - PENGUIN_DISTANCE_MIN_MM)*sweepRandom();
+		bearingsDeg[scene->nbPenguins] = bearingDeg;
+		scene->freqHz[scene->nbPenguins] = freqsHz[freq];
+		scene->xMm[scene->nbPenguins] = distanceMm*cos(bearingDeg/DEG_PER_RAD);
+		scene->yMm[scene->nbPenguins] = -distanceMm*sin(bearingDeg/DEG_PER_RAD);
+		if(fabs(bearingDeg) < fabs(bearingsDeg[scene->expected])){
+			scene->expected = scene->nbPenguins;
+		}
+		scene->nbPenguins++;
+	}
+
+	if(sweepRandom() < killerShare){
+		double bearingRad 			= 2*M_PI*sweepRandom();
+		double distanceMm 			= KILLER_DISTANCE_MIN_MM + (KILLER_DISTANCE_MAX_MM - KILLER_DISTANCE_MIN_MM)*sweepRandom();
+
+		scene->killer = true;
+		scene->killerXMm = distanceMm*cos(bearingRad);
+		scene->killerYMm = distanceMm*sin(bearingRad);
+		scene->killerOnsetS = KILLER_ONSET_MIN_S + (KILLER_ONSET_MAX_S - KILLER_ONSET_MIN_S)*sweepRandom();
+	}
+}
+
+pid_t sweepStart(const SweepOption *options, const double *values, const SweepScene *scene, int *outFd)
+{
+	int pipeFds[2];
+	pid_t pid 				= 0;
+
+	if(pipe(pipeFds) != 0){
+		return -1;
+	}
+	fflush(NULL);
+	pid = fork();
+	if(pid != 0){
+		close(pipeFds[1]);
+		*outFd = pipeFds[0];
+		if(pid < 0){
+			close(pipeFds[0]);
+		}
+		return pid;
+	}
+
+	//Child: the arguments only live until execv
+	static char strings[ARGS_MAX][COMMAND_SIZE];
+	char *args[ARGS_MAX + 1];
+	uint8_t nbArgs 			= 0;
+
+#define SWEEP_ARG(...)		snprintf(strings[nbArgs], COMMAND_SIZE, __VA_ARGS__), args[nbArgs] = strings[nbArgs], nbArgs++
+	args[nbArgs++] = (char *) options->simulator;
+	SWEEP_ARG("-t");
+	SWEEP_ARG("%g", options->limitS);
+	SWEEP_ARG("-e");
+	SWEEP_ARG("%llu", (unsigned long long) scene->seed);
+	SWEEP_ARG("-n");
+	SWEEP_ARG("%g", scene->noiseRms);
+	SWEEP_ARG("-a");
+	SWEEP_ARG("%g", ARENA_HALF_MM);
+	for(uint8_t penguin_counter = 0; penguin_counter < scene->nbPenguins; penguin_counter++){
+		SWEEP_ARG("-s");
+		SWEEP_ARG("%g,%.0f,%.0f", scene->freqHz[penguin_counter], scene->xMm[penguin_counter], scene->yMm[penguin_counter]);
+	}
+	if(scene->killer){
+		SWEEP_ARG("-k");
+		SWEEP_ARG("%.0f,%.0f,%.2f", scene->killerXMm, scene->killerYMm, scene->killerOnsetS);
+	}
+	SWEEP_ARG("-c");
+	SWEEP_ARG("set audio %g %g %g %.3f", values[0], values[1], values[2], values[3]);
+	if(options->propMode){
+		SWEEP_ARG("-c");
+		SWEEP_ARG("set mode prop");
+		SWEEP_ARG("-c");
+		SWEEP_ARG("set prop %g %.3f", values[NB_AUDIO_PARAMS], values[NB_AUDIO_PARAMS + 1]);
+	}
+	SWEEP_ARG("-c");
+	SWEEP_ARG("mission nearest");
+#undef SWEEP_ARG
+	args[nbArgs] = NULL;
+
+	close(pipeFds[0]);
+	dup2(pipeFds[1], STDOUT_FILENO);
+	close(pipeFds[1]);
+	execv(options->simulator, args);
+	_exit(127);
+}
+
+void sweepRead(const SweepOption *options, const SweepScene *scene, int outFd, int status, SweepRun *run)
+{
+	char output[OUTPUT_SIZE];
+	size_t length 			= 0;
+	ssize_t nbRead 			= 0;
+	char *line 				= NULL;
+
+	memset(run, 0, sizeof(SweepRun));
+	run->exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+	run->timeToTargetS = NO_TIME;
+	run->killerDetectS = NO_TIME;
+	run->killerEscapeS = NO_TIME;
+
+	while(length < sizeof(output) - 1 && (nbRead = read(outFd, output + length, sizeof(output) - 1 - length)) > 0){
+		length += (size_t) nbRead;
+	}
+	output[length] = '\0';
+
+	for(line = strtok(output, "\n"); line != NULL; line = strtok(NULL, "\n")){
+		char name[COMMAND_SIZE];
+		double value 			= 0;
+
+		if(sscanf(line, "%63s %lf", name, &value) != 2){
+			continue;
+		}
+		if(strcmp(name, "time_to_target_s") == 0){
+			run->timeToTargetS = value;
+		}
+		else if(strcmp(name, "target_hz") == 0){
+			run->targetHz = value;
+		}
+		else if(strcmp(name, "target_gap_mm") == 0){
+			run->targetGapMm = value;
+		}
+		else if(strcmp(name, "collisions") == 0){
+			run->collisions = value;
+		}
+		else if(strcmp(name, "killer_detect_s") == 0){
+			run->killerDetectS = value;
+		}
+		else if(strcmp(name, "killer_escape_s") == 0){
+			run->killerEscapeS = value;
+		}
+		else if(strcmp(name, "pipeline_ms_per_s") == 0){
+			run->pipelineMsPerS = value;
+		}
+	}
+
+	//penguin_sim already checked the arrival and the escape, the penguin reached is checked here
+	run->correct = run->exitCode == SIM_EXIT_REACHED && scene->nbPenguins > 0
+			&& run->targetHz == scene->freqHz[scene->expected] && run->targetGapMm <= options->gapMm;
+}
+
+void sweepScore(const SweepOption *options, const SweepRun *runs, SweepScore *scores)
+{
+	for(uint32_t config_counter = 0; config_counter < options->nbConfigs; config_counter++){
+		SweepScore *score 		= &scores[config_counter];
+
+		memset(score, 0, sizeof(SweepScore));
+		for(uint32_t scene_counter = 0; scene_counter < options->nbScenes; scene_counter++){
+			const SweepRun *run 	= &runs[config_counter*options->nbScenes + scene_counter];
+
+			score->accuracy += run->correct;
+			score->pipelineMsPerS += run->pipelineMsPerS;
+			score->timeToTargetS += (run->timeToTargetS != NO_TIME) ? run->timeToTargetS : options->limitS;
+		}
+		score->accuracy /= options->nbScenes;
+		score->pipelineMsPerS /= options->nbScenes;
+		score->timeToTargetS /= options->nbScenes;
+	}
+
+	//A configuration is on the front if no other one is as good on all the measures and better on one
+	for(uint32_t config_counter = 0; config_counter < options->nbConfigs; config_counter++){
+		const SweepScore *score 	= &scores[config_counter];
+
+		scores[config_counter].pareto = true;
+		for(uint32_t other_counter = 0; other_counter < options->nbConfigs; other_counter++){
+			const SweepScore *other 	= &scores[other_counter];
+
+			if(other->accuracy >= score->accuracy && other->pipelineMsPerS <= score->pipelineMsPerS
+					&& other->timeToTargetS <= score->timeToTargetS
+					&& (other->accuracy > score->accuracy || other->pipelineMsPerS < score->pipelineMsPerS
+							|| other->timeToTargetS < score->timeToTargetS)){
+				scores[config_counter].pareto = false;
+				break;
+			}
+		}
+	}
+}
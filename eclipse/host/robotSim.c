@@ -0,0 +1,239 @@
+/*
+ * robotSim.c
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Simulated world of the e-puck2, see robotSim.h. The distance sensors are rays cast from the
+ * 		edge of the robot to the round obstacles and the walls.
+ *
+ * Functions prefix for public functions in this file: sim_
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <robotSim.h>
+
+
+/*===========================================================================*/
+/* Constants definition for this file						               */
+/*===========================================================================*/
+
+#define DEG_PER_RAD							(180.0/M_PI)
+#define MM_PER_STEP							(SIM__WHEEL_PERIMETER_MM/SIM__STEPS_PER_TURN)
+#define STRAIGHT_RAD_PER_S					1e-9		//slower turns are driven as straight lines
+#define NB_TOF_RAYS							3			//edges and centre of the cone
+
+
+/*===========================================================================*/
+/* Private functions definitions                                             */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the smallest gap between the robot at a position and the obstacles or walls, negative if it
+ * 			overlaps one of them
+*/
+double simClearanceMm(const SimWorld *world, double xMm, double yMm);
+
+/**
+ * @brief   Returns the distance along a ray to the first obstacle or wall, INFINITY if there is none
+ *
+ *  @param[in] angleRad		direction of the ray in the world
+*/
+double simRayMm(const SimWorld *world, double xMm, double yMm, double angleRad);
+
+/**
+ * @brief   Returns the distance seen by a sensor on the edge of the robot, at a bearing of the robot
+ *
+ *  @param[in] bearingDeg		positive to the right of the robot
+*/
+double simSensorRayMm(const SimWorld *world, double bearingDeg);
+
+
+/*===========================================================================*/
+/* Public functions              											*/
+/*===========================================================================*/
+
+void sim_init(SimWorld *world, uint64_t seed)
+{
+	memset(world, 0, sizeof(SimWorld));
+	scene_init(&world->scene, seed);
+}
+
+bool sim_addObstacle(SimWorld *world, double xMm, double yMm, double radiusMm)
+{
+	if(world->nbObstacles >= SIM__NB_OBSTACLES_MAX){
+		return false;
+	}
+	world->obstacles[world->nbObstacles].xMm = xMm;
+	world->obstacles[world->nbObstacles].yMm = yMm;
+	world->obstacles[world->nbObstacles].radiusMm = radiusMm;
+	world->nbObstacles++;
+	return true;
+}
+
+int8_t sim_addSource(SimWorld *world, double freqHz, double xMm, double yMm, double amplitude, bool penguin)
+{
+	int8_t source 			= -1;
+
+	if(penguin && world->nbObstacles >= SIM__NB_OBSTACLES_MAX){
+		return -1;
+	}
+	source = scene_addSource(&world->scene, freqHz, xMm, yMm, amplitude);
+	if(source < 0){
+		return -1;
+	}
+
+	world->sourceObstacle[source] = -1;
+	if(penguin){
+		world->sourceObstacle[source] = (int8_t) world->nbObstacles;
+		sim_addObstacle(world, xMm, yMm, SIM__SOURCE_RADIUS_MM);
+	}
+	return source;
+}
+
+void sim_setArena(SimWorld *world, double halfSizeMm)
+{
+	world->arenaHalfMm = halfSizeMm;
+}
+
+void sim_step(SimWorld *world, int rightSps, int leftSps, double durationS)
+{
+	Scene *scene 			= &world->scene;
+	double rightMmps 		= rightSps*MM_PER_STEP;
+	double leftMmps 			= leftSps*MM_PER_STEP;
+	double speedMmps 		= (rightMmps + leftMmps)/2;
+	double turnRadps 		= (rightMmps - leftMmps)/SIM__WHEEL_DISTANCE_MM;	//positive to the left, as the world
+	double heading 			= scene->robotHeadingRad + turnRadps*durationS;
+	double xMm 				= scene->robotXMm;
+	double yMm 				= scene->robotYMm;
+
+	//Exact arc of circle, the speeds are constant during the step
+	if(fabs(turnRadps) < STRAIGHT_RAD_PER_S){
+		xMm += speedMmps*durationS*cos(scene->robotHeadingRad);
+		yMm += speedMmps*durationS*sin(scene->robotHeadingRad);
+	}
+	else{
+		xMm += speedMmps/turnRadps*(sin(heading) - sin(scene->robotHeadingRad));
+		yMm -= speedMmps/turnRadps*(cos(heading) - cos(scene->robotHeadingRad));
+	}
+
+	//A move out of an overlap is allowed, so a robot placed against an obstacle can still leave
+	double clearance 		= simClearanceMm(world, xMm, yMm);
+
+	if(clearance < 0 && clearance < simClearanceMm(world, scene->robotXMm, scene->robotYMm)){
+		if(!world->colliding){
+			world->collisions++;
+		}
+		world->colliding = true;
+		xMm = scene->robotXMm;
+		yMm = scene->robotYMm;
+	}
+	else{
+		world->colliding = false;
+		world->pathMm += fabs(speedMmps)*durationS;
+	}
+
+	scene_setRobotPose(scene, xMm, yMm, remainder(heading, 2*M_PI)*DEG_PER_RAD);
+}
+
+uint16_t sim_getTofMm(const SimWorld *world)
+{
+	double distanceMm 		= INFINITY;
+
+	for(int8_t ray_counter = -1; ray_counter < NB_TOF_RAYS - 1; ray_counter++){
+		distanceMm = fmin(distanceMm, simSensorRayMm(world, ray_counter*SIM__TOF_HALF_FOV_DEG));
+	}
+	return (distanceMm < SIM__TOF_MAX_MM) ? (uint16_t) lround(distanceMm) : SIM__TOF_MAX_MM;
+}
+
+int sim_getProximity(const SimWorld *world, uint8_t sensor)
+{
+	static const double bearingDeg[SIM__NB_IR] = SIM__IR_BEARING_DEG;
+	double distanceMm 		= 0;
+
+	if(sensor >= SIM__NB_IR){
+		return 0;
+	}
+	distanceMm = simSensorRayMm(world, bearingDeg[sensor]);
+	if(distanceMm >= SIM__IR_RANGE_MM){
+		return 0;
+	}
+	return (int) lround(SIM__IR_CONTACT_VALUE*exp(-distanceMm/SIM__IR_DECAY_MM));
+}
+
+double sim_getSourceGapMm(const SimWorld *world, uint8_t source)
+{
+	double distanceMm 		= scene_getDistanceMm(&world->scene, source);
+
+	if(world->sourceObstacle[source] < 0){
+		return distanceMm;
+	}
+	return distanceMm - SIM__ROBOT_RADIUS_MM - world->obstacles[world->sourceObstacle[source]].radiusMm;
+}
+
+
+/*===========================================================================*/
+/* Private functions	 code												   */
+/*===========================================================================*/
+
+double simClearanceMm(const SimWorld *world, double xMm, double yMm)
+{
+	double clearance 		= INFINITY;
+
+	for(uint8_t obstacle_counter = 0; obstacle_counter < world->nbObstacles; obstacle_counter++){
+		const SimObstacle *obstacle 	= &world->obstacles[obstacle_counter];
+
+		clearance = fmin(clearance, hypot(obstacle->xMm - xMm, obstacle->yMm - yMm)
+				- obstacle->radiusMm - SIM__ROBOT_RADIUS_MM);
+	}
+	if(world->arenaHalfMm > 0){
+		clearance = fmin(clearance, world->arenaHalfMm - SIM__ROBOT_RADIUS_MM - fmax(fabs(xMm), fabs(yMm)));
+	}
+	return clearance;
+}
+
+double simRayMm(const SimWorld *world, double xMm, double yMm, double angleRad)
+{
+	double dirX 				= cos(angleRad);
+	double dirY 				= sin(angleRad);
+	double distanceMm 		= INFINITY;
+
+	for(uint8_t obstacle_counter = 0; obstacle_counter < world->nbObstacles; obstacle_counter++){
+		const SimObstacle *obstacle 	= &world->obstacles[obstacle_counter];
+		double toX 			= obstacle->xMm - xMm;
+		double toY 			= obstacle->yMm - yMm;
+		double along 		= toX*dirX + toY*dirY;
+		double across2 		= toX*toX + toY*toY - along*along;
+		double radius2 		= obstacle->radiusMm*obstacle->radiusMm;
+
+		if(toX*toX + toY*toY <= radius2){		//the sensor is inside the obstacle
+			return 0;
+		}
+		if(along > 0 && across2 < radius2){
+			distanceMm = fmin(distanceMm, along - sqrt(radius2 - across2));
+		}
+	}
+
+	//The sensor is inside the arena, the ray leaves it through one wall in x and one in y
+	if(world->arenaHalfMm > 0){
+		if(dirX != 0){
+			distanceMm = fmin(distanceMm, ((dirX > 0 ? world->arenaHalfMm : -world->arenaHalfMm) - xMm)/dirX);
+		}
+		if(dirY != 0){
+			distanceMm = fmin(distanceMm, ((dirY > 0 ? world->arenaHalfMm : -world->arenaHalfMm) - yMm)/dirY);
+		}
+	}
+	return fmax(distanceMm, 0);
+}
+
+double simSensorRayMm(const SimWorld *world, double bearingDeg)
+{
+	const Scene *scene 		= &world->scene;
+	double angleRad 			= scene->robotHeadingRad - bearingDeg/DEG_PER_RAD;
+
+	return simRayMm(world, scene->robotXMm + SIM__ROBOT_RADIUS_MM*cos(angleRad),
+			scene->robotYMm + SIM__ROBOT_RADIUS_MM*sin(angleRad), angleRad);
+}
@@ -0,0 +1,138 @@
+/*
+ * robotSim.h
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Simulated world of the e-puck2, for the firmware built for the host: the robot drives with the
+ * 		speeds of its two stepper motors (differential drive), its time of flight and infrared sensors see the
+ * 		obstacles around it, and its microphones hear the sources of a scene (sceneGen.h) from where it is.
+ * 		The frames are the ones of sceneGen.h: the world in mm, the robot pose kept in the scene, bearings in
+ * 		degrees positive to the right of the robot. The sources are penguins, small speakers which the distance
+ * 		sensors see as obstacles, or killer whales, only heard.
+ * Function prefix for public functions in this file: sim_
+ * Constant prefix for public constants in this file: SIM__
+ */
+#ifndef ROBOTSIM_H_
+#define ROBOTSIM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <sceneGen.h>
+
+/*===========================================================================*/
+/* Constants definition for this library						               */
+/*===========================================================================*/
+
+//Geometry of the e-puck2, the wheels as travelController.c
+#define SIM__ROBOT_RADIUS_MM					37.0
+#define SIM__WHEEL_DISTANCE_MM				53.5
+#define SIM__WHEEL_PERIMETER_MM				130.0
+#define SIM__STEPS_PER_TURN					1000.0
+
+//Distance sensors
+#define SIM__TOF_MAX_MM						2000			//SHIM__TOF_DEFAULT_MM, nothing seen
+#define SIM__TOF_HALF_FOV_DEG				12.5			//the time of flight sees a cone, not a line
+#define SIM__NB_IR							8
+#define SIM__IR_BEARING_DEG					{17, 49, 90, 150, -150, -90, -49, -17}	//as obstacleSensor.c
+#define SIM__IR_CONTACT_VALUE				3000.0		//calibrated value of an obstacle touching the sensor
+#define SIM__IR_DECAY_MM						10.0		//the value is divided by e every SIM__IR_DECAY_MM
+#define SIM__IR_RANGE_MM						80.0		//further obstacles give 0
+
+#define SIM__SOURCE_RADIUS_MM				20.0		//penguin speaker seen by the distance sensors
+#define SIM__KILLER_FREQ_HZ					1000.0		//KILLER_FREQ of audio_processing.c
+#define SIM__NB_OBSTACLES_MAX				16
+
+
+/*===========================================================================*/
+/* Structures						 			                            */
+/*===========================================================================*/
+
+/*
+ * Round obstacle, seen by the distance sensors
+ */
+typedef struct SimObstacles {
+	double xMm;
+	double yMm;
+	double radiusMm;
+} SimObstacle;
+
+/*
+ * Whole world, to be initialised with sim_init
+ */
+typedef struct SimWorlds {
+	Scene scene;						//sources and robot pose
+	SimObstacle obstacles[SIM__NB_OBSTACLES_MAX];
+	uint8_t nbObstacles;
+	int8_t sourceObstacle[SCENE__NB_SOURCES_MAX];	//obstacle of each source, -1 for a killer whale
+	double arenaHalfMm;					//square walls around (0,0), 0 for none
+	double pathMm;						//distance driven by the centre of the robot
+	uint32_t collisions;					//times the robot drove into an obstacle or a wall
+	bool colliding;
+} SimWorld;
+
+
+/*===========================================================================*/
+/* Public functions definitions            									 */
+/*===========================================================================*/
+
+/*
+ * @brief	Initialises an empty world without walls, the robot at (0,0) facing +x
+ *
+ *  @param[in] seed		of the noise of the microphones
+ */
+void sim_init(SimWorld *world, uint64_t seed);
+
+/*
+ * @brief	Adds a round obstacle
+ *
+ * @return	false if there are already SIM__NB_OBSTACLES_MAX obstacles
+ */
+bool sim_addObstacle(SimWorld *world, double xMm, double yMm, double radiusMm);
+
+/*
+ * @brief	Adds a source to the scene, a penguin is also an obstacle of SIM__SOURCE_RADIUS_MM
+ * @note 	As scene_addSource, the amplitude is the one heard from the pose of the robot at this time
+ *
+ * @return	index of the source in the scene, -1 if the scene or the obstacles are full
+ */
+int8_t sim_addSource(SimWorld *world, double freqHz, double xMm, double yMm, double amplitude, bool penguin);
+
+/*
+ * @brief	Surrounds the world with square walls
+ *
+ *  @param[in] halfSizeMm	the walls are at x and y = +-halfSizeMm, 0 for no walls
+ */
+void sim_setArena(SimWorld *world, double halfSizeMm);
+
+/*
+ * @brief	Moves the robot for a time at constant motor speeds, on an arc of circle
+ * @note 	The robot stops at an obstacle or a wall, only turning on the spot stays possible.
+ *
+ *  @param[in] rightSps, leftSps		speeds of the motors in steps/s, as given to right/left_motor_set_speed
+ *  @param[in] durationS				time at these speeds
+ */
+void sim_step(SimWorld *world, int rightSps, int leftSps, double durationS);
+
+/*
+ * @brief	Returns the distance measured by the time of flight sensor, in front of the robot
+ */
+uint16_t sim_getTofMm(const SimWorld *world);
+
+/*
+ * @brief	Returns the calibrated value of an infrared proximity sensor, as get_calibrated_prox
+ *
+ *  @param[in] sensor		0 to SIM__NB_IR-1, in the order of the e-puck2 library
+ */
+int sim_getProximity(const SimWorld *world, uint8_t sensor);
+
+/*
+ * @brief	Returns the distance between the surfaces of the robot and of a source, in mm
+ * @note 	The distance to the centre of the source for a killer whale
+ */
+double sim_getSourceGapMm(const SimWorld *world, uint8_t source);
+
+
+#endif /* ROBOTSIM_H_ */
@@ -0,0 +1,248 @@
+/*
+ * sceneGen.c
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Synthetic acoustic scene of the 4 microphones of the e-puck2, see sceneGen.h.
+ * 		The time of a sample is computed from its index since scene_init, so the sounds stay continuous
+ * 		from one block to the next whatever the block size.
+ *
+ * Functions prefix for public functions in this file: scene_
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <sceneGen.h>
+
+
+/*===========================================================================*/
+/* Constants definition for this file						               */
+/*===========================================================================*/
+
+#define MM_PER_M								1000.0
+#define MS_PER_S								1000.0
+#define DEG_PER_RAD							(180.0/M_PI)
+#define DISTANCE_MIN_MM						1.0			//a source on a microphone is not infinitely loud
+
+#define NOISE_MULTIPLIER						0x2545F4914F6CDD1DULL	//xorshift64* generator
+#define NOISE_SEED_DEFAULT					0x9E3779B97F4A7C15ULL	//xorshift needs a non zero state
+#define NOISE_BITS_SHIFT						11						//keeps the 53 bits of a double mantissa
+#define NOISE_BITS_SCALE						(1.0/9007199254740992.0)	//2^-53
+
+
+/*===========================================================================*/
+/* Private functions definitions                                             */
+/*===========================================================================*/
+
+/**
+ * @brief   Gives the position of a microphone in the world, in mm
+*/
+void sceneMicPosition(const Scene *scene, uint8_t mic, double *xMm, double *yMm);
+
+/**
+ * @brief   Returns the sound of the active sources at a point of the world, at a time of the scene
+ * @note 	Each echo is the direct sound delayed and attenuated
+*/
+double sceneSound(const Scene *scene, double xMm, double yMm, double timeS);
+
+/**
+ * @brief   Returns a uniform random number in ]0,1]
+*/
+double sceneUniform(Scene *scene);
+
+/**
+ * @brief   Returns a gaussian random number of rms 1, Box-Muller
+*/
+double sceneGaussian(Scene *scene);
+
+
+/*===========================================================================*/
+/* Public functions              											*/
+/*===========================================================================*/
+
+void scene_init(Scene *scene, uint64_t seed)
+{
+	memset(scene, 0, sizeof(Scene));
+	scene->samplingHz = SCENE__SAMPLING_HZ;
+	scene->micDistanceMm = SCENE__MIC_DISTANCE_MM;
+	scene->speedSoundMps = SCENE__SPEED_SOUND_MPS;
+	scene->noiseState = (seed != 0) ? seed : NOISE_SEED_DEFAULT;
+}
+
+int8_t scene_addSource(Scene *scene, double freqHz, double xMm, double yMm, double amplitude)
+{
+	if(scene->nbSources >= SCENE__NB_SOURCES_MAX){
+		return -1;
+	}
+
+	uint8_t index 			= scene->nbSources;
+	SceneSource *source 	= &scene->sources[index];
+
+	source->freqHz = freqHz;
+	source->xMm = xMm;
+	source->yMm = yMm;
+	source->amplitude = amplitude;
+	source->phaseRad = 0;
+	source->active = true;
+	scene->nbSources++;
+	source->refDistanceMm = scene_getDistanceMm(scene, index);
+	return (int8_t) index;
+}
+
+void scene_setSourceActive(Scene *scene, uint8_t source, bool active)
+{
+	if(source < scene->nbSources){
+		scene->sources[source].active = active;
+	}
+}
+
+bool scene_addTap(Scene *scene, double delayMs, double gain)
+{
+	if(scene->nbTaps >= SCENE__NB_TAPS_MAX){
+		return false;
+	}
+	scene->taps[scene->nbTaps].delayMs = delayMs;
+	scene->taps[scene->nbTaps].gain = gain;
+	scene->nbTaps++;
+	return true;
+}
+
+void scene_setNoise(Scene *scene, double noiseRms)
+{
+	scene->noiseRms = noiseRms;
+}
+
+void scene_setRobotPose(Scene *scene, double xMm, double yMm, double headingDeg)
+{
+	scene->robotXMm = xMm;
+	scene->robotYMm = yMm;
+	scene->robotHeadingRad = headingDeg/DEG_PER_RAD;
+}
+
+double scene_getBearingDeg(const Scene *scene, uint8_t source)
+{
+	const SceneSource *src 	= &scene->sources[source];
+	double bearing 			= scene->robotHeadingRad - atan2(src->yMm - scene->robotYMm, src->xMm - scene->robotXMm);
+
+	bearing = remainder(bearing, 2*M_PI);
+	if(bearing <= -M_PI){
+		bearing += 2*M_PI;
+	}
+	return bearing*DEG_PER_RAD;
+}
+
+double scene_getDistanceMm(const Scene *scene, uint8_t source)
+{
+	const SceneSource *src 	= &scene->sources[source];
+
+	return hypot(src->xMm - scene->robotXMm, src->yMm - scene->robotYMm);
+}
+
+void scene_fill(int16_t *samples, uint16_t nbFrames, void *context)
+{
+	Scene *scene 			= (Scene *) context;
+	double micX[SCENE__NB_MICS];
+	double micY[SCENE__NB_MICS];
+
+	for(uint8_t mic = 0; mic < SCENE__NB_MICS; mic++){
+		sceneMicPosition(scene, mic, &micX[mic], &micY[mic]);
+	}
+
+	for(uint16_t frame_counter = 0; frame_counter < nbFrames; frame_counter++){
+		double timeS 		= (double) (scene->frame + frame_counter)/scene->samplingHz;
+
+		for(uint8_t mic = 0; mic < SCENE__NB_MICS; mic++){
+			double value 	= sceneSound(scene, micX[mic], micY[mic], timeS);
+
+			if(scene->noiseRms > 0){
+				value += scene->noiseRms*sceneGaussian(scene);
+			}
+			value = round(value);
+			if(value > INT16_MAX){
+				value = INT16_MAX;
+				scene->clipped++;
+			}
+			else if(value < INT16_MIN){
+				value = INT16_MIN;
+				scene->clipped++;
+			}
+			samples[SCENE__NB_MICS*frame_counter + mic] = (int16_t) value;
+		}
+	}
+	scene->frame += nbFrames;
+}
+
+
+/*===========================================================================*/
+/* Private functions	 code												   */
+/*===========================================================================*/
+
+void sceneMicPosition(const Scene *scene, uint8_t mic, double *xMm, double *yMm)
+{
+	double half 			= scene->micDistanceMm/2;
+	double forward 		= 0;
+	double left 			= 0;
+
+	switch(mic){
+	case SCENE__MIC_RIGHT:
+		left = -half;
+		break;
+	case SCENE__MIC_LEFT:
+		left = half;
+		break;
+	case SCENE__MIC_BACK:
+		forward = -half;
+		break;
+	default:
+		forward = half;
+		break;
+	}
+
+	*xMm = scene->robotXMm + forward*cos(scene->robotHeadingRad) - left*sin(scene->robotHeadingRad);
+	*yMm = scene->robotYMm + forward*sin(scene->robotHeadingRad) + left*cos(scene->robotHeadingRad);
+}
+
+double sceneSound(const Scene *scene, double xMm, double yMm, double timeS)
+{
+	double sound 			= 0;
+
+	for(uint8_t source_counter = 0; source_counter < scene->nbSources; source_counter++){
+		const SceneSource *src 	= &scene->sources[source_counter];
+
+		if(!src->active){
+			continue;
+		}
+
+		double distanceMm 	= fmax(hypot(src->xMm - xMm, src->yMm - yMm), DISTANCE_MIN_MM);
+		double ampli 		= src->amplitude*fmax(src->refDistanceMm, DISTANCE_MIN_MM)/distanceMm;
+		double arrivalS 	= timeS - distanceMm/(MM_PER_M*scene->speedSoundMps);
+
+		sound += ampli*sin(2*M_PI*src->freqHz*arrivalS + src->phaseRad);
+		for(uint8_t tap_counter = 0; tap_counter < scene->nbTaps; tap_counter++){
+			double echoS 	= arrivalS - scene->taps[tap_counter].delayMs/MS_PER_S;
+
+			sound += scene->taps[tap_counter].gain*ampli*sin(2*M_PI*src->freqHz*echoS + src->phaseRad);
+		}
+	}
+	return sound;
+}
+
+double sceneUniform(Scene *scene)
+{
+	scene->noiseState ^= scene->noiseState >> 12;
+	scene->noiseState ^= scene->noiseState << 25;
+	scene->noiseState ^= scene->noiseState >> 27;
+
+	//+1 to never return 0, the logarithm of sceneGaussian needs it
+	return ((double) ((scene->noiseState*NOISE_MULTIPLIER) >> NOISE_BITS_SHIFT) + 1.0)*NOISE_BITS_SCALE;
+}
+
+double sceneGaussian(Scene *scene)
+{
+	double radius 			= sqrt(-2*log(sceneUniform(scene)));
+
+	return radius*cos(2*M_PI*sceneUniform(scene));
+}
@@ -0,0 +1,159 @@
+/*
+ * sceneGen.h
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Synthetic acoustic scene heard by the 4 microphones of the e-puck2, as repeatable input for the
+ * 		audio pipeline. Mono-frequency sources (penguins) are placed in the world, each microphone hears them with
+ * 		the delay and the 1/distance attenuation of its own position, plus optional echoes and white noise.
+ * 		The samples are generated as mic_start delivers them: int16, interleaved right, left, back, front.
+ *
+ * 		Frames: the world is in mm, x and y. The robot has a pose in it, by default at (0,0) facing +x.
+ * 		In the robot frame x points forward and y to the left, the microphones are at EPUCK_MIC_DISTANCE of
+ * 		each other: front (+d/2,0), back (-d/2,0), left (0,+d/2), right (0,-d/2). Bearings are in degrees as the
+ * 		angles of audio_processing.c: 0 in front of the robot and positive to its right.
+ * Function prefix for public functions in this file: scene_
+ * Constant prefix for public constants in this file: SCENE__
+ */
+#ifndef SCENEGEN_H_
+#define SCENEGEN_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*===========================================================================*/
+/* Constants definition for this library						               */
+/*===========================================================================*/
+
+#define SCENE__NB_MICS						4
+#define SCENE__MIC_RIGHT						0			//order of the samples of a frame, as mic_start
+#define SCENE__MIC_LEFT						1
+#define SCENE__MIC_BACK						2
+#define SCENE__MIC_FRONT						3
+
+#define SCENE__SAMPLING_HZ					16000
+#define SCENE__BLOCK_FRAMES					160			//frames of a mic_start callback
+#define SCENE__MIC_DISTANCE_MM				60.0		//EPUCK_MIC_DISTANCE of audio_processing.c
+#define SCENE__SPEED_SOUND_MPS				343.0		//SPEED_SOUND of audio_processing.c
+
+#define SCENE__NB_SOURCES_MAX				8
+#define SCENE__NB_TAPS_MAX					8
+
+
+/*===========================================================================*/
+/* Structures						 			                            */
+/*===========================================================================*/
+
+/*
+ * Mono-frequency source, its amplitude is the one heard at the centre of the robot at startup
+ */
+typedef struct SceneSources {
+	double freqHz;
+	double xMm;
+	double yMm;
+	double amplitude;					//in LSB of the samples
+	double refDistanceMm;				//distance at which amplitude is heard
+	double phaseRad;
+	bool active;
+} SceneSource;
+
+/*
+ * Echo: a copy of all the sources, delayed and attenuated
+ */
+typedef struct SceneTaps {
+	double delayMs;
+	double gain;
+} SceneTap;
+
+/*
+ * Whole scene, to be initialised with scene_init
+ */
+typedef struct Scenes {
+	uint32_t samplingHz;
+	double micDistanceMm;
+	double speedSoundMps;
+	SceneSource sources[SCENE__NB_SOURCES_MAX];
+	uint8_t nbSources;
+	SceneTap taps[SCENE__NB_TAPS_MAX];
+	uint8_t nbTaps;
+	double noiseRms;					//white noise of each microphone, in LSB
+	uint64_t noiseState;
+	double robotXMm;
+	double robotYMm;
+	double robotHeadingRad;
+	uint64_t frame;						//frames generated since scene_init
+	uint32_t clipped;					//samples which did not fit in int16
+} Scene;
+
+
+/*===========================================================================*/
+/* Public functions definitions            									 */
+/*===========================================================================*/
+
+/*
+ * @brief	Empty scene: no source, no echo, no noise, the robot at (0,0) facing +x
+ *
+ *  @param[in] seed			seed of the noise, the same seed gives the same samples
+ */
+void scene_init(Scene *scene, uint64_t seed);
+
+/*
+ * @brief	Adds a source
+ *
+ *  @param[in] freqHz		frequency of the sound
+ *  @param[in] xMm, yMm		position in the world
+ *  @param[in] amplitude	amplitude heard at the centre of the robot, in LSB
+ *
+ * @return	index of the source, -1 if there are already SCENE__NB_SOURCES_MAX sources
+ */
+int8_t scene_addSource(Scene *scene, double freqHz, double xMm, double yMm, double amplitude);
+
+/*
+ * @brief	Switches a source on or off, to make a penguin stop crying
+ */
+void scene_setSourceActive(Scene *scene, uint8_t source, bool active);
+
+/*
+ * @brief	Adds an echo of all the sources
+ *
+ * @return	false if there are already SCENE__NB_TAPS_MAX echoes
+ */
+bool scene_addTap(Scene *scene, double delayMs, double gain);
+
+/*
+ * @brief	Sets the rms of the white noise of each microphone, in LSB
+ */
+void scene_setNoise(Scene *scene, double noiseRms);
+
+/*
+ * @brief	Moves the robot, the time of the scene goes on
+ *
+ *  @param[in] headingDeg	direction of the front of the robot, counterclockwise from +x
+ */
+void scene_setRobotPose(Scene *scene, double xMm, double yMm, double headingDeg);
+
+/*
+ * @brief	Returns the bearing of a source from the robot, in degrees in ]-180,180]
+ */
+double scene_getBearingDeg(const Scene *scene, uint8_t source);
+
+/*
+ * @brief	Returns the distance of a source from the centre of the robot, in mm
+ */
+double scene_getDistanceMm(const Scene *scene, uint8_t source);
+
+/*
+ * @brief	Generates the next samples of the microphones
+ * @note 	Has the signature of shim_micSource: shim_setMicSource(scene_fill, &scene) makes the microphones of the
+ * 			host build hear the scene, audio_processAudioData then gets it as from mic_start
+ *
+ *  @param[out] samples		SCENE__NB_MICS*nbFrames samples, interleaved right, left, back, front
+ *  @param[in] nbFrames		samples of each microphone
+ *  @param[in] context		the Scene
+ */
+void scene_fill(int16_t *samples, uint16_t nbFrames, void *context);
+
+
+#endif /* SCENEGEN_H_ */
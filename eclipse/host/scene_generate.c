@@ -0,0 +1,197 @@
+/*
+ * scene_generate.c
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Command line tool that writes the samples of a synthetic acoustic scene (sceneGen.h), as mic_start
+ * 		delivers them: blocks of SCENE__BLOCK_FRAMES frames of 4 int16 in the byte order of the host, interleaved
+ * 		right, left, back, front. The bearing and distance of each source are printed on stderr.
+ *
+ * 		usage: scene_generate [-d seconds] [-s freq,x,y[,ampli]]... [-n rms] [-r delay,gain]... [-p x,y,heading]
+ * 				[-m mic distance] [-f sampling] [-e seed] [-o file | -c capture]
+ * 			-d seconds			length of the scene (default 1)
+ * 			-s freq,x,y,ampli	source in Hz at (x,y) mm, heard with ampli LSB by the robot (default 2000)
+ * 			-n rms				white noise of each microphone, in LSB (default 0)
+ * 			-r delay,gain		echo of all the sources after delay ms
+ * 			-p x,y,heading		pose of the robot in mm and degrees (default 0,0,0: facing +x)
+ * 			-m mic distance		distance between two opposite microphones in mm (default 60)
+ * 			-f sampling			sampling frequency in Hz (default 16000)
+ * 			-e seed				seed of the noise (default 1)
+ * 			-o file				output file (default stdout)
+ * 			-c capture			writes a capture file (captureFile.h) for capture_replay instead of the raw blocks
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sceneGen.h>
+#include <captureFile.h>
+
+
+/*===========================================================================*/
+/* Constants definition for this file						               */
+/*===========================================================================*/
+
+#define DEFAULT_SECONDS						1.0
+#define DEFAULT_AMPLITUDE					2000.0
+#define DEFAULT_SEED							1
+
+#define USAGE								"usage: %s [-d seconds] [-s freq,x,y[,ampli]]... [-n rms] [-r delay,gain]... " \
+											"[-p x,y,heading] [-m mic distance] [-f sampling] [-e seed] [-o file | -c capture]\n"
+
+
+/*===========================================================================*/
+/* Main					 										            */
+/*===========================================================================*/
+
+int main(int argc, char *argv[])
+{
+	static Scene scene;
+	static CapFile capture;
+	CapFileHeader captureHeader;
+	int16_t block[SCENE__NB_MICS*SCENE__BLOCK_FRAMES];
+	double seconds 			= DEFAULT_SECONDS;
+	double values[4] 		= {0};
+	double noiseRms 			= 0;
+	double pose[3] 			= {0};
+	double micDistanceMm 	= SCENE__MIC_DISTANCE_MM;
+	uint32_t samplingHz 		= SCENE__SAMPLING_HZ;
+	uint64_t seed 			= DEFAULT_SEED;
+	const char *outputPath 	= NULL;
+	const char *capturePath 	= NULL;
+	FILE *output 			= stdout;
+	int option 				= 0;
+	int nbValues 			= 0;
+
+	//the sources are added once the geometry is known, their options are parsed twice
+	while((option = getopt(argc, argv, "d:s:n:r:p:m:f:e:o:c:")) != -1){
+		switch(option){
+		case 'd':
+			seconds = atof(optarg);
+			break;
+		case 's':
+			nbValues = sscanf(optarg, "%lf,%lf,%lf,%lf", &values[0], &values[1], &values[2], &values[3]);
+			if(nbValues < 3){
+				fprintf(stderr, USAGE, argv[0]);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'n':
+			noiseRms = atof(optarg);
+			break;
+		case 'r':
+			if(sscanf(optarg, "%lf,%lf", &values[0], &values[1]) != 2){
+				fprintf(stderr, USAGE, argv[0]);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'p':
+			if(sscanf(optarg, "%lf,%lf,%lf", &pose[0], &pose[1], &pose[2]) != 3){
+				fprintf(stderr, USAGE, argv[0]);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'm':
+			micDistanceMm = atof(optarg);
+			break;
+		case 'f':
+			samplingHz = (uint32_t) strtoul(optarg, NULL, 0);
+			break;
+		case 'e':
+			seed = strtoull(optarg, NULL, 0);
+			break;
+		case 'o':
+			outputPath = optarg;
+			break;
+		case 'c':
+			capturePath = optarg;
+			break;
+		default:
+			fprintf(stderr, USAGE, argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if(optind != argc || seconds <= 0 || samplingHz == 0 || (outputPath != NULL && capturePath != NULL)){
+		fprintf(stderr, USAGE, argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	scene_init(&scene, seed);
+	scene.samplingHz = samplingHz;
+	scene.micDistanceMm = micDistanceMm;
+	scene_setNoise(&scene, noiseRms);
+	scene_setRobotPose(&scene, pose[0], pose[1], pose[2]);
+
+	optind = 1;
+	while((option = getopt(argc, argv, "d:s:n:r:p:m:f:e:o:c:")) != -1){
+		if(option == 's'){
+			values[3] = DEFAULT_AMPLITUDE;
+			sscanf(optarg, "%lf,%lf,%lf,%lf", &values[0], &values[1], &values[2], &values[3]);
+			if(scene_addSource(&scene, values[0], values[1], values[2], values[3]) < 0){
+				fprintf(stderr, "at most %d sources\n", SCENE__NB_SOURCES_MAX);
+				return EXIT_FAILURE;
+			}
+		}
+		else if(option == 'r'){
+			sscanf(optarg, "%lf,%lf", &values[0], &values[1]);
+			if(!scene_addTap(&scene, values[0], values[1])){
+				fprintf(stderr, "at most %d echoes\n", SCENE__NB_TAPS_MAX);
+				return EXIT_FAILURE;
+			}
+		}
+	}
+
+	if(outputPath != NULL){
+		output = fopen(outputPath, "wb");
+		if(output == NULL){
+			perror(outputPath);
+			return EXIT_FAILURE;
+		}
+	}
+	//The blocks are numbered and stamped as if the robot had captured them without gap
+	if(capturePath != NULL){
+		capFile_defaultHeader(&captureHeader);
+		captureHeader.samplingHz = samplingHz;
+		if(!capFile_create(&capture, capturePath, &captureHeader)){
+			perror(capturePath);
+			return EXIT_FAILURE;
+		}
+	}
+
+	for(uint8_t source = 0; source < scene.nbSources; source++){
+		fprintf(stderr, "source %u: %.1f Hz, bearing %.2f deg, distance %.0f mm\n", source,
+				scene.sources[source].freqHz, scene_getBearingDeg(&scene, source), scene_getDistanceMm(&scene, source));
+	}
+
+	uint64_t nbBlocks 		= (uint64_t) (seconds*samplingHz + SCENE__BLOCK_FRAMES - 1)/SCENE__BLOCK_FRAMES;
+
+	for(uint64_t block_counter = 0; block_counter < nbBlocks; block_counter++){
+		scene_fill(block, SCENE__BLOCK_FRAMES, &scene);
+		if(capturePath != NULL){
+			uint32_t time 		= (uint32_t) (block_counter*SCENE__BLOCK_FRAMES*CAPFILE__TICK_HZ/samplingHz);
+
+			if(!capFile_writeBlock(&capture, (uint32_t) block_counter, time, block)){
+				perror(capturePath);
+				return EXIT_FAILURE;
+			}
+		}
+		else if(fwrite(block, sizeof(block), 1, output) != 1){
+			perror("write");
+			return EXIT_FAILURE;
+		}
+	}
+	if(capturePath != NULL){
+		capFile_close(&capture);
+	}
+	if(output != stdout){
+		fclose(output);
+	}
+
+	fprintf(stderr, "blocks %llu of %u frames, clipped samples %u\n",
+			(unsigned long long) nbBlocks, SCENE__BLOCK_FRAMES, scene.clipped);
+	return EXIT_SUCCESS;
+}
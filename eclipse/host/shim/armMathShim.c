@@ -0,0 +1,238 @@
+/*
+ * armMathShim.c
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Host (Linux) implementation of the CMSIS-DSP functions of arm_math.h. The complex FFT is
+ * 		a plain radix-2 decimation in frequency, which leaves its output in bit reversed order as CMSIS does
+ * 		before its bit reversal stage. The twiddles of all lengths are taken from one table of the largest.
+ * 		The real FFT packs the samples as complex numbers, and splits the complex FFT of half its length into
+ * 		the spectra of the even and odd samples.
+ *
+ * Functions prefix for public functions in this file: CMSIS-DSP names
+ */
+
+#include <pthread.h>
+
+#include <arm_math.h>
+#include <arm_const_structs.h>
+
+
+/*===========================================================================*/
+/* Constants definition for this file						               */
+/*===========================================================================*/
+
+#define FFT_LEN_MAX							4096
+#define CMPX_VAL								2			//a complex number is a real and an imaginary part
+#define REAL_PART							0
+#define IMAG_PART							1
+
+
+/*===========================================================================*/
+/* Static variables definitions 		 			                            */
+/*===========================================================================*/
+
+//cos and sin of 2*pi*k/FFT_LEN_MAX for k up to FFT_LEN_MAX/2
+static float32_t twiddleCos[FFT_LEN_MAX/2];
+static float32_t twiddleSin[FFT_LEN_MAX/2];
+static pthread_once_t twiddlesOnce 		= PTHREAD_ONCE_INIT;
+
+const arm_cfft_instance_f32 arm_cfft_sR_f32_len16 = {16, NULL, NULL, 0};
+const arm_cfft_instance_f32 arm_cfft_sR_f32_len32 = {32, NULL, NULL, 0};
+const arm_cfft_instance_f32 arm_cfft_sR_f32_len64 = {64, NULL, NULL, 0};
+const arm_cfft_instance_f32 arm_cfft_sR_f32_len128 = {128, NULL, NULL, 0};
+const arm_cfft_instance_f32 arm_cfft_sR_f32_len256 = {256, NULL, NULL, 0};
+const arm_cfft_instance_f32 arm_cfft_sR_f32_len512 = {512, NULL, NULL, 0};
+const arm_cfft_instance_f32 arm_cfft_sR_f32_len1024 = {1024, NULL, NULL, 0};
+const arm_cfft_instance_f32 arm_cfft_sR_f32_len2048 = {2048, NULL, NULL, 0};
+const arm_cfft_instance_f32 arm_cfft_sR_f32_len4096 = {4096, NULL, NULL, 0};
+
+#define RFFT_LEN_MIN							32
+
+
+/*===========================================================================*/
+/* Private functions definitions                                             */
+/*===========================================================================*/
+
+/**
+ * @brief   Computes the table of twiddles, once
+*/
+void armTwiddlesInit(void);
+
+/**
+ * @brief   Puts the complex numbers of a bit reversed order in the normal order
+*/
+void armBitReverse(float32_t *data, uint16_t fftLen);
+
+
+/*===========================================================================*/
+/* Public functions              											*/
+/*===========================================================================*/
+
+void arm_cfft_f32(const arm_cfft_instance_f32 *S, float32_t *p1, uint8_t ifftFlag, uint8_t bitReverseFlag)
+{
+	uint16_t fftLen 		= S->fftLen;
+	float32_t sign 		= (ifftFlag != 0) ? 1.0f : -1.0f;		//exp(-j...) forward, exp(+j...) inverse
+	float32_t scale 		= 1.0f/(float32_t) fftLen;
+
+	pthread_once(&twiddlesOnce, armTwiddlesInit);
+
+	for(uint16_t size = fftLen; size >= 2; size /= 2){
+		uint16_t half 		= size/2;
+		uint16_t stride 	= FFT_LEN_MAX/size;
+
+		for(uint16_t start = 0; start < fftLen; start += size){
+			for(uint16_t k = 0; k < half; k++){
+				float32_t *a 	= &p1[CMPX_VAL*(start + k)];
+				float32_t *b 	= &p1[CMPX_VAL*(start + k + half)];
+				float32_t wRe 	= twiddleCos[k*stride];
+				float32_t wIm 	= sign*twiddleSin[k*stride];
+				float32_t dRe 	= a[REAL_PART] - b[REAL_PART];
+				float32_t dIm 	= a[IMAG_PART] - b[IMAG_PART];
+
+				a[REAL_PART] += b[REAL_PART];
+				a[IMAG_PART] += b[IMAG_PART];
+				b[REAL_PART] = dRe*wRe - dIm*wIm;
+				b[IMAG_PART] = dRe*wIm + dIm*wRe;
+			}
+		}
+	}
+
+	if(bitReverseFlag != 0){
+		armBitReverse(p1, fftLen);
+	}
+	if(ifftFlag != 0){
+		for(uint32_t value_counter = 0; value_counter < (uint32_t) CMPX_VAL*fftLen; value_counter++){
+			p1[value_counter] *= scale;
+		}
+	}
+}
+
+arm_status arm_rfft_fast_init_f32(arm_rfft_fast_instance_f32 *S, uint16_t fftLen)
+{
+	if(fftLen < RFFT_LEN_MIN || fftLen > FFT_LEN_MAX || (fftLen & (fftLen - 1)) != 0){
+		return ARM_MATH_ARGUMENT_ERROR;
+	}
+	S->Sint.fftLen = fftLen/2;
+	S->Sint.pTwiddle = NULL;
+	S->Sint.pBitRevTable = NULL;
+	S->Sint.bitRevLength = 0;
+	S->fftLenRFFT = fftLen;
+	S->pTwiddleRFFT = NULL;
+	return ARM_MATH_SUCCESS;
+}
+
+void arm_rfft_fast_f32(arm_rfft_fast_instance_f32 *S, float32_t *p, float32_t *pOut, uint8_t ifftFlag)
+{
+	uint16_t half 		= S->Sint.fftLen;
+	uint16_t stride 		= FFT_LEN_MAX/S->fftLenRFFT;
+
+	pthread_once(&twiddlesOnce, armTwiddlesInit);
+
+	if(ifftFlag == 0){
+		//Z = FFT of z[n] = x[2n] + j*x[2n+1], then X[k] = (Z[k] + conj(Z[half-k]))/2 - j*W^k*(Z[k] - conj(Z[half-k]))/2
+		arm_cfft_f32(&S->Sint, p, 0, 1);
+		pOut[0] = p[REAL_PART] + p[IMAG_PART];
+		pOut[1] = p[REAL_PART] - p[IMAG_PART];
+		for(uint16_t k = 1; k < half; k++){
+			float32_t *z 		= &p[CMPX_VAL*k];
+			float32_t *zMirror 	= &p[CMPX_VAL*(half - k)];
+			float32_t evenRe 	= (z[REAL_PART] + zMirror[REAL_PART])/2;
+			float32_t evenIm 	= (z[IMAG_PART] - zMirror[IMAG_PART])/2;
+			float32_t oddRe 		= (z[IMAG_PART] + zMirror[IMAG_PART])/2;
+			float32_t oddIm 		= -(z[REAL_PART] - zMirror[REAL_PART])/2;
+			float32_t wRe 		= twiddleCos[k*stride];
+			float32_t wIm 		= -twiddleSin[k*stride];
+
+			pOut[CMPX_VAL*k + REAL_PART] = evenRe + oddRe*wRe - oddIm*wIm;
+			pOut[CMPX_VAL*k + IMAG_PART] = evenIm + oddRe*wIm + oddIm*wRe;
+		}
+		return;
+	}
+
+	//Inverse: Z[k] = E[k] + j*O[k] with E[k] = (X[k] + conj(X[half-k]))/2 and O[k] = (X[k] - conj(X[half-k]))/(2*W^k)
+	pOut[REAL_PART] = (p[0] + p[1])/2;
+	pOut[IMAG_PART] = (p[0] - p[1])/2;
+	for(uint16_t k = 1; k < half; k++){
+		float32_t *x 		= &p[CMPX_VAL*k];
+		float32_t *xMirror 	= &p[CMPX_VAL*(half - k)];
+		float32_t evenRe 	= (x[REAL_PART] + xMirror[REAL_PART])/2;
+		float32_t evenIm 	= (x[IMAG_PART] - xMirror[IMAG_PART])/2;
+		float32_t diffRe 	= (x[REAL_PART] - xMirror[REAL_PART])/2;
+		float32_t diffIm 	= (x[IMAG_PART] + xMirror[IMAG_PART])/2;
+		float32_t wRe 		= twiddleCos[k*stride];
+		float32_t wIm 		= twiddleSin[k*stride];			//1/W^k = conj(W^k)
+		float32_t oddRe 		= diffRe*wRe - diffIm*wIm;
+		float32_t oddIm 		= diffRe*wIm + diffIm*wRe;
+
+		pOut[CMPX_VAL*k + REAL_PART] = evenRe - oddIm;
+		pOut[CMPX_VAL*k + IMAG_PART] = evenIm + oddRe;
+	}
+	arm_cfft_f32(&S->Sint, pOut, 1, 1);
+}
+
+void arm_copy_f32(float32_t *pSrc, float32_t *pDst, uint32_t blockSize)
+{
+	for(uint32_t value_counter = 0; value_counter < blockSize; value_counter++){
+		pDst[value_counter] = pSrc[value_counter];
+	}
+}
+
+void arm_cmplx_mag_f32(float32_t *pSrc, float32_t *pDst, uint32_t numSamples)
+{
+	for(uint32_t sample_counter = 0; sample_counter < numSamples; sample_counter++){
+		float32_t re 		= pSrc[CMPX_VAL*sample_counter + REAL_PART];
+		float32_t im 		= pSrc[CMPX_VAL*sample_counter + IMAG_PART];
+
+		pDst[sample_counter] = sqrtf(re*re + im*im);
+	}
+}
+
+void arm_cmplx_mag_squared_f32(float32_t *pSrc, float32_t *pDst, uint32_t numSamples)
+{
+	for(uint32_t sample_counter = 0; sample_counter < numSamples; sample_counter++){
+		float32_t re 		= pSrc[CMPX_VAL*sample_counter + REAL_PART];
+		float32_t im 		= pSrc[CMPX_VAL*sample_counter + IMAG_PART];
+
+		pDst[sample_counter] = re*re + im*im;
+	}
+}
+
+
+/*===========================================================================*/
+/* Private functions	 code												   */
+/*===========================================================================*/
+
+void armTwiddlesInit(void)
+{
+	for(uint16_t k = 0; k < FFT_LEN_MAX/2; k++){
+		twiddleCos[k] = (float32_t) cos(2.0*M_PI*k/FFT_LEN_MAX);
+		twiddleSin[k] = (float32_t) sin(2.0*M_PI*k/FFT_LEN_MAX);
+	}
+}
+
+void armBitReverse(float32_t *data, uint16_t fftLen)
+{
+	uint16_t reversed 		= 0;
+	float32_t swap 			= 0;
+
+	for(uint16_t index = 0; index < fftLen; index++){
+		if(index < reversed){
+			for(uint8_t part = 0; part < CMPX_VAL; part++){
+				swap = data[CMPX_VAL*index + part];
+				data[CMPX_VAL*index + part] = data[CMPX_VAL*reversed + part];
+				data[CMPX_VAL*reversed + part] = swap;
+			}
+		}
+
+		//increments reversed as a number written from its most significant bit
+		uint16_t bit = fftLen/2;
+		while(bit > 0 && (reversed & bit) != 0){
+			reversed &= (uint16_t) ~bit;
+			bit /= 2;
+		}
+		reversed |= bit;
+	}
+}
@@ -0,0 +1,71 @@
+/*
+ * arm_math.h
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Host (Linux) stand-in for the CMSIS-DSP functions used by the firmware, with the signatures
+ * 		of CMSIS 4.5 shipped with the e-puck2 library. They give the same results up to the float rounding,
+ * 		not the same timings. Implemented in armMathShim.c.
+ */
+#ifndef ARM_MATH_H_
+#define ARM_MATH_H_
+
+#include <stdint.h>
+#include <math.h>
+
+#define PI									3.14159265358979f
+
+typedef float float32_t;
+
+typedef enum {
+	ARM_MATH_SUCCESS = 0,
+	ARM_MATH_ARGUMENT_ERROR = -1
+} arm_status;
+
+/*
+ * Complex FFT, only fftLen is used on the host, the twiddles are computed at the first use of a length
+ */
+typedef struct {
+	uint16_t fftLen;
+	const float32_t *pTwiddle;
+	const uint16_t *pBitRevTable;
+	uint16_t bitRevLength;
+} arm_cfft_instance_f32;
+
+/*
+ * @brief	In place complex FFT of fftLen interleaved real and imaginary parts
+ *
+ *  @param[in] ifftFlag			0 for the forward transform, 1 for the inverse one (scaled by 1/fftLen)
+ *  @param[in] bitReverseFlag	1 for an output in the normal order, 0 to leave it in bit reversed order
+ */
+void arm_cfft_f32(const arm_cfft_instance_f32 *S, float32_t *p1, uint8_t ifftFlag, uint8_t bitReverseFlag);
+
+/*
+ * Real FFT, computed with a complex FFT of half its length
+ */
+typedef struct {
+	arm_cfft_instance_f32 Sint;
+	uint16_t fftLenRFFT;
+	float32_t *pTwiddleRFFT;
+} arm_rfft_fast_instance_f32;
+
+/*
+ * @brief	Initialises a real FFT of fftLen points, 32 to 4096
+ */
+arm_status arm_rfft_fast_init_f32(arm_rfft_fast_instance_f32 *S, uint16_t fftLen);
+
+/*
+ * @brief	Real FFT of fftLen points, p is used as a work buffer
+ * @note 	The forward output is packed as in CMSIS: the real parts of the bins 0 and fftLen/2, then the real
+ * 			and imaginary parts of the bins 1 to fftLen/2-1. The inverse takes this format and gives fftLen samples.
+ */
+void arm_rfft_fast_f32(arm_rfft_fast_instance_f32 *S, float32_t *p, float32_t *pOut, uint8_t ifftFlag);
+
+void arm_copy_f32(float32_t *pSrc, float32_t *pDst, uint32_t blockSize);
+void arm_cmplx_mag_f32(float32_t *pSrc, float32_t *pDst, uint32_t numSamples);
+void arm_cmplx_mag_squared_f32(float32_t *pSrc, float32_t *pDst, uint32_t numSamples);
+
+
+#endif /* ARM_MATH_H_ */
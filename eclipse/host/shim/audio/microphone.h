@@ -0,0 +1,23 @@
+/*
+ * microphone.h
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Host (Linux) stand-in for the microphones of the e-puck2 library. As the processing thread
+ * 		of the library, a thread calls the callback every 10ms with 160 samples of each of the 4 microphones,
+ * 		interleaved right, left, back, front. The samples come from the source set with shim_setMicSource.
+ * 		Implemented in epuckShim.c.
+ */
+#ifndef MICROPHONE_H_
+#define MICROPHONE_H_
+
+#include <stdint.h>
+
+typedef void (*mic_callback_t)(int16_t *data, uint16_t num_samples);
+
+void mic_start(mic_callback_t customFullbufferCb);
+
+
+#endif /* MICROPHONE_H_ */
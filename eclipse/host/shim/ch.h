@@ -0,0 +1,205 @@
+/*
+ * ch.h
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Host (Linux) stand-in for the ChibiOS RT 4 kernel, with only the part of the API used by the
+ * 		firmware. Each ChibiOS thread is a pthread, but they run one at a time: a thread only runs while it holds
+ * 		the kernel token, and gives it back when it blocks (sleep, semaphore, mutex, mailbox, serial input).
+ * 		This keeps the ChibiOS guarantees the firmware relies on, chSysLock() is thus a no-op, and a thread is
+ * 		never interrupted between two blocking calls. Priorities are recorded but not used to schedule.
+ * 		Implemented in chibiosShim.c.
+ */
+#ifndef CH_H_
+#define CH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+
+/*===========================================================================*/
+/* Configuration, as in chconf.h						    		           */
+/*===========================================================================*/
+
+#ifndef TRUE
+#define TRUE									1
+#endif
+#ifndef FALSE
+#define FALSE								0
+#endif
+
+#define CH_CFG_ST_FREQUENCY					10000		//system ticks per second, as the e-puck2
+#define CH_CFG_USE_REGISTRY					TRUE
+#define CH_DBG_THREADS_PROFILING				TRUE			//p_time counts the ticks a thread held the token
+#define CH_DBG_FILL_THREADS					FALSE		//the threads run on pthread stacks
+#define CH_DBG_STACK_FILL_VALUE				0x55
+
+
+/*===========================================================================*/
+/* Types and constants						    		                   */
+/*===========================================================================*/
+
+typedef uint32_t systime_t;
+typedef intptr_t msg_t;						//32 bits on the robot, the firmware posts pointers in mailboxes
+typedef int32_t cnt_t;
+typedef uint32_t tprio_t;
+typedef uint64_t stkalign_t;
+
+#define NOPRIO								0
+#define IDLEPRIO								1
+#define LOWPRIO								2
+#define NORMALPRIO							128
+#define HIGHPRIO								255
+
+#define MSG_OK								0
+#define MSG_TIMEOUT							-1
+#define MSG_RESET							-2
+
+#define TIME_IMMEDIATE						((systime_t) 0)
+#define TIME_INFINITE						((systime_t) -1)
+
+//Conversions with the rounding and the 32 bits arithmetic of ChibiOS RT 4
+#define S2ST(sec)							((systime_t) ((uint32_t) (sec)*(uint32_t) CH_CFG_ST_FREQUENCY))
+#define MS2ST(msec)							((systime_t) (((uint32_t) (msec)*(uint32_t) CH_CFG_ST_FREQUENCY + 999U)/1000U))
+#define US2ST(usec)							((systime_t) (((uint32_t) (usec)*(uint32_t) CH_CFG_ST_FREQUENCY + 999999U)/1000000U))
+#define ST2S(n)								((uint32_t) (((uint32_t) (n) + CH_CFG_ST_FREQUENCY - 1U)/CH_CFG_ST_FREQUENCY))
+#define ST2MS(n)								((uint32_t) (((uint32_t) (n)*1000U + CH_CFG_ST_FREQUENCY - 1U)/CH_CFG_ST_FREQUENCY))
+#define ST2US(n)								((uint32_t) (((uint32_t) (n)*1000000U + CH_CFG_ST_FREQUENCY - 1U)/CH_CFG_ST_FREQUENCY))
+
+
+/*===========================================================================*/
+/* Kernel objects						 			                        */
+/*===========================================================================*/
+
+typedef struct thread thread_t;
+typedef void (*tfunc_t)(void *arg);
+
+typedef struct mutex {
+	thread_t *m_owner;
+	struct mutex *m_next;				//next mutex owned by m_owner, the last locked one is first
+} mutex_t;
+
+struct thread {
+	const char *p_name;
+	tprio_t p_prio;
+	systime_t p_time;
+	mutex_t *p_mtxlist;
+	pthread_t p_pthread;
+	tfunc_t p_function;
+	void *p_arg;
+	systime_t p_runStart;				//when it took the token
+	uint64_t p_deadline;				//virtual clock: end of its timed wait, UINT64_MAX if it has none
+};
+
+typedef struct {
+	cnt_t s_cnt;
+} semaphore_t;
+
+typedef struct {
+	bool taken;
+} binary_semaphore_t;
+
+typedef struct {
+	uint32_t c_broadcasts;
+} condition_variable_t;
+typedef condition_variable_t condvar_t;
+
+typedef struct {
+	msg_t *mb_buffer;
+	msg_t *mb_top;
+	msg_t *mb_wrptr;
+	msg_t *mb_rdptr;
+	cnt_t mb_used;
+} mailbox_t;
+
+struct pool_header {
+	struct pool_header *ph_next;
+};
+
+typedef struct {
+	struct pool_header *mp_next;
+	size_t mp_object_size;
+	void *mp_provider;					//no allocation provider on the host, only preloaded objects
+} memory_pool_t;
+
+#define _SEMAPHORE_DATA(name, n)				{(n)}
+#define SEMAPHORE_DECL(name, n)				semaphore_t name = _SEMAPHORE_DATA(name, n)
+#define _BSEMAPHORE_DATA(name, taken)		{(taken)}
+#define BSEMAPHORE_DECL(name, taken)			binary_semaphore_t name = _BSEMAPHORE_DATA(name, taken)
+#define _MUTEX_DATA(name)					{NULL, NULL}
+#define MUTEX_DECL(name)						mutex_t name = _MUTEX_DATA(name)
+#define _CONDVAR_DATA(name)					{0}
+#define CONDVAR_DECL(name)					condition_variable_t name = _CONDVAR_DATA(name)
+#define _MAILBOX_DATA(name, buffer, size)	{(msg_t *) (buffer), (msg_t *) (buffer) + (size), (msg_t *) (buffer), (msg_t *) (buffer), 0}
+#define MAILBOX_DECL(name, buffer, size)		mailbox_t name = _MAILBOX_DATA(name, buffer, size)
+#define _MEMORYPOOL_DATA(name, size, provider)	{NULL, (size), (void *) (provider)}
+#define MEMORYPOOL_DECL(name, size, provider)	memory_pool_t name = _MEMORYPOOL_DATA(name, size, provider)
+
+//The working areas are not used as stacks, they only keep the declarations of the firmware valid
+#define THD_WORKING_AREA(s, n)				stkalign_t s[((n) + sizeof(stkalign_t) - 1)/sizeof(stkalign_t)]
+#define THD_FUNCTION(tname, arg)				void tname(void *arg)
+
+#define chDbgAssert(c, r)					((void) 0)
+
+
+/*===========================================================================*/
+/* Kernel functions						 			                        */
+/*===========================================================================*/
+
+void chSysInit(void);
+void chSysHalt(const char *reason);
+static inline void chSysLock(void) {}
+static inline void chSysUnlock(void) {}
+static inline void chSysLockFromISR(void) {}
+static inline void chSysUnlockFromISR(void) {}
+
+systime_t chVTGetSystemTime(void);
+systime_t chVTGetSystemTimeX(void);
+
+thread_t *chThdCreateStatic(void *wsp, size_t size, tprio_t prio, tfunc_t pf, void *arg);
+thread_t *chThdGetSelfX(void);
+void chThdSleep(systime_t time);
+void chThdSleepMilliseconds(uint32_t msec);
+void chThdSleepUntil(systime_t time);
+void chThdYield(void);
+
+void chRegSetThreadName(const char *name);
+thread_t *chRegFirstThread(void);
+thread_t *chRegNextThread(thread_t *tp);
+
+void chSemObjectInit(semaphore_t *sp, cnt_t n);
+msg_t chSemWait(semaphore_t *sp);
+msg_t chSemWaitTimeout(semaphore_t *sp, systime_t time);
+void chSemSignal(semaphore_t *sp);
+void chSemSignalI(semaphore_t *sp);
+
+void chBSemObjectInit(binary_semaphore_t *bsp, bool taken);
+msg_t chBSemWait(binary_semaphore_t *bsp);
+msg_t chBSemWaitTimeout(binary_semaphore_t *bsp, systime_t time);
+void chBSemSignal(binary_semaphore_t *bsp);
+void chBSemSignalI(binary_semaphore_t *bsp);
+
+void chMtxObjectInit(mutex_t *mp);
+void chMtxLock(mutex_t *mp);
+void chMtxUnlock(mutex_t *mp);
+
+void chCondObjectInit(condition_variable_t *cp);
+msg_t chCondWait(condition_variable_t *cp);
+void chCondBroadcast(condition_variable_t *cp);
+
+void chMBObjectInit(mailbox_t *mbp, msg_t *buf, cnt_t n);
+msg_t chMBPost(mailbox_t *mbp, msg_t msg, systime_t timeout);
+msg_t chMBPostI(mailbox_t *mbp, msg_t msg);
+msg_t chMBFetch(mailbox_t *mbp, msg_t *msgp, systime_t timeout);
+cnt_t chMBGetUsedCountI(mailbox_t *mbp);
+
+void chPoolObjectInit(memory_pool_t *mp, size_t size, void *provider);
+void chPoolLoadArray(memory_pool_t *mp, void *p, size_t n);
+void *chPoolAlloc(memory_pool_t *mp);
+void chPoolFree(memory_pool_t *mp, void *objp);
+
+
+#endif /* CH_H_ */
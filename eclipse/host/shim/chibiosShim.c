@@ -0,0 +1,928 @@
+/*
+ * chibiosShim.c
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Host (Linux) implementation of the ChibiOS kernel and HAL subset declared in ch.h, hal.h
+ * 		and chprintf.h. All the kernel objects are protected by the token, a single pthread mutex held by the
+ * 		running thread. A thread waiting on an object releases the token in pthread_cond_wait on a condition
+ * 		broadcast at every change of any object, and checks again its own object when it wakes up.
+ * 		With the virtual clock (shim_useVirtualClock), the time only moves when all the threads wait: the last
+ * 		thread to wait moves it to the first deadline of all, and the time spent by the host computing is not seen.
+ *
+ * Functions prefix for public functions in this file: ChibiOS and HAL names, shim_
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <ch.h>
+#include <hal.h>
+#include <chprintf.h>
+#include <hostShim.h>
+
+
+/*===========================================================================*/
+/* Constants definition for this file						               */
+/*===========================================================================*/
+
+#define SHIM_NB_THREADS_MAX					16
+#define SHIM_NB_PORTS						8			//GPIOA to GPIOH
+#define NS_PER_S								1000000000ULL
+#define FORMAT_SIZE_MAX						512			//longest chprintf format, longer ones are used as they are
+#define PRINTF_LINE_SIZE						256			//longest chprintf output
+#define NO_DEADLINE							UINT64_MAX
+
+
+/*===========================================================================*/
+/* Structures						 			                            */
+/*===========================================================================*/
+
+/*
+ * End of a timed wait, on the clock in use
+ */
+typedef struct ShimDeadlines {
+	struct timespec real;									//on CLOCK_MONOTONIC
+	uint64_t ticks;											//on the virtual clock
+} ShimDeadline;
+
+
+/*===========================================================================*/
+/* Static variables definitions 		 			                            */
+/*===========================================================================*/
+
+static pthread_mutex_t token 			= PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t objectChanged;						//on CLOCK_MONOTONIC, initialised by chSysInit
+static pthread_cond_t idleChanged 		= PTHREAD_COND_INITIALIZER;
+static pthread_once_t initOnce 			= PTHREAD_ONCE_INIT;
+static struct timespec startTime;
+
+static thread_t threads[SHIM_NB_THREADS_MAX];
+static uint8_t nbThreads 				= 0;
+static __thread thread_t *self 			= NULL;
+
+//A notification wakes all the waiting threads, they are counted again when they wait again
+static uint8_t nbWaiting 				= 0;
+static uint8_t nbHostBlocked 			= 0;		//threads waiting for the serial input
+static uint32_t notifyCount 				= 0;
+
+//Virtual clock, its ticks do not wrap as systime_t does
+static bool virtualClock 				= false;
+static uint64_t virtualTicks 			= 0;
+static shim_clockHook clockHook 			= NULL;
+static void *clockHookContext 			= NULL;
+
+//Input of the serial link given by shim_setSerialInput, instead of the input file
+static const char *serialInput 			= NULL;
+
+static uint16_t pads[SHIM_NB_PORTS];
+
+static size_t serialWrite(void *instance, const uint8_t *bp, size_t n);
+static size_t serialRead(void *instance, uint8_t *bp, size_t n);
+static msg_t serialPut(void *instance, uint8_t b);
+static msg_t serialGet(void *instance);
+
+static const struct BaseSequentialStreamVMT serialVmt = {serialWrite, serialRead, serialPut, serialGet};
+SerialDriver SD3 = {&serialVmt, STDIN_FILENO, STDOUT_FILENO};
+
+
+/*===========================================================================*/
+/* Private functions definitions                                             */
+/*===========================================================================*/
+
+/**
+ * @brief   Starts the clock and the condition of the objects, once
+*/
+void shimInit(void);
+
+/**
+ * @brief   Accounts the time the current thread held the token in its p_time
+ * @note 	shimRunStart is called when the thread takes the token, shimRunEnd when it gives it back
+*/
+void shimRunStart(void);
+void shimRunEnd(void);
+
+/**
+ * @brief   Gives the token back around a blocking call of the host (read, write)
+*/
+void shimReleaseToken(void);
+void shimTakeToken(void);
+
+/**
+ * @brief   Waits for a change of any object, without the token
+ *
+ * @parameter[in] deadline		NULL to wait without limit
+ *
+ * @return	false if the deadline passed
+*/
+bool shimWait(const ShimDeadline *deadline);
+
+/**
+ * @brief   Waits until an object is ready, as the ChibiOS functions with a timeout
+ *
+ * @parameter[in] isReady		tells if the object is ready
+ * @parameter[in] object			given to isReady
+ * @parameter[in] timeout		TIME_IMMEDIATE, TIME_INFINITE or a number of ticks
+ *
+ * @return	MSG_OK when it is ready, MSG_TIMEOUT otherwise
+*/
+msg_t shimBlock(bool (*isReady)(const void *object), const void *object, systime_t timeout);
+
+/**
+ * @brief   Wakes the threads waiting on any object
+*/
+void shimNotify(void);
+
+/**
+ * @brief   Wakes shim_waitIdle if all the threads but the one calling it wait
+*/
+void shimCheckIdle(void);
+
+/**
+ * @brief   Moves the virtual clock to the first deadline of the waiting threads, and wakes them all
+ * @note 	Called by the last thread to wait, all the threads wait or read the input file
+*/
+void shimAdvanceClock(void);
+
+/**
+ * @brief   Returns the time after a number of ticks from now
+*/
+void shimDeadline(systime_t ticks, ShimDeadline *deadline);
+
+/**
+ * @brief   Readiness of the objects, for shimBlock
+*/
+bool shimSemIsReady(const void *object);
+bool shimBSemIsReady(const void *object);
+bool shimMtxIsReady(const void *object);
+bool shimCondIsReady(const void *object);
+bool shimMBCanPost(const void *object);
+bool shimMBCanFetch(const void *object);
+bool shimSerialInputIsReady(const void *object);
+
+/**
+ * @brief   Runs a thread created with chThdCreateStatic, with the token
+*/
+void *shimThreadStart(void *arg);
+
+/**
+ * @brief   Converts a chprintf format into a printf one
+ * @note 	The upper case conversions and the l modifier are 32 bits on the robot, the integers given
+ * 			by the firmware are thus formatted as int.
+ *
+ * @return	false if the format was too long, then it is used as it is
+*/
+bool shimConvertFormat(const char *fmt, char *converted, size_t size);
+
+
+/*===========================================================================*/
+/* Kernel             														*/
+/*===========================================================================*/
+
+void chSysInit(void)
+{
+	pthread_once(&initOnce, shimInit);
+
+	//The calling thread becomes the main thread
+	pthread_mutex_lock(&token);
+	threads[0].p_name = "main";
+	threads[0].p_prio = NORMALPRIO;
+	threads[0].p_pthread = pthread_self();
+	threads[0].p_deadline = NO_DEADLINE;
+	nbThreads = 1;
+	self = &threads[0];
+	shimRunStart();
+}
+
+void chSysHalt(const char *reason)
+{
+	fprintf(stderr, "chSysHalt: %s\n", reason);
+	abort();
+}
+
+systime_t chVTGetSystemTime(void)
+{
+	return chVTGetSystemTimeX();
+}
+
+systime_t chVTGetSystemTimeX(void)
+{
+	struct timespec now;
+	uint64_t elapsedNs 		= 0;
+
+	if(virtualClock){
+		return (systime_t) virtualTicks;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	elapsedNs = (uint64_t) (now.tv_sec - startTime.tv_sec)*NS_PER_S + (uint64_t) now.tv_nsec - (uint64_t) startTime.tv_nsec;
+	return (systime_t) (elapsedNs*CH_CFG_ST_FREQUENCY/NS_PER_S);
+}
+
+thread_t *chThdCreateStatic(void *wsp, size_t size, tprio_t prio, tfunc_t pf, void *arg)
+{
+	thread_t *tp 			= NULL;
+
+	(void) wsp;
+	(void) size;
+
+	if(nbThreads >= SHIM_NB_THREADS_MAX){
+		chSysHalt("chThdCreateStatic: too many threads");
+	}
+	tp = &threads[nbThreads];
+	tp->p_name = NULL;
+	tp->p_prio = prio;
+	tp->p_function = pf;
+	tp->p_arg = arg;
+	tp->p_deadline = NO_DEADLINE;
+	nbThreads++;
+
+	//It runs when the creator gives the token back
+	if(pthread_create(&tp->p_pthread, NULL, shimThreadStart, tp) != 0){
+		chSysHalt("chThdCreateStatic: pthread_create failed");
+	}
+	return tp;
+}
+
+thread_t *chThdGetSelfX(void)
+{
+	return self;
+}
+
+void chThdSleep(systime_t time)
+{
+	ShimDeadline deadline;
+
+	shimDeadline(time, &deadline);
+	while(shimWait(&deadline)){
+	}
+}
+
+void chThdSleepMilliseconds(uint32_t msec)
+{
+	chThdSleep(MS2ST(msec));
+}
+
+void chThdSleepUntil(systime_t time)
+{
+	int32_t remaining = (int32_t) (time - chVTGetSystemTimeX());
+
+	if(remaining > 0){
+		chThdSleep((systime_t) remaining);
+	}
+}
+
+void chThdYield(void)
+{
+	shimReleaseToken();
+	sched_yield();
+	shimTakeToken();
+}
+
+void chRegSetThreadName(const char *name)
+{
+	if(self != NULL){
+		self->p_name = name;
+	}
+}
+
+thread_t *chRegFirstThread(void)
+{
+	return (nbThreads > 0) ? &threads[0] : NULL;
+}
+
+thread_t *chRegNextThread(thread_t *tp)
+{
+	return (tp + 1 < &threads[nbThreads]) ? tp + 1 : NULL;
+}
+
+void chSemObjectInit(semaphore_t *sp, cnt_t n)
+{
+	sp->s_cnt = n;
+}
+
+msg_t chSemWait(semaphore_t *sp)
+{
+	return chSemWaitTimeout(sp, TIME_INFINITE);
+}
+
+msg_t chSemWaitTimeout(semaphore_t *sp, systime_t time)
+{
+	if(shimBlock(shimSemIsReady, sp, time) != MSG_OK){
+		return MSG_TIMEOUT;
+	}
+	sp->s_cnt--;
+	return MSG_OK;
+}
+
+void chSemSignal(semaphore_t *sp)
+{
+	sp->s_cnt++;
+	shimNotify();
+}
+
+void chSemSignalI(semaphore_t *sp)
+{
+	chSemSignal(sp);
+}
+
+void chBSemObjectInit(binary_semaphore_t *bsp, bool taken)
+{
+	bsp->taken = taken;
+}
+
+msg_t chBSemWait(binary_semaphore_t *bsp)
+{
+	return chBSemWaitTimeout(bsp, TIME_INFINITE);
+}
+
+msg_t chBSemWaitTimeout(binary_semaphore_t *bsp, systime_t time)
+{
+	if(shimBlock(shimBSemIsReady, bsp, time) != MSG_OK){
+		return MSG_TIMEOUT;
+	}
+	bsp->taken = true;
+	return MSG_OK;
+}
+
+void chBSemSignal(binary_semaphore_t *bsp)
+{
+	bsp->taken = false;
+	shimNotify();
+}
+
+void chBSemSignalI(binary_semaphore_t *bsp)
+{
+	chBSemSignal(bsp);
+}
+
+void chMtxObjectInit(mutex_t *mp)
+{
+	mp->m_owner = NULL;
+	mp->m_next = NULL;
+}
+
+void chMtxLock(mutex_t *mp)
+{
+	if(mp->m_owner == self){
+		chSysHalt("chMtxLock: mutex already owned by this thread");
+	}
+	shimBlock(shimMtxIsReady, mp, TIME_INFINITE);
+	mp->m_owner = self;
+	mp->m_next = self->p_mtxlist;
+	self->p_mtxlist = mp;
+}
+
+void chMtxUnlock(mutex_t *mp)
+{
+	mutex_t **owned = &self->p_mtxlist;
+
+	while(*owned != NULL && *owned != mp){
+		owned = &(*owned)->m_next;
+	}
+	if(*owned == NULL){
+		chSysHalt("chMtxUnlock: mutex not owned by this thread");
+	}
+	*owned = mp->m_next;
+	mp->m_owner = NULL;
+	mp->m_next = NULL;
+	shimNotify();
+}
+
+void chCondObjectInit(condition_variable_t *cp)
+{
+	cp->c_broadcasts = 0;
+}
+
+msg_t chCondWait(condition_variable_t *cp)
+{
+	//As ChibiOS, releases the mutex locked last and takes it again once woken up
+	mutex_t *mp 						= self->p_mtxlist;
+	struct {
+		const condition_variable_t *condvar;
+		uint32_t broadcasts;
+	} wait 							= {cp, cp->c_broadcasts};
+
+	if(mp == NULL){
+		chSysHalt("chCondWait: no mutex owned");
+	}
+	chMtxUnlock(mp);
+	shimBlock(shimCondIsReady, &wait, TIME_INFINITE);
+	chMtxLock(mp);
+	return MSG_OK;
+}
+
+void chCondBroadcast(condition_variable_t *cp)
+{
+	cp->c_broadcasts++;
+	shimNotify();
+}
+
+void chMBObjectInit(mailbox_t *mbp, msg_t *buf, cnt_t n)
+{
+	mbp->mb_buffer = buf;
+	mbp->mb_top = buf + n;
+	mbp->mb_wrptr = buf;
+	mbp->mb_rdptr = buf;
+	mbp->mb_used = 0;
+}
+
+msg_t chMBPost(mailbox_t *mbp, msg_t msg, systime_t timeout)
+{
+	if(shimBlock(shimMBCanPost, mbp, timeout) != MSG_OK){
+		return MSG_TIMEOUT;
+	}
+	*mbp->mb_wrptr++ = msg;
+	if(mbp->mb_wrptr >= mbp->mb_top){
+		mbp->mb_wrptr = mbp->mb_buffer;
+	}
+	mbp->mb_used++;
+	shimNotify();
+	return MSG_OK;
+}
+
+msg_t chMBPostI(mailbox_t *mbp, msg_t msg)
+{
+	return chMBPost(mbp, msg, TIME_IMMEDIATE);
+}
+
+msg_t chMBFetch(mailbox_t *mbp, msg_t *msgp, systime_t timeout)
+{
+	if(shimBlock(shimMBCanFetch, mbp, timeout) != MSG_OK){
+		return MSG_TIMEOUT;
+	}
+	*msgp = *mbp->mb_rdptr++;
+	if(mbp->mb_rdptr >= mbp->mb_top){
+		mbp->mb_rdptr = mbp->mb_buffer;
+	}
+	mbp->mb_used--;
+	shimNotify();
+	return MSG_OK;
+}
+
+cnt_t chMBGetUsedCountI(mailbox_t *mbp)
+{
+	return mbp->mb_used;
+}
+
+void chPoolObjectInit(memory_pool_t *mp, size_t size, void *provider)
+{
+	mp->mp_next = NULL;
+	mp->mp_object_size = size;
+	mp->mp_provider = provider;
+}
+
+void chPoolLoadArray(memory_pool_t *mp, void *p, size_t n)
+{
+	for(size_t object_counter = 0; object_counter < n; object_counter++){
+		chPoolFree(mp, (uint8_t *) p + object_counter*mp->mp_object_size);
+	}
+}
+
+void *chPoolAlloc(memory_pool_t *mp)
+{
+	struct pool_header *object = mp->mp_next;
+
+	if(object != NULL){
+		mp->mp_next = object->ph_next;
+	}
+	return object;
+}
+
+void chPoolFree(memory_pool_t *mp, void *objp)
+{
+	struct pool_header *object = (struct pool_header *) objp;
+
+	object->ph_next = mp->mp_next;
+	mp->mp_next = object;
+}
+
+
+/*===========================================================================*/
+/* HAL             															*/
+/*===========================================================================*/
+
+void halInit(void)
+{
+	memset(pads, 0, sizeof(pads));
+}
+
+void sdStart(SerialDriver *sdp, const SerialConfig *config)
+{
+	(void) sdp;
+	(void) config;
+}
+
+void sdStop(SerialDriver *sdp)
+{
+	(void) sdp;
+}
+
+size_t sdWrite(SerialDriver *sdp, const uint8_t *bp, size_t n)
+{
+	return serialWrite(sdp, bp, n);
+}
+
+msg_t sdGet(SerialDriver *sdp)
+{
+	return serialGet(sdp);
+}
+
+void palSetPad(ioportid_t port, uint8_t pad)
+{
+	pads[port % SHIM_NB_PORTS] |= (uint16_t) (1U << pad);
+}
+
+void palClearPad(ioportid_t port, uint8_t pad)
+{
+	pads[port % SHIM_NB_PORTS] &= (uint16_t) ~(1U << pad);
+}
+
+void palTogglePad(ioportid_t port, uint8_t pad)
+{
+	pads[port % SHIM_NB_PORTS] ^= (uint16_t) (1U << pad);
+}
+
+uint8_t palReadPad(ioportid_t port, uint8_t pad)
+{
+	return (uint8_t) ((pads[port % SHIM_NB_PORTS] >> pad) & 1U);
+}
+
+bool shim_getPad(ioportid_t port, uint8_t pad)
+{
+	return palReadPad(port, pad) != 0;
+}
+
+void shim_waitIdle(void)
+{
+	//Each thread that starts waiting checks the count again, a notification meanwhile resets it
+	shimRunEnd();
+	while(nbWaiting + nbHostBlocked + 1 < nbThreads){
+		pthread_cond_wait(&idleChanged, &token);
+	}
+	shimRunStart();
+}
+
+void shim_useVirtualClock(shim_clockHook hook, void *context)
+{
+	virtualClock = true;
+	clockHook = hook;
+	clockHookContext = context;
+}
+
+void shim_setSerialInput(const char *text)
+{
+	serialInput = text;
+	shimNotify();
+}
+
+
+/*===========================================================================*/
+/* Formatted output             												*/
+/*===========================================================================*/
+
+int chvsnprintf(char *str, size_t size, const char *fmt, va_list ap)
+{
+	char converted[FORMAT_SIZE_MAX];
+
+	if(shimConvertFormat(fmt, converted, sizeof(converted))){
+		fmt = converted;
+	}
+	return vsnprintf(str, size, fmt, ap);
+}
+
+int chsnprintf(char *str, size_t size, const char *fmt, ...)
+{
+	va_list ap;
+	int formatted_bytes;
+
+	va_start(ap, fmt);
+	formatted_bytes = chvsnprintf(str, size, fmt, ap);
+	va_end(ap);
+	return formatted_bytes;
+}
+
+int chvprintf(BaseSequentialStream *chp, const char *fmt, va_list ap)
+{
+	char line[PRINTF_LINE_SIZE];
+	int formatted_bytes 		= chvsnprintf(line, sizeof(line), fmt, ap);
+
+	chSequentialStreamWrite(chp, (const uint8_t *) line, strnlen(line, sizeof(line)));
+	return formatted_bytes;
+}
+
+int chprintf(BaseSequentialStream *chp, const char *fmt, ...)
+{
+	va_list ap;
+	int formatted_bytes;
+
+	va_start(ap, fmt);
+	formatted_bytes = chvprintf(chp, fmt, ap);
+	va_end(ap);
+	return formatted_bytes;
+}
+
+
+/*===========================================================================*/
+/* Private functions	 code												   */
+/*===========================================================================*/
+
+void shimInit(void)
+{
+	pthread_condattr_t attributes;
+
+	pthread_condattr_init(&attributes);
+	pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+	pthread_cond_init(&objectChanged, &attributes);
+	pthread_condattr_destroy(&attributes);
+	clock_gettime(CLOCK_MONOTONIC, &startTime);
+}
+
+void shimRunStart(void)
+{
+	if(self != NULL){
+		self->p_runStart = chVTGetSystemTimeX();
+	}
+}
+
+void shimRunEnd(void)
+{
+	if(self != NULL){
+		self->p_time += chVTGetSystemTimeX() - self->p_runStart;
+	}
+}
+
+void shimReleaseToken(void)
+{
+	shimRunEnd();
+	pthread_mutex_unlock(&token);
+}
+
+void shimTakeToken(void)
+{
+	pthread_mutex_lock(&token);
+	shimRunStart();
+}
+
+bool shimWait(const ShimDeadline *deadline)
+{
+	int result 			= 0;
+	uint32_t notified 	= notifyCount;
+
+	shimRunEnd();
+	nbWaiting++;
+	shimCheckIdle();
+	if(virtualClock){
+		self->p_deadline = (deadline == NULL) ? NO_DEADLINE : deadline->ticks;
+		if(nbWaiting + nbHostBlocked >= nbThreads){
+			shimAdvanceClock();
+		}
+		else{
+			pthread_cond_wait(&objectChanged, &token);
+		}
+		self->p_deadline = NO_DEADLINE;
+		result = (deadline != NULL && virtualTicks >= deadline->ticks) ? ETIMEDOUT : 0;
+	}
+	else if(deadline == NULL){
+		result = pthread_cond_wait(&objectChanged, &token);
+	}
+	else{
+		result = pthread_cond_timedwait(&objectChanged, &token, &deadline->real);
+	}
+	if(notified == notifyCount){			//timeout or spurious wake up, shimNotify did not count it out
+		nbWaiting--;
+	}
+	shimRunStart();
+	return result != ETIMEDOUT;
+}
+
+msg_t shimBlock(bool (*isReady)(const void *object), const void *object, systime_t timeout)
+{
+	ShimDeadline deadline;
+	bool timedOut 		= false;
+
+	if(timeout != TIME_INFINITE){
+		shimDeadline(timeout, &deadline);
+	}
+	while(isReady(object) == false){
+		if(timeout == TIME_IMMEDIATE || timedOut){
+			return MSG_TIMEOUT;
+		}
+		timedOut = !shimWait((timeout == TIME_INFINITE) ? NULL : &deadline);
+	}
+	return MSG_OK;
+}
+
+void shimNotify(void)
+{
+	pthread_cond_broadcast(&objectChanged);
+	notifyCount++;
+	nbWaiting = 0;
+}
+
+void shimCheckIdle(void)
+{
+	if(nbWaiting + nbHostBlocked + 1 >= nbThreads){
+		pthread_cond_broadcast(&idleChanged);
+	}
+}
+
+void shimAdvanceClock(void)
+{
+	uint64_t next 		= NO_DEADLINE;
+
+	for(uint8_t thread_counter = 0; thread_counter < nbThreads; thread_counter++){
+		if(threads[thread_counter].p_deadline < next){
+			next = threads[thread_counter].p_deadline;
+		}
+	}
+	if(next == NO_DEADLINE){
+		chSysHalt("virtual clock: all the threads wait without timeout");
+	}
+
+	if(next > virtualTicks){
+		virtualTicks = next;
+	}
+	if(clockHook != NULL){
+		clockHook((systime_t) virtualTicks, clockHookContext);
+	}
+	shimNotify();
+}
+
+void shimDeadline(systime_t ticks, ShimDeadline *deadline)
+{
+	uint64_t ns 		= (uint64_t) ticks*NS_PER_S/CH_CFG_ST_FREQUENCY;
+
+	deadline->ticks = virtualTicks + ticks;
+	clock_gettime(CLOCK_MONOTONIC, &deadline->real);
+	ns += (uint64_t) deadline->real.tv_nsec;
+	deadline->real.tv_sec += (time_t) (ns/NS_PER_S);
+	deadline->real.tv_nsec = (long) (ns%NS_PER_S);
+}
+
+bool shimSemIsReady(const void *object)
+{
+	return ((const semaphore_t *) object)->s_cnt > 0;
+}
+
+bool shimBSemIsReady(const void *object)
+{
+	return ((const binary_semaphore_t *) object)->taken == false;
+}
+
+bool shimMtxIsReady(const void *object)
+{
+	return ((const mutex_t *) object)->m_owner == NULL;
+}
+
+bool shimCondIsReady(const void *object)
+{
+	const struct {
+		const condition_variable_t *condvar;
+		uint32_t broadcasts;
+	} *wait = object;
+
+	return wait->condvar->c_broadcasts != wait->broadcasts;
+}
+
+bool shimMBCanPost(const void *object)
+{
+	const mailbox_t *mbp = object;
+
+	return mbp->mb_used < (cnt_t) (mbp->mb_top - mbp->mb_buffer);
+}
+
+bool shimMBCanFetch(const void *object)
+{
+	return ((const mailbox_t *) object)->mb_used > 0;
+}
+
+bool shimSerialInputIsReady(const void *object)
+{
+	(void) object;
+	return *serialInput != '\0';
+}
+
+void *shimThreadStart(void *arg)
+{
+	thread_t *tp = (thread_t *) arg;
+
+	pthread_mutex_lock(&token);
+	self = tp;
+	shimRunStart();
+	tp->p_function(tp->p_arg);
+	shimReleaseToken();
+	return NULL;
+}
+
+bool shimConvertFormat(const char *fmt, char *converted, size_t size)
+{
+	size_t length 		= 0;
+
+	while(*fmt != '\0'){
+		if(length + 2 >= size){
+			return false;
+		}
+		converted[length++] = *fmt;
+		if(*fmt++ != '%'){
+			continue;
+		}
+
+		//flags, width and precision are the same, the l modifier is dropped and D, U, X, O become d, u, x, o
+		while(*fmt != '\0' && strchr("-+ #0123456789.*", *fmt) != NULL && length + 2 < size){
+			converted[length++] = *fmt++;
+		}
+		if(*fmt == 'l'){
+			fmt++;
+		}
+		switch(*fmt){
+		case 'D':
+		case 'U':
+		case 'X':
+		case 'O':
+			converted[length++] = (char) (*fmt++ - 'A' + 'a');
+			break;
+		case 'I':
+			converted[length++] = 'd';
+			fmt++;
+			break;
+		case '\0':
+			break;
+		default:
+			converted[length++] = *fmt++;
+			break;
+		}
+	}
+	converted[length] = '\0';
+	return true;
+}
+
+static size_t serialWrite(void *instance, const uint8_t *bp, size_t n)
+{
+	const SerialDriver *sdp 	= (const SerialDriver *) instance;
+	size_t written 			= 0;
+	ssize_t result 			= 0;
+
+	shimReleaseToken();
+	while(written < n){
+		result = write(sdp->outFd, bp + written, n - written);
+		if(result <= 0 && errno != EINTR){
+			break;
+		}
+		written += (result > 0) ? (size_t) result : 0;
+	}
+	shimTakeToken();
+	return written;
+}
+
+static size_t serialRead(void *instance, uint8_t *bp, size_t n)
+{
+	size_t nbRead 			= 0;
+
+	while(nbRead < n){
+		bp[nbRead++] = (uint8_t) serialGet(instance);
+	}
+	return nbRead;
+}
+
+static msg_t serialPut(void *instance, uint8_t b)
+{
+	serialWrite(instance, &b, 1);
+	return MSG_OK;
+}
+
+static msg_t serialGet(void *instance)
+{
+	const SerialDriver *sdp 	= (const SerialDriver *) instance;
+	uint8_t byte 			= 0;
+	ssize_t result 			= 0;
+
+	//The input given by shim_setSerialInput is waited for as a kernel object, it may come later
+	if(serialInput != NULL){
+		shimBlock(shimSerialInputIsReady, NULL, TIME_INFINITE);
+		return (uint8_t) *serialInput++;
+	}
+
+	nbHostBlocked++;
+	shimCheckIdle();
+	shimReleaseToken();
+	do{
+		result = read(sdp->inFd, &byte, 1);
+	}while(result < 0 && errno == EINTR);
+	shimTakeToken();
+	nbHostBlocked--;
+
+	//At the end of the input nothing is received anymore, as on a silent serial link
+	while(result <= 0){
+		chThdSleep(TIME_INFINITE - 1);
+	}
+	return byte;
+}
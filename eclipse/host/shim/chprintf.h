@@ -0,0 +1,25 @@
+/*
+ * chprintf.h
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Host (Linux) stand-in for the ChibiOS formatted output. The formats are those of chprintf:
+ * 		the upper case conversions (%D, %U, %X) are 32 bits integers as on the robot, and they are converted
+ * 		to the printf ones before formatting. Implemented in chibiosShim.c.
+ */
+#ifndef CHPRINTF_H_
+#define CHPRINTF_H_
+
+#include <stdarg.h>
+
+#include <chstreams.h>
+
+int chvprintf(BaseSequentialStream *chp, const char *fmt, va_list ap);
+int chprintf(BaseSequentialStream *chp, const char *fmt, ...);
+int chvsnprintf(char *str, size_t size, const char *fmt, va_list ap);
+int chsnprintf(char *str, size_t size, const char *fmt, ...);
+
+
+#endif /* CHPRINTF_H_ */
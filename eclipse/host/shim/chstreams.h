@@ -0,0 +1,36 @@
+/*
+ * chstreams.h
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Host (Linux) stand-in for the ChibiOS sequential streams, the interface of the serial drivers.
+ */
+#ifndef CHSTREAMS_H_
+#define CHSTREAMS_H_
+
+#include <ch.h>
+
+/*===========================================================================*/
+/* Structures						 			                            */
+/*===========================================================================*/
+
+struct BaseSequentialStreamVMT {
+	size_t (*write)(void *instance, const uint8_t *bp, size_t n);
+	size_t (*read)(void *instance, uint8_t *bp, size_t n);
+	msg_t (*put)(void *instance, uint8_t b);
+	msg_t (*get)(void *instance);
+};
+
+typedef struct {
+	const struct BaseSequentialStreamVMT *vmt;
+} BaseSequentialStream;
+
+#define chSequentialStreamWrite(ip, bp, n)	((ip)->vmt->write(ip, bp, n))
+#define chSequentialStreamRead(ip, bp, n)	((ip)->vmt->read(ip, bp, n))
+#define chSequentialStreamPut(ip, b)			((ip)->vmt->put(ip, b))
+#define chSequentialStreamGet(ip)			((ip)->vmt->get(ip))
+
+
+#endif /* CHSTREAMS_H_ */
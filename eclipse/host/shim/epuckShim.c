@@ -0,0 +1,382 @@
+/*
+ * epuckShim.c
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Host (Linux) implementation of the e-puck2 library parts used by the firmware: motors,
+ * 		proximity and time of flight sensors, microphones, messagebus and memory protection. The sensors and
+ * 		microphones give what was set with the functions of hostShim.h. As the rest of the firmware, this
+ * 		code runs with the kernel token of chibiosShim.c, so it needs no other lock.
+ *
+ * Functions prefix for public functions in this file: e-puck2 library names, shim_
+ */
+
+#include <string.h>
+
+#include <ch.h>
+#include <hal.h>
+#include <motors.h>
+#include <memory_protection.h>
+#include <msgbus/messagebus.h>
+#include <sensors/proximity.h>
+#include <sensors/VL53L0X/VL53L0X.h>
+#include <audio/microphone.h>
+#include <hostShim.h>
+
+
+/*===========================================================================*/
+/* Constants definition for this file						               */
+/*===========================================================================*/
+
+#define MOTOR_RIGHT							0
+#define MOTOR_LEFT							1
+#define NB_MOTORS							2
+
+#define SHIM_WORKING_AREA_SIZE				256			//not used on the host
+
+
+/*===========================================================================*/
+/* Structures						 			                            */
+/*===========================================================================*/
+
+/*
+ * Stepper motor, the position is kept in steps*CH_CFG_ST_FREQUENCY to not lose the fractions of steps
+ */
+typedef struct ShimMotors {
+	int speed;
+	int64_t position;
+	systime_t lastUpdate;
+} ShimMotor;
+
+
+/*===========================================================================*/
+/* Static variables definitions 		 			                            */
+/*===========================================================================*/
+
+static ShimMotor motors[NB_MOTORS];
+
+static uint16_t tofMm 							= SHIM__TOF_DEFAULT_MM;
+static int proximity[SHIM__NB_PROXIMITY];
+
+static mic_callback_t micCallback 				= NULL;
+static shim_micSource micSource 					= NULL;
+static void *micSourceContext 					= NULL;
+
+//The proximity topic is advertised on the bus of the firmware, as the e-puck2 library does
+extern messagebus_t bus;
+static messagebus_topic_t proximityTopic;
+static MUTEX_DECL(proximityTopicLock);
+static CONDVAR_DECL(proximityTopicCondvar);
+static proximity_msg_t proximityTopicBuffer;
+
+
+/*===========================================================================*/
+/* Private functions definitions                                             */
+/*===========================================================================*/
+
+/**
+ * @brief   Advances the step counter of a motor up to now, at its current speed
+*/
+void shimMotorUpdate(ShimMotor *motor);
+
+/**
+ * @brief   Sets the speed of a motor, clamped to MOTOR_SPEED_LIMIT
+*/
+void shimMotorSetSpeed(ShimMotor *motor, int speed);
+
+/**
+ * @brief   Returns the topic of the bus with this name, NULL if there is none
+ * @note 	The lock of the bus must be held
+*/
+messagebus_topic_t *shimFindTopic(messagebus_t *bus, const char *name);
+
+
+/*===========================================================================*/
+/* Threads used in the shim                  									*/
+/*===========================================================================*/
+
+/* Microphones thread: as the processing thread of the e-puck2 library, calls the callback with new samples */
+static THD_WORKING_AREA(waMicThd, SHIM_WORKING_AREA_SIZE);
+static THD_FUNCTION(MicThd, arg)
+{
+	(void)arg;
+	chRegSetThreadName(__FUNCTION__);
+
+	static int16_t samples[SHIM__NB_MICS*SHIM__MIC_FRAMES];
+	systime_t time 			= chVTGetSystemTime();
+
+	while(true){
+		time += MS2ST(SHIM__MIC_PERIOD_MS);
+		chThdSleepUntil(time);
+
+		if(micSource != NULL){
+			micSource(samples, SHIM__MIC_FRAMES, micSourceContext);
+		}
+		else{
+			memset(samples, 0, sizeof(samples));
+		}
+		micCallback(samples, SHIM__NB_MICS*SHIM__MIC_FRAMES);
+	}
+}
+
+/* Proximity thread: publishes the values of the infrared sensors */
+static THD_WORKING_AREA(waProximityThd, SHIM_WORKING_AREA_SIZE);
+static THD_FUNCTION(ProximityThd, arg)
+{
+	(void)arg;
+	chRegSetThreadName(__FUNCTION__);
+
+	proximity_msg_t values;
+
+	memset(&values, 0, sizeof(values));
+	while(true){
+		for(uint8_t sensor_counter = 0; sensor_counter < SHIM__NB_PROXIMITY; sensor_counter++){
+			values.delta[sensor_counter] = (unsigned int) proximity[sensor_counter];
+		}
+		messagebus_topic_publish(&proximityTopic, &values, sizeof(values));
+		chThdSleepMilliseconds(SHIM__PROXIMITY_PERIOD_MS);
+	}
+}
+
+
+/*===========================================================================*/
+/* Environment of the robot, hostShim.h              							*/
+/*===========================================================================*/
+
+void shim_setMicSource(shim_micSource source, void *context)
+{
+	micSource = source;
+	micSourceContext = context;
+}
+
+void shim_setTofMm(uint16_t distanceMm)
+{
+	tofMm = distanceMm;
+}
+
+void shim_setProximity(uint8_t sensor, int value)
+{
+	if(sensor < SHIM__NB_PROXIMITY){
+		proximity[sensor] = value;
+	}
+}
+
+void shim_getMotorSpeeds(int *rightSpeed, int *leftSpeed)
+{
+	*rightSpeed = motors[MOTOR_RIGHT].speed;
+	*leftSpeed = motors[MOTOR_LEFT].speed;
+}
+
+
+/*===========================================================================*/
+/* e-puck2 library              												*/
+/*===========================================================================*/
+
+void mpu_init(void)
+{
+}
+
+void motors_init(void)
+{
+	memset(motors, 0, sizeof(motors));
+	motors[MOTOR_RIGHT].lastUpdate = chVTGetSystemTime();
+	motors[MOTOR_LEFT].lastUpdate = chVTGetSystemTime();
+}
+
+void left_motor_set_speed(int speed)
+{
+	shimMotorSetSpeed(&motors[MOTOR_LEFT], speed);
+}
+
+void right_motor_set_speed(int speed)
+{
+	shimMotorSetSpeed(&motors[MOTOR_RIGHT], speed);
+}
+
+int32_t left_motor_get_pos(void)
+{
+	shimMotorUpdate(&motors[MOTOR_LEFT]);
+	return (int32_t) (motors[MOTOR_LEFT].position/CH_CFG_ST_FREQUENCY);
+}
+
+int32_t right_motor_get_pos(void)
+{
+	shimMotorUpdate(&motors[MOTOR_RIGHT]);
+	return (int32_t) (motors[MOTOR_RIGHT].position/CH_CFG_ST_FREQUENCY);
+}
+
+void left_motor_set_pos(int32_t counter_value)
+{
+	shimMotorUpdate(&motors[MOTOR_LEFT]);
+	motors[MOTOR_LEFT].position = (int64_t) counter_value*CH_CFG_ST_FREQUENCY;
+}
+
+void right_motor_set_pos(int32_t counter_value)
+{
+	shimMotorUpdate(&motors[MOTOR_RIGHT]);
+	motors[MOTOR_RIGHT].position = (int64_t) counter_value*CH_CFG_ST_FREQUENCY;
+}
+
+void proximity_start(void)
+{
+	memset(&proximityTopicBuffer, 0, sizeof(proximityTopicBuffer));
+	messagebus_topic_init(&proximityTopic, &proximityTopicLock, &proximityTopicCondvar,
+			&proximityTopicBuffer, sizeof(proximityTopicBuffer));
+	messagebus_advertise_topic(&bus, &proximityTopic, "/proximity");
+	chThdCreateStatic(waProximityThd, sizeof(waProximityThd), NORMALPRIO, ProximityThd, NULL);
+}
+
+void calibrate_ir(void)
+{
+}
+
+int get_prox(unsigned int sensor_number)
+{
+	return (sensor_number < SHIM__NB_PROXIMITY) ? proximity[sensor_number] : 0;
+}
+
+int get_calibrated_prox(unsigned int sensor_number)
+{
+	return get_prox(sensor_number);
+}
+
+int get_ambient_light(unsigned int sensor_number)
+{
+	(void) sensor_number;
+	return 0;
+}
+
+void VL53L0X_start(void)
+{
+}
+
+void VL53L0X_stop(void)
+{
+}
+
+uint16_t VL53L0X_get_dist_mm(void)
+{
+	return tofMm;
+}
+
+void mic_start(mic_callback_t customFullbufferCb)
+{
+	micCallback = customFullbufferCb;
+	chThdCreateStatic(waMicThd, sizeof(waMicThd), NORMALPRIO, MicThd, NULL);
+}
+
+void messagebus_init(messagebus_t *bus, void *lock, void *condvar)
+{
+	bus->head = NULL;
+	bus->lock = lock;
+	bus->condvar = condvar;
+}
+
+void messagebus_topic_init(messagebus_topic_t *topic, void *topic_lock, void *topic_condvar,
+		void *buffer, size_t buffer_len)
+{
+	memset(topic, 0, sizeof(messagebus_topic_t));
+	topic->buffer = buffer;
+	topic->buffer_len = buffer_len;
+	topic->lock = topic_lock;
+	topic->condvar = topic_condvar;
+}
+
+void messagebus_advertise_topic(messagebus_t *bus, messagebus_topic_t *topic, const char *name)
+{
+	chMtxLock(bus->lock);
+	strncpy(topic->name, name, TOPIC_NAME_MAX_LENGTH);
+	topic->next = bus->head;
+	bus->head = topic;
+	chCondBroadcast(bus->condvar);
+	chMtxUnlock(bus->lock);
+}
+
+messagebus_topic_t *messagebus_find_topic(messagebus_t *bus, const char *name)
+{
+	messagebus_topic_t *topic = NULL;
+
+	chMtxLock(bus->lock);
+	topic = shimFindTopic(bus, name);
+	chMtxUnlock(bus->lock);
+	return topic;
+}
+
+messagebus_topic_t *messagebus_find_topic_blocking(messagebus_t *bus, const char *name)
+{
+	messagebus_topic_t *topic = NULL;
+
+	chMtxLock(bus->lock);
+	while((topic = shimFindTopic(bus, name)) == NULL){
+		chCondWait(bus->condvar);
+	}
+	chMtxUnlock(bus->lock);
+	return topic;
+}
+
+void messagebus_topic_publish(messagebus_topic_t *topic, void *buf, size_t buf_len)
+{
+	chMtxLock(topic->lock);
+	memcpy(topic->buffer, buf, (buf_len < topic->buffer_len) ? buf_len : topic->buffer_len);
+	topic->published = true;
+	chCondBroadcast(topic->condvar);
+	chMtxUnlock(topic->lock);
+}
+
+bool messagebus_topic_read(messagebus_topic_t *topic, void *buf, size_t buf_len)
+{
+	bool published 		= false;
+
+	chMtxLock(topic->lock);
+	published = topic->published;
+	if(published){
+		memcpy(buf, topic->buffer, (buf_len < topic->buffer_len) ? buf_len : topic->buffer_len);
+	}
+	chMtxUnlock(topic->lock);
+	return published;
+}
+
+void messagebus_topic_wait(messagebus_topic_t *topic, void *buf, size_t buf_len)
+{
+	chMtxLock(topic->lock);
+	chCondWait(topic->condvar);
+	memcpy(buf, topic->buffer, (buf_len < topic->buffer_len) ? buf_len : topic->buffer_len);
+	chMtxUnlock(topic->lock);
+}
+
+
+/*===========================================================================*/
+/* Private functions	 code												   */
+/*===========================================================================*/
+
+void shimMotorUpdate(ShimMotor *motor)
+{
+	systime_t now 		= chVTGetSystemTime();
+
+	motor->position += (int64_t) motor->speed*(systime_t) (now - motor->lastUpdate);
+	motor->lastUpdate = now;
+}
+
+void shimMotorSetSpeed(ShimMotor *motor, int speed)
+{
+	shimMotorUpdate(motor);
+	if(speed > MOTOR_SPEED_LIMIT){
+		speed = MOTOR_SPEED_LIMIT;
+	}
+	else if(speed < -MOTOR_SPEED_LIMIT){
+		speed = -MOTOR_SPEED_LIMIT;
+	}
+	motor->speed = speed;
+}
+
+messagebus_topic_t *shimFindTopic(messagebus_t *bus, const char *name)
+{
+	messagebus_topic_t *topic = bus->head;
+
+	while(topic != NULL && strncmp(topic->name, name, TOPIC_NAME_MAX_LENGTH) != 0){
+		topic = topic->next;
+	}
+	return topic;
+}
@@ -0,0 +1,71 @@
+/*
+ * hal.h
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Host (Linux) stand-in for the ChibiOS HAL used by the firmware: the serial driver SD3 reads
+ * 		the standard input and writes the standard output, and the pads of the LEDs only keep their state
+ * 		(see shim_getPad). Implemented in chibiosShim.c.
+ */
+#ifndef HAL_H_
+#define HAL_H_
+
+#include <ch.h>
+#include <chstreams.h>
+
+/*===========================================================================*/
+/* Serial driver						 			                        */
+/*===========================================================================*/
+
+typedef struct {
+	uint32_t speed;
+	uint16_t cr1;
+	uint16_t cr2;
+	uint16_t cr3;
+} SerialConfig;
+
+typedef struct {
+	const struct BaseSequentialStreamVMT *vmt;			//first, so that it can be used as a BaseSequentialStream
+	int inFd;
+	int outFd;
+} SerialDriver;
+
+extern SerialDriver SD3;
+
+void sdStart(SerialDriver *sdp, const SerialConfig *config);
+void sdStop(SerialDriver *sdp);
+size_t sdWrite(SerialDriver *sdp, const uint8_t *bp, size_t n);
+msg_t sdGet(SerialDriver *sdp);
+
+
+/*===========================================================================*/
+/* Pads of the e-puck2 board						 			               */
+/*===========================================================================*/
+
+typedef uint32_t ioportid_t;
+
+#define GPIOB								1
+#define GPIOD								3
+#define GPIOB_LED_BODY						2
+#define GPIOD_LED1							5
+#define GPIOD_LED3							6
+#define GPIOD_LED5							10
+#define GPIOD_LED7							11
+#define GPIOD_LED_FRONT						14
+
+void palSetPad(ioportid_t port, uint8_t pad);
+void palClearPad(ioportid_t port, uint8_t pad);
+void palTogglePad(ioportid_t port, uint8_t pad);
+uint8_t palReadPad(ioportid_t port, uint8_t pad);
+
+
+/*===========================================================================*/
+/* Initialisation						 			                        */
+/*===========================================================================*/
+
+void halInit(void);
+
+
+#endif /* HAL_H_ */
@@ -0,0 +1,122 @@
+/*
+ * hostShim.h
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Environment of the firmware built for the host (Linux), in place of the world around the
+ * 		robot: what the microphones hear, what the distance sensors see, and what the motors and LEDs do.
+ * 		The firmware itself only uses the ChibiOS and e-puck2 library headers of this folder.
+ * Function prefix for public functions in this file: shim_
+ * Constant prefix for public constants in this file: SHIM__
+ */
+#ifndef HOSTSHIM_H_
+#define HOSTSHIM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <hal.h>
+
+/*===========================================================================*/
+/* Constants definition for this library						               */
+/*===========================================================================*/
+
+//Microphones, as the e-puck2
+#define SHIM__MIC_SAMPLING_HZ				16000
+#define SHIM__MIC_PERIOD_MS					10			//the callback of mic_start is called at this period
+#define SHIM__MIC_FRAMES						160			//samples of each microphone per callback
+#define SHIM__NB_MICS						4			//interleaved right, left, back, front
+
+//Distance sensors
+#define SHIM__NB_PROXIMITY					8
+#define SHIM__PROXIMITY_PERIOD_MS			10			//the "/proximity" topic is published at this period
+#define SHIM__TOF_DEFAULT_MM					2000			//nothing in front of the robot
+
+
+/*===========================================================================*/
+/* Structures						 			                            */
+/*===========================================================================*/
+
+/*
+ * @brief	Fills the samples of the microphones for the next callback
+ *
+ *  @param[out] samples		SHIM__NB_MICS*nbFrames samples, interleaved right, left, back, front
+ *  @param[in] nbFrames		samples of each microphone
+ *  @param[in] context		given to shim_setMicSource
+ */
+typedef void (*shim_micSource)(int16_t *samples, uint16_t nbFrames, void *context);
+
+/*
+ * @brief	Called each time the virtual clock moved, by the thread which moved it, before the waiting threads
+ * 			are woken up. The environment of the robot can be updated there with the functions of this file.
+ *
+ *  @param[in] now			new time of the clock, as chVTGetSystemTime
+ *  @param[in] context		given to shim_useVirtualClock
+ */
+typedef void (*shim_clockHook)(systime_t now, void *context);
+
+
+/*===========================================================================*/
+/* Public functions definitions            									 */
+/*===========================================================================*/
+
+/*
+ * @brief	Sets what the microphones hear, silence by default
+ *
+ *  @param[in] source		called by the microphone thread, NULL for silence
+ *  @param[in] context		given to source
+ */
+void shim_setMicSource(shim_micSource source, void *context);
+
+/*
+ * @brief	Sets the distance measured by the time of flight sensor, SHIM__TOF_DEFAULT_MM by default
+ */
+void shim_setTofMm(uint16_t distanceMm);
+
+/*
+ * @brief	Sets the calibrated value of an infrared proximity sensor, 0 (nothing close) by default
+ *
+ *  @param[in] sensor		0 to SHIM__NB_PROXIMITY-1, in the order of the e-puck2 library
+ *  @param[in] value		as returned by get_calibrated_prox
+ */
+void shim_setProximity(uint8_t sensor, int value);
+
+/*
+ * @brief	Returns the speeds last set on the motors, in steps/s
+ */
+void shim_getMotorSpeeds(int *rightSpeed, int *leftSpeed);
+
+/*
+ * @brief	Returns the state of a pad set with palSetPad, palClearPad and palTogglePad
+ */
+bool shim_getPad(ioportid_t port, uint8_t pad);
+
+/*
+ * @brief	Waits until all the other threads wait on a kernel object, sleep or wait for the serial input
+ * @note 	The firmware has then processed everything given to it, e.g. a test driver can give the next input.
+ * 			The caller must be a thread of the firmware (created by chThdCreateStatic or the main thread).
+ */
+void shim_waitIdle(void);
+
+/*
+ * @brief	Uses a virtual clock instead of the clock of the host, to be called before chSysInit
+ * @note 	The clock only moves when all the threads wait, to the first time one of them waits for: the firmware
+ * 			runs as fast as the host computes, and sees no time pass while it computes. A thread must never
+ * 			poll the time without waiting.
+ *
+ *  @param[in] hook			called each time the clock moved, NULL for none
+ *  @param[in] context		given to hook
+ */
+void shim_useVirtualClock(shim_clockHook hook, void *context);
+
+/*
+ * @brief	Gives the next characters received on the serial link, instead of the input file
+ * @note 	The text is not copied, it must stay valid until it was read. Once read, the link stays silent
+ * 			until the next call.
+ */
+void shim_setSerialInput(const char *text);
+
+
+#endif /* HOSTSHIM_H_ */
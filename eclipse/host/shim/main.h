@@ -0,0 +1,15 @@
+/*
+ * main.h
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: fft.c includes main.h, which only exists in the build environment of the robot.
+ * 		Nothing from it is used.
+ */
+#ifndef MAIN_H_
+#define MAIN_H_
+
+
+#endif /* MAIN_H_ */
@@ -0,0 +1,17 @@
+/*
+ * memory_protection.h
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Host (Linux) stand-in for the memory protection of the e-puck2 library, the host
+ * 		already protects the memory. Implemented in epuckShim.c.
+ */
+#ifndef MEMORY_PROTECTION_H_
+#define MEMORY_PROTECTION_H_
+
+void mpu_init(void);
+
+
+#endif /* MEMORY_PROTECTION_H_ */
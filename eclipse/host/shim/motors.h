@@ -0,0 +1,27 @@
+/*
+ * motors.h
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Host (Linux) stand-in for the stepper motors of the e-puck2 library. The step counters
+ * 		advance with the speed set and the time of ch.h. Implemented in epuckShim.c.
+ */
+#ifndef MOTORS_H_
+#define MOTORS_H_
+
+#include <stdint.h>
+
+#define MOTOR_SPEED_LIMIT					1100			//in steps/s, faster speeds are clamped
+
+void motors_init(void);
+void left_motor_set_speed(int speed);
+void right_motor_set_speed(int speed);
+int32_t left_motor_get_pos(void);
+int32_t right_motor_get_pos(void);
+void left_motor_set_pos(int32_t counter_value);
+void right_motor_set_pos(int32_t counter_value);
+
+
+#endif /* MOTORS_H_ */
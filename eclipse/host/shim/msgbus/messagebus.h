@@ -0,0 +1,45 @@
+/*
+ * messagebus.h
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Host (Linux) stand-in for the messagebus of the e-puck2 library, with the same topics,
+ * 		locks and condition variables, on the kernel objects of ch.h. Implemented in epuckShim.c.
+ */
+#ifndef MESSAGEBUS_H_
+#define MESSAGEBUS_H_
+
+#include <ch.h>
+
+#define TOPIC_NAME_MAX_LENGTH				64
+
+typedef struct topic_s {
+	void *buffer;
+	size_t buffer_len;
+	void *lock;							//mutex_t
+	void *condvar;						//condition_variable_t
+	char name[TOPIC_NAME_MAX_LENGTH + 1];
+	bool published;
+	struct topic_s *next;
+} messagebus_topic_t;
+
+typedef struct {
+	messagebus_topic_t *head;
+	void *lock;
+	void *condvar;
+} messagebus_t;
+
+void messagebus_init(messagebus_t *bus, void *lock, void *condvar);
+void messagebus_topic_init(messagebus_topic_t *topic, void *topic_lock, void *topic_condvar,
+		void *buffer, size_t buffer_len);
+void messagebus_advertise_topic(messagebus_t *bus, messagebus_topic_t *topic, const char *name);
+messagebus_topic_t *messagebus_find_topic(messagebus_t *bus, const char *name);
+messagebus_topic_t *messagebus_find_topic_blocking(messagebus_t *bus, const char *name);
+void messagebus_topic_publish(messagebus_topic_t *topic, void *buf, size_t buf_len);
+bool messagebus_topic_read(messagebus_topic_t *topic, void *buf, size_t buf_len);
+void messagebus_topic_wait(messagebus_topic_t *topic, void *buf, size_t buf_len);
+
+
+#endif /* MESSAGEBUS_H_ */
@@ -0,0 +1,21 @@
+/*
+ * VL53L0X.h
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Host (Linux) stand-in for the time of flight sensor of the e-puck2 library, it returns the
+ * 		distance set with shim_setTofMm. Implemented in epuckShim.c.
+ */
+#ifndef VL53L0X_H_
+#define VL53L0X_H_
+
+#include <stdint.h>
+
+void VL53L0X_start(void);
+void VL53L0X_stop(void);
+uint16_t VL53L0X_get_dist_mm(void);
+
+
+#endif /* VL53L0X_H_ */
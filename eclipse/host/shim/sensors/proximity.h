@@ -0,0 +1,30 @@
+/*
+ * proximity.h
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Host (Linux) stand-in for the infrared proximity sensors of the e-puck2 library. A thread
+ * 		publishes the values set with shim_setProximity on the "/proximity" topic. Implemented in epuckShim.c.
+ */
+#ifndef PROXIMITY_H_
+#define PROXIMITY_H_
+
+#define PROXIMITY_NB_CHANNELS				8
+
+typedef struct {
+	unsigned int ambient[PROXIMITY_NB_CHANNELS];
+	unsigned int reflected[PROXIMITY_NB_CHANNELS];
+	unsigned int delta[PROXIMITY_NB_CHANNELS];
+	unsigned int initValue[PROXIMITY_NB_CHANNELS];
+} proximity_msg_t;
+
+void proximity_start(void);
+void calibrate_ir(void);
+int get_prox(unsigned int sensor_number);
+int get_calibrated_prox(unsigned int sensor_number);
+int get_ambient_light(unsigned int sensor_number);
+
+
+#endif /* PROXIMITY_H_ */
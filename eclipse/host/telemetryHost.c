@@ -0,0 +1,346 @@
+/*
+ * telemetryHost.c
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Host (Linux) side of the binary telemetry: serial link, stream decoding and CSV formatting.
+ *
+ * Functions prefix for public functions in this file: telemHost_
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <telemetryHost.h>
+
+
+/*===========================================================================*/
+/* Constants definition for this file						               */
+/*===========================================================================*/
+
+#define READ_BUFFER_SIZE						4096
+#define SEQUENCE_MODULO						65536UL
+
+//Payload sizes, see telemetryFrame.h
+#define SPECTRUM_HEADER_SIZE					7
+#define SOURCES_HEADER_SIZE					5
+#define SOURCE_SIZE							6
+#define DESTINATION_SIZE						13
+#define CONTROLLER_SIZE						17
+#define SENSORS_SIZE							25
+#define NB_IR								8
+#define BAND_HEADER_SIZE						10
+#define BAND_PEAK_SIZE						3
+#define AUDIO_FRAME_SIZE						(4*sizeof(int16_t))	//one sample of each microphone
+
+
+/*===========================================================================*/
+/* Public functions for setting/getting internal parameters					  */
+/* Descriptions  are only in the header file (to have a single source of truth) */
+/*===========================================================================*/
+
+int telemHost_openSerial(const char *path)
+{
+	struct termios options;
+	int fd = open(path, O_RDONLY | O_NOCTTY);
+
+	if(fd < 0 || isatty(fd) == 0){
+		return fd;
+	}
+
+	if(tcgetattr(fd, &options) != 0){
+		close(fd);
+		return -1;
+	}
+	cfmakeraw(&options);
+	cfsetispeed(&options, B115200);
+	cfsetospeed(&options, B115200);
+	options.c_cc[VMIN] = 1;
+	options.c_cc[VTIME] = 0;
+	if(tcsetattr(fd, TCSANOW, &options) != 0){
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+bool telemHost_decodeStream(int fd, telemHost_frameCallback onFrame, telemHost_textCallback onText,
+		void *context, TelemHostStat *stats)
+{
+	static TelemDecoder decoder;
+	static TelemFrame frame;
+	uint8_t buffer[READ_BUFFER_SIZE];
+	ssize_t size = 0;
+	bool sequenceKnown = false;
+	uint16_t nextSequence = 0;
+	uint8_t result = TELEM__DECODE_NONE;
+
+	*stats = (TelemHostStat) {0};
+	telem_DecoderInit(&decoder);
+
+	while(true){
+		size = read(fd, buffer, sizeof(buffer));
+		if(size < 0 && errno == EINTR){
+			continue;
+		}
+		//a pseudo terminal whose other side is closed reports EIO, it is the end of the stream as well
+		if(size <= 0){
+			if(telem_DecoderFlush(&decoder) == TELEM__DECODE_TEXT && onText != NULL){
+				stats->textBytes += decoder.textLength;
+				onText(decoder.buffer, decoder.textLength, context);
+			}
+			stats->crcErrors = decoder.crcErrors;
+			stats->overflows = decoder.overflows;
+			return size == 0 || errno == EIO;
+		}
+
+		for(ssize_t i = 0; i < size; i++){
+			result = telem_DecoderPush(&decoder, buffer[i], &frame);
+			if(result == TELEM__DECODE_FRAME){
+				if(sequenceKnown){
+					stats->lostFrames += (uint16_t) (frame.sequence - nextSequence);
+				}
+				sequenceKnown = true;
+				nextSequence = (uint16_t) ((frame.sequence + 1) % SEQUENCE_MODULO);
+				stats->frames++;
+				if(onFrame != NULL){
+					onFrame(&frame, context);
+				}
+			}
+			else if(result == TELEM__DECODE_TEXT){
+				stats->textBytes += decoder.textLength;
+				if(onText != NULL){
+					onText(decoder.buffer, decoder.textLength, context);
+				}
+			}
+		}
+	}
+}
+
+const char *telemHost_typeName(uint8_t type)
+{
+	switch(type){
+	case TELEM__MSG_SPECTRUM:
+		return "spectrum";
+	case TELEM__MSG_SOURCES:
+		return "sources";
+	case TELEM__MSG_DESTINATION:
+		return "destination";
+	case TELEM__MSG_CONTROLLER:
+		return "controller";
+	case TELEM__MSG_SENSORS:
+		return "sensors";
+	case TELEM__MSG_BAND:
+		return "band";
+	case TELEM__MSG_AUDIO:
+		return "audio";
+	default:
+		return NULL;
+	}
+}
+
+void telemHost_writeCsvHeader(uint8_t type, FILE *csv)
+{
+	switch(type){
+	case TELEM__MSG_SPECTRUM:
+		fprintf(csv, "sequence,frame_time,first_bin,nb_bins,magnitudes...\n");
+		break;
+	case TELEM__MSG_SOURCES:
+		fprintf(csv, "sequence,frame_time,index,freq,ampli\n");
+		break;
+	case TELEM__MSG_DESTINATION:
+		fprintf(csv, "sequence,frame_time,freq,angle,valid,ampli\n");
+		break;
+	case TELEM__MSG_CONTROLLER:
+		fprintf(csv, "sequence,time,mode,moving,avoid_state,dest_angle,heading,right_speed,left_speed\n");
+		break;
+	case TELEM__MSG_SENSORS:
+		fprintf(csv, "sequence,time,tof_mm,ir1,ir2,ir3,ir4,ir5,ir6,ir7,ir8,obstacle_near,obstacle_bearing\n");
+		break;
+	case TELEM__MSG_BAND:
+		fprintf(csv, "sequence,frame_time,first_bin,nb_bins,peaks(bin:angle),levels(1/8 octave)...\n");
+		break;
+	case TELEM__MSG_AUDIO:
+		fprintf(csv, "sequence,block_time,block_index,block_frames,chunk,nb_chunks\n");
+		break;
+	default:
+		break;
+	}
+}
+
+bool telemHost_decodeBand(const TelemFrame *frame, TelemHostBand *band)
+{
+	const uint8_t *read = frame->payload;
+	uint8_t index = 0;
+	uint8_t flags = 0;
+	uint16_t angle = 0;
+
+	if(frame->type != TELEM__MSG_BAND || frame->size < BAND_HEADER_SIZE){
+		return false;
+	}
+	read = telem_GetU32(read, &band->frameTime);
+	read = telem_GetU8(read, &index);
+	read = telem_GetU8(read, &flags);
+	read = telem_GetU16(read, &band->firstBin);
+	read = telem_GetU8(read, &band->nbBins);
+	read = telem_GetU8(read, &band->nbPeaks);
+	if(frame->size < BAND_HEADER_SIZE + band->nbPeaks*BAND_PEAK_SIZE){
+		band->valid = false;
+		return false;
+	}
+	for(uint8_t i = 0; i < band->nbPeaks; i++){
+		read = telem_GetU8(read, &band->peakBin[i]);
+		read = telem_GetU16(read, &angle);
+		band->peakAngle[i] = (int16_t) angle;
+	}
+
+	//Differences only apply to the band frame right before, otherwise wait for a key frame
+	if(flags & TELEM__BAND_KEY_FRAME){
+		memset(band->values, 0, sizeof(band->values));
+	}
+	else if(band->valid == false || index != band->nextIndex){
+		band->valid = false;
+		return false;
+	}
+	band->nextIndex = (uint8_t) (index + 1);
+	band->valid = telem_DecodeBand(read, frame->size - (size_t) (read - frame->payload), band->values, band->nbBins);
+	return band->valid;
+}
+
+bool telemHost_writeCsv(const TelemFrame *frame, FILE *csv)
+{
+	static TelemHostBand band;
+	const uint8_t *read = frame->payload;
+	uint32_t time = 0;
+	uint32_t value32 = 0;
+	uint16_t value16 = 0;
+	uint16_t value16b = 0;
+	uint8_t value8 = 0;
+	uint8_t count = 0;
+	float valueF = 0;
+
+	switch(frame->type){
+	case TELEM__MSG_SPECTRUM:
+		if(frame->size < SPECTRUM_HEADER_SIZE){
+			return false;
+		}
+		read = telem_GetU32(read, &time);
+		read = telem_GetU16(read, &value16);
+		read = telem_GetU8(read, &count);
+		if(frame->size != SPECTRUM_HEADER_SIZE + count*sizeof(uint16_t)){
+			return false;
+		}
+		fprintf(csv, "%u,%u,%u,%u", frame->sequence, time, value16, count);
+		for(uint8_t i = 0; i < count; i++){
+			read = telem_GetU16(read, &value16);
+			fprintf(csv, ",%u", value16);
+		}
+		fprintf(csv, "\n");
+		return true;
+
+	case TELEM__MSG_SOURCES:
+		if(frame->size < SOURCES_HEADER_SIZE){
+			return false;
+		}
+		read = telem_GetU32(read, &time);
+		read = telem_GetU8(read, &count);
+		if(frame->size != SOURCES_HEADER_SIZE + count*SOURCE_SIZE){
+			return false;
+		}
+		for(uint8_t i = 0; i < count; i++){
+			read = telem_GetU16(read, &value16);
+			read = telem_GetF32(read, &valueF);
+			fprintf(csv, "%u,%u,%u,%u,%.1f\n", frame->sequence, time, i, value16, (double) valueF);
+		}
+		return true;
+
+	case TELEM__MSG_DESTINATION:
+		if(frame->size != DESTINATION_SIZE){
+			return false;
+		}
+		read = telem_GetU32(read, &time);
+		read = telem_GetU16(read, &value16);
+		read = telem_GetU16(read, &value16b);
+		read = telem_GetU8(read, &value8);
+		read = telem_GetF32(read, &valueF);
+		fprintf(csv, "%u,%u,%u,%d,%u,%.1f\n", frame->sequence, time, value16, (int16_t) value16b, value8, (double) valueF);
+		return true;
+
+	case TELEM__MSG_CONTROLLER:
+		if(frame->size != CONTROLLER_SIZE){
+			return false;
+		}
+		read = telem_GetU32(read, &time);
+		fprintf(csv, "%u,%u", frame->sequence, time);
+		for(uint8_t i = 0; i < 3; i++){
+			read = telem_GetU8(read, &value8);
+			fprintf(csv, ",%u", value8);
+		}
+		read = telem_GetU16(read, &value16);
+		read = telem_GetF32(read, &valueF);
+		fprintf(csv, ",%d,%.2f", (int16_t) value16, (double) valueF);
+		read = telem_GetU16(read, &value16);
+		read = telem_GetU16(read, &value16b);
+		fprintf(csv, ",%d,%d\n", (int16_t) value16, (int16_t) value16b);
+		return true;
+
+	case TELEM__MSG_SENSORS:
+		if(frame->size != SENSORS_SIZE){
+			return false;
+		}
+		read = telem_GetU32(read, &time);
+		read = telem_GetU16(read, &value16);
+		fprintf(csv, "%u,%u,%u", frame->sequence, time, value16);
+		for(uint8_t i = 0; i < NB_IR; i++){
+			read = telem_GetU16(read, &value16);
+			fprintf(csv, ",%d", (int16_t) value16);
+		}
+		read = telem_GetU8(read, &value8);
+		read = telem_GetU16(read, &value16);
+		fprintf(csv, ",%u,%d\n", value8, (int16_t) value16);
+		return true;
+
+	case TELEM__MSG_BAND:
+		if(telemHost_decodeBand(frame, &band) == false){
+			return false;
+		}
+		fprintf(csv, "%u,%u,%u,%u,", frame->sequence, band.frameTime, band.firstBin, band.nbBins);
+		for(uint8_t i = 0; i < band.nbPeaks; i++){
+			if(band.peakAngle[i] == TELEM__ANGLE_UNKNOWN){
+				fprintf(csv, "%s%u:", i ? ";" : "", band.peakBin[i]);
+			}
+			else{
+				fprintf(csv, "%s%u:%d", i ? ";" : "", band.peakBin[i], band.peakAngle[i]);
+			}
+		}
+		for(uint8_t i = 0; i < band.nbBins; i++){
+			fprintf(csv, ",%u", band.values[i]);
+		}
+		fprintf(csv, "\n");
+		return true;
+
+	case TELEM__MSG_AUDIO:
+		//the samples are written in a capture file (captureFile.h), not in the CSV
+		if(frame->size < TELEM__AUDIO_HEADER_SIZE){
+			return false;
+		}
+		read = telem_GetU32(read, &time);
+		read = telem_GetU32(read, &value32);
+		read = telem_GetU16(read, &value16);
+		read = telem_GetU8(read, &value8);
+		read = telem_GetU8(read, &count);
+		if(count == 0 || value16 % count != 0 || frame->size != TELEM__AUDIO_HEADER_SIZE + (value16/count)*AUDIO_FRAME_SIZE){
+			return false;
+		}
+		fprintf(csv, "%u,%u,%u,%u,%u,%u\n", frame->sequence, time, value32, value16, value8, count);
+		return true;
+
+	default:
+		return false;
+	}
+}
@@ -0,0 +1,104 @@
+/*
+ * telemetryHost.h
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Host (Linux) side of the binary telemetry: opens the serial link, decodes the stream
+ * 		of frames and text with telemetryFrame.c, and formats the payloads as CSV.
+ * Function prefix for public functions in this file: telemHost_
+ */
+#ifndef TELEMETRYHOST_H_
+#define TELEMETRYHOST_H_
+
+#include <stdio.h>
+
+#include <telemetryFrame.h>
+
+/*===========================================================================*/
+/* Structures						 			                            */
+/*===========================================================================*/
+
+/*
+ * Counters of a decoded stream
+ */
+typedef struct TelemHostStats {
+	uint32_t frames;
+	uint32_t lostFrames;				//from the gaps in the sequence numbers
+	uint32_t crcErrors;
+	uint32_t overflows;
+	uint32_t textBytes;
+} TelemHostStat;
+
+/*
+ * Band of TELEM__MSG_BAND frames, decoded against the previous band frame
+ */
+typedef struct TelemHostBands {
+	bool valid;							//false until a key frame is received, and after a band frame is missed
+	uint8_t nextIndex;
+	uint32_t frameTime;
+	uint16_t firstBin;
+	uint8_t nbBins;
+	uint8_t values[UINT8_MAX];			//TELEM__BAND_STEPS_PER_OCTAVE*log2(magnitude)
+	uint8_t nbPeaks;
+	uint8_t peakBin[UINT8_MAX];			//from firstBin
+	int16_t peakAngle[UINT8_MAX];		//TELEM__ANGLE_UNKNOWN if there is no angle in this frame
+} TelemHostBand;
+
+typedef void (*telemHost_frameCallback)(const TelemFrame *frame, void *context);
+typedef void (*telemHost_textCallback)(const uint8_t *text, size_t size, void *context);
+
+
+/*===========================================================================*/
+/* Public functions definitions            									 */
+/*===========================================================================*/
+
+/*
+ * @brief	Opens a serial device in raw mode at 115200 baud, or any other file (a log, a pipe) as it is
+ *
+ * @return	file descriptor, -1 on error (errno is set)
+ */
+int telemHost_openSerial(const char *path);
+
+/*
+ * @brief	Reads and decodes fd until the end of the stream, calling the callbacks for each frame and text
+ *
+ *  @param[in] fd			stream to read
+ *  @param[in] onFrame		called for each valid frame, can be NULL
+ *  @param[in] onText		called for the text between frames, can be NULL
+ *  @param[in] context		given back to the callbacks
+ *  @param[out] stats		counters of the stream
+ *
+ * @return	true if the stream ended normally, false on a read error
+ */
+bool telemHost_decodeStream(int fd, telemHost_frameCallback onFrame, telemHost_textCallback onText,
+		void *context, TelemHostStat *stats);
+
+/*
+ * @brief	Returns the name of a message type, used to name its CSV file, NULL for unknown types
+ */
+const char *telemHost_typeName(uint8_t type);
+
+/*
+ * @brief	Writes the CSV header line of a message type
+ */
+void telemHost_writeCsvHeader(uint8_t type, FILE *csv);
+
+/*
+ * @brief	Decodes a TELEM__MSG_BAND frame into band, which must hold the previous band (zeros at start)
+ *
+ * @return	true if band holds the values of this frame, false if a key frame is needed first or the payload is wrong
+ */
+bool telemHost_decodeBand(const TelemFrame *frame, TelemHostBand *band);
+
+/*
+ * @brief	Writes a frame as CSV line(s), sources are written one line per source
+ * @note 	Band frames are decoded against the previous band frame given to this function
+ *
+ * @return	false if the payload does not match its type (or the band can not be decoded yet)
+ */
+bool telemHost_writeCsv(const TelemFrame *frame, FILE *csv);
+
+
+#endif /* TELEMETRYHOST_H_ */
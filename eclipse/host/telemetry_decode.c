@@ -0,0 +1,198 @@
+/*
+ * telemetry_decode.c
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Command line tool that decodes the telemetry of the robot from the serial link (or a recorded file)
+ * 		into one CSV file per message type, and optionally a binary log of the decoded frames.
+ * 		The text output of the robot is printed on stdout.
+ *
+ * 		usage: telemetry_decode [-o prefix] [-b] [-c capture] <device|file|->
+ * 			-o prefix	CSV files are prefix_<type>.csv (default "telemetry")
+ * 			-b			also writes prefix.bin, one record per frame: u8 type, u16 sequence, u16 size, payload
+ * 			-c capture	also assembles the audio frames (micCapture.h) into a capture file for capture_replay
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <telemetryHost.h>
+#include <captureFile.h>
+
+
+/*===========================================================================*/
+/* Constants definition for this file						               */
+/*===========================================================================*/
+
+#define DEFAULT_PREFIX						"telemetry"
+#define PATH_SIZE							512
+
+#define USAGE								"usage: %s [-o prefix] [-b] [-c capture] <device|file|->\n"
+
+
+/*===========================================================================*/
+/* Structures						 			                            */
+/*===========================================================================*/
+
+/*
+ * Output files, each CSV file is only created when its first frame arrives
+ */
+typedef struct Outputs {
+	const char *prefix;
+	FILE *csv[TELEM__NB_MSG_TYPES];
+	FILE *binary;
+	CapFile *capture;
+	uint32_t badPayloads;
+} Output;
+
+
+/*===========================================================================*/
+/* Private functions definitions                                             */
+/*===========================================================================*/
+
+/**
+ * @brief   Writes a decoded frame into its CSV file and the binary log
+*/
+void decodeOnFrame(const TelemFrame *frame, void *context);
+
+/**
+ * @brief   Prints the text received between frames
+*/
+void decodeOnText(const uint8_t *text, size_t size, void *context);
+
+
+/*===========================================================================*/
+/* Main					 										            */
+/*===========================================================================*/
+
+int main(int argc, char *argv[])
+{
+	static CapFile capture;
+	CapFileHeader captureHeader;
+	Output output = {DEFAULT_PREFIX, {NULL}, NULL, NULL, 0};
+	const char *capturePath = NULL;
+	TelemHostStat stats;
+	char path[PATH_SIZE];
+	bool binary = false;
+	int option = 0;
+	int fd = 0;
+
+	while((option = getopt(argc, argv, "o:bc:")) != -1){
+		switch(option){
+		case 'o':
+			output.prefix = optarg;
+			break;
+		case 'b':
+			binary = true;
+			break;
+		case 'c':
+			capturePath = optarg;
+			break;
+		default:
+			fprintf(stderr, USAGE, argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if(optind != argc-1){
+		fprintf(stderr, USAGE, argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if(strcmp(argv[optind], "-") != 0){
+		fd = telemHost_openSerial(argv[optind]);
+		if(fd < 0){
+			perror(argv[optind]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if(binary){
+		snprintf(path, sizeof(path), "%s.bin", output.prefix);
+		output.binary = fopen(path, "wb");
+		if(output.binary == NULL){
+			perror(path);
+			return EXIT_FAILURE;
+		}
+	}
+
+	//The robot sends the samples as mic_start gives them
+	if(capturePath != NULL){
+		capFile_defaultHeader(&captureHeader);
+		if(!capFile_create(&capture, capturePath, &captureHeader)){
+			perror(capturePath);
+			return EXIT_FAILURE;
+		}
+		output.capture = &capture;
+	}
+
+	bool ok = telemHost_decodeStream(fd, decodeOnFrame, decodeOnText, &output, &stats);
+
+	for(uint8_t type = 0; type < TELEM__NB_MSG_TYPES; type++){
+		if(output.csv[type] != NULL){
+			fclose(output.csv[type]);
+		}
+	}
+	if(output.binary != NULL){
+		fclose(output.binary);
+	}
+	if(output.capture != NULL){
+		capFile_close(output.capture);
+		fprintf(stderr, "capture: blocks %u, incomplete blocks %u, bad audio frames %u\n",
+				capture.nbBlocks, capture.incompleteBlocks, capture.badFrames);
+	}
+
+	fprintf(stderr, "frames %u, lost %u, crc errors %u, overflows %u, bad payloads %u, text bytes %u\n",
+			stats.frames, stats.lostFrames, stats.crcErrors, stats.overflows, output.badPayloads, stats.textBytes);
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+/*===========================================================================*/
+/* Private functions	 code												   */
+/*===========================================================================*/
+
+void decodeOnFrame(const TelemFrame *frame, void *context)
+{
+	Output *output = (Output *) context;
+	char path[PATH_SIZE];
+	uint8_t header[TELEM__HEADER_SIZE + sizeof(uint16_t)];
+	uint8_t *write = header;
+
+	if(output->binary != NULL){
+		write = telem_PutU8(write, frame->type);
+		write = telem_PutU16(write, frame->sequence);
+		write = telem_PutU16(write, frame->size);
+		fwrite(header, 1, sizeof(header), output->binary);
+		fwrite(frame->payload, 1, frame->size, output->binary);
+	}
+
+	if(telemHost_typeName(frame->type) == NULL){
+		output->badPayloads++;
+		return;
+	}
+	if(output->csv[frame->type] == NULL){
+		snprintf(path, sizeof(path), "%s_%s.csv", output->prefix, telemHost_typeName(frame->type));
+		output->csv[frame->type] = fopen(path, "w");
+		if(output->csv[frame->type] == NULL){
+			perror(path);
+			exit(EXIT_FAILURE);
+		}
+		telemHost_writeCsvHeader(frame->type, output->csv[frame->type]);
+	}
+	if(telemHost_writeCsv(frame, output->csv[frame->type]) == false){
+		output->badPayloads++;
+	}
+	if(output->capture != NULL && frame->type == TELEM__MSG_AUDIO){
+		capFile_pushAudioFrame(output->capture, frame);
+	}
+}
+
+void decodeOnText(const uint8_t *text, size_t size, void *context)
+{
+	(void) context;
+	fwrite(text, 1, size, stdout);
+	fflush(stdout);
+}
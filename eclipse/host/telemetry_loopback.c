@@ -0,0 +1,254 @@
+/*
+ * telemetry_loopback.c
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Checks the telemetry encoder and decoder end to end through a pseudo terminal,
+ * 		which stands in for the serial port: frames of every type, text in between, a corrupted frame
+ * 		and a dropped frame are written on one side, and decoded on the other with telemHost_decodeStream.
+ * 		Returns 0 if everything was decoded as expected.
+ */
+
+#define _XOPEN_SOURCE 600
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <telemetryHost.h>
+
+
+/*===========================================================================*/
+/* Constants definition for this file						               */
+/*===========================================================================*/
+
+#define NB_FRAMES							200
+#define DROPPED_SEQUENCE						50			//this frame is never sent
+#define CORRUPTED_SEQUENCE					100			//this frame gets a byte changed, the CRC must reject it
+#define TEXT_LINE							"angle of source 2 : 45\r\n"
+
+
+/*===========================================================================*/
+/* Structures						 			                            */
+/*===========================================================================*/
+
+typedef struct Results {
+	uint32_t frames;
+	uint32_t payloadErrors;
+	uint32_t textLines;
+	FILE *csv;
+} Result;
+
+
+/*===========================================================================*/
+/* Private functions definitions                                             */
+/*===========================================================================*/
+
+/**
+ * @brief   Fills the payload of the frame of a given sequence, so that the receiver can check it
+ *
+ * @return	payload size
+*/
+uint16_t loopbackPayload(uint16_t sequence, uint8_t *type, uint8_t *payload);
+
+/**
+ * @brief   Writes all frames and text into fd, as the robot would
+*/
+void loopbackSend(int fd);
+
+void loopbackOnFrame(const TelemFrame *frame, void *context);
+void loopbackOnText(const uint8_t *text, size_t size, void *context);
+
+
+/*===========================================================================*/
+/* Main					 										            */
+/*===========================================================================*/
+
+int main(void)
+{
+	Result result = {0, 0, 0, NULL};
+	TelemHostStat stats;
+	int master = posix_openpt(O_RDWR | O_NOCTTY);
+	int slave = 0;
+	pid_t sender = 0;
+	bool ok = true;
+
+	if(master < 0 || grantpt(master) != 0 || unlockpt(master) != 0){
+		perror("pseudo terminal");
+		return EXIT_FAILURE;
+	}
+	slave = telemHost_openSerial(ptsname(master));
+	if(slave < 0){
+		perror("pseudo terminal slave");
+		return EXIT_FAILURE;
+	}
+	result.csv = tmpfile();
+
+	//the robot side runs in its own process, as the pseudo terminal buffer is smaller than the whole stream
+	sender = fork();
+	if(sender == 0){
+		close(slave);
+		loopbackSend(master);
+		return EXIT_SUCCESS;
+	}
+	close(master);
+
+	ok = telemHost_decodeStream(slave, loopbackOnFrame, loopbackOnText, &result, &stats);
+	waitpid(sender, NULL, 0);
+
+	ok = ok && stats.frames == NB_FRAMES-2;
+	ok = ok && stats.lostFrames == 2;
+	ok = ok && stats.crcErrors == 1;
+	ok = ok && result.payloadErrors == 0;
+	ok = ok && result.textLines == NB_FRAMES/10;
+	ok = ok && ftell(result.csv) > 0;
+
+	printf("%s: frames %u, lost %u, crc errors %u, payload errors %u, text lines %u\n", ok ? "PASS" : "FAIL",
+			stats.frames, stats.lostFrames, stats.crcErrors, result.payloadErrors, result.textLines);
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+/*===========================================================================*/
+/* Private functions	 code												   */
+/*===========================================================================*/
+
+uint16_t loopbackPayload(uint16_t sequence, uint8_t *type, uint8_t *payload)
+{
+	uint8_t *write = payload;
+	uint8_t band[66];
+	const uint8_t reference[66] = {0};
+
+	//Cycle through all types, with payloads that contain zeros and long runs to exercise COBS
+	*type = (uint8_t) (TELEM__MSG_SPECTRUM + sequence % (TELEM__NB_MSG_TYPES-1));
+	switch(*type){
+	case TELEM__MSG_SPECTRUM:
+		write = telem_PutU32(write, sequence);
+		write = telem_PutU16(write, 945);
+		write = telem_PutU8(write, 66);
+		for(uint16_t i = 0; i < 66; i++){
+			write = telem_PutU16(write, (uint16_t) (i*sequence));
+		}
+		break;
+	case TELEM__MSG_SOURCES:
+		write = telem_PutU32(write, sequence);
+		write = telem_PutU8(write, 64);
+		for(uint16_t i = 0; i < 64; i++){
+			write = telem_PutU16(write, (uint16_t) (945+i));
+			write = telem_PutF32(write, 15000.0f + i);
+		}
+		break;
+	case TELEM__MSG_DESTINATION:
+		write = telem_PutU32(write, sequence);
+		write = telem_PutU16(write, 959);
+		write = telem_PutU16(write, (uint16_t) -45);
+		write = telem_PutU8(write, true);
+		write = telem_PutF32(write, 150000.0f);
+		break;
+	case TELEM__MSG_CONTROLLER:
+		write = telem_PutU32(write, sequence);
+		write = telem_PutU8(write, 1);
+		write = telem_PutU8(write, true);
+		write = telem_PutU8(write, 0);
+		write = telem_PutU16(write, (uint16_t) -12);
+		write = telem_PutF32(write, -12.5f);
+		write = telem_PutU16(write, 600);
+		write = telem_PutU16(write, (uint16_t) -600);
+		break;
+	case TELEM__MSG_BAND:
+		//only key frames, as frames are dropped on purpose
+		write = telem_PutU32(write, sequence);
+		write = telem_PutU8(write, (uint8_t) sequence);
+		write = telem_PutU8(write, TELEM__BAND_KEY_FRAME);
+		write = telem_PutU16(write, 945);
+		write = telem_PutU8(write, 66);
+		write = telem_PutU8(write, 2);
+		write = telem_PutU8(write, 14);
+		write = telem_PutU16(write, (uint16_t) -45);
+		write = telem_PutU8(write, 40);
+		write = telem_PutU16(write, (uint16_t) TELEM__ANGLE_UNKNOWN);
+		for(uint8_t i = 0; i < 66; i++){
+			band[i] = (uint8_t) ((i < 20 || i > 40) ? 100 : 100 + i + sequence);
+		}
+		write += telem_EncodeBand(band, reference, 66, write);
+		break;
+	case TELEM__MSG_AUDIO:
+		write = telem_PutU32(write, sequence);
+		write = telem_PutU32(write, 7u*sequence);
+		write = telem_PutU16(write, 160);
+		write = telem_PutU8(write, (uint8_t) (sequence % 4));
+		write = telem_PutU8(write, 4);
+		for(uint16_t i = 0; i < 4*40; i++){
+			write = telem_PutU16(write, (uint16_t) ((i % 7 == 0) ? 0 : (int16_t) (i - 80)*sequence));
+		}
+		break;
+	default:
+		write = telem_PutU32(write, sequence);
+		write = telem_PutU16(write, 80);
+		for(uint8_t i = 0; i < 8; i++){
+			write = telem_PutU16(write, 0);
+		}
+		write = telem_PutU8(write, false);
+		write = telem_PutU16(write, 0);
+		break;
+	}
+	return (uint16_t) (write - payload);
+}
+
+void loopbackSend(int fd)
+{
+	uint8_t payload[TELEM__MAX_PAYLOAD];
+	uint8_t encoded[TELEM__MAX_ENCODED];
+	uint8_t type = 0;
+	size_t length = 0;
+
+	for(uint16_t sequence = 0; sequence < NB_FRAMES; sequence++){
+		if(sequence % 10 == 0){
+			write(fd, TEXT_LINE, strlen(TEXT_LINE));
+		}
+		if(sequence == DROPPED_SEQUENCE){
+			continue;
+		}
+		length = telem_EncodeFrame(type, sequence, payload, loopbackPayload(sequence, &type, payload), encoded);
+		if(sequence == CORRUPTED_SEQUENCE){
+			//change a byte without creating a delimiter, which would split the frame in two
+			encoded[length/2] = (encoded[length/2] == 0x55) ? 0xAA : 0x55;
+		}
+		write(fd, encoded, length);
+	}
+	//let the receiver drain the pseudo terminal before closing it
+	tcdrain(fd);
+	sleep(1);
+	close(fd);
+}
+
+void loopbackOnFrame(const TelemFrame *frame, void *context)
+{
+	Result *result = (Result *) context;
+	uint8_t payload[TELEM__MAX_PAYLOAD];
+	uint8_t type = 0;
+	uint16_t size = loopbackPayload(frame->sequence, &type, payload);
+
+	result->frames++;
+	if(frame->type != type || frame->size != size || memcmp(frame->payload, payload, size) != 0
+			|| telemHost_writeCsv(frame, result->csv) == false){
+		result->payloadErrors++;
+	}
+}
+
+void loopbackOnText(const uint8_t *text, size_t size, void *context)
+{
+	Result *result = (Result *) context;
+
+	if(size == strlen(TEXT_LINE) && memcmp(text, TEXT_LINE, size) == 0){
+		result->textLines++;
+	}
+	else{
+		result->payloadErrors++;
+	}
+}
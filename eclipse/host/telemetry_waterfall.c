@@ -0,0 +1,241 @@
+/*
+ * telemetry_waterfall.c
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Renders the band stream of the robot (TELEM__MSG_BAND) as a live waterfall in the terminal,
+ * 		one line per audio frame, with the detected peaks marked and their angles listed at the end of the line.
+ * 		The whole recording can also be saved as a grayscale PGM image, one pixel row per frame.
+ * 		The text output of the robot is printed on stderr, so that it does not break the waterfall.
+ *
+ * 		usage: telemetry_waterfall [-q] [-p image.pgm] [-l low] [-h high] <device|file|->
+ * 			-q			no terminal rendering, only record
+ * 			-p file		writes the waterfall image at the end of the stream
+ * 			-l, -h		levels shown as black and white, in 1/8 octave (default 96 and 192)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <telemetryHost.h>
+
+
+/*===========================================================================*/
+/* Constants definition for this file						               */
+/*===========================================================================*/
+
+#define DEFAULT_LEVEL_LOW					96			//2^12, well under the peak threshold of the robot
+#define DEFAULT_LEVEL_HIGH					192			//2^24
+#define ANSI_GRAY_FIRST						232			//the 256 color palette has 24 grays from 232 to 255
+#define ANSI_GRAY_LEVELS						24
+#define PGM_MAX_VALUE						255
+
+//As audioP_convertFreq: freq[real]=15611-freq[FFT-domain]*15.244
+#define CONVERT_FREQ_CONST					15611.0f
+#define CONVERT_FREQ_PARAM					15.244f
+
+
+/*===========================================================================*/
+/* Structures						 			                            */
+/*===========================================================================*/
+
+typedef struct Waterfalls {
+	TelemHostBand band;
+	bool render;
+	uint8_t low;
+	uint8_t high;
+	uint8_t width;						//nbBins of the first band, the image keeps this width
+	uint8_t *image;
+	size_t nbRows;
+	size_t capacity;
+	uint32_t missedBands;
+} Waterfall;
+
+
+/*===========================================================================*/
+/* Private functions definitions                                             */
+/*===========================================================================*/
+
+/**
+ * @brief   Maps a level to [0,PGM_MAX_VALUE] between the low and high levels
+*/
+uint8_t waterfallShade(const Waterfall *waterfall, uint8_t level);
+
+/**
+ * @brief   Prints a band as a line of gray cells, peaks are marked with |
+*/
+void waterfallRender(const Waterfall *waterfall);
+
+/**
+ * @brief   Appends a band to the image
+*/
+void waterfallRecord(Waterfall *waterfall);
+
+/**
+ * @brief   Writes the image as a binary PGM file
+*/
+bool waterfallWritePgm(const Waterfall *waterfall, const char *path);
+
+void waterfallOnFrame(const TelemFrame *frame, void *context);
+void waterfallOnText(const uint8_t *text, size_t size, void *context);
+
+
+/*===========================================================================*/
+/* Main					 										            */
+/*===========================================================================*/
+
+int main(int argc, char *argv[])
+{
+	static Waterfall waterfall;
+	TelemHostStat stats;
+	const char *pgmPath = NULL;
+	int option = 0;
+	int fd = 0;
+
+	waterfall.render = true;
+	waterfall.low = DEFAULT_LEVEL_LOW;
+	waterfall.high = DEFAULT_LEVEL_HIGH;
+
+	while((option = getopt(argc, argv, "qp:l:h:")) != -1){
+		switch(option){
+		case 'q':
+			waterfall.render = false;
+			break;
+		case 'p':
+			pgmPath = optarg;
+			break;
+		case 'l':
+			waterfall.low = (uint8_t) atoi(optarg);
+			break;
+		case 'h':
+			waterfall.high = (uint8_t) atoi(optarg);
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-q] [-p image.pgm] [-l low] [-h high] <device|file|->\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if(optind != argc-1 || waterfall.high <= waterfall.low){
+		fprintf(stderr, "usage: %s [-q] [-p image.pgm] [-l low] [-h high] <device|file|->\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if(strcmp(argv[optind], "-") != 0){
+		fd = telemHost_openSerial(argv[optind]);
+		if(fd < 0){
+			perror(argv[optind]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	bool ok = telemHost_decodeStream(fd, waterfallOnFrame, waterfallOnText, &waterfall, &stats);
+
+	if(pgmPath != NULL && waterfallWritePgm(&waterfall, pgmPath) == false){
+		perror(pgmPath);
+		ok = false;
+	}
+	fprintf(stderr, "bands %zu, missed bands %u, frames %u, lost frames %u, crc errors %u\n",
+			waterfall.nbRows, waterfall.missedBands, stats.frames, stats.lostFrames, stats.crcErrors);
+	free(waterfall.image);
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+/*===========================================================================*/
+/* Private functions	 code												   */
+/*===========================================================================*/
+
+uint8_t waterfallShade(const Waterfall *waterfall, uint8_t level)
+{
+	if(level <= waterfall->low){
+		return 0;
+	}
+	if(level >= waterfall->high){
+		return PGM_MAX_VALUE;
+	}
+	return (uint8_t) ((level - waterfall->low) * PGM_MAX_VALUE / (waterfall->high - waterfall->low));
+}
+
+void waterfallRender(const Waterfall *waterfall)
+{
+	const TelemHostBand *band = &waterfall->band;
+	bool peak = false;
+
+	for(uint8_t bin = 0; bin < band->nbBins; bin++){
+		peak = false;
+		for(uint8_t i = 0; i < band->nbPeaks; i++){
+			peak = peak || (band->peakBin[i] == bin);
+		}
+		printf("\033[48;5;%um%s", ANSI_GRAY_FIRST + waterfallShade(waterfall, band->values[bin])*(ANSI_GRAY_LEVELS-1)/PGM_MAX_VALUE,
+				peak ? "\033[31m|" : " ");
+	}
+	printf("\033[0m %10u", band->frameTime);
+	for(uint8_t i = 0; i < band->nbPeaks; i++){
+		printf(" %4.0fHz", (double) (CONVERT_FREQ_CONST - (band->firstBin + band->peakBin[i])*CONVERT_FREQ_PARAM));
+		if(band->peakAngle[i] != TELEM__ANGLE_UNKNOWN){
+			printf("@%d", band->peakAngle[i]);
+		}
+	}
+	printf("\n");
+	fflush(stdout);
+}
+
+void waterfallRecord(Waterfall *waterfall)
+{
+	uint8_t *row = NULL;
+
+	if(waterfall->nbRows == 0){
+		waterfall->width = waterfall->band.nbBins;
+	}
+	if(waterfall->nbRows == waterfall->capacity){
+		waterfall->capacity = waterfall->capacity ? 2*waterfall->capacity : 1024;
+		waterfall->image = realloc(waterfall->image, waterfall->capacity * waterfall->width);
+		if(waterfall->image == NULL){
+			perror("waterfall");
+			exit(EXIT_FAILURE);
+		}
+	}
+	row = &waterfall->image[waterfall->nbRows * waterfall->width];
+	for(uint8_t bin = 0; bin < waterfall->width; bin++){
+		row[bin] = (bin < waterfall->band.nbBins) ? waterfallShade(waterfall, waterfall->band.values[bin]) : 0;
+	}
+	waterfall->nbRows++;
+}
+
+bool waterfallWritePgm(const Waterfall *waterfall, const char *path)
+{
+	FILE *pgm = fopen(path, "wb");
+
+	if(pgm == NULL){
+		return false;
+	}
+	fprintf(pgm, "P5\n%u %zu\n%u\n", waterfall->width, waterfall->nbRows, PGM_MAX_VALUE);
+	fwrite(waterfall->image, waterfall->width, waterfall->nbRows, pgm);
+	return fclose(pgm) == 0;
+}
+
+void waterfallOnFrame(const TelemFrame *frame, void *context)
+{
+	Waterfall *waterfall = (Waterfall *) context;
+
+	if(frame->type != TELEM__MSG_BAND){
+		return;
+	}
+	if(telemHost_decodeBand(frame, &waterfall->band) == false){
+		waterfall->missedBands++;
+		return;
+	}
+	waterfallRecord(waterfall);
+	if(waterfall->render){
+		waterfallRender(waterfall);
+	}
+}
+
+void waterfallOnText(const uint8_t *text, size_t size, void *context)
+{
+	(void) context;
+	fwrite(text, 1, size, stderr);
+}
@@ -0,0 +1,180 @@
+/*
+ * latencyTrace.c
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Ring buffer of the latency traces. The travel controller thread writes the traces and the
+ * 		comms reception thread reads them, so they are written and copied under chSysLock. The percentiles are
+ * 		calculated in a static buffer, to keep the stack of the reading thread small, protected by a mutex.
+ *
+ * Functions prefix for public functions in this file: trace_
+ */
+
+#include <stdlib.h>
+
+#include <latencyTrace.h>
+
+
+/*===========================================================================*/
+/* Constants definition for this file						               */
+/*===========================================================================*/
+
+#define PERCENTILE_50						50
+#define PERCENTILE_90						90
+#define PERCENTILE_99						99
+#define PERCENTILE_100						100
+
+//ST2US computes in 32 bits and overflows for durations above a few hundred ms
+#define US_PER_S							1000000ULL
+#define TICKS_TO_US(ticks)					((uint32_t) ((uint64_t) (ticks)*US_PER_S/CH_CFG_ST_FREQUENCY))
+
+
+/*===========================================================================*/
+/* Structures						 			                            */
+/*===========================================================================*/
+
+/*
+ * Durations of the segments of a trace, in us
+ */
+typedef struct TraceEntries {
+	uint32_t segmentUs[TRACE__NB_SEGMENTS];
+} TraceEntry;
+
+
+/*===========================================================================*/
+/* Static variables definitions 		 			                            */
+/*===========================================================================*/
+
+static TraceEntry traces[TRACE__SIZE];
+static uint16_t traceIndex 					= 0;		//where the next trace is written
+static uint32_t nbTraces 					= 0;
+static uint32_t lastTraceFrame 				= TRACE__NO_FRAME;
+
+static uint32_t sortedUs[TRACE__SIZE];
+static MUTEX_DECL(percentilesLock);
+
+
+/*===========================================================================*/
+/* Private functions definitions                                             */
+/*===========================================================================*/
+
+/**
+ * @brief   Compares two durations for qsort
+*/
+int traceCompareUs(const void *duration1, const void *duration2);
+
+/**
+ * @brief   Returns a percentile of the sorted durations
+*/
+uint32_t tracePercentile(uint16_t nbSorted, uint8_t percent);
+
+
+/*===========================================================================*/
+/* Public functions for setting/getting internal parameters					  */
+/* Descriptions  are only in the header file (to have a single source of truth) */
+/*===========================================================================*/
+
+void trace_record(const TraceStamp *stamp, systime_t actuation)
+{
+	TraceEntry entry;
+
+	if(stamp->frame == TRACE__NO_FRAME){
+		return;
+	}
+
+	entry.segmentUs[TRACE__SEGMENT_ANALYSIS] = TICKS_TO_US(stamp->analysis - stamp->capture);
+	entry.segmentUs[TRACE__SEGMENT_COMMAND] = TICKS_TO_US(stamp->command - stamp->analysis);
+	entry.segmentUs[TRACE__SEGMENT_ACTUATION] = TICKS_TO_US(actuation - stamp->command);
+	entry.segmentUs[TRACE__SEGMENT_TOTAL] = TICKS_TO_US(actuation - stamp->capture);
+
+	chSysLock();
+	traces[traceIndex] = entry;
+	traceIndex = (uint16_t) ((traceIndex + 1) % TRACE__SIZE);
+	nbTraces++;
+	lastTraceFrame = stamp->frame;
+	chSysUnlock();
+}
+
+void trace_reset(void)
+{
+	chSysLock();
+	traceIndex = 0;
+	nbTraces = 0;
+	lastTraceFrame = TRACE__NO_FRAME;
+	chSysUnlock();
+}
+
+bool trace_getPercentiles(uint8_t segment, TracePercentile *percentiles)
+{
+	uint16_t nbSorted = 0;
+
+	if(segment >= TRACE__NB_SEGMENTS){
+		return false;
+	}
+
+	chMtxLock(&percentilesLock);
+
+	chSysLock();
+	nbSorted = (uint16_t) ((nbTraces < TRACE__SIZE) ? nbTraces : TRACE__SIZE);
+	for(uint16_t trace_counter = 0; trace_counter < nbSorted; trace_counter++){
+		sortedUs[trace_counter] = traces[trace_counter].segmentUs[segment];
+	}
+	chSysUnlock();
+
+	qsort(sortedUs, nbSorted, sizeof(uint32_t), traceCompareUs);
+	percentiles->count = nbSorted;
+	percentiles->p50Us = tracePercentile(nbSorted, PERCENTILE_50);
+	percentiles->p90Us = tracePercentile(nbSorted, PERCENTILE_90);
+	percentiles->p99Us = tracePercentile(nbSorted, PERCENTILE_99);
+	percentiles->maxUs = tracePercentile(nbSorted, PERCENTILE_100);
+
+	chMtxUnlock(&percentilesLock);
+	return true;
+}
+
+const char *trace_getSegmentName(uint8_t segment)
+{
+	switch(segment){
+	case TRACE__SEGMENT_ANALYSIS:
+		return "capture->analysis";
+	case TRACE__SEGMENT_COMMAND:
+		return "analysis->command";
+	case TRACE__SEGMENT_ACTUATION:
+		return "command->actuation";
+	case TRACE__SEGMENT_TOTAL:
+		return "capture->actuation";
+	default:
+		return "";
+	}
+}
+
+void trace_getLast(uint32_t *lastFrame, uint32_t *nbTracesRecorded)
+{
+	chSysLock();
+	*lastFrame = lastTraceFrame;
+	*nbTracesRecorded = nbTraces;
+	chSysUnlock();
+}
+
+
+/*===========================================================================*/
+/* Private functions	 code												   */
+/*===========================================================================*/
+
+int traceCompareUs(const void *duration1, const void *duration2)
+{
+	uint32_t value1 = *(const uint32_t *) duration1;
+	uint32_t value2 = *(const uint32_t *) duration2;
+
+	return (value1 > value2) - (value1 < value2);
+}
+
+uint32_t tracePercentile(uint16_t nbSorted, uint8_t percent)
+{
+	if(nbSorted == 0){
+		return 0;
+	}
+	return sortedUs[((uint32_t) (nbSorted - 1)*percent)/PERCENTILE_100];
+}
@@ -0,0 +1,104 @@
+/*
+ * latencyTrace.h
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: End-to-end latency tracing, from the sound reaching the mics to the change of wheel speeds.
+ * 		Each audio frame is stamped with a sequence number and its capture time. The stamp travels with the
+ * 		angle computed from the frame in Destination, gets the analysis time, then the command time in
+ * 		travelCtrl_goToAngle, and the travel controller records it with the actuation time the first time
+ * 		it updates the speeds for that command. The last TRACE__SIZE traces are kept for percentiles.
+ * Function prefix for public functions in this file: trace_
+ * Constant prefix for public constants in this file: TRACE__
+ */
+#ifndef LATENCYTRACE_H_
+#define LATENCYTRACE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <ch.h>
+
+/*===========================================================================*/
+/* Constants definition for this library						               */
+/*===========================================================================*/
+
+#define TRACE__SIZE							128			//traces kept for the percentiles
+#define TRACE__NO_FRAME						UINT32_MAX	//the angle does not come from an audio frame (e.g. predicted), not traced
+
+//Segments of the latency
+#define TRACE__SEGMENT_ANALYSIS				0			//capture to analysis: waiting for the audio thread, FFT, peaks and angle
+#define TRACE__SEGMENT_COMMAND				1			//analysis to command: main thread until travelCtrl_goToAngle
+#define TRACE__SEGMENT_ACTUATION				2			//command to actuation: mailbox and controller period
+#define TRACE__SEGMENT_TOTAL					3			//capture to actuation
+#define TRACE__NB_SEGMENTS					4
+
+
+/*===========================================================================*/
+/* Structures						 			                            */
+/*===========================================================================*/
+
+/*
+ * Stamp of an angle, from the audio frame it was computed from
+ * @note capture is the time the last sample of the frame was received, the frame covers the 64ms before it
+ */
+typedef struct TraceStamps {
+	uint32_t frame;				//sequence number of the audio frame
+	systime_t capture;
+	systime_t analysis;
+	systime_t command;
+} TraceStamp;
+
+/*
+ * Percentiles of a segment over the traces kept, in us
+ */
+typedef struct TracePercentiles {
+	uint32_t count;
+	uint32_t p50Us;
+	uint32_t p90Us;
+	uint32_t p99Us;
+	uint32_t maxUs;
+} TracePercentile;
+
+
+/*===========================================================================*/
+/* Public functions definitions            									 */
+/*===========================================================================*/
+
+/*
+ * @brief	Records a trace, called by the travel controller when it updated the speeds for a command
+ *
+ *  @param[in] stamp			stamp of the command, ignored if its frame is TRACE__NO_FRAME
+ *  @param[in] actuation		time at which the new speeds were given to the motors
+ */
+void trace_record(const TraceStamp *stamp, systime_t actuation);
+
+/*
+ * @brief	Forgets all the traces
+ */
+void trace_reset(void);
+
+/*
+ * @brief	Calculates the percentiles of a segment over the traces kept
+ *
+ *  @param[in] segment			TRACE__SEGMENT_XXX
+ *  @param[out] percentiles		percentiles, all 0 if there is no trace
+ *
+ * @return	false if segment does not exist
+ */
+bool trace_getPercentiles(uint8_t segment, TracePercentile *percentiles);
+
+/*
+ * @brief	Returns the name of a segment, for printing
+ */
+const char *trace_getSegmentName(uint8_t segment);
+
+/*
+ * @brief	Returns the frame of the last trace recorded and the number of traces since start or trace_reset
+ */
+void trace_getLast(uint32_t *lastFrame, uint32_t *nbTracesRecorded);
+
+
+#endif /* LATENCYTRACE_H_ */
@@ -25,6 +25,13 @@
 #include <audio_processing.h>
 #include <travelController.h>
 #include <comms.h>
+#include <telemetry.h>
+#include <mission.h>
+#include <planner.h>
+#include <profiling.h>
+#include <systemMonitor.h>
+#include <micCapture.h>
+#include <dspBench.h>
 
 /*===========================================================================*/
 /* Constants definition for this file						               */
@@ -34,6 +41,23 @@
 #define DIR_SOURCE_MAX_TEXT_LENGTH	10
 #define NUM_BASE_10					10
 
+//Return values of moveTowardsDestination when the robot was blocked by an obstacle, or the user asked for a rescan
+#define DESTINATION_BLOCKED			5555
+#define DESTINATION_RESCAN			4444
+
+/* @note User requests
+ * The commands typed by the user run in the comms reception thread, they only post a request
+ * that the main thread takes when it is ready: while waiting for a selection, or at each update while moving. */
+#define USER_REQUEST_NONE			0
+#define USER_REQUEST_SELECT_INDEX	1			//value is the index of the source in the last scan
+#define USER_REQUEST_SELECT_FREQ		2			//value is the frequency in Hz
+#define USER_REQUEST_RESCAN			3
+#define USER_POLL_MS					100			//how often the selection prompt checks for requests
+#define FREQ_SELECT_TOLERANCE_HZ		45			//a source is selected by frequency if it is this close, as FREQ_THD
+#define MISSION_RESCAN_DELAY_MS		1000			//in an autonomous mission, rescan after this delay when no penguin fits the policy
+#define BENCH_LINE_MAX				128			//tx space waited for before each line of the bench command, it drops what does not fit
+#define BENCH_TX_POLL_MS				10
+
 //Time constants
 #define MSEC_150						150
 #define SEC_2						2000
@@ -51,6 +75,12 @@
  */
 static bool robotMoving		= false;
 
+/* @note obstacleReason
+ * Why the travelController stopped the robot, TRAVCTRL__AT_SOURCE or TRAVCTRL__BLOCKED,
+ * set by destReachedCB before robotMoving.
+ */
+static uint8_t obstacleReason	= TRAVCTRL__AT_SOURCE;
+
 /* @note killerIsComing
  * Variable that defines if the robot is currently hunted by a killer whale or not.
  * This is a file variable because the main function depends on it,
@@ -58,6 +88,17 @@ static bool robotMoving		= false;
  */
 static bool killerIsComing	= false;
 
+/* @note sourcesScan
+ * Sources found by the last scan, the user selects one of them by its index or its frequency.
+ * Only the main thread uses them, the command handlers post requests instead.
+ */
+static Destination sourcesScan[AUDIOP__NB_SOURCES_MAX];
+static uint16_t nbSourcesScan		= 0;
+
+//Request posted by a command handler, written and taken under chSysLock
+static uint8_t userRequest			= USER_REQUEST_NONE;
+static uint16_t userRequestValue		= 0;
+
 
 /*===========================================================================*/
 /* Internal functions definitions of main. 							 		*/
@@ -92,7 +133,8 @@ uint16_t detectSources(Destination *destination_scan);
  *
  *  @param[out] destination 		the destination to go to, which will be updated as the robot moves
  *
- * return	AUDIOP__SUCCESS if destination is reached, AUDIOP__SOURCE_NOT_FOUND if source is not anymore found
+ * return	AUDIOP__SUCCESS if destination is reached, AUDIOP__SOURCE_NOT_FOUND if source is not anymore found,
+ * 			DESTINATION_BLOCKED if an obstacle could not be gone around, DESTINATION_RESCAN if the user asked for a rescan
  */
 uint16_t moveTowardsDestination(Destination *destination);
 
@@ -112,8 +154,74 @@ void printSources(uint16_t nb_sources, Destination *destination_scan);
 /*
  * @brief	sets body LED and moves backwards such that a new sources can be targeted
  * @note		is only called if the destination was reached
+ *
+ *  @param[in] backupMs		how long the robot moves backwards
+ */
+void destinationReached(uint16_t backupMs);
+
+/*
+ * @brief	prints the order of the visits planned and how long they should take
+ */
+void printPlan(void);
+
+/*
+ * @brief	posts a request for the main thread, replacing a request not taken yet
+ */
+void postUserRequest(uint8_t request, uint16_t value);
+
+/*
+ * @brief	takes the pending request, if any
+ *
+ *  @param[out] value		value of the request
+ *
+ * return	USER_REQUEST_XXX, USER_REQUEST_NONE if there is none
+ */
+uint8_t takeUserRequest(uint16_t *value);
+
+/*
+ * @brief	selects a source of the last scan as destination
+ *
+ *  @param[in] request		USER_REQUEST_SELECT_INDEX or USER_REQUEST_SELECT_FREQ
+ *  @param[in] value			index in sourcesScan or frequency in Hz
+ *  @param[out] destination	updated with the selected source
+ *
+ * return	true if the source exists, false otherwise (and the user is told why)
+ */
+bool selectSource(uint8_t request, uint16_t value, Destination *destination);
+
+/*
+ * @brief	reads an integer argument of a command, checked before it is narrowed to its type
+ *
+ *  @param[in] text			argument
+ *  @param[in] min			smallest accepted value
+ *  @param[in] max			largest accepted value
+ *  @param[out] value		the integer, only written if it is accepted
+ *
+ * return	false if text is not a whole integer between min and max
  */
-void destinationReached(void);
+bool parseInteger(const char *text, long min, long max, long *value);
+
+/*
+ * @brief	registers the commands of the user interface in comms
+ */
+void registerCommands(void);
+
+/*
+ * @brief	command handlers, see registerCommands for their syntax
+ */
+void selCommand(uint8_t argc, char *argv[]);
+void freqCommand(uint8_t argc, char *argv[]);
+void rescanCommand(uint8_t argc, char *argv[]);
+void setCommand(uint8_t argc, char *argv[]);
+void statsCommand(uint8_t argc, char *argv[]);
+void missionCommand(uint8_t argc, char *argv[]);
+void profCommand(uint8_t argc, char *argv[]);
+void latencyCommand(uint8_t argc, char *argv[]);
+void sysmonCommand(uint8_t argc, char *argv[]);
+void captureCommand(uint8_t argc, char *argv[]);
+#if BENCH__ENABLED
+void benchCommand(uint8_t argc, char *argv[]);
+#endif
 
 
 /*===========================================================================*/
@@ -122,11 +230,12 @@ void destinationReached(void);
 
 /* @brief callback function to update the state in main of robotMoving
  * @note it is required by the travelController. It will be called by
- * 			travelController library when the robots arrives at an obstacle.
- * 			The type and arguments follow the travCtrl_dirAngleCb_t type
+ * 			travelController library when the robots arrives at the source or is blocked.
+ * 			The type and arguments follow the travCtrl_obstacleReached type
  */
-void destReachedCB(void)
+void destReachedCB(uint8_t reason)
 {
+	obstacleReason = reason;
 	robotMoving = false;
 }
 
@@ -173,8 +282,13 @@ int main(void)
 {
 
 	Destination destination;
+	bool planned 		= false;			//the next destination comes from the planner, without a scan
+	uint16_t outcome 	= AUDIOP__SUCCESS;
 	destination.freq = 	AUDIOP__UNINITIALIZED_FREQ;
 	destination.angle = 	0;
+	destination.valid = 	false;
+	destination.stamp.frame = 	TRACE__NO_FRAME;
+	destination.ampli = 	0;
 
 	//Initialise chibios systems, hardware abstraction layer and memory protection
 	halInit();
@@ -184,28 +298,60 @@ int main(void)
 	//Start the serial communication over bluetooth
 	comms_start();
 
+	//Start the cycle counter used to time the pipeline stages
+	prof_init();
+
 	// Initialise motor controller. It does not move yet, as it waits for an angle
 	travCtrl_init(destReachedCB);
 
 	// Initialise audio module, which starts listening to mics and acquiring audio data
 	audioP_init();
 
+	//Raw capture of the microphones, it only sends something when asked with the capture command
+	micCap_init();
+
 	//Thread for the LEDs when the killer whale is coming
 	chThdCreateStatic(waThdLed, sizeof(waThdLed), NORMALPRIO, ThdLed, NULL);
 
+	//Commands can be typed at any time, even while the robot moves
+	registerCommands();
+
 	//prints information for starting
 	startPrintf();
 
 	/* Infinite main thread loop. */
 	while (true){
 
-		//Scan sources and ask the user to select one or escape from killer whale !
-		communicationUser(&destination);
+		//Scan sources and ask the user (or the mission policy) to select one or escape from killer whale !
+		if(planned == false){
+			communicationUser(&destination);
+		}
+		//The robot already turns towards the bearing predicted by the planner, the audio then corrects it
+		else{
+			comms_printf("\n\rThe robot now goes on to the penguin at %u Hz\n\r", audioP_convertFreq(destination.freq));
+			travelCtrl_goToAngle(destination.angle, &destination.stamp, destination.ampli >= AUDIOP__AMPLI_SOURCE_CLOSE);
+		}
 
 		//Move towards the selected source, until it is reached or not found anymore
-		if(moveTowardsDestination(&destination) != AUDIOP__SOURCE_NOT_FOUND){
-			destinationReached();
+		outcome = moveTowardsDestination(&destination);
+		switch(outcome){
+		case AUDIOP__SUCCESS:
+			destinationReached((mission_getPolicy() == MISSION__PLANNED) ? PLANNER__BACKUP_MS : SEC_3);
+			mission_recordOutcome(&destination, MISSION__VISITED);
+			break;
+		case DESTINATION_BLOCKED:
+			mission_recordOutcome(&destination, MISSION__BLOCKED);
+			break;
+		case AUDIOP__SOURCE_NOT_FOUND:
+			mission_recordOutcome(&destination, MISSION__LOST);
+			break;
+		default:									//the user asked for a rescan
+			break;
 		}
+
+		//With a plan, the robot drives on to the next penguin from where it backed up
+		planned = outcome == AUDIOP__SUCCESS && mission_getPolicy() == MISSION__PLANNED
+				&& planner_nextDestination(&destination);
 	}
 }
 
@@ -220,9 +366,10 @@ void startPrintf(void)
 	char readNumberText[DIR_SOURCE_MAX_TEXT_LENGTH];
 	bool keepAsking 										= true;		//this is the while control variable
 
-	while(keepAsking == true){										//press 's' to start the program
-		comms_readf( readNumberText, DIR_SOURCE_MAX_TEXT_LENGTH);
-		if(readNumberText[0]=='s'){
+	//press 's' to start the program, an autonomous mission (build default or mission command) starts without it
+	while(keepAsking == true && mission_getPolicy() == MISSION__MANUAL){
+		if(comms_readfTimeout( readNumberText, DIR_SOURCE_MAX_TEXT_LENGTH, MS2ST(USER_POLL_MS)) != COMMS__TIMEOUT
+				&& readNumberText[0]=='s'){
 			keepAsking = false;
 		}
 	}
@@ -241,57 +388,92 @@ void communicationUser(Destination *destination)
 	uint8_t readNumber 	= AUDIOP__NB_SOURCES_MAX;					//AUDIOP__NB_SOURCES_MAX is not a valid number of sources
 	char *endTextReadPointer; 										//pointer to store where strtol finishes reading text
 
-	Destination destination_scan[AUDIOP__NB_SOURCES_MAX] = {0};		//for scanned sources
 	bool keepAsking 										= true;		//this is the while control variable
-	uint16_t nb_sources 									= 0;
+	bool prompt 											= true;
+	uint8_t request 										= USER_REQUEST_NONE;
+	uint16_t requestValue 								= 0;
+	uint16_t choice 										= MISSION__NO_CHOICE;
+	systime_t pollTime 									= MS2ST(USER_POLL_MS);
 
 	//Scanning for available sources (and killer whales 🐋)
-	nb_sources = detectSources(destination_scan);
+	nbSourcesScan = detectSources(sourcesScan);
 
-	//Keep asking until the input is valid or r was pressed
+	//Keep asking until the input is valid, sources are rescanned when r is entered
 	while(keepAsking == true){
 
-		comms_printf( "\n\rPlease enter the number of the penguin you want to go to or enter 'r' to rescan penguins.\n\r");
-		comms_readf( readNumberText, DIR_SOURCE_MAX_TEXT_LENGTH);
+		//In an autonomous mission the policy chooses, and if no penguin fits it the sources are rescanned a bit later
+		if(mission_getPolicy() != MISSION__MANUAL){
+			choice = mission_chooseSource(sourcesScan, nbSourcesScan);
+			if(choice != MISSION__NO_CHOICE && selectSource(USER_REQUEST_SELECT_INDEX, choice, destination)){
+				if(mission_getPolicy() == MISSION__PLANNED){
+					printPlan();
+				}
+				break;
+			}
+			pollTime = MS2ST(MISSION_RESCAN_DELAY_MS);
+		}
+		else{
+			pollTime = MS2ST(USER_POLL_MS);
+			if(prompt){
+				comms_printf( "\n\rPlease enter the number of the penguin you want to go to or enter 'r' to rescan penguins.\n\r");
+				prompt = false;
+			}
+		}
+
+		//The answer can be typed at the prompt, or given with the sel, freq and rescan commands, even during a mission
+		if(comms_readfTimeout( readNumberText, DIR_SOURCE_MAX_TEXT_LENGTH, pollTime) == COMMS__TIMEOUT){
+			if(mission_getPolicy() != MISSION__MANUAL){
+				nbSourcesScan = detectSources(sourcesScan);
+			}
+		}
+		else{
+			prompt = true;
 
-		//Entered number is verified
-		if(readNumberText[0]!='r'){
+			//Entered number is verified
+			if(readNumberText[0]!='r'){
 
-			readNumber = (uint8_t) strtol(readNumberText, &endTextReadPointer, NUM_BASE_10);
+				readNumber = (uint8_t) strtol(readNumberText, &endTextReadPointer, NUM_BASE_10);
 
-			//No number was entered
-			if(endTextReadPointer==readNumberText){
-				comms_printf( "It seems what you just typed is not a number. Please try again !\n\r");
+				//No number was entered
+				if(endTextReadPointer==readNumberText){
+					comms_printf( "It seems what you just typed is not a number. Please try again !\n\r");
+				}
+				//Value entered is valid: between 0 (included) and nb_sources (excluded)
+				else if(selectSource(USER_REQUEST_SELECT_INDEX, readNumber, destination)){
+					keepAsking = false;
+				}
 			}
-			//Value entered is valid: between 0 (included) and nb_sources (excluded)
-			else if(readNumber < nb_sources){
+			//r was pressed so sources are rescanned
+			else{
+				nbSourcesScan = detectSources(sourcesScan);
+			}
+		}
+
+		request = takeUserRequest(&requestValue);
+		if(request == USER_REQUEST_RESCAN){
+			nbSourcesScan = detectSources(sourcesScan);
+			prompt = true;
+		}
+		else if(request != USER_REQUEST_NONE && keepAsking){
+			if(selectSource(request, requestValue, destination)){
 				keepAsking = false;
 			}
-			//The number wasn't a valid source or there were 0 sources available
 			else{
-				comms_printf( "It seems the number %u you just entered is not a valid source. Please try again !\n\r", readNumber);
+				prompt = true;
 			}
 		}
-		//r was pressed so sources are rescanned
-		else{
-			nb_sources = detectSources(destination_scan);
-		}
 	}
-
-	comms_printf( "The robot will now go to penguin %u ...\n\r", readNumber);
-	destination->freq = destination_scan[readNumber].freq;
-	destination->angle = destination_scan[readNumber].angle;
 }
 
 uint16_t detectSources(Destination *destination_scan)
 {
 	uint16_t nb_sources 	= 0;
 
-	nb_sources = audioP_analyseSources(destination_scan);
+	nb_sources = audioP_analyseSources(destination_scan, AUDIOP__SCAN_FRAME_BUDGET);
 	while(nb_sources==AUDIOP__KILLER_WHALE_DETECTED){
 		escapeKiller();
 		travCtrl_stopMoving();
-		nb_sources = audioP_analyseSources(destination_scan);
+		nb_sources = audioP_analyseSources(destination_scan, AUDIOP__SCAN_FRAME_BUDGET);
 	}
 
 	printSources(nb_sources, destination_scan);
@@ -302,14 +484,28 @@ uint16_t detectSources(Destination *destination_scan)
 uint16_t moveTowardsDestination(Destination *destination)
 {
 	uint16_t analyseDestination		= 0;
+	uint8_t request					= USER_REQUEST_NONE;
+	uint16_t requestValue			= 0;
 
 	/*Now we set robotMoving file variable to true, it will either be set to false here if
 	 * we cannot find the destination source anymore, or by the destReachedCB function
 	 * called from travelController when the robot encounters an obstacle. */
+	obstacleReason = TRAVCTRL__AT_SOURCE;
 	robotMoving = true;
 
 	while (robotMoving == true) {
 
+		//The user can change the destination or ask for a rescan while the robot moves
+		request = takeUserRequest(&requestValue);
+		if(request == USER_REQUEST_RESCAN){
+			robotMoving = false;
+			travCtrl_stopMoving();
+			return DESTINATION_RESCAN;
+		}
+		else if(request != USER_REQUEST_NONE){
+			selectSource(request, requestValue, destination);
+		}
+
 		//Scans sound for destination source and updates angle
 		analyseDestination = audioP_analyseDestination(destination);
 
@@ -325,10 +521,16 @@ uint16_t moveTowardsDestination(Destination *destination)
 			robotMoving = true;
 		}
 		else{
-			travelCtrl_goToAngle(destination->angle);
+			travelCtrl_goToAngle(destination->angle, &destination->stamp, destination->ampli >= AUDIOP__AMPLI_SOURCE_CLOSE);
 		}
 	}
 
+	//The robot stopped at an obstacle which is not the source, no need to back off from it
+	if(obstacleReason == TRAVCTRL__BLOCKED){
+		comms_printf( "\n\rThe robot is blocked by an obstacle, please select a new penguin.\n\r");
+		return DESTINATION_BLOCKED;
+	}
+
 	return AUDIOP__SUCCESS;
 }
 
@@ -337,6 +539,9 @@ void escapeKiller(void)
 	Destination killer;
 	killer.freq =	AUDIOP__UNINITIALIZED_FREQ;
 	killer.angle = 	0;
+	killer.valid = 	false;
+	killer.stamp.frame = 	TRACE__NO_FRAME;
+	killer.ampli = 	0;
 
 	killerIsComing =true;
 	while(killerIsComing){
@@ -344,7 +549,7 @@ void escapeKiller(void)
 			killerIsComing = false;
 		}
 		else{
-			travelCtrl_goToAngle(killer.angle);
+			travelCtrl_goToAngle(killer.angle, &killer.stamp, false);
 		}
 	}
 
@@ -352,7 +557,7 @@ void escapeKiller(void)
 
 void printSources(uint16_t nb_sources, Destination *destination_scan)
 {
-	//We are sure there are no more errors or killer whales inside destination_scan, so we do not check for errors here
+	//There are no killer whales inside destination_scan, but some sources might not have a valid angle
 	comms_printf( "The following penguins are available: \n\r");
 	if(nb_sources==0){
 		comms_printf("    ...No penguins were found...\n\r");
@@ -360,20 +565,26 @@ void printSources(uint16_t nb_sources, Destination *destination_scan)
 	}
 	else{
 		for (uint8_t source_counter = 0; source_counter < nb_sources; source_counter++) {
-			comms_printf("Penguin %d :	 frequency =%u		angle =%d \n\r", source_counter,
-					audioP_convertFreq(destination_scan[source_counter].freq), destination_scan[source_counter].angle);
+			if(destination_scan[source_counter].valid){
+				comms_printf("Penguin %d :	 frequency =%u		angle =%d \n\r", source_counter,
+						audioP_convertFreq(destination_scan[source_counter].freq), destination_scan[source_counter].angle);
+			}
+			else{
+				comms_printf("Penguin %d :	 frequency =%u		angle unknown \n\r", source_counter,
+						audioP_convertFreq(destination_scan[source_counter].freq));
+			}
 		}
 	}
 }
 
-void destinationReached(void)
+void destinationReached(uint16_t backupMs)
 {
 	comms_printf("\n\r\n\r Final destination reached! \n\r\n\r\n\r");
 	palSetPad(GPIOB, GPIOB_LED_BODY);
 	chThdSleepMilliseconds(SEC_2);
 
 	travCtrl_moveBackwards();				//moves backwards in case robot wants to go to another source
-	chThdSleepMilliseconds(SEC_3);
+	chThdSleepMilliseconds(backupMs);
 
 	travCtrl_stopMoving();
 	palClearPad(GPIOB, GPIOB_LED_BODY);
@@ -381,6 +592,390 @@ void destinationReached(void)
 }
 
 
+void printPlan(void)
+{
+	uint16_t freqs[PLANNER__NB_TARGETS_MAX];
+	uint8_t nbSteps = planner_getPlan(freqs, PLANNER__NB_TARGETS_MAX);
+
+	comms_printf("Plan of %u penguins, about %U s:", nbSteps, (uint32_t) planner_getPlanTimeS());
+	for(uint8_t step_counter = 0; step_counter < nbSteps; step_counter++){
+		comms_printf(" %u Hz", freqs[step_counter]);
+	}
+	comms_printf("\n\r");
+}
+
+
+
+void postUserRequest(uint8_t request, uint16_t value)
+{
+	chSysLock();
+	userRequest = request;
+	userRequestValue = value;
+	chSysUnlock();
+}
+
+uint8_t takeUserRequest(uint16_t *value)
+{
+	uint8_t request = USER_REQUEST_NONE;
+
+	chSysLock();
+	request = userRequest;
+	*value = userRequestValue;
+	userRequest = USER_REQUEST_NONE;
+	chSysUnlock();
+
+	return request;
+}
+
+bool parseInteger(const char *text, long min, long max, long *value)
+{
+	char *endTextReadPointer;
+	long number 			= strtol(text, &endTextReadPointer, NUM_BASE_10);
+
+	if(endTextReadPointer == text || *endTextReadPointer != '\0' || number < min || number > max){
+		return false;
+	}
+	*value = number;
+	return true;
+}
+
+bool selectSource(uint8_t request, uint16_t value, Destination *destination)
+{
+	uint16_t index 		= nbSourcesScan;
+	uint16_t freqError 	= FREQ_SELECT_TOLERANCE_HZ+1;
+
+	if(request == USER_REQUEST_SELECT_INDEX){
+		if(value >= nbSourcesScan){
+			comms_printf( "It seems the number %u you just entered is not a valid source. Please try again !\n\r", value);
+			return false;
+		}
+		index = value;
+	}
+	else{
+		//the closest source in frequency, if it is close enough
+		for(uint16_t source_counter = 0; source_counter < nbSourcesScan; source_counter++){
+			if((uint16_t) abs(audioP_convertFreq(sourcesScan[source_counter].freq) - value) < freqError){
+				freqError = (uint16_t) abs(audioP_convertFreq(sourcesScan[source_counter].freq) - value);
+				index = source_counter;
+			}
+		}
+		if(index == nbSourcesScan){
+			comms_printf( "There is no penguin at %u Hz. Please try again !\n\r", value);
+			return false;
+		}
+	}
+
+	comms_printf( "The robot will now go to penguin %u ...\n\r", index);
+	destination->freq = sourcesScan[index].freq;
+	destination->angle = sourcesScan[index].angle;
+	destination->valid = sourcesScan[index].valid;
+	destination->stamp = sourcesScan[index].stamp;
+	destination->ampli = sourcesScan[index].ampli;
+	return true;
+}
+
+void registerCommands(void)
+{
+	comms_registerCommand("sel", "sel <n> : goes to penguin n of the last scan", selCommand);
+	comms_registerCommand("freq", "freq <Hz> : goes to the penguin crying at this frequency", freqCommand);
+	comms_registerCommand("rescan", "rescan : stops and scans the penguins again", rescanCommand);
+	comms_registerCommand("set", "set sources <n> | mode pid|prop | gains <kp> <ki> <kd> | prop <max angle> <ema> | audio <ampli> <freq bins> <errors> <ema> | telem <mask>", setCommand);
+	comms_registerCommand("stats", "stats : prints the communication statistics", statsCommand);
+	comms_registerCommand("mission", "mission manual | nearest | loudest | list <Hz>... | plan | stats", missionCommand);
+	comms_registerCommand("prof", "prof [reset] : prints the timing of the pipeline stages (us), or clears it", profCommand);
+	comms_registerCommand("latency", "latency [reset] : prints the sound to motor latency percentiles (us), or clears them", latencyCommand);
+	comms_registerCommand("sysmon", "sysmon [reset] : prints the threads cpu and free stack, loop deadlines and waits, or clears them", sysmonCommand);
+	comms_registerCommand("capture", "capture <bursts> | stop : sends bursts of raw microphone samples as telemetry", captureCommand);
+#if BENCH__ENABLED
+	comms_registerCommand("bench", "bench [repetitions] : times the dsp kernels (csv), run it with the robot stopped", benchCommand);
+#endif
+}
+
+void selCommand(uint8_t argc, char *argv[])
+{
+	char *endTextReadPointer;
+	long index = 0;
+
+	if(argc == 2){
+		index = strtol(argv[1], &endTextReadPointer, NUM_BASE_10);
+		if(endTextReadPointer != argv[1] && index >= 0 && index < AUDIOP__NB_SOURCES_MAX){
+			postUserRequest(USER_REQUEST_SELECT_INDEX, (uint16_t) index);
+			return;
+		}
+	}
+	comms_printf("usage: sel <n>\n\r");
+}
+
+void freqCommand(uint8_t argc, char *argv[])
+{
+	char *endTextReadPointer;
+	long freq = 0;
+
+	if(argc == 2){
+		freq = strtol(argv[1], &endTextReadPointer, NUM_BASE_10);
+		if(endTextReadPointer != argv[1] && freq > 0 && freq < UINT16_MAX){
+			postUserRequest(USER_REQUEST_SELECT_FREQ, (uint16_t) freq);
+			return;
+		}
+	}
+	comms_printf("usage: freq <Hz>\n\r");
+}
+
+void rescanCommand(uint8_t argc, char *argv[])
+{
+	(void) argc;
+	(void) argv;
+	postUserRequest(USER_REQUEST_RESCAN, 0);
+}
+
+void setCommand(uint8_t argc, char *argv[])
+{
+	long nbSources 			= 0;
+	long freqThd 			= 0;
+	long nbErrors 			= 0;
+
+	//an integer out of the range of its setting prints the usage, it is not narrowed to another value
+	if(argc == 3 && strcmp(argv[1], "sources") == 0 && parseInteger(argv[2], 1, AUDIOP__NB_SOURCES_MAX, &nbSources)){
+		audioP_setNbSourcesMax((uint8_t) nbSources);
+		comms_printf("at most %u sources\n\r", audioP_getNbSourcesMax());
+	}
+	else if(argc == 3 && strcmp(argv[1], "mode") == 0 && strcmp(argv[2], "pid") == 0){
+		travCtrl_setMode(TRAVCTRL__MODE_PID);
+	}
+	else if(argc == 3 && strcmp(argv[1], "mode") == 0 && strcmp(argv[2], "prop") == 0){
+		travCtrl_setMode(TRAVCTRL__MODE_PROPORTIONAL);
+	}
+	else if(argc == 5 && strcmp(argv[1], "gains") == 0){
+		travCtrl_setPidGains(strtof(argv[2], NULL), strtof(argv[3], NULL), strtof(argv[4], NULL));
+	}
+	else if(argc == 4 && strcmp(argv[1], "prop") == 0){
+		travCtrl_setPropGains((int16_t) strtol(argv[2], NULL, NUM_BASE_10), strtof(argv[3], NULL));
+	}
+	else if(argc == 6 && strcmp(argv[1], "audio") == 0 && parseInteger(argv[3], 1, AUDIOP__SCAN_BINS, &freqThd)
+			&& parseInteger(argv[4], 1, UINT8_MAX, &nbErrors)){
+		AudioPTuning tuning;
+
+		tuning.ampliThd = strtof(argv[2], NULL);
+		tuning.freqThd = (uint8_t) freqThd;
+		tuning.nbErrorDetectedMax = (uint8_t) nbErrors;
+		tuning.emaWeight = strtof(argv[5], NULL);
+		audioP_setTuning(&tuning);
+		audioP_getTuning(&tuning);
+		comms_printf("audio: ampli %d, freq %u bins, errors %u, ema %d/100\n\r", (int) tuning.ampliThd, tuning.freqThd,
+				tuning.nbErrorDetectedMax, (int) (tuning.emaWeight*100));
+	}
+	else if(argc == 3 && strcmp(argv[1], "telem") == 0){
+		telem_setStreams((uint32_t) strtoul(argv[2], NULL, 0));		//base 0 to accept 0x.. masks
+		comms_printf("telemetry streams 0x%x\n\r", telem_getStreams());
+	}
+	else{
+		comms_printf("usage: set sources <1..%u> | mode pid|prop | gains <kp> <ki> <kd> | prop <max angle> <ema> | audio <ampli> <1..%u freq bins> <1..%u errors> <ema> | telem <mask>\n\r",
+				AUDIOP__NB_SOURCES_MAX, AUDIOP__SCAN_BINS, UINT8_MAX);
+	}
+}
+
+void statsCommand(uint8_t argc, char *argv[])
+{
+	uint32_t droppedBytes 		= 0;
+	uint32_t droppedMessages 	= 0;
+	uint32_t sentFrames 			= 0;
+	uint32_t droppedFrames 		= 0;
+
+	(void) argc;
+	(void) argv;
+
+	comms_getTxStats(&droppedBytes, &droppedMessages);
+	telem_getStats(&sentFrames, &droppedFrames);
+	comms_printf("output dropped: %U bytes in %U messages, input lines dropped: %U\n\r",
+			droppedBytes, droppedMessages, comms_getRxDroppedLines());
+	comms_printf("telemetry frames sent: %U, dropped: %U\n\r", sentFrames, droppedFrames);
+}
+
+void missionCommand(uint8_t argc, char *argv[])
+{
+	uint16_t freqs[MISSION__FREQ_LIST_MAX];
+	MissionStat stats;
+
+	if(argc == 2 && strcmp(argv[1], "manual") == 0){
+		mission_setPolicy(MISSION__MANUAL);
+	}
+	else if(argc == 2 && strcmp(argv[1], "nearest") == 0){
+		mission_setPolicy(MISSION__NEAREST_BEARING);
+	}
+	else if(argc == 2 && strcmp(argv[1], "loudest") == 0){
+		mission_setPolicy(MISSION__LOUDEST);
+	}
+	else if(argc == 2 && strcmp(argv[1], "plan") == 0){
+		mission_setPolicy(MISSION__PLANNED);
+	}
+	else if(argc > MISSION__FREQ_LIST_MAX + 2 && strcmp(argv[1], "list") == 0){
+		comms_printf("mission list: at most %u frequencies, the policy is not changed\n\r", MISSION__FREQ_LIST_MAX);
+	}
+	else if(argc >= 3 && strcmp(argv[1], "list") == 0){
+		for(uint8_t arg_counter = 2; arg_counter < argc; arg_counter++){
+			freqs[arg_counter-2] = (uint16_t) strtol(argv[arg_counter], NULL, NUM_BASE_10);
+		}
+		mission_setFreqList(freqs, (uint8_t) (argc-2));
+		mission_setPolicy(MISSION__FREQ_LIST);
+	}
+	else if(argc == 2 && strcmp(argv[1], "stats") == 0){
+		mission_getStats(&stats);
+		comms_printf("mission policy %u: %U visits, %U blocked, %U lost in %U s, %U visits per hour\n\r", mission_getPolicy(),
+				stats.visits, stats.blocked, stats.lost, stats.elapsedS, stats.visitsPerHour);
+	}
+	else{
+		comms_printf("usage: mission manual | nearest | loudest | list <Hz>... | plan | stats\n\r");
+	}
+}
+
+void profCommand(uint8_t argc, char *argv[])
+{
+	ProfStat stats;
+	uint8_t lastBin 		= 0;
+
+	if(argc == 2 && strcmp(argv[1], "reset") == 0){
+		prof_reset();
+		return;
+	}
+	if(argc != 1){
+		comms_printf("usage: prof [reset]\n\r");
+		return;
+	}
+	if(PROF__ENABLED == 0){
+		comms_printf("profiling is disabled, build with -DPROF__ENABLED=1\n\r");
+		return;
+	}
+
+	//durations in us with one decimal, then the histogram bins up to the last one used: <1us, <2us, <4us...
+	for(uint8_t stage_counter = 0; stage_counter < PROF__NB_STAGES; stage_counter++){
+		prof_getStats(stage_counter, &stats);
+		comms_printf("%s: %U runs, min %U.%U max %U.%U mean %U.%U, hist", prof_getStageName(stage_counter), stats.count,
+				stats.minNs/1000, (stats.minNs%1000)/100, stats.maxNs/1000, (stats.maxNs%1000)/100,
+				stats.meanNs/1000, (stats.meanNs%1000)/100);
+		lastBin = PROF__HIST_BINS;
+		while(lastBin > 0 && stats.histogram[lastBin-1] == 0){
+			lastBin--;
+		}
+		for(uint8_t bin_counter = 0; bin_counter < lastBin; bin_counter++){
+			comms_printf(" %U", stats.histogram[bin_counter]);
+		}
+		comms_printf("\n\r");
+	}
+}
+
+void latencyCommand(uint8_t argc, char *argv[])
+{
+	TracePercentile percentiles;
+	uint32_t lastFrame 		= 0;
+	uint32_t nbTraces 		= 0;
+
+	if(argc == 2 && strcmp(argv[1], "reset") == 0){
+		trace_reset();
+		return;
+	}
+	if(argc != 1){
+		comms_printf("usage: latency [reset]\n\r");
+		return;
+	}
+
+	trace_getLast(&lastFrame, &nbTraces);
+	comms_printf("%U traces, last frame %U\n\r", nbTraces, lastFrame);
+	for(uint8_t segment_counter = 0; segment_counter < TRACE__NB_SEGMENTS; segment_counter++){
+		trace_getPercentiles(segment_counter, &percentiles);
+		comms_printf("%s: p50 %U p90 %U p99 %U max %U\n\r", trace_getSegmentName(segment_counter),
+				percentiles.p50Us, percentiles.p90Us, percentiles.p99Us, percentiles.maxUs);
+	}
+}
+
+void sysmonCommand(uint8_t argc, char *argv[])
+{
+	SysmonThread threads[SYSMON__NB_THREADS_MAX];
+	SysmonLoop loop;
+	SysmonWait wait;
+	uint8_t nbThreads 		= 0;
+
+	if(argc == 2 && strcmp(argv[1], "reset") == 0){
+		sysmon_reset();
+		return;
+	}
+	if(argc != 1){
+		comms_printf("usage: sysmon [reset]\n\r");
+		return;
+	}
+
+	//cpu in % with one decimal since the previous sysmon, ? when not available with this chconf.h
+	nbThreads = sysmon_getThreads(threads, SYSMON__NB_THREADS_MAX);
+	for(uint8_t thread_counter = 0; thread_counter < nbThreads; thread_counter++){
+		comms_printf("%s: prio %u", threads[thread_counter].name, threads[thread_counter].prio);
+		if(threads[thread_counter].cpuPermille == SYSMON__UNKNOWN){
+			comms_printf(", cpu ?");
+		}
+		else{
+			comms_printf(", cpu %U.%U%%", threads[thread_counter].cpuPermille/10, threads[thread_counter].cpuPermille%10);
+		}
+		if(threads[thread_counter].stackFreeBytes == SYSMON__UNKNOWN){
+			comms_printf(", stack free ?\n\r");
+		}
+		else{
+			comms_printf(", stack free %U B\n\r", threads[thread_counter].stackFreeBytes);
+		}
+	}
+
+	for(uint8_t loop_counter = 0; loop_counter < SYSMON__NB_LOOPS; loop_counter++){
+		sysmon_getLoop(loop_counter, &loop);
+		comms_printf("%s: %U runs, %U missed, lateness min %D max %D mean %D us\n\r", sysmon_getLoopName(loop_counter),
+				loop.runs, loop.missed, loop.minLatenessUs, loop.maxLatenessUs, loop.meanLatenessUs);
+	}
+	for(uint8_t wait_counter = 0; wait_counter < SYSMON__NB_WAITS; wait_counter++){
+		sysmon_getWait(wait_counter, &wait);
+		comms_printf("%s: %U waits, %U ms in total, max %U us, %U.%U%% of the time\n\r", sysmon_getWaitName(wait_counter),
+				wait.count, wait.totalMs, wait.maxUs, wait.permille/10, wait.permille%10);
+	}
+}
+
+void captureCommand(uint8_t argc, char *argv[])
+{
+	if(argc == 2 && strcmp(argv[1], "stop") == 0){
+		micCap_start(0);
+	}
+	else if(argc == 2){
+		micCap_start((uint16_t) strtol(argv[1], NULL, NUM_BASE_10));
+	}
+	else{
+		comms_printf("usage: capture <bursts> | stop\n\r");
+		return;
+	}
+	comms_printf("capture: %u bursts of %u blocks to send\n\r", micCap_getRemainingBursts(), MICCAP__BURST_BLOCKS);
+}
+
+#if BENCH__ENABLED
+void benchCommand(uint8_t argc, char *argv[])
+{
+	BenchResult result;
+	uint16_t repetitions 	= BENCH__REPETITIONS_DEFAULT;
+
+	if(argc == 2){
+		repetitions = (uint16_t) strtol(argv[1], NULL, NUM_BASE_10);
+	}
+	if(argc > 2 || repetitions == 0){
+		comms_printf("usage: bench [repetitions]\n\r");
+		return;
+	}
+
+	//same csv as host/dsp_bench, which can compare a copy of this output to a baseline
+	comms_printf("%s\n\r", BENCH__CSV_HEADER);
+	for(uint8_t case_counter = 0; case_counter < bench_getNbCases(); case_counter++){
+		bench_run(case_counter, repetitions, &result);
+		while(comms_getTxFree() < BENCH_LINE_MAX){
+			chThdSleepMilliseconds(BENCH_TX_POLL_MS);
+		}
+		comms_printf("%s,%s,%u,%u,%U,%U,%U\n\r", result.kernel, result.input, result.size, result.repetitions,
+				result.minNs, result.meanNs, result.errorPpm);
+	}
+}
+#endif
+
+
 
 /*===========================================================================*/
 /* Code to protect against smashing */
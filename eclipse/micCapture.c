@@ -0,0 +1,203 @@
+/*
+ * micCapture.c
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Captures bursts of raw microphone blocks and sends them as TELEM__MSG_AUDIO frames.
+ * 		The microphone callback only copies the blocks while a burst is being captured, the sending thread
+ * 		then owns the burst buffer until it was sent, so no lock is needed: the state tells who owns it.
+ *
+ * Functions prefix for public functions in this file: micCap_
+ */
+
+#include <string.h>
+
+#include <ch.h>
+
+#include <micCapture.h>
+#include <telemetry.h>
+#include <comms.h>
+
+
+/*===========================================================================*/
+/* Constants definition for this file						               */
+/*===========================================================================*/
+
+#define BLOCK_SAMPLES						(MICCAP__NB_MICS*MICCAP__BLOCK_FRAMES)
+#define CHUNK_SAMPLES						(MICCAP__NB_MICS*MICCAP__CHUNK_FRAMES)
+#define SAMPLE_SIZE							2			//bytes of an int16_t sample, for the preprocessor checks
+#define CHUNK_PAYLOAD_SIZE					(TELEM__AUDIO_HEADER_SIZE + CHUNK_SAMPLES*SAMPLE_SIZE)
+
+#define TX_FREE_MIN							TELEM__MAX_ENCODED	//a chunk is only sent when the comms queue can take it
+#define TX_POLL_MS							10			//the 115200 baud link drains about 115 bytes in this time
+
+#define MIC_CAPTURE_WORKING_AREA_SIZE		1024			//a chunk payload is built on the stack
+
+#if MICCAP__BLOCK_FRAMES % MICCAP__CHUNK_FRAMES != 0
+#error "MICCAP__BLOCK_FRAMES must be a multiple of MICCAP__CHUNK_FRAMES"
+#endif
+#if CHUNK_PAYLOAD_SIZE > TELEM__MAX_PAYLOAD
+#error "a chunk of MICCAP__CHUNK_FRAMES frames does not fit in a telemetry frame"
+#endif
+
+//States of the burst buffer
+#define CAPTURE_IDLE							0
+#define CAPTURE_FILLING						1			//owned by the microphone callback
+#define CAPTURE_SENDING						2			//owned by the sending thread
+
+
+/*===========================================================================*/
+/* Structures						 			                            */
+/*===========================================================================*/
+
+/*
+ * Captured block of the microphones
+ */
+typedef struct MicCapBlocks {
+	uint32_t index;
+	uint32_t time;
+	int16_t samples[BLOCK_SAMPLES];
+} MicCapBlock;
+
+
+/*===========================================================================*/
+/* Static variables definitions 		 			                            */
+/*===========================================================================*/
+
+static MicCapBlock burst[MICCAP__BURST_BLOCKS];
+static uint8_t nbBurstBlocks 					= 0;
+static volatile uint8_t captureState 			= CAPTURE_IDLE;
+static volatile uint16_t remainingBursts 		= 0;
+static uint32_t blockIndex 						= 0;		//blocks given by the microphones since start
+static BSEMAPHORE_DECL(burstFull, TRUE);
+
+
+/*===========================================================================*/
+/* Private functions definitions                                             */
+/*===========================================================================*/
+
+/**
+ * @brief   Sends one chunk of a block, waiting for space in the comms queue
+ *
+ * @return	false if the TELEM__MSG_AUDIO stream was disabled meanwhile
+*/
+bool micCapSendChunk(const MicCapBlock *block, uint8_t chunk);
+
+
+/*===========================================================================*/
+/* Threads used in micCapture                  								*/
+/*===========================================================================*/
+
+/* Sending thread: sends each full burst, it has a low priority as the capture is never urgent */
+static THD_WORKING_AREA(waMicCaptureThd, MIC_CAPTURE_WORKING_AREA_SIZE);
+static THD_FUNCTION(MicCaptureThd, arg)
+{
+	(void)arg;
+	chRegSetThreadName(__FUNCTION__);
+
+	bool streaming 			= true;
+
+	while(true){
+		chBSemWait(&burstFull);
+
+		streaming = true;
+		for(uint8_t block_counter = 0; block_counter < nbBurstBlocks && streaming; block_counter++){
+			for(uint8_t chunk = 0; chunk < MICCAP__NB_CHUNKS && streaming; chunk++){
+				streaming = micCapSendChunk(&burst[block_counter], chunk);
+			}
+		}
+
+		if(remainingBursts > 0){
+			remainingBursts--;
+		}
+		if(remainingBursts == 0 || !streaming){
+			remainingBursts = 0;
+			captureState = CAPTURE_IDLE;
+			telem_setStreams(telem_getStreams() & ~TELEM__STREAM(TELEM__MSG_AUDIO));
+		}
+		else{
+			nbBurstBlocks = 0;
+			captureState = CAPTURE_FILLING;
+		}
+	}
+}
+
+
+/*===========================================================================*/
+/* Public functions for setting/getting internal parameters					  */
+/* Descriptions  are only in the header file (to have a single source of truth) */
+/*===========================================================================*/
+
+void micCap_init(void)
+{
+	chThdCreateStatic(waMicCaptureThd, sizeof(waMicCaptureThd), NORMALPRIO-1, MicCaptureThd, NULL);
+}
+
+void micCap_start(uint16_t nbBursts)
+{
+	remainingBursts = nbBursts;
+	if(nbBursts > 0 && captureState == CAPTURE_IDLE){
+		telem_setStreams(telem_getStreams() | TELEM__STREAM(TELEM__MSG_AUDIO));
+		nbBurstBlocks = 0;
+		captureState = CAPTURE_FILLING;
+	}
+}
+
+uint16_t micCap_getRemainingBursts(void)
+{
+	return remainingBursts;
+}
+
+void micCap_onBlock(const int16_t *data, uint16_t num_samples)
+{
+	MicCapBlock *block 		= NULL;
+
+	blockIndex++;
+	if(captureState != CAPTURE_FILLING || num_samples != BLOCK_SAMPLES){
+		return;
+	}
+
+	block = &burst[nbBurstBlocks];
+	block->index = blockIndex - 1;
+	block->time = chVTGetSystemTimeX();
+	memcpy(block->samples, data, sizeof(block->samples));
+
+	if(++nbBurstBlocks >= MICCAP__BURST_BLOCKS){
+		captureState = CAPTURE_SENDING;
+		chBSemSignal(&burstFull);
+	}
+}
+
+
+/*===========================================================================*/
+/* Private functions	 code												   */
+/*===========================================================================*/
+
+bool micCapSendChunk(const MicCapBlock *block, uint8_t chunk)
+{
+	uint8_t payload[CHUNK_PAYLOAD_SIZE];
+	uint8_t *write 			= payload;
+	const int16_t *samples 	= &block->samples[chunk*CHUNK_SAMPLES];
+
+	write = telem_PutU32(write, block->time);
+	write = telem_PutU32(write, block->index);
+	write = telem_PutU16(write, MICCAP__BLOCK_FRAMES);
+	write = telem_PutU8(write, chunk);
+	write = telem_PutU8(write, MICCAP__NB_CHUNKS);
+	for(uint16_t sample_counter = 0; sample_counter < CHUNK_SAMPLES; sample_counter++){
+		write = telem_PutU16(write, (uint16_t) samples[sample_counter]);
+	}
+
+	//The queue is shared with the text and the other streams, which may take the space first
+	while(true){
+		if(!telem_isStreaming(TELEM__MSG_AUDIO)){
+			return false;
+		}
+		if(comms_getTxFree() >= TX_FREE_MIN && telem_send(TELEM__MSG_AUDIO, payload, sizeof(payload))){
+			return true;
+		}
+		chThdSleepMilliseconds(TX_POLL_MS);
+	}
+}
@@ -0,0 +1,69 @@
+/*
+ * micCapture.h
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Capture of the raw samples of the microphones, to replay field failures on the host (see
+ * 		host/captureFile.h and host/capture_replay.c). The blocks given by mic_start are numbered since start and
+ * 		stamped with their system time. The 4 microphones need 128kB/s, far more than the 115200 baud link, so they are
+ * 		captured in bursts: MICCAP__BURST_BLOCKS consecutive blocks are copied in RAM, which is more than one FFT frame,
+ * 		then sent as TELEM__MSG_AUDIO frames as fast as the link allows, and the next burst starts with the next block.
+ * 		The block indexes show the gaps between the bursts.
+ * Function prefix for public functions in this file: micCap_
+ * Constant prefix for public constants in this file: MICCAP__
+ */
+#ifndef MICCAPTURE_H_
+#define MICCAPTURE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*===========================================================================*/
+/* Constants definition for this library						               */
+/*===========================================================================*/
+
+#define MICCAP__NB_MICS						4			//interleaved right, left, back, front, as mic_start
+#define MICCAP__BLOCK_FRAMES					160			//frames of a mic_start callback
+#define MICCAP__CHUNK_FRAMES					40			//frames of a TELEM__MSG_AUDIO frame, 320 bytes of samples
+#define MICCAP__NB_CHUNKS					(MICCAP__BLOCK_FRAMES/MICCAP__CHUNK_FRAMES)
+
+//Blocks of a burst, 1280 bytes of RAM each, can be overridden at build time. 8 blocks hold 1280 frames (80ms).
+#ifndef MICCAP__BURST_BLOCKS
+#define MICCAP__BURST_BLOCKS					8
+#endif
+
+
+/*===========================================================================*/
+/* Public functions definitions            									 */
+/*===========================================================================*/
+
+/*
+ * @brief	Starts the thread which sends the bursts, nothing is captured before micCap_start
+ */
+void micCap_init(void);
+
+/*
+ * @brief	Captures and sends a number of bursts, the TELEM__MSG_AUDIO stream is enabled until the last one is sent
+ *
+ *  @param[in] nbBursts		bursts to capture, 0 stops after the burst being captured or sent
+ */
+void micCap_start(uint16_t nbBursts);
+
+/*
+ * @brief	Returns the number of bursts still to capture or send
+ */
+uint16_t micCap_getRemainingBursts(void);
+
+/*
+ * @brief	Gives a block of the microphones to the capture, to be called first by the callback of mic_start
+ * @note 	Only copies the block when a burst is being captured
+ *
+ *  @param[in] data			interleaved samples, as given to the callback
+ *  @param[in] num_samples	number of samples of all the microphones
+ */
+void micCap_onBlock(const int16_t *data, uint16_t num_samples);
+
+
+#endif /* MICCAPTURE_H_ */
@@ -0,0 +1,236 @@
+/*
+ * mission.c
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Mission policies choosing the next penguin to go to without an operator, and statistics of the visits.
+ * 		The policy and frequency list are set by the command handlers, in the comms reception thread,
+ * 		and used by the main thread, so they are copied under chSysLock.
+ *
+ * Functions prefix for public functions in this file: mission_
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <ch.h>
+
+#include <planner.h>
+#include <mission.h>
+
+
+/*===========================================================================*/
+/* Constants definition for this file						               */
+/*===========================================================================*/
+
+#define FREQ_TOLERANCE_HZ					45			//a source matches a frequency of the list if it is this close, as FREQ_THD
+#define SECONDS_PER_HOUR						3600
+
+
+/*===========================================================================*/
+/* Static variables definitions 		 			                            */
+/*===========================================================================*/
+
+static uint8_t policy 						= MISSION__POLICY_DEFAULT;
+static uint16_t freqList[MISSION__FREQ_LIST_MAX];
+static uint8_t nbFreqList 					= 0;
+static uint8_t freqListIndex 				= 0;		//next frequency of the list to visit
+static bool planReset 						= true;		//the planner is only used by the main thread, it is reset there
+
+static uint16_t lastTargetFreq 				= AUDIOP__UNINITIALIZED_FREQ;	//FFT-domain, as in Destination
+static systime_t missionStart 				= 0;
+static uint32_t nbVisits 					= 0;
+static uint32_t nbBlocked 					= 0;
+static uint32_t nbLost 						= 0;
+
+
+/*===========================================================================*/
+/* Private functions definitions                                             */
+/*===========================================================================*/
+
+/**
+ * @brief   Checks whether a source can be chosen: it has an angle and was not the last target
+ *
+ * @parameter[in] allowLast		the last target can be chosen as well
+*/
+bool missionIsCandidate(const Destination *source, bool allowLast);
+
+/**
+ * @brief   Chooses with the MISSION__NEAREST_BEARING or MISSION__LOUDEST policy
+*/
+uint16_t missionChooseBest(const Destination *scan, uint16_t nbSources, uint8_t currentPolicy, bool allowLast);
+
+/**
+ * @brief   Chooses with the MISSION__FREQ_LIST policy: the first frequency of the list found in scan, from freqListIndex on
+ *
+ * @parameter[out] listIndex		index in the list of the frequency chosen
+*/
+uint16_t missionChooseFromList(const Destination *scan, uint16_t nbSources, bool allowLast, uint8_t *listIndex);
+
+
+/*===========================================================================*/
+/* Public functions for setting/getting internal parameters					  */
+/* Descriptions  are only in the header file (to have a single source of truth) */
+/*===========================================================================*/
+
+void mission_setPolicy(uint8_t newPolicy)
+{
+	chSysLock();
+	policy = newPolicy;
+	planReset = true;
+	missionStart = chVTGetSystemTimeX();
+	nbVisits = 0;
+	nbBlocked = 0;
+	nbLost = 0;
+	chSysUnlock();
+}
+
+uint8_t mission_getPolicy(void)
+{
+	return policy;
+}
+
+void mission_setFreqList(const uint16_t *freqsHz, uint8_t nbFreqs)
+{
+	if(nbFreqs > MISSION__FREQ_LIST_MAX){
+		nbFreqs = MISSION__FREQ_LIST_MAX;
+	}
+
+	chSysLock();
+	memcpy(freqList, freqsHz, nbFreqs*sizeof(uint16_t));
+	nbFreqList = nbFreqs;
+	freqListIndex = 0;
+	chSysUnlock();
+}
+
+uint16_t mission_chooseSource(const Destination *scan, uint16_t nbSources)
+{
+	uint8_t currentPolicy 	= policy;
+	uint16_t choice 			= MISSION__NO_CHOICE;
+	uint8_t listIndex 		= 0;
+	bool reset 				= false;
+
+	if(currentPolicy == MISSION__FREQ_LIST){
+		choice = missionChooseFromList(scan, nbSources, false, &listIndex);
+		if(choice == MISSION__NO_CHOICE){
+			choice = missionChooseFromList(scan, nbSources, true, &listIndex);
+		}
+		if(choice != MISSION__NO_CHOICE){
+			freqListIndex = listIndex;
+		}
+	}
+	else if(currentPolicy == MISSION__PLANNED){
+		chSysLock();
+		reset = planReset;
+		planReset = false;
+		chSysUnlock();
+		if(reset){
+			planner_reset();
+		}
+		choice = planner_update(scan, nbSources);
+	}
+	else if(currentPolicy != MISSION__MANUAL){
+		choice = missionChooseBest(scan, nbSources, currentPolicy, false);
+		if(choice == MISSION__NO_CHOICE){
+			choice = missionChooseBest(scan, nbSources, currentPolicy, true);
+		}
+	}
+
+	return choice;
+}
+
+void mission_recordOutcome(const Destination *destination, uint8_t outcome)
+{
+	if(policy == MISSION__PLANNED){
+		planner_markDone(destination->freq, outcome == MISSION__VISITED);
+	}
+
+	chSysLock();
+	//whatever happened, another penguin is preferred next, so that a blocked or lost one does not stall the mission
+	lastTargetFreq = destination->freq;
+	switch(outcome){
+	case MISSION__VISITED:
+		nbVisits++;
+		//the list goes on with the next frequency after a visit
+		if(policy == MISSION__FREQ_LIST && nbFreqList > 0){
+			freqListIndex = (uint8_t) ((freqListIndex + 1) % nbFreqList);
+		}
+		break;
+	case MISSION__BLOCKED:
+		nbBlocked++;
+		break;
+	default:
+		nbLost++;
+		break;
+	}
+	chSysUnlock();
+}
+
+void mission_getStats(MissionStat *stats)
+{
+	chSysLock();
+	stats->visits = nbVisits;
+	stats->blocked = nbBlocked;
+	stats->lost = nbLost;
+	stats->elapsedS = (chVTGetSystemTimeX() - missionStart)/CH_CFG_ST_FREQUENCY;			//ST2MS overflows after a few minutes
+	chSysUnlock();
+
+	stats->visitsPerHour = (stats->elapsedS > 0) ? (stats->visits * SECONDS_PER_HOUR) / stats->elapsedS : 0;
+}
+
+
+/*===========================================================================*/
+/* Private functions	 code												   */
+/*===========================================================================*/
+
+bool missionIsCandidate(const Destination *source, bool allowLast)
+{
+	if(source->valid == false){
+		return false;
+	}
+	return allowLast || lastTargetFreq == AUDIOP__UNINITIALIZED_FREQ
+			|| abs(audioP_convertFreq(source->freq) - audioP_convertFreq(lastTargetFreq)) >= FREQ_TOLERANCE_HZ;
+}
+
+uint16_t missionChooseBest(const Destination *scan, uint16_t nbSources, uint8_t currentPolicy, bool allowLast)
+{
+	uint16_t choice = MISSION__NO_CHOICE;
+
+	for(uint16_t source_counter = 0; source_counter < nbSources; source_counter++){
+		if(missionIsCandidate(&scan[source_counter], allowLast) == false){
+			continue;
+		}
+		if(choice == MISSION__NO_CHOICE
+				|| (currentPolicy == MISSION__NEAREST_BEARING && abs(scan[source_counter].angle) < abs(scan[choice].angle))
+				|| (currentPolicy == MISSION__LOUDEST && scan[source_counter].ampli > scan[choice].ampli)){
+			choice = source_counter;
+		}
+	}
+	return choice;
+}
+
+uint16_t missionChooseFromList(const Destination *scan, uint16_t nbSources, bool allowLast, uint8_t *listIndex)
+{
+	uint16_t freqs[MISSION__FREQ_LIST_MAX];
+	uint8_t nbFreqs = 0;
+	uint8_t firstIndex = 0;
+
+	chSysLock();
+	memcpy(freqs, freqList, sizeof(freqs));
+	nbFreqs = nbFreqList;
+	firstIndex = freqListIndex;
+	chSysUnlock();
+
+	for(uint8_t list_counter = 0; list_counter < nbFreqs; list_counter++){
+		*listIndex = (uint8_t) ((firstIndex + list_counter) % nbFreqs);
+		for(uint16_t source_counter = 0; source_counter < nbSources; source_counter++){
+			if(missionIsCandidate(&scan[source_counter], allowLast)
+					&& abs(audioP_convertFreq(scan[source_counter].freq) - freqs[*listIndex]) < FREQ_TOLERANCE_HZ){
+				return source_counter;
+			}
+		}
+	}
+	return MISSION__NO_CHOICE;
+}
@@ -0,0 +1,113 @@
+/*
+ * mission.h
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Mission policies choosing the next penguin to go to without an operator, so that the robot can
+ * 		run headless for long unattended runs, and statistics of the visits. With MISSION__MANUAL the user chooses
+ * 		at the prompt as before. Commands typed during a mission (sel, freq, rescan) still override the policy.
+ * Function prefix for public functions in this file: mission_
+ * Constant prefix for public constants in this file: MISSION__
+ */
+#ifndef MISSION_H_
+#define MISSION_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <audio_processing.h>
+
+/*===========================================================================*/
+/* Constants definition for this library						               */
+/*===========================================================================*/
+
+//Policies
+#define MISSION__MANUAL						0			//the user chooses at the prompt
+#define MISSION__NEAREST_BEARING				1			//the penguin with the smallest angle, to turn as little as possible
+#define MISSION__LOUDEST						2			//the penguin with the biggest amplitude, likely the closest
+#define MISSION__FREQ_LIST					3			//the penguins of a list of frequencies, in turn
+#define MISSION__PLANNED						4			//all the penguins in one pass, in the order of the planner (see planner.h)
+
+//Policy at start, can be overridden at build time to start headless (e.g. -DMISSION__POLICY_DEFAULT=MISSION__LOUDEST)
+#ifndef MISSION__POLICY_DEFAULT
+#define MISSION__POLICY_DEFAULT				MISSION__MANUAL
+#endif
+
+#define MISSION__FREQ_LIST_MAX				8
+#define MISSION__NO_CHOICE					UINT16_MAX
+
+//Outcomes of a trip towards a penguin
+#define MISSION__VISITED						0
+#define MISSION__BLOCKED						1
+#define MISSION__LOST						2
+
+
+/*===========================================================================*/
+/* Structures						 			                            */
+/*===========================================================================*/
+
+/*
+ * Statistics since the policy was set
+ */
+typedef struct MissionStats {
+	uint32_t visits;
+	uint32_t blocked;
+	uint32_t lost;
+	uint32_t elapsedS;
+	uint32_t visitsPerHour;
+} MissionStat;
+
+
+/*===========================================================================*/
+/* Public functions definitions            									 */
+/*===========================================================================*/
+
+/*
+ * @brief	Sets the policy, by default MISSION__POLICY_DEFAULT, and restarts the statistics
+ *
+ *  @param[in] newPolicy		MISSION__XXX policy
+ */
+void mission_setPolicy(uint8_t newPolicy);
+
+/*
+ * @brief	Returns the current policy
+ */
+uint8_t mission_getPolicy(void);
+
+/*
+ * @brief	Sets the frequencies visited in turn by MISSION__FREQ_LIST, starting with the first one
+ *
+ *  @param[in] freqsHz		frequencies in Hz
+ *  @param[in] nbFreqs		number of frequencies, at most MISSION__FREQ_LIST_MAX are kept
+ */
+void mission_setFreqList(const uint16_t *freqsHz, uint8_t nbFreqs);
+
+/*
+ * @brief	Chooses the penguin to go to among the scanned sources, with the current policy
+ *
+ *  @param[in] scan			sources found by audioP_analyseSources
+ *  @param[in] nbSources	number of sources in scan
+ *
+ * @return	index of the chosen source in scan, MISSION__NO_CHOICE if none fits the policy or the policy is manual
+ * @note 	The penguin targeted last is only chosen again if it is the only one fitting the policy,
+ * 			so that all penguins get fed and a blocked one does not stall the mission
+ */
+uint16_t mission_chooseSource(const Destination *scan, uint16_t nbSources);
+
+/*
+ * @brief	Records how the trip towards a penguin ended
+ *
+ *  @param[in] destination	the penguin targeted
+ *  @param[in] outcome		MISSION__VISITED, MISSION__BLOCKED or MISSION__LOST
+ */
+void mission_recordOutcome(const Destination *destination, uint8_t outcome);
+
+/*
+ * @brief	Returns the statistics since the policy was set
+ */
+void mission_getStats(MissionStat *stats);
+
+
+#endif /* MISSION_H_ */
@@ -0,0 +1,154 @@
+/*
+ * numeric.h
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Small single-precision and fixed-point helpers shared by the audio and
+ * 		travel controller modules. The Cortex-M4F only has a single-precision FPU, so every
+ * 		literal and every operation here is kept in float (suffix f) or in integer Q15, and
+ * 		never gets promoted to software emulated double.
+ * 		The functions are static inline because they are called in the hot paths.
+ * Function prefix for public functions in this file: num_
+ * Constant prefix for public constants in this file: NUM__
+ */
+#ifndef NUMERIC_H_
+#define NUMERIC_H_
+
+#include <stdint.h>
+
+/*===========================================================================*/
+/* Constants definition for this library						               */
+/*===========================================================================*/
+
+#define NUM__PI_F							3.14159265f
+#define NUM__TWO_PI_F						6.28318531f
+#define NUM__DEG180_F						180.0f
+#define NUM__RAD_TO_DEG_F					(NUM__DEG180_F/NUM__PI_F)
+#define NUM__DEG_TO_RAD_F					(NUM__PI_F/NUM__DEG180_F)
+
+#define NUM__Q15_SHIFT						15
+#define NUM__Q15_ONE						(1L<<NUM__Q15_SHIFT)
+
+/* @note NUM__Q15(x)
+ * Converts a constant in range [0,1] to Q15 fixed-point. It is meant to be used with
+ * constant expressions only, so that the compiler folds it and no float code remains */
+#define NUM__Q15(x)							((int32_t) ((x)*(float)NUM__Q15_ONE + 0.5f))
+
+
+/*===========================================================================*/
+/* Float helpers								 			                    */
+/*===========================================================================*/
+
+/*
+ * @brief	Exponential moving average in float
+ *
+ *  @param[in] past		previous average
+ *  @param[in] sample	new value
+ *  @param[in] weight	range [0,1], weight of the new sample (if smaller past values have more weight)
+ *
+ * @return	updated average
+ */
+static inline float num_EmaF(float past, float sample, float weight)
+{
+	return past + weight*(sample-past);
+}
+
+/*
+ * @brief	Clamps a float between min and max
+ */
+static inline float num_ClampF(float value, float min, float max)
+{
+	if(value > max){
+		return max;
+	}
+	if(value < min){
+		return min;
+	}
+	return value;
+}
+
+/*
+ * @brief	Linear scaling in float: value*gain + offset
+ */
+static inline float num_ScaleF(float value, float gain, float offset)
+{
+	return value*gain + offset;
+}
+
+/*
+ * @brief	Converts an angle from radians into degrees
+ */
+static inline float num_RadToDeg(float rad)
+{
+	return rad*NUM__RAD_TO_DEG_F;
+}
+
+/*
+ * @brief	Converts an angle from degrees into radians
+ */
+static inline float num_DegToRad(float deg)
+{
+	return deg*NUM__DEG_TO_RAD_F;
+}
+
+
+/*
+ * @brief	Wraps an angle in degrees into [-180°,180°[
+ * @note		Meant for angles that are at most a few turns away from this range
+ */
+static inline float num_WrapDeg180F(float deg)
+{
+	while(deg >= NUM__DEG180_F){
+		deg -= 2.0f*NUM__DEG180_F;
+	}
+	while(deg < -NUM__DEG180_F){
+		deg += 2.0f*NUM__DEG180_F;
+	}
+	return deg;
+}
+
+
+/*===========================================================================*/
+/* Fixed-point and integer helpers				 			                */
+/*===========================================================================*/
+
+/*
+ * @brief	Exponential moving average in Q15 fixed-point, for integer signals
+ *
+ *  @param[in] past			previous average
+ *  @param[in] sample		new value
+ *  @param[in] weightQ15		weight of the new sample in Q15, use NUM__Q15(weight) to obtain it
+ *
+ * @return	updated average
+ */
+static inline int32_t num_EmaQ15(int32_t past, int32_t sample, int32_t weightQ15)
+{
+	return past + (((sample-past)*weightQ15) >> NUM__Q15_SHIFT);
+}
+
+/*
+ * @brief	Clamps an int32 between min and max
+ */
+static inline int32_t num_ClampI32(int32_t value, int32_t min, int32_t max)
+{
+	if(value > max){
+		return max;
+	}
+	if(value < min){
+		return min;
+	}
+	return value;
+}
+
+/*
+ * @brief	Linear scaling in Q15 fixed-point: value*gainQ15 + offset
+ */
+static inline int32_t num_ScaleQ15(int32_t value, int32_t gainQ15, int32_t offset)
+{
+	return ((value*gainQ15) >> NUM__Q15_SHIFT) + offset;
+}
+
+
+#endif /* NUMERIC_H_ */
@@ -0,0 +1,255 @@
+/*
+ * obstacleSensor.c
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Fuses the time of flight and infrared proximity sensors in their own thread, and
+ * 		publishes the resulting obstacle state on the messagebus, for the travel controller or any other subscriber.
+ * 		The thread runs at the rate of the proximity sensors (it waits for each of their messages), and
+ * 		reads the latest time of flight distance at the same time, which is only updated at its own slower rate.
+ *
+ * Functions prefix for public functions in this file: obstSens_
+ */
+
+#include <math.h>
+
+#include <ch.h> 							//for chibios threads functionality
+#include <msgbus/messagebus.h>
+
+#include <sensors/VL53L0X/VL53L0X.h>		//Time of flight sensor library
+#include <sensors/proximity.h>			//infrared sensors
+
+#include <obstacleSensor.h>
+#include <numeric.h>
+#include <telemetry.h>
+
+
+/*===========================================================================*/
+/* Constants definition for this file						               */
+/*===========================================================================*/
+
+#define STOP_DISTANCE_VALUE_MM				OBSTSENS__STOP_DISTANCE_MM
+#define INIT_DISTANCE_VALUE_MM				80
+#define TOF_HYSTERESIS_MM					15			//the obstacle is gone when further than STOP_DISTANCE_VALUE_MM+TOF_HYSTERESIS_MM
+
+#define IR_STOP_VALUE						300			//IR threshold for source proximity detection
+#define IR_HYSTERESIS						100			//the obstacle is gone when all IR are under IR_STOP_VALUE-IR_HYSTERESIS
+#define IR_LEFT 								6			//EPUCK IR-seonsor IR7
+#define IR_RIGHT								1			//EPUCK IR-seonsor IR2
+#define IR_FRONT_LEFT 						7			//EPUCK IR-seonsor IR8
+#define IR_FRONT_RIGHT 						0			//EPUCK IR-seonsor IR1
+
+/* @note IR_BEARING_DEG
+ * Direction of each infrared sensor IR1..IR8 on the e-puck2, in degrees positive to the right.
+ * The time of flight sensor looks straight ahead (0°).
+ */
+#define IR_BEARING_DEG						{17, 49, 90, 150, -150, -90, -49, -17}
+#define TOF_BEARING_WEIGHT					IR_STOP_VALUE	//weight of the time of flight in the bearing, when it sees the obstacle
+
+/* @note EMA_WEIGHT_XXX
+ * Weights of the past values in the exponential moving averages (ema), as in the travel controller.
+ * If faster response time overall is needed, reduce EMA_WEIGHT_XXX.
+ */
+#define EMA_WEIGHT_TOF 						0.8f
+#define EMA_WEIGHT_IR 						0.5f
+#define EMA_NEW_WEIGHT_TOF_Q15				NUM__Q15(1.0f-EMA_WEIGHT_TOF)
+#define EMA_NEW_WEIGHT_IR_Q15				NUM__Q15(1.0f-EMA_WEIGHT_IR)
+
+/* @note DISCARD_FIRST_N_TOF_MEASURES
+ * The time of flight sensor returns 0 values for approx 30 cycles, so we set 50 to have a margin and discard those first cycles
+ */
+#define DISCARD_FIRST_N_TOF_MEASURES 		50
+
+#define OBSTACLE_SENSOR_WORKING_AREA_SIZE 	512
+#define TELEMETRY_DIVIDER					5			//one state out of 5 is sent as telemetry
+
+
+/*===========================================================================*/
+/* Static variables definitions 		 			                            */
+/*===========================================================================*/
+
+//Topic where the fused obstacle state is published, and its buffer
+static ObstacleState obstacleTopicBuffer;
+static messagebus_topic_t obstacleTopic;
+static MUTEX_DECL(obstacleTopicLock);
+static CONDVAR_DECL(obstacleTopicCondvar);
+
+extern messagebus_t bus;
+
+
+/*===========================================================================*/
+/* Private functions definitions                                             */
+/*===========================================================================*/
+
+/**
+ * @brief   Filters the newest measurements into state and updates obstacleNear with hysteresis
+ *
+ * @parameter[out] state 	state to update, it holds the past filtered values
+*/
+void obstSensUpdateState(ObstacleState *state);
+
+/**
+ * @brief   Calculates the bearing of the obstacle as the mean direction of the sensors, weighted by their values
+ *
+ * @parameter[in] state 	state with the filtered values
+ *
+ * @return	bearing in degrees, between -180° and 180°, 0 if no sensor sees anything
+*/
+int16_t obstSensCalculateBearing(const ObstacleState *state);
+
+/**
+ * @brief   Sends the state as TELEM__MSG_SENSORS, if this stream is enabled
+*/
+void obstSensSendTelemetry(const ObstacleState *state);
+
+
+/*===========================================================================*/
+/* Threads used in obstacleSensor                  							*/
+/*===========================================================================*/
+
+static THD_WORKING_AREA(waObstacleSensorThd, OBSTACLE_SENSOR_WORKING_AREA_SIZE);
+static THD_FUNCTION(ObstacleSensorThd, arg)
+{
+	(void)arg; 									// silence warning about unused argument
+	chRegSetThreadName(__FUNCTION__);
+
+	messagebus_topic_t *proximityTopic = messagebus_find_topic_blocking(&bus, "/proximity");
+	proximity_msg_t proximityValues;
+	ObstacleState state = {0};
+	uint8_t telemetryCounter = 0;
+
+	state.tofDistanceMm = INIT_DISTANCE_VALUE_MM;
+
+	while(true){
+		//Wait for the next infrared measurement, so the thread runs at the rate of the proximity sensors
+		messagebus_topic_wait(proximityTopic, &proximityValues, sizeof(proximityValues));
+
+		obstSensUpdateState(&state);
+		messagebus_topic_publish(&obstacleTopic, &state, sizeof(state));
+
+		if(++telemetryCounter >= TELEMETRY_DIVIDER){
+			telemetryCounter = 0;
+			obstSensSendTelemetry(&state);
+		}
+	}
+}
+
+
+/*===========================================================================*/
+/* Public functions for setting/getting internal parameters					  */
+/* Descriptions  are only in the header file (to have a single source of truth) */
+/*===========================================================================*/
+
+void obstSens_start(void)
+{
+	//Start the time of flight (TOF) sensor, and start and calibrate the infrared proximity sensors
+	VL53L0X_start();
+	proximity_start();
+	calibrate_ir();
+
+	messagebus_topic_init(&obstacleTopic, &obstacleTopicLock, &obstacleTopicCondvar, &obstacleTopicBuffer, sizeof(obstacleTopicBuffer));
+	messagebus_advertise_topic(&bus, &obstacleTopic, OBSTSENS__TOPIC_NAME);
+
+	chThdCreateStatic(waObstacleSensorThd, sizeof(waObstacleSensorThd), NORMALPRIO, ObstacleSensorThd, NULL);
+}
+
+bool obstSens_getState(ObstacleState *state)
+{
+	if(messagebus_topic_read(&obstacleTopic, state, sizeof(ObstacleState)) == false){
+		*state = (ObstacleState) {0};
+		state->tofDistanceMm = INIT_DISTANCE_VALUE_MM;
+		return false;
+	}
+	return true;
+}
+
+
+/*===========================================================================*/
+/* Private functions	 code												   */
+/*===========================================================================*/
+
+void obstSensUpdateState(ObstacleState *state)
+{
+	static uint8_t discardStartMeasurements 	= 0;
+
+	bool irNear				= false;
+	bool irGone				= true;
+
+	state->time = chVTGetSystemTime();
+
+	//For approx. the first DISCARD_FIRST_N_TOF_MEASURES times VL53L0X_get_dist_mm() is called it returns 0.
+	if(discardStartMeasurements<DISCARD_FIRST_N_TOF_MEASURES){
+		discardStartMeasurements++;
+		state->tofDistanceMm = INIT_DISTANCE_VALUE_MM;
+	}
+	else{
+		state->tofDistanceMm = (uint16_t) num_EmaQ15(state->tofDistanceMm, VL53L0X_get_dist_mm(), EMA_NEW_WEIGHT_TOF_Q15);
+	}
+
+	for(uint8_t ir_counter = 0; ir_counter < OBSTSENS__NB_IR; ir_counter++){
+		state->ir[ir_counter] = (int16_t) num_EmaQ15(state->ir[ir_counter], get_calibrated_prox(ir_counter), EMA_NEW_WEIGHT_IR_Q15);
+	}
+
+	//Only the front and side sensors stop the robot, the back ones are only published
+	const uint8_t stopSensors[] = {IR_FRONT_RIGHT, IR_RIGHT, IR_LEFT, IR_FRONT_LEFT};
+	for(uint8_t i = 0; i < sizeof(stopSensors); i++){
+		irNear = irNear || (state->ir[stopSensors[i]] > IR_STOP_VALUE);
+		irGone = irGone && (state->ir[stopSensors[i]] < IR_STOP_VALUE-IR_HYSTERESIS);
+	}
+
+	//Hysteresis: an obstacle appears under the stop values, and is gone only clearly above them
+	if(state->tofDistanceMm <= STOP_DISTANCE_VALUE_MM || irNear){
+		state->obstacleNear = true;
+	}
+	else if(state->tofDistanceMm > STOP_DISTANCE_VALUE_MM+TOF_HYSTERESIS_MM && irGone){
+		state->obstacleNear = false;
+	}
+
+	state->obstacleBearing = obstSensCalculateBearing(state);
+}
+
+int16_t obstSensCalculateBearing(const ObstacleState *state)
+{
+	static const int16_t irBearing[OBSTSENS__NB_IR] = IR_BEARING_DEG;
+
+	float sumSin 	= 0;
+	float sumCos		= 0;
+
+	for(uint8_t ir_counter = 0; ir_counter < OBSTSENS__NB_IR; ir_counter++){
+		if(state->ir[ir_counter] > 0){
+			sumSin += state->ir[ir_counter] * sinf(num_DegToRad(irBearing[ir_counter]));
+			sumCos += state->ir[ir_counter] * cosf(num_DegToRad(irBearing[ir_counter]));
+		}
+	}
+
+	//The time of flight only counts when it sees the obstacle at stopping distance
+	if(state->tofDistanceMm <= STOP_DISTANCE_VALUE_MM+TOF_HYSTERESIS_MM){
+		sumCos += TOF_BEARING_WEIGHT;
+	}
+
+	if(sumSin == 0 && sumCos == 0){
+		return 0;
+	}
+	return (int16_t) num_RadToDeg(atan2f(sumSin, sumCos));
+}
+
+void obstSensSendTelemetry(const ObstacleState *state)
+{
+	uint8_t payload[sizeof(uint32_t)+sizeof(uint16_t)+OBSTSENS__NB_IR*sizeof(int16_t)+sizeof(uint8_t)+sizeof(int16_t)];
+	uint8_t *write = payload;
+
+	if(telem_isStreaming(TELEM__MSG_SENSORS) == false){
+		return;
+	}
+
+	write = telem_PutU32(write, (uint32_t) state->time);
+	write = telem_PutU16(write, state->tofDistanceMm);
+	for(uint8_t ir_counter = 0; ir_counter < OBSTSENS__NB_IR; ir_counter++){
+		write = telem_PutU16(write, (uint16_t) state->ir[ir_counter]);
+	}
+	write = telem_PutU8(write, state->obstacleNear);
+	write = telem_PutU16(write, (uint16_t) state->obstacleBearing);
+	telem_send(TELEM__MSG_SENSORS, payload, (uint16_t) (write - payload));
+}
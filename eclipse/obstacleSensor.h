@@ -0,0 +1,62 @@
+/*
+ * obstacleSensor.h
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Fuses the time of flight and infrared proximity sensors in their own thread, and
+ * 		publishes the resulting obstacle state on the messagebus, for the travel controller or any other subscriber.
+ * Function prefix for public functions in this file: obstSens_
+ * Constant prefix for public constants in this file: OBSTSENS__
+ */
+#ifndef OBSTACLESENSOR_H_
+#define OBSTACLESENSOR_H_
+
+/*===========================================================================*/
+/* Constants definition for this library						               */
+/*===========================================================================*/
+
+#define OBSTSENS__TOPIC_NAME					"/obstacle"		//name of the topic on the messagebus bus
+#define OBSTSENS__NB_IR						8				//number of infrared proximity sensors
+#define OBSTSENS__STOP_DISTANCE_MM			35				//how far, in mm, from an obstacle the robot should stop moving
+
+
+/*===========================================================================*/
+/* Structures						 			                            */
+/*===========================================================================*/
+
+/*
+ * Obstacle state published on OBSTSENS__TOPIC_NAME
+ * @note ir values are the filtered calibrated values, indexed like the e-puck2 sensors IR1..IR8 (0..7)
+ */
+typedef struct ObstacleStates {
+	systime_t time;					//time of the sample this state was computed from
+	uint16_t tofDistanceMm;			//filtered time of flight distance
+	int16_t ir[OBSTSENS__NB_IR];
+	bool obstacleNear;				//with hysteresis, true when the robot should stop
+	int16_t obstacleBearing;			//direction of the obstacle from the sensor geometry, in degrees from -180° to 180° (positive to the right)
+} ObstacleState;
+
+
+/*===========================================================================*/
+/* Public functions definitions            									 */
+/*===========================================================================*/
+
+/*
+ * @brief   Starts the time of flight and proximity sensors, and the fusion thread
+ * @warning The messagebus bus must be initialised before
+*/
+void obstSens_start(void);
+
+/*
+ * @brief   Reads the latest obstacle state, without waiting
+ *
+ * @parameter[out] state 	latest state, a state without obstacle at the initial distance if nothing was published yet
+ *
+ * @return	true if a state was published already, false otherwise
+*/
+bool obstSens_getState(ObstacleState *state);
+
+
+#endif /* OBSTACLESENSOR_H_ */
@@ -0,0 +1,433 @@
+/*
+ * planner.c
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Plans the order in which all the detected penguins are visited in one pass.
+ * 		Positions are in the frame of the robot at the last scan: x ahead of it, y towards positive angles.
+ * 		Each visit is modelled as: turn on the spot towards the penguin, drive until the stop distance,
+ * 		then back up for PLANNER__BACKUP_MS, which gives the position from which the next visit starts.
+ *
+ * Functions prefix for public functions in this file: planner_
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <ch.h>
+
+#include <numeric.h>
+#include <obstacleSensor.h>
+#include <planner.h>
+
+
+/*===========================================================================*/
+/* Constants definition for this file						               */
+/*===========================================================================*/
+
+#define FREQ_TOLERANCE_HZ					45			//a penguin is found again if it is this close in frequency, as FREQ_THD
+
+//Model of the robot, from the speeds used by the travelController
+#define ROBOT_SPEED_MM_S						65.0f		//MOT_MAX_NEEDED_SPS (500 steps/s) with 0.13mm per step
+#define ROBOT_TURN_DEG_S						80.0f		//turning on the spot, with the wheels at about 300 steps/s
+#define STOP_DISTANCE_MM						((float) OBSTSENS__STOP_DISTANCE_MM)
+#define BACKUP_DISTANCE_MM					(ROBOT_SPEED_MM_S*(float) PLANNER__BACKUP_MS/1000.0f)
+
+#define TWO_OPT_MAX_PASSES					8			//2-opt stops earlier as soon as a pass improves nothing
+#define TWO_OPT_MIN_GAIN_S					0.01f		//smaller improvements are rounding noise
+
+
+/*===========================================================================*/
+/* Structures						 			                            */
+/*===========================================================================*/
+
+/*
+ * Penguin of the plan
+ */
+typedef struct PlannerTargets {
+	uint16_t freq;				//FFT-domain, as in Destination
+	uint16_t scanIndex;			//index in the last scan
+	float xMm;
+	float yMm;
+} PlannerTarget;
+
+/*
+ * Position and heading of the robot, heading in degrees from the x axis
+ */
+typedef struct PlannerPoses {
+	float xMm;
+	float yMm;
+	float headingDeg;
+} PlannerPose;
+
+
+/*===========================================================================*/
+/* Static variables definitions 		 			                            */
+/*===========================================================================*/
+
+static PlannerTarget targets[PLANNER__NB_TARGETS_MAX];
+static uint8_t nbTargets 					= 0;
+static uint8_t order[PLANNER__NB_TARGETS_MAX];			//indexes in targets of the penguins left, in the order of the visits
+static uint8_t nbPlanned 					= 0;
+
+static uint16_t visitedFreqs[PLANNER__NB_TARGETS_MAX];	//penguins done during this pass
+static uint8_t nbVisited 					= 0;
+
+static PlannerPose pose 						= {0.0f, 0.0f, 0.0f};
+static bool poseKnown 						= false;
+static float planTimeS 						= 0.0f;
+
+
+/*===========================================================================*/
+/* Private functions definitions                                             */
+/*===========================================================================*/
+
+/**
+ * @brief   Checks whether two FFT-domain frequencies belong to the same penguin
+*/
+bool plannerSameFreq(uint16_t freqA, uint16_t freqB);
+
+/**
+ * @brief   Checks whether a penguin was done during this pass
+*/
+bool plannerIsVisited(uint16_t freq);
+
+/**
+ * @brief   Fills targets with the penguins of a scan that have an angle and were not done during this pass
+ *
+ * @return	number of penguins with an angle in the scan, done or not
+*/
+uint8_t plannerLoadScan(const Destination *scan, uint16_t nbSources);
+
+/**
+ * @brief   Time needed to visit a penguin, turning then driving
+ *
+ * @parameter[inout] from		position before the visit, replaced by the position after backing up from the penguin
+ * @parameter[in] target			penguin to visit
+ *
+ * @return	time in s
+*/
+float plannerLegTimeS(PlannerPose *from, const PlannerTarget *target);
+
+/**
+ * @brief   Time needed to visit penguins in a given order, starting from pose
+*/
+float plannerPathTimeS(const uint8_t *path, uint8_t nbSteps);
+
+/**
+ * @brief   Appends to order the penguins not used yet, each time the one that is the quickest to reach
+*/
+void plannerGreedy(bool *used);
+
+/**
+ * @brief   Inserts a penguin in order where it adds the least time
+*/
+void plannerInsert(uint8_t target);
+
+/**
+ * @brief   Improves order by reversing parts of it, as long as it gets quicker
+*/
+void plannerTwoOpt(void);
+
+
+/*===========================================================================*/
+/* Public functions for setting/getting internal parameters					  */
+/* Descriptions  are only in the header file (to have a single source of truth) */
+/*===========================================================================*/
+
+void planner_reset(void)
+{
+	nbTargets = 0;
+	nbPlanned = 0;
+	nbVisited = 0;
+	poseKnown = false;
+	planTimeS = 0.0f;
+}
+
+float planner_estimateRangeMm(float ampli)
+{
+	if(ampli <= 0.0f){
+		return PLANNER__RANGE_MAX_MM;
+	}
+	return num_ClampF(PLANNER__RANGE_CLOSE_MM*AUDIOP__AMPLI_SOURCE_CLOSE/ampli, PLANNER__RANGE_MIN_MM, PLANNER__RANGE_MAX_MM);
+}
+
+uint16_t planner_update(const Destination *scan, uint16_t nbSources)
+{
+	uint16_t previousFreqs[PLANNER__NB_TARGETS_MAX];
+	uint8_t nbPrevious 		= nbPlanned;
+	bool used[PLANNER__NB_TARGETS_MAX] = {false};
+
+	for(uint8_t step_counter = 0; step_counter < nbPlanned; step_counter++){
+		previousFreqs[step_counter] = targets[order[step_counter]].freq;
+	}
+
+	//The scan is taken where the robot is now, which becomes the origin
+	pose.xMm = 0.0f;
+	pose.yMm = 0.0f;
+	pose.headingDeg = 0.0f;
+	poseKnown = true;
+
+	//All the penguins heard were fed: a new pass starts
+	if(plannerLoadScan(scan, nbSources) > 0 && nbTargets == 0){
+		nbVisited = 0;
+		plannerLoadScan(scan, nbSources);
+	}
+
+	//The previous order is kept for the penguins found again
+	nbPlanned = 0;
+	for(uint8_t step_counter = 0; step_counter < nbPrevious; step_counter++){
+		for(uint8_t target_counter = 0; target_counter < nbTargets; target_counter++){
+			if(used[target_counter] == false && plannerSameFreq(targets[target_counter].freq, previousFreqs[step_counter])){
+				used[target_counter] = true;
+				order[nbPlanned++] = target_counter;
+				break;
+			}
+		}
+	}
+
+	//New penguins are inserted, or the plan is built from scratch
+	if(nbPlanned == 0){
+		plannerGreedy(used);
+	}
+	else{
+		for(uint8_t target_counter = 0; target_counter < nbTargets; target_counter++){
+			if(used[target_counter] == false){
+				plannerInsert(target_counter);
+			}
+		}
+	}
+	plannerTwoOpt();
+	planTimeS = plannerPathTimeS(order, nbPlanned);
+
+	if(nbPlanned == 0){
+		return PLANNER__NO_TARGET;
+	}
+	return targets[order[0]].scanIndex;
+}
+
+void planner_markDone(uint16_t freq, bool reached)
+{
+	bool found = false;
+
+	if(nbVisited < PLANNER__NB_TARGETS_MAX && plannerIsVisited(freq) == false){
+		visitedFreqs[nbVisited++] = freq;
+	}
+
+	for(uint8_t step_counter = 0; step_counter < nbPlanned; step_counter++){
+		if(plannerSameFreq(targets[order[step_counter]].freq, freq)){
+			if(reached){
+				plannerLegTimeS(&pose, &targets[order[step_counter]]);
+				found = true;
+			}
+			memmove(&order[step_counter], &order[step_counter+1], (size_t) (nbPlanned-step_counter-1));
+			nbPlanned--;
+			break;
+		}
+	}
+
+	//The robot is somewhere else than where the plan expected
+	if(found == false){
+		poseKnown = false;
+	}
+	planTimeS = plannerPathTimeS(order, nbPlanned);
+}
+
+bool planner_nextDestination(Destination *destination)
+{
+	const PlannerTarget *target = NULL;
+	float dx 		= 0.0f;
+	float dy 		= 0.0f;
+	float bearing 	= 0.0f;
+
+	if(poseKnown == false || nbPlanned == 0){
+		return false;
+	}
+
+	target = &targets[order[0]];
+	dx = target->xMm - pose.xMm;
+	dy = target->yMm - pose.yMm;
+	bearing = num_WrapDeg180F(num_RadToDeg(atan2f(dy, dx)) - pose.headingDeg);
+
+	destination->freq = target->freq;
+	destination->angle = (int16_t) lroundf(bearing);
+	destination->valid = true;
+	destination->ampli = PLANNER__RANGE_CLOSE_MM*AUDIOP__AMPLI_SOURCE_CLOSE/fmaxf(sqrtf(dx*dx + dy*dy), PLANNER__RANGE_MIN_MM);
+	destination->stamp.frame = TRACE__NO_FRAME;
+	destination->stamp.capture = chVTGetSystemTime();
+	destination->stamp.analysis = destination->stamp.capture;
+	destination->stamp.command = destination->stamp.capture;
+	return true;
+}
+
+uint8_t planner_getPlan(uint16_t *freqsHz, uint8_t maxFreqs)
+{
+	for(uint8_t step_counter = 0; step_counter < nbPlanned && step_counter < maxFreqs; step_counter++){
+		freqsHz[step_counter] = audioP_convertFreq(targets[order[step_counter]].freq);
+	}
+	return nbPlanned;
+}
+
+float planner_getPlanTimeS(void)
+{
+	return planTimeS;
+}
+
+
+/*===========================================================================*/
+/* Private functions	 code												   */
+/*===========================================================================*/
+
+bool plannerSameFreq(uint16_t freqA, uint16_t freqB)
+{
+	return abs(audioP_convertFreq(freqA) - audioP_convertFreq(freqB)) < FREQ_TOLERANCE_HZ;
+}
+
+bool plannerIsVisited(uint16_t freq)
+{
+	for(uint8_t visited_counter = 0; visited_counter < nbVisited; visited_counter++){
+		if(plannerSameFreq(visitedFreqs[visited_counter], freq)){
+			return true;
+		}
+	}
+	return false;
+}
+
+uint8_t plannerLoadScan(const Destination *scan, uint16_t nbSources)
+{
+	uint8_t nbHeard 	= 0;
+	float range 		= 0.0f;
+	float angle 		= 0.0f;
+
+	nbTargets = 0;
+	for(uint16_t source_counter = 0; source_counter < nbSources; source_counter++){
+		if(scan[source_counter].valid == false){
+			continue;
+		}
+		nbHeard++;
+		if(plannerIsVisited(scan[source_counter].freq) || nbTargets >= PLANNER__NB_TARGETS_MAX){
+			continue;
+		}
+		range = planner_estimateRangeMm(scan[source_counter].ampli);
+		angle = num_DegToRad((float) scan[source_counter].angle);
+		targets[nbTargets].freq = scan[source_counter].freq;
+		targets[nbTargets].scanIndex = source_counter;
+		targets[nbTargets].xMm = range*cosf(angle);
+		targets[nbTargets].yMm = range*sinf(angle);
+		nbTargets++;
+	}
+	return nbHeard;
+}
+
+float plannerLegTimeS(PlannerPose *from, const PlannerTarget *target)
+{
+	float dx 			= target->xMm - from->xMm;
+	float dy 			= target->yMm - from->yMm;
+	float distance 		= sqrtf(dx*dx + dy*dy);
+	float direction 		= num_RadToDeg(atan2f(dy, dx));
+	float turnTimeS 		= fabsf(num_WrapDeg180F(direction - from->headingDeg))/ROBOT_TURN_DEG_S;
+	float driveTimeS 	= fmaxf(distance - STOP_DISTANCE_MM, 0.0f)/ROBOT_SPEED_MM_S;
+
+	//The robot stops in front of the penguin, then backs up in the direction it came from
+	if(distance > STOP_DISTANCE_MM + BACKUP_DISTANCE_MM){
+		from->xMm = target->xMm - (STOP_DISTANCE_MM + BACKUP_DISTANCE_MM)*dx/distance;
+		from->yMm = target->yMm - (STOP_DISTANCE_MM + BACKUP_DISTANCE_MM)*dy/distance;
+	}
+	from->headingDeg = direction;
+
+	return turnTimeS + driveTimeS;
+}
+
+float plannerPathTimeS(const uint8_t *path, uint8_t nbSteps)
+{
+	PlannerPose current 	= pose;
+	float timeS 			= 0.0f;
+
+	for(uint8_t step_counter = 0; step_counter < nbSteps; step_counter++){
+		timeS += plannerLegTimeS(&current, &targets[path[step_counter]]);
+	}
+	return timeS;
+}
+
+void plannerGreedy(bool *used)
+{
+	PlannerPose current 	= pose;
+	PlannerPose next 	= pose;
+	uint8_t best 		= 0;
+	float bestTimeS 		= 0.0f;
+	float timeS 			= 0.0f;
+
+	while(nbPlanned < nbTargets){
+		bestTimeS = INFINITY;
+		for(uint8_t target_counter = 0; target_counter < nbTargets; target_counter++){
+			if(used[target_counter]){
+				continue;
+			}
+			next = current;
+			timeS = plannerLegTimeS(&next, &targets[target_counter]);
+			if(timeS < bestTimeS){
+				bestTimeS = timeS;
+				best = target_counter;
+			}
+		}
+		used[best] = true;
+		order[nbPlanned++] = best;
+		plannerLegTimeS(&current, &targets[best]);
+	}
+}
+
+void plannerInsert(uint8_t target)
+{
+	uint8_t candidate[PLANNER__NB_TARGETS_MAX];
+	uint8_t bestPosition 	= nbPlanned;
+	float bestTimeS 			= INFINITY;
+	float timeS 				= 0.0f;
+
+	for(uint8_t position = 0; position <= nbPlanned; position++){
+		memcpy(candidate, order, position);
+		candidate[position] = target;
+		memcpy(&candidate[position+1], &order[position], (size_t) (nbPlanned-position));
+		timeS = plannerPathTimeS(candidate, (uint8_t) (nbPlanned+1));
+		if(timeS < bestTimeS){
+			bestTimeS = timeS;
+			bestPosition = position;
+		}
+	}
+
+	memmove(&order[bestPosition+1], &order[bestPosition], (size_t) (nbPlanned-bestPosition));
+	order[bestPosition] = target;
+	nbPlanned++;
+}
+
+void plannerTwoOpt(void)
+{
+	uint8_t candidate[PLANNER__NB_TARGETS_MAX];
+	uint8_t swap 		= 0;
+	float bestTimeS 		= plannerPathTimeS(order, nbPlanned);
+	float timeS 			= 0.0f;
+	bool improved 		= true;
+
+	for(uint8_t pass_counter = 0; pass_counter < TWO_OPT_MAX_PASSES && improved; pass_counter++){
+		improved = false;
+		for(uint8_t first = 0; first + 1 < nbPlanned; first++){
+			for(uint8_t last = (uint8_t) (first+1); last < nbPlanned; last++){
+				//The path is open and starts at the robot, so any part of it can be reversed, even the first visit
+				memcpy(candidate, order, nbPlanned);
+				for(uint8_t low = first, high = last; low < high; low++, high--){
+					swap = candidate[low];
+					candidate[low] = candidate[high];
+					candidate[high] = swap;
+				}
+				timeS = plannerPathTimeS(candidate, nbPlanned);
+				if(timeS < bestTimeS - TWO_OPT_MIN_GAIN_S){
+					memcpy(order, candidate, nbPlanned);
+					bestTimeS = timeS;
+					improved = true;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,108 @@
+/*
+ * planner.h
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Plans the order in which all the detected penguins are visited in one pass, so that the robot
+ * 		spends as little time as possible turning and driving. The range of each penguin is estimated from its
+ * 		amplitude, and with its bearing gives its position relative to the robot at the time of the scan.
+ * 		The order is built greedily, then improved with 2-opt. Each new scan re-plans incrementally: the previous
+ * 		order is kept for the penguins found again, matched by frequency, and new ones are inserted where they cost least.
+ * 		Between scans the position of the robot is estimated after each visit, so that it can drive on to the
+ * 		next penguin of the plan without scanning again.
+ * 		All functions must be called from the same thread (the main thread).
+ * Function prefix for public functions in this file: planner_
+ * Constant prefix for public constants in this file: PLANNER__
+ */
+#ifndef PLANNER_H_
+#define PLANNER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <audio_processing.h>
+
+/*===========================================================================*/
+/* Constants definition for this library						               */
+/*===========================================================================*/
+
+#define PLANNER__NB_TARGETS_MAX				16			//penguins planned at most, the cost of 2-opt grows with the cube of this
+#define PLANNER__NO_TARGET					UINT16_MAX
+
+/* @note Range model
+ * The amplitude of a sound decreases as the inverse of the distance, so the range is estimated as
+ * PLANNER__RANGE_CLOSE_MM*AUDIOP__AMPLI_SOURCE_CLOSE/ampli, clamped to [PLANNER__RANGE_MIN_MM,PLANNER__RANGE_MAX_MM].
+ * PLANNER__RANGE_CLOSE_MM is the distance at which a penguin reaches AUDIOP__AMPLI_SOURCE_CLOSE, to be tuned on site. */
+#define PLANNER__RANGE_CLOSE_MM				100.0f
+#define PLANNER__RANGE_MIN_MM				50.0f
+#define PLANNER__RANGE_MAX_MM				1500.0f
+
+#define PLANNER__BACKUP_MS					1000			//how long the robot backs up from a penguin before driving on to the next one
+
+
+/*===========================================================================*/
+/* Public functions definitions            									 */
+/*===========================================================================*/
+
+/*
+ * @brief	Forgets the plan and the penguins visited, the next planner_update starts a new pass
+ */
+void planner_reset(void);
+
+/*
+ * @brief	Estimates the distance to a penguin from its amplitude, see the range model
+ *
+ *  @param[in] ampli		FFT amplitude of the penguin
+ *
+ * @return	estimated distance in mm
+ */
+float planner_estimateRangeMm(float ampli);
+
+/*
+ * @brief	Re-plans with a new scan, taken at the current position of the robot
+ * @note 	When all the penguins of the scan were visited, a new pass starts
+ *
+ *  @param[in] scan			sources found by audioP_analyseSources, sources without angle are ignored
+ *  @param[in] nbSources	number of sources in scan
+ *
+ * @return	index in scan of the first penguin of the plan, PLANNER__NO_TARGET if there is none
+ */
+uint16_t planner_update(const Destination *scan, uint16_t nbSources);
+
+/*
+ * @brief	Tells the planner that the trip towards a penguin ended, it is not planned again during this pass
+ *
+ *  @param[in] freq			frequency of the penguin, in the FFT-domain as in Destination
+ *  @param[in] reached		true if the robot reached it and backed up for PLANNER__BACKUP_MS, so that its position
+ * 							is known, false if the robot stopped somewhere else (the next step then needs a scan)
+ */
+void planner_markDone(uint16_t freq, bool reached);
+
+/*
+ * @brief	Gives the next penguin of the plan, with its bearing predicted from the estimated position of the robot
+ *
+ *  @param[out] destination	the next penguin, its stamp has no frame (TRACE__NO_FRAME) as the bearing is predicted
+ *
+ * @return	false if the plan is empty or the position of the robot is not known since the last planner_update
+ */
+bool planner_nextDestination(Destination *destination);
+
+/*
+ * @brief	Returns the planned order
+ *
+ *  @param[out] freqsHz		frequencies in Hz of the penguins left, in the order of the visits
+ *  @param[in] maxFreqs		size of freqsHz
+ *
+ * @return	number of penguins left in the plan
+ */
+uint8_t planner_getPlan(uint16_t *freqsHz, uint8_t maxFreqs);
+
+/*
+ * @brief	Returns the estimated time to visit the penguins left in the plan, turning and driving, in s
+ */
+float planner_getPlanTimeS(void);
+
+
+#endif /* PLANNER_H_ */
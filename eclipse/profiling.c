@@ -0,0 +1,151 @@
+/*
+ * profiling.c
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Accumulation of the durations of the pipeline stages. The stages run in different threads
+ * 		(audio, motor controller) and are read by the comms reception thread, so the statistics are
+ * 		updated and copied under chSysLock, which only lasts a few instructions.
+ *
+ * Functions prefix for public functions in this file: prof_
+ */
+
+#include <string.h>
+
+#include <ch.h>
+#include <hal.h>
+
+#include <profiling.h>
+
+
+/*===========================================================================*/
+/* Constants definition for this file						               */
+/*===========================================================================*/
+
+#if defined(__linux__)
+#define TICKS_PER_US							1000UL						//prof_now gives ns
+#else
+#define TICKS_PER_US							(STM32_SYSCLK/1000000UL)	//prof_now gives cycles
+#endif
+#define NS_PER_US							1000ULL
+
+
+/*===========================================================================*/
+/* Structures						 			                            */
+/*===========================================================================*/
+
+/*
+ * Accumulated durations of a stage, in ticks
+ */
+typedef struct ProfAccumulators {
+	uint32_t count;
+	uint32_t min;
+	uint32_t max;
+	uint64_t sum;
+	uint32_t histogram[PROF__HIST_BINS];
+} ProfAccumulator;
+
+
+/*===========================================================================*/
+/* Static variables definitions 		 			                            */
+/*===========================================================================*/
+
+static ProfAccumulator accumulators[PROF__NB_STAGES];
+
+static const char *stageNames[PROF__NB_STAGES] = {
+	"deinterleave",
+	"copy",
+	"fft",
+	"magnitude",
+	"peak",
+	"angle",
+	"motUpdate"
+};
+
+
+/*===========================================================================*/
+/* Public functions for setting/getting internal parameters					  */
+/* Descriptions  are only in the header file (to have a single source of truth) */
+/*===========================================================================*/
+
+void prof_init(void)
+{
+#if !defined(__linux__)
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+	prof_reset();
+}
+
+void prof_record(uint8_t stage, uint32_t ticks)
+{
+	uint32_t us 		= ticks/TICKS_PER_US;
+	uint8_t bin 		= 0;
+
+	if(stage >= PROF__NB_STAGES){
+		return;
+	}
+
+	//The bin is the number of bits of the duration in us
+	if(us != 0){
+		bin = (uint8_t) (32 - __builtin_clz(us));
+		if(bin >= PROF__HIST_BINS){
+			bin = PROF__HIST_BINS - 1;
+		}
+	}
+
+	chSysLock();
+	if(accumulators[stage].count == 0 || ticks < accumulators[stage].min){
+		accumulators[stage].min = ticks;
+	}
+	if(ticks > accumulators[stage].max){
+		accumulators[stage].max = ticks;
+	}
+	accumulators[stage].count++;
+	accumulators[stage].sum += ticks;
+	accumulators[stage].histogram[bin]++;
+	chSysUnlock();
+}
+
+uint32_t prof_ticksToNs(uint64_t ticks)
+{
+	return (uint32_t) (ticks*NS_PER_US/TICKS_PER_US);
+}
+
+void prof_reset(void)
+{
+	chSysLock();
+	memset(accumulators, 0, sizeof(accumulators));
+	chSysUnlock();
+}
+
+bool prof_getStats(uint8_t stage, ProfStat *stats)
+{
+	ProfAccumulator accumulator;
+
+	if(stage >= PROF__NB_STAGES){
+		return false;
+	}
+
+	chSysLock();
+	accumulator = accumulators[stage];
+	chSysUnlock();
+
+	stats->count = accumulator.count;
+	stats->minNs = prof_ticksToNs(accumulator.min);
+	stats->maxNs = prof_ticksToNs(accumulator.max);
+	stats->meanNs = (accumulator.count > 0) ? prof_ticksToNs(accumulator.sum/accumulator.count) : 0;
+	memcpy(stats->histogram, accumulator.histogram, sizeof(stats->histogram));
+	return true;
+}
+
+const char *prof_getStageName(uint8_t stage)
+{
+	if(stage >= PROF__NB_STAGES){
+		return "";
+	}
+	return stageNames[stage];
+}
@@ -0,0 +1,140 @@
+/*
+ * profiling.h
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Lightweight timing of the stages of the audio and motor pipelines. A stage is timed between
+ * 		PROF__BEGIN(stage) and PROF__END(stage) in the same block, with the DWT cycle counter of the Cortex-M4
+ * 		on the robot, and with clock_gettime on a Linux host build. For each stage the min, max, mean and a
+ * 		histogram of the durations are accumulated.
+ * 		Profiling is disabled by default, the markers then compile to nothing. Build with -DPROF__ENABLED=1
+ * 		(e.g. UDEFS += -DPROF__ENABLED=1 in the makefile) to enable it.
+ * Function prefix for public functions in this file: prof_
+ * Constant prefix for public constants in this file: PROF__
+ */
+#ifndef PROFILING_H_
+#define PROFILING_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#if defined(__linux__)
+#include <time.h>
+#else
+#include <hal.h>					//for the DWT registers
+#endif
+
+/*===========================================================================*/
+/* Constants definition for this library						               */
+/*===========================================================================*/
+
+#ifndef PROF__ENABLED
+#define PROF__ENABLED						0
+#endif
+
+//Stages
+#define PROF__STAGE_DEINTERLEAVE				0			//audioP_ctxProcessAudioData, for each block of samples from the mics
+#define PROF__STAGE_COPY						1			//the four arm_copy_f32 of a frame
+#define PROF__STAGE_FFT						2			//each of the four FFTs of a frame
+#define PROF__STAGE_MAGNITUDE				3			//arm_cmplx_mag_f32
+#define PROF__STAGE_PEAK						4			//audio_Peak
+#define PROF__STAGE_ANGLE					5			//audio_determineAngle
+#define PROF__STAGE_MOT_UPDATE				6			//motControllerUpdateSpeeds
+#define PROF__NB_STAGES						7
+
+/* @note Histogram
+ * Bin 0 counts the durations below 1us, bin k the durations in [2^(k-1),2^k[ us,
+ * and the last bin everything longer. */
+#define PROF__HIST_BINS						16
+
+
+/*===========================================================================*/
+/* Structures						 			                            */
+/*===========================================================================*/
+
+/*
+ * Statistics of a stage, durations in ns
+ */
+typedef struct ProfStats {
+	uint32_t count;
+	uint32_t minNs;
+	uint32_t maxNs;
+	uint32_t meanNs;
+	uint32_t histogram[PROF__HIST_BINS];
+} ProfStat;
+
+
+/*===========================================================================*/
+/* Markers						 			                                */
+/*===========================================================================*/
+
+#if PROF__ENABLED
+#define PROF__BEGIN(stage)					uint32_t profStart_##stage = prof_now()
+#define PROF__END(stage)						prof_record((stage), prof_now() - profStart_##stage)
+#else
+#define PROF__BEGIN(stage)
+#define PROF__END(stage)
+#endif
+
+
+/*===========================================================================*/
+/* Public functions definitions            									 */
+/*===========================================================================*/
+
+/*
+ * @brief	Starts the cycle counter, to be called once before any marker
+ */
+void prof_init(void);
+
+/*
+ * @brief	Returns the current time in ticks of the profiling clock: cycles on the robot, ns on the host
+ * @note 	Wraps around, only differences are meaningful
+ */
+static inline uint32_t prof_now(void)
+{
+#if defined(__linux__)
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint32_t) ((uint64_t) now.tv_sec*1000000000ULL + (uint64_t) now.tv_nsec);
+#else
+	return DWT->CYCCNT;
+#endif
+}
+
+/*
+ * @brief	Accumulates a duration of a stage, called by PROF__END
+ *
+ *  @param[in] stage		PROF__STAGE_XXX
+ *  @param[in] ticks		duration in ticks of prof_now
+ */
+void prof_record(uint8_t stage, uint32_t ticks);
+
+/*
+ * @brief	Converts a duration in ticks of prof_now into ns
+ */
+uint32_t prof_ticksToNs(uint64_t ticks);
+
+/*
+ * @brief	Clears the statistics of all stages
+ */
+void prof_reset(void);
+
+/*
+ * @brief	Returns the statistics of a stage since start or the last prof_reset
+ *
+ *  @param[in] stage		PROF__STAGE_XXX
+ *  @param[out] stats		statistics, all 0 if the stage never ran
+ *
+ * @return	false if stage does not exist
+ */
+bool prof_getStats(uint8_t stage, ProfStat *stats);
+
+/*
+ * @brief	Returns the name of a stage, for printing
+ */
+const char *prof_getStageName(uint8_t stage);
+
+
+#endif /* PROFILING_H_ */
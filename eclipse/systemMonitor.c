@@ -0,0 +1,335 @@
+/*
+ * systemMonitor.c
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Runtime monitor of the threads, periodic loops and waits. The loops and waits are recorded by
+ * 		their own threads and read by the comms reception thread, so they are updated and copied under chSysLock.
+ * 		The fields of thread_t are only accessed through the THREAD_XXX macros below, which follow ChibiOS RT 4
+ * 		(ChibiOS 16.1, used by the e-puck2 library): thread_t is at the base of its working area, the stack
+ * 		grows down towards it, so the unused stack is the fill pattern found just above thread_t.
+ *
+ * Functions prefix for public functions in this file: sysmon_
+ */
+
+#include <string.h>
+
+#include <ch.h>
+
+#include <profiling.h>
+#include <systemMonitor.h>
+
+
+/*===========================================================================*/
+/* Constants definition for this file						               */
+/*===========================================================================*/
+
+#if defined(CH_CFG_USE_REGISTRY) && (CH_CFG_USE_REGISTRY == TRUE)
+#define SYSMON_THREADS						1
+#else
+#define SYSMON_THREADS						0
+#endif
+#if defined(CH_DBG_THREADS_PROFILING) && (CH_DBG_THREADS_PROFILING == TRUE)
+#define SYSMON_CPU							1
+#else
+#define SYSMON_CPU							0
+#endif
+#if defined(CH_DBG_FILL_THREADS) && (CH_DBG_FILL_THREADS == TRUE)
+#define SYSMON_THREAD_STACKS					1
+#else
+#define SYSMON_THREAD_STACKS					0
+#endif
+#if defined(__linux__)
+#define SYSMON_MAIN_STACKS					0			//no linker stacks on a host build
+#else
+#define SYSMON_MAIN_STACKS					1
+#endif
+
+#define STACK_FILL_VALUE						0x55		//CH_DBG_STACK_FILL_VALUE, and the byte of CRT0_STACKS_FILL_PATTERN
+#define PERMILLE								1000ULL
+#define NS_PER_US							1000
+#define PERCENT								100
+#define US_PER_S								1000000ULL
+
+//Fields of thread_t in ChibiOS RT 4
+#define THREAD_NAME(tp)						((tp)->p_name)
+#define THREAD_PRIO(tp)						((uint8_t) (tp)->p_prio)
+#define THREAD_TICKS(tp)						((tp)->p_time)
+#define THREAD_STACK_BASE(tp)				((const uint8_t *) ((tp) + 1))
+#define THREAD_STACK_POINTER(tp)				((const uint8_t *) (tp)->p_ctx.r13)
+
+
+/*===========================================================================*/
+/* Structures						 			                            */
+/*===========================================================================*/
+
+/*
+ * Accumulated timing of a loop, lateness in ticks of prof_now
+ */
+typedef struct SysmonLoopAccumulators {
+	bool started;
+	uint32_t lastRun;
+	uint32_t runs;
+	uint32_t missed;
+	int32_t minLateness;
+	int32_t maxLateness;
+	int64_t sumLateness;
+} SysmonLoopAccumulator;
+
+/*
+ * Accumulated time blocked in a wait, in ns
+ */
+typedef struct SysmonWaitAccumulators {
+	uint32_t count;
+	uint64_t totalNs;
+	uint32_t maxNs;
+} SysmonWaitAccumulator;
+
+
+/*===========================================================================*/
+/* Static variables definitions 		 			                            */
+/*===========================================================================*/
+
+static SysmonLoopAccumulator loops[SYSMON__NB_LOOPS];
+static SysmonWaitAccumulator waits[SYSMON__NB_WAITS];
+static systime_t resetTime 					= 0;
+
+//CPU time of each thread at the previous sysmon_getThreads, only used by the thread calling it
+static const void *previousThreads[SYSMON__NB_THREADS_MAX];
+static uint32_t previousTicks[SYSMON__NB_THREADS_MAX];
+static uint8_t nbPreviousThreads 			= 0;
+
+#if SYSMON_MAIN_STACKS
+//Linker symbols of the ChibiOS rules.ld: exception (main) stack and main thread (process) stack
+extern uint8_t __main_stack_base__[];
+extern uint8_t __main_stack_end__[];
+extern uint8_t __process_stack_base__[];
+extern uint8_t __process_stack_end__[];
+#endif
+
+
+/*===========================================================================*/
+/* Private functions definitions                                             */
+/*===========================================================================*/
+
+/**
+ * @brief   Counts the bytes of the fill pattern from the lowest address of a stack, which were never used
+ *
+ * @parameter[in] base		lowest address of the stack
+ * @parameter[in] end		the count stops there, the current stack pointer or the end of the stack
+*/
+uint32_t sysmonStackFree(const uint8_t *base, const uint8_t *end);
+
+/**
+ * @brief   Returns the CPU ticks a thread had at the previous call, 0 for a new thread
+*/
+uint32_t sysmonPreviousTicks(const void *thread);
+
+
+/*===========================================================================*/
+/* Public functions for setting/getting internal parameters					  */
+/* Descriptions  are only in the header file (to have a single source of truth) */
+/*===========================================================================*/
+
+uint8_t sysmon_getThreads(SysmonThread *threads, uint8_t maxThreads)
+{
+	uint8_t nbThreads 		= 0;
+
+#if SYSMON_THREADS
+	const void *ids[SYSMON__NB_THREADS_MAX];
+	uint32_t ticks[SYSMON__NB_THREADS_MAX];
+	uint32_t deltas[SYSMON__NB_THREADS_MAX];
+	uint64_t totalTicks 		= 0;
+	uint8_t stackMarker 		= 0;			//its address is the stack pointer of the calling thread
+	thread_t *tp 			= chRegFirstThread();
+
+	while(tp != NULL){
+		if(nbThreads < maxThreads && nbThreads < SYSMON__NB_THREADS_MAX){
+			threads[nbThreads].name = (THREAD_NAME(tp) != NULL) ? THREAD_NAME(tp) : "?";
+			threads[nbThreads].prio = THREAD_PRIO(tp);
+			threads[nbThreads].stackFreeBytes = SYSMON__UNKNOWN;
+			ids[nbThreads] = tp;
+			ticks[nbThreads] = 0;
+
+#if SYSMON_CPU
+			ticks[nbThreads] = (uint32_t) THREAD_TICKS(tp);
+			deltas[nbThreads] = ticks[nbThreads] - sysmonPreviousTicks(tp);
+			totalTicks += deltas[nbThreads];
+#endif
+
+			//The main thread runs on the process stack of the linker, its thread_t is not in a working area
+#if SYSMON_MAIN_STACKS
+			if(tp == &ch.mainthread){
+				threads[nbThreads].stackFreeBytes = sysmonStackFree(__process_stack_base__,
+						(tp == chThdGetSelfX()) ? &stackMarker : THREAD_STACK_POINTER(tp));
+			}
+			else
+#endif
+			{
+#if SYSMON_THREAD_STACKS
+				threads[nbThreads].stackFreeBytes = sysmonStackFree(THREAD_STACK_BASE(tp),
+						(tp == chThdGetSelfX()) ? &stackMarker : THREAD_STACK_POINTER(tp));
+#endif
+			}
+			nbThreads++;
+		}
+		tp = chRegNextThread(tp);
+	}
+
+	for(uint8_t thread_counter = 0; thread_counter < nbThreads; thread_counter++){
+		threads[thread_counter].cpuPermille = (totalTicks > 0) ?
+				(uint32_t) (deltas[thread_counter]*PERMILLE/totalTicks) : SYSMON__UNKNOWN;
+	}
+	memcpy(previousThreads, ids, nbThreads*sizeof(ids[0]));
+	memcpy(previousTicks, ticks, nbThreads*sizeof(ticks[0]));
+	nbPreviousThreads = nbThreads;
+	(void) stackMarker;
+#endif
+
+#if SYSMON_MAIN_STACKS
+	if(nbThreads < maxThreads){
+		threads[nbThreads].name = "exceptions";
+		threads[nbThreads].prio = 0;
+		threads[nbThreads].cpuPermille = SYSMON__UNKNOWN;
+		threads[nbThreads].stackFreeBytes = sysmonStackFree(__main_stack_base__, __main_stack_end__);
+		nbThreads++;
+	}
+#endif
+
+	return nbThreads;
+}
+
+void sysmon_loopRun(uint8_t loop, uint32_t periodUs, bool scheduled)
+{
+	uint32_t now 			= prof_now();
+	int32_t latenessUs 		= 0;
+	SysmonLoopAccumulator *accumulator = NULL;
+
+	if(loop >= SYSMON__NB_LOOPS){
+		return;
+	}
+	accumulator = &loops[loop];
+
+	chSysLock();
+	if(scheduled && accumulator->started){
+		latenessUs = (int32_t) (prof_ticksToNs(now - accumulator->lastRun)/NS_PER_US) - (int32_t) periodUs;
+		if(accumulator->runs == 0 || latenessUs < accumulator->minLateness){
+			accumulator->minLateness = latenessUs;
+		}
+		if(accumulator->runs == 0 || latenessUs > accumulator->maxLateness){
+			accumulator->maxLateness = latenessUs;
+		}
+		if(latenessUs > (int32_t) (periodUs*SYSMON__DEADLINE_SLACK_PERCENT/PERCENT)){
+			accumulator->missed++;
+		}
+		accumulator->sumLateness += latenessUs;
+		accumulator->runs++;
+	}
+	accumulator->lastRun = now;
+	accumulator->started = true;
+	chSysUnlock();
+}
+
+void sysmon_recordWait(uint8_t wait, uint32_t ticks)
+{
+	uint32_t ns = prof_ticksToNs(ticks);
+
+	if(wait >= SYSMON__NB_WAITS){
+		return;
+	}
+
+	chSysLock();
+	waits[wait].count++;
+	waits[wait].totalNs += ns;
+	if(ns > waits[wait].maxNs){
+		waits[wait].maxNs = ns;
+	}
+	chSysUnlock();
+}
+
+bool sysmon_getLoop(uint8_t loop, SysmonLoop *stats)
+{
+	SysmonLoopAccumulator accumulator;
+
+	if(loop >= SYSMON__NB_LOOPS){
+		return false;
+	}
+
+	chSysLock();
+	accumulator = loops[loop];
+	chSysUnlock();
+
+	stats->runs = accumulator.runs;
+	stats->missed = accumulator.missed;
+	stats->minLatenessUs = accumulator.minLateness;
+	stats->maxLatenessUs = accumulator.maxLateness;
+	stats->meanLatenessUs = (accumulator.runs > 0) ? (int32_t) (accumulator.sumLateness/accumulator.runs) : 0;
+	return true;
+}
+
+bool sysmon_getWait(uint8_t wait, SysmonWait *stats)
+{
+	SysmonWaitAccumulator accumulator;
+	uint64_t elapsedUs 		= 0;
+
+	if(wait >= SYSMON__NB_WAITS){
+		return false;
+	}
+
+	chSysLock();
+	accumulator = waits[wait];
+	elapsedUs = (uint64_t) (chVTGetSystemTimeX() - resetTime)*US_PER_S/CH_CFG_ST_FREQUENCY;		//ST2US would overflow
+	chSysUnlock();
+
+	stats->count = accumulator.count;
+	stats->totalMs = (uint32_t) (accumulator.totalNs/(NS_PER_US*NS_PER_US));
+	stats->maxUs = accumulator.maxNs/NS_PER_US;
+	stats->permille = (elapsedUs > 0) ? (uint32_t) (accumulator.totalNs/NS_PER_US*PERMILLE/elapsedUs) : 0;
+	return true;
+}
+
+const char *sysmon_getLoopName(uint8_t loop)
+{
+	return (loop == SYSMON__LOOP_MOT_CONTROLLER) ? "motController" : "";
+}
+
+const char *sysmon_getWaitName(uint8_t wait)
+{
+	return (wait == SYSMON__WAIT_AUDIO_BUFFER) ? "audioBufferIsReady" : "";
+}
+
+void sysmon_reset(void)
+{
+	chSysLock();
+	memset(loops, 0, sizeof(loops));
+	memset(waits, 0, sizeof(waits));
+	resetTime = chVTGetSystemTimeX();
+	chSysUnlock();
+}
+
+
+/*===========================================================================*/
+/* Private functions	 code												   */
+/*===========================================================================*/
+
+uint32_t sysmonStackFree(const uint8_t *base, const uint8_t *end)
+{
+	const uint8_t *byte = base;
+
+	while(byte < end && *byte == STACK_FILL_VALUE){
+		byte++;
+	}
+	return (uint32_t) (byte - base);
+}
+
+uint32_t sysmonPreviousTicks(const void *thread)
+{
+	for(uint8_t thread_counter = 0; thread_counter < nbPreviousThreads; thread_counter++){
+		if(previousThreads[thread_counter] == thread){
+			return previousTicks[thread_counter];
+		}
+	}
+	return 0;
+}
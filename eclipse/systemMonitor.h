@@ -0,0 +1,138 @@
+/*
+ * systemMonitor.h
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Runtime monitor to size the working areas and priorities from data instead of guesses:
+ * 		- CPU share and unused stack of every thread, from the ChibiOS registry,
+ * 		- period jitter and missed deadlines of the periodic loops (motor controller),
+ * 		- time spent blocked waiting for data (audio buffer).
+ * 		The CPU share needs CH_DBG_THREADS_PROFILING and the unused stack of the threads needs CH_DBG_FILL_THREADS,
+ * 		both set to TRUE in chconf.h, otherwise they are reported as SYSMON__UNKNOWN. The main and exception stacks
+ * 		are filled at startup anyway.
+ * Function prefix for public functions in this file: sysmon_
+ * Constant prefix for public constants in this file: SYSMON__
+ */
+#ifndef SYSTEMMONITOR_H_
+#define SYSTEMMONITOR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*===========================================================================*/
+/* Constants definition for this library						               */
+/*===========================================================================*/
+
+#define SYSMON__NB_THREADS_MAX				16			//threads reported at most, the exception stack included
+#define SYSMON__UNKNOWN						UINT32_MAX	//the value is not available with this ChibiOS configuration
+
+//Periodic loops
+#define SYSMON__LOOP_MOT_CONTROLLER			0
+#define SYSMON__NB_LOOPS						1
+
+//A run of a loop missed its deadline if it started later than this share of the period after it
+#define SYSMON__DEADLINE_SLACK_PERCENT		50
+
+//Waits
+#define SYSMON__WAIT_AUDIO_BUFFER			0			//audio thread waiting for audioBufferIsReady
+#define SYSMON__NB_WAITS						1
+
+
+/*===========================================================================*/
+/* Structures						 			                            */
+/*===========================================================================*/
+
+/*
+ * State of a thread
+ */
+typedef struct SysmonThreads {
+	const char *name;
+	uint8_t prio;
+	uint32_t cpuPermille;		//share of the CPU since the previous sysmon_getThreads, in 1/1000
+	uint32_t stackFreeBytes;		//bytes of the stack never used since start
+} SysmonThread;
+
+/*
+ * Timing of a periodic loop, lateness is how much later than its period a run started, in us
+ */
+typedef struct SysmonLoops {
+	uint32_t runs;				//runs checked against their deadline
+	uint32_t missed;
+	int32_t minLatenessUs;
+	int32_t maxLatenessUs;
+	int32_t meanLatenessUs;
+} SysmonLoop;
+
+/*
+ * Time blocked in a wait
+ */
+typedef struct SysmonWaits {
+	uint32_t count;
+	uint32_t totalMs;
+	uint32_t maxUs;
+	uint32_t permille;			//share of the time since sysmon_reset, in 1/1000
+} SysmonWait;
+
+
+/*===========================================================================*/
+/* Public functions definitions            									 */
+/*===========================================================================*/
+
+/*
+ * @brief	Returns the state of the threads, and of the exception stack with the name "exceptions"
+ * @note 	Must always be called from the same thread, it keeps the CPU time of the previous call
+ *
+ *  @param[out] threads		array of at least maxThreads threads
+ *  @param[in] maxThreads	size of threads
+ *
+ * @return	number of threads written
+ */
+uint8_t sysmon_getThreads(SysmonThread *threads, uint8_t maxThreads);
+
+/*
+ * @brief	Tells the monitor that a periodic loop runs
+ *
+ *  @param[in] loop			SYSMON__LOOP_XXX
+ *  @param[in] periodUs		period of the loop
+ *  @param[in] scheduled	true if it runs because its period elapsed, then it is checked against its deadline,
+ * 							false if it runs early (e.g. for a new command), then only the period restarts
+ */
+void sysmon_loopRun(uint8_t loop, uint32_t periodUs, bool scheduled);
+
+/*
+ * @brief	Adds a time blocked in a wait
+ *
+ *  @param[in] wait			SYSMON__WAIT_XXX
+ *  @param[in] ticks		time blocked, in ticks of prof_now
+ */
+void sysmon_recordWait(uint8_t wait, uint32_t ticks);
+
+/*
+ * @brief	Returns the timing of a loop since sysmon_reset
+ *
+ * @return	false if loop does not exist
+ */
+bool sysmon_getLoop(uint8_t loop, SysmonLoop *stats);
+
+/*
+ * @brief	Returns the time blocked in a wait since sysmon_reset
+ *
+ * @return	false if wait does not exist
+ */
+bool sysmon_getWait(uint8_t wait, SysmonWait *stats);
+
+/*
+ * @brief	Returns the name of a loop or a wait, for printing
+ */
+const char *sysmon_getLoopName(uint8_t loop);
+const char *sysmon_getWaitName(uint8_t wait);
+
+/*
+ * @brief	Clears the loop and wait statistics
+ */
+void sysmon_reset(void);
+
+
+#endif /* SYSTEMMONITOR_H_ */
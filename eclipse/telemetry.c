@@ -0,0 +1,84 @@
+/*
+ * telemetry.c
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Sends binary telemetry frames through the comms transmission queue.
+ * 		The modules build their payloads themselves and only when their stream is enabled,
+ * 		this file numbers, frames and queues them.
+ *
+ * Functions prefix for public functions in this file: telem_
+ */
+
+#include <ch.h>
+
+#include <telemetry.h>
+#include <comms.h>
+
+
+/*===========================================================================*/
+/* Static variables definitions 		 			                            */
+/*===========================================================================*/
+
+static volatile uint32_t telemStreams = TELEM__STREAMS_DEFAULT;
+
+//The sequence number and the encoding buffer are shared by all threads sending frames
+static MUTEX_DECL(telemLock);
+static uint8_t telemEncoded[TELEM__MAX_ENCODED];
+static uint16_t telemSequence = 0;
+static uint32_t telemSentFrames = 0;
+static uint32_t telemDroppedFrames = 0;
+
+
+/*===========================================================================*/
+/* Public functions for setting/getting internal parameters					  */
+/* Descriptions  are only in the header file (to have a single source of truth) */
+/*===========================================================================*/
+
+void telem_setStreams(uint32_t streams)
+{
+	telemStreams = streams & TELEM__STREAMS_ALL;
+}
+
+uint32_t telem_getStreams(void)
+{
+	return telemStreams;
+}
+
+bool telem_isStreaming(uint8_t type)
+{
+	return type < TELEM__NB_MSG_TYPES && (telemStreams & TELEM__STREAM(type));
+}
+
+bool telem_send(uint8_t type, const uint8_t *payload, uint16_t size)
+{
+	size_t length = 0;
+	bool queued = false;
+
+	if(telem_isStreaming(type) == false){
+		return false;
+	}
+
+	chMtxLock(&telemLock);
+	length = telem_EncodeFrame(type, telemSequence++, payload, size, telemEncoded);
+	queued = length != 0 && comms_write(telemEncoded, length);
+	if(queued){
+		telemSentFrames++;
+	}
+	else{
+		telemDroppedFrames++;
+	}
+	chMtxUnlock(&telemLock);
+
+	return queued;
+}
+
+void telem_getStats(uint32_t *sentFrames, uint32_t *droppedFrames)
+{
+	chMtxLock(&telemLock);
+	*sentFrames = telemSentFrames;
+	*droppedFrames = telemDroppedFrames;
+	chMtxUnlock(&telemLock);
+}
@@ -0,0 +1,75 @@
+/*
+ * telemetry.h
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Sends binary telemetry frames (see telemetryFrame.h for the format and payloads) through
+ * 		the comms transmission queue, interleaved with the text output. Each message type is a stream that
+ * 		is disabled by default, so that the text interface stays readable unless a host tool asks for data.
+ * Function prefix for public functions in this file: telem_
+ * Constant prefix for public constants in this file: TELEM__
+ */
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <telemetryFrame.h>
+
+/*===========================================================================*/
+/* Constants definition for this library						               */
+/*===========================================================================*/
+
+#define TELEM__STREAM(type)					(1UL<<(type))		//bit of a message type in the streams mask
+#define TELEM__STREAMS_NONE					0UL
+#define TELEM__STREAMS_ALL					((1UL<<TELEM__NB_MSG_TYPES)-1)
+
+//Streams enabled at start, can be overridden at build time (e.g. -DTELEM__STREAMS_DEFAULT=TELEM__STREAMS_ALL)
+#ifndef TELEM__STREAMS_DEFAULT
+#define TELEM__STREAMS_DEFAULT				TELEM__STREAMS_NONE
+#endif
+
+
+/*===========================================================================*/
+/* Public functions definitions            									 */
+/*===========================================================================*/
+
+/*
+ * @brief	Chooses which message types are sent, by default TELEM__STREAMS_DEFAULT
+ *
+ *  @param[in] streams		or of TELEM__STREAM(TELEM__MSG_XXX)
+ */
+void telem_setStreams(uint32_t streams);
+
+/*
+ * @brief	Returns the mask of message types currently sent
+ */
+uint32_t telem_getStreams(void);
+
+/*
+ * @brief	Checks whether a message type is sent, to skip building its payload otherwise
+ *
+ *  @param[in] type			TELEM__MSG_XXX
+ */
+bool telem_isStreaming(uint8_t type);
+
+/*
+ * @brief	Frames and queues a message, if its stream is enabled
+ * @note 	Thread safe. It never waits for the serial link, the frame is dropped if the queue is full
+ *
+ *  @param[in] type			TELEM__MSG_XXX
+ *  @param[in] payload		payload bytes, in the layout of the type
+ *  @param[in] size			payload size, at most TELEM__MAX_PAYLOAD
+ *
+ * @return	true if the frame was queued
+ */
+bool telem_send(uint8_t type, const uint8_t *payload, uint16_t size);
+
+/*
+ * @brief	Returns how many frames were queued and dropped since start
+ * @note 	Every frame queued or dropped takes a sequence number, so the host sees drops as sequence gaps
+ */
+void telem_getStats(uint32_t *sentFrames, uint32_t *droppedFrames);
+
+
+#endif /* TELEMETRY_H_ */
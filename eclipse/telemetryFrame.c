@@ -0,0 +1,331 @@
+/*
+ * telemetryFrame.c
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Framing of the binary telemetry, shared by the robot and the host tools (no ChibiOS dependency).
+ * 		Frames are COBS encoded (Consistent Overhead Byte Stuffing): each 0x00 byte is replaced by the distance to
+ * 		the next one, so 0x00 only appears as frame delimiter and a receiver can resynchronise on any delimiter.
+ *
+ * Functions prefix for public functions in this file: telem_
+ */
+
+#include <string.h>
+
+#include <telemetryFrame.h>
+
+
+/*===========================================================================*/
+/* Constants definition for this file						               */
+/*===========================================================================*/
+
+#define FRAME_DELIMITER						0x00
+#define COBS_MAX_BLOCK						0xFF		//code of a block of 254 non zero bytes not followed by a zero
+#define CRC_POLYNOMIAL						0x1021
+#define CRC_INIT								0xFFFF
+#define BAND_RUN								0x00		//starts a run of unchanged band values
+#define BAND_RUN_MAX							UINT8_MAX
+
+//Text is only reported when it is printable, otherwise the bytes are counted as a corrupted frame
+#define ASCII_PRINTABLE_BEGIN				32
+#define ASCII_PRINTABLE_END					126
+
+
+/*===========================================================================*/
+/* Structures						 			                            */
+/*===========================================================================*/
+
+/*
+ * COBS encoding in progress, the frame is encoded piece by piece without being copied
+ */
+typedef struct TelemCobss {
+	uint8_t *encoded;
+	size_t length;			//bytes written, including the code of the current block
+	size_t codeIndex;		//position of the code of the current block
+	uint8_t code;			//code of the current block: its number of bytes plus one
+} TelemCobs;
+
+
+/*===========================================================================*/
+/* Private functions definitions                                             */
+/*===========================================================================*/
+
+/**
+ * @brief   Starts the COBS encoding of a frame at encoded
+*/
+void telemCobsStart(TelemCobs *cobs, uint8_t *encoded);
+
+/**
+ * @brief   COBS encodes the next bytes of the frame
+*/
+void telemCobsPut(TelemCobs *cobs, const uint8_t *data, size_t size);
+
+/**
+ * @brief   Ends the COBS encoding of the frame
+ *
+ * @return	number of bytes written in encoded, without delimiter
+*/
+size_t telemCobsEnd(TelemCobs *cobs);
+
+/**
+ * @brief   COBS decodes data, decoded must hold TELEM__MAX_FRAME bytes
+ *
+ * @return	number of decoded bytes, 0 if the data is not valid COBS
+*/
+size_t telemCobsDecode(const uint8_t *data, size_t size, uint8_t *decoded);
+
+/**
+ * @brief   Checks whether the bytes look like text output of comms_printf
+*/
+bool telemIsText(const uint8_t *data, size_t size);
+
+
+/*===========================================================================*/
+/* Public functions for setting/getting internal parameters					  */
+/* Descriptions  are only in the header file (to have a single source of truth) */
+/*===========================================================================*/
+
+uint16_t telem_Crc16(const uint8_t *data, size_t size, uint16_t crc)
+{
+	for(size_t i = 0; i < size; i++){
+		crc ^= (uint16_t) (data[i] << 8);
+		for(uint8_t bit = 0; bit < 8; bit++){
+			if(crc & 0x8000){
+				crc = (uint16_t) ((crc << 1) ^ CRC_POLYNOMIAL);
+			}
+			else{
+				crc = (uint16_t) (crc << 1);
+			}
+		}
+	}
+	return crc;
+}
+
+size_t telem_EncodeFrame(uint8_t type, uint16_t sequence, const uint8_t *payload, size_t size, uint8_t *encoded)
+{
+	//only the header and the crc are copied: the frame is encoded in place, it is not built on the stack of the sender
+	uint8_t header[TELEM__HEADER_SIZE];
+	uint8_t crcBytes[TELEM__CRC_SIZE];
+	TelemCobs cobs;
+	uint16_t crc = 0;
+	size_t length = 0;
+
+	if(size > TELEM__MAX_PAYLOAD){
+		return 0;
+	}
+
+	telem_PutU16(telem_PutU8(header, type), sequence);
+	crc = telem_Crc16(header, TELEM__HEADER_SIZE, CRC_INIT);
+	crc = telem_Crc16(payload, size, crc);
+	telem_PutU16(crcBytes, crc);
+
+	encoded[length++] = FRAME_DELIMITER;
+	telemCobsStart(&cobs, &encoded[length]);
+	telemCobsPut(&cobs, header, TELEM__HEADER_SIZE);
+	telemCobsPut(&cobs, payload, size);
+	telemCobsPut(&cobs, crcBytes, TELEM__CRC_SIZE);
+	length += telemCobsEnd(&cobs);
+	encoded[length++] = FRAME_DELIMITER;
+	return length;
+}
+
+void telem_DecoderInit(TelemDecoder *decoder)
+{
+	decoder->length = 0;
+	decoder->textLength = 0;
+	decoder->pending = false;
+	decoder->crcErrors = 0;
+	decoder->overflows = 0;
+}
+
+uint8_t telem_DecoderPush(TelemDecoder *decoder, uint8_t byte, TelemFrame *frame)
+{
+	size_t size = 0;
+	uint16_t crc = 0;
+
+	decoder->textLength = 0;
+	if(decoder->pending){
+		decoder->buffer[decoder->length++] = decoder->pendingByte;
+		decoder->pending = false;
+	}
+
+	if(byte != FRAME_DELIMITER){
+		if(decoder->length < sizeof(decoder->buffer)){
+			decoder->buffer[decoder->length++] = byte;
+			return TELEM__DECODE_NONE;
+		}
+		//Full without delimiter: long text is handed out in chunks, anything else is dropped
+		decoder->pending = true;
+		decoder->pendingByte = byte;
+		if(telemIsText(decoder->buffer, decoder->length)){
+			return telem_DecoderFlush(decoder);
+		}
+		decoder->length = 0;
+		decoder->overflows++;
+		return TELEM__DECODE_OVERFLOW;
+	}
+
+	//Delimiter: the bytes since the previous one are either a frame or text
+	if(decoder->length == 0){
+		return TELEM__DECODE_NONE;
+	}
+	size = telemCobsDecode(decoder->buffer, decoder->length, decoder->decoded);
+	if(size >= TELEM__HEADER_SIZE + TELEM__CRC_SIZE){
+		telem_GetU16(&decoder->decoded[size - TELEM__CRC_SIZE], &crc);
+		if(crc == telem_Crc16(decoder->decoded, size - TELEM__CRC_SIZE, CRC_INIT)){
+			telem_GetU8(decoder->decoded, &frame->type);
+			telem_GetU16(&decoder->decoded[1], &frame->sequence);
+			frame->size = (uint16_t) (size - TELEM__HEADER_SIZE - TELEM__CRC_SIZE);
+			memcpy(frame->payload, &decoder->decoded[TELEM__HEADER_SIZE], frame->size);
+			decoder->length = 0;
+			return TELEM__DECODE_FRAME;
+		}
+	}
+
+	if(telemIsText(decoder->buffer, decoder->length)){
+		return telem_DecoderFlush(decoder);
+	}
+	decoder->length = 0;
+	decoder->crcErrors++;
+	return TELEM__DECODE_NONE;
+}
+
+uint8_t telem_DecoderFlush(TelemDecoder *decoder)
+{
+	decoder->textLength = decoder->length;
+	decoder->length = 0;
+	if(decoder->textLength == 0){
+		return TELEM__DECODE_NONE;
+	}
+	return TELEM__DECODE_TEXT;
+}
+
+size_t telem_EncodeBand(const uint8_t *band, const uint8_t *reference, uint8_t nbBins, uint8_t *encoded)
+{
+	size_t length = 0;
+	uint8_t run = 0;
+
+	for(uint8_t bin = 0; bin < nbBins; bin++){
+		if(band[bin] == reference[bin]){
+			run++;
+			if(run < BAND_RUN_MAX){
+				continue;
+			}
+		}
+		if(run != 0){
+			encoded[length++] = BAND_RUN;
+			encoded[length++] = run;
+			//the value that ended the run still has to be sent, unless it is part of a full run
+			if(band[bin] == reference[bin]){
+				run = 0;
+				continue;
+			}
+			run = 0;
+		}
+		encoded[length++] = (uint8_t) (band[bin] - reference[bin]);
+	}
+	if(run != 0){
+		encoded[length++] = BAND_RUN;
+		encoded[length++] = run;
+	}
+	return length;
+}
+
+bool telem_DecodeBand(const uint8_t *encoded, size_t size, uint8_t *band, uint8_t nbBins)
+{
+	size_t read = 0;
+	uint16_t bin = 0;
+
+	while(read < size){
+		if(encoded[read] == BAND_RUN){
+			if(read + 1 >= size || encoded[read+1] == 0){
+				return false;
+			}
+			bin += encoded[read+1];
+			read += 2;
+		}
+		else{
+			if(bin >= nbBins){
+				return false;
+			}
+			band[bin] = (uint8_t) (band[bin] + encoded[read]);
+			bin++;
+			read++;
+		}
+	}
+	return bin == nbBins;
+}
+
+
+/*===========================================================================*/
+/* Private functions	 code												   */
+/*===========================================================================*/
+
+void telemCobsStart(TelemCobs *cobs, uint8_t *encoded)
+{
+	cobs->encoded = encoded;
+	cobs->codeIndex = 0;
+	cobs->length = 1;
+	cobs->code = 1;
+}
+
+void telemCobsPut(TelemCobs *cobs, const uint8_t *data, size_t size)
+{
+	for(size_t i = 0; i < size; i++){
+		if(data[i] == 0){
+			cobs->encoded[cobs->codeIndex] = cobs->code;
+			cobs->codeIndex = cobs->length++;
+			cobs->code = 1;
+		}
+		else{
+			cobs->encoded[cobs->length++] = data[i];
+			cobs->code++;
+			if(cobs->code == COBS_MAX_BLOCK){
+				cobs->encoded[cobs->codeIndex] = cobs->code;
+				cobs->codeIndex = cobs->length++;
+				cobs->code = 1;
+			}
+		}
+	}
+}
+
+size_t telemCobsEnd(TelemCobs *cobs)
+{
+	cobs->encoded[cobs->codeIndex] = cobs->code;
+	return cobs->length;
+}
+
+size_t telemCobsDecode(const uint8_t *data, size_t size, uint8_t *decoded)
+{
+	size_t read = 0;
+	size_t write = 0;
+	uint8_t code = 0;
+
+	while(read < size){
+		code = data[read++];
+		if(code == 0 || read + code - 1 > size || write + code > TELEM__MAX_FRAME){
+			return 0;
+		}
+		for(uint8_t i = 1; i < code; i++){
+			decoded[write++] = data[read++];
+		}
+		//a zero follows every block except the maximal ones and the last one
+		if(code != COBS_MAX_BLOCK && read < size){
+			decoded[write++] = 0;
+		}
+	}
+	return write;
+}
+
+bool telemIsText(const uint8_t *data, size_t size)
+{
+	for(size_t i = 0; i < size; i++){
+		if((data[i] < ASCII_PRINTABLE_BEGIN || data[i] > ASCII_PRINTABLE_END)
+				&& data[i] != '\n' && data[i] != '\r' && data[i] != '\t' && data[i] != '\b'){
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,245 @@
+/*
+ * telemetryFrame.h
+ *
+ *  Created on: October 18, 2026
+ *  Authors: Nicolaj Schmid & Théophane Mayaud
+ * 	Project: EPFL MT BA6 penguins epuck2 project
+ *
+ * Introduction: Framing of the binary telemetry, shared by the robot and the host tools (no ChibiOS dependency).
+ * 		A frame is [type u8][sequence u16][payload][crc16 u16], all little endian, COBS encoded so that it contains
+ * 		no 0x00 byte, and sent between two 0x00 delimiters. The text output of comms_printf never contains 0x00, so
+ * 		text and frames can share the serial link: whatever is between two delimiters and is not a valid frame is text.
+ * 		The CRC is CRC16-CCITT (polynomial 0x1021, init 0xFFFF) over type, sequence and payload.
+ * Function prefix for public functions in this file: telem_
+ * Constant prefix for public constants in this file: TELEM__
+ */
+#ifndef TELEMETRYFRAME_H_
+#define TELEMETRYFRAME_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*===========================================================================*/
+/* Constants definition for this library						               */
+/*===========================================================================*/
+
+/* @note Message types and payloads (little endian)
+ * TELEM__MSG_SPECTRUM:		u32 frameTime, u16 firstBin, u8 nbBins, nbBins x u16 magnitude/TELEM__SPECTRUM_SCALE (saturated)
+ * TELEM__MSG_SOURCES:		u32 frameTime, u8 nbSources, nbSources x {u16 freq (FFT-domain), f32 ampli}
+ * TELEM__MSG_DESTINATION:	u32 frameTime, u16 freq (FFT-domain), i16 angle, u8 valid, f32 ampli
+ * TELEM__MSG_CONTROLLER:	u32 time, u8 mode, u8 moving, u8 avoidState, i16 destAngle, f32 heading, i16 rightSpeed, i16 leftSpeed
+ * TELEM__MSG_SENSORS:		u32 time, u16 tofDistanceMm, 8 x i16 ir, u8 obstacleNear, i16 obstacleBearing
+ * TELEM__MSG_BAND:			u32 frameTime, u8 bandIndex, u8 flags, u16 firstBin, u8 nbBins, u8 nbPeaks,
+ * 							nbPeaks x {u8 bin (from firstBin), i16 angle (of this frame only, TELEM__ANGLE_UNKNOWN if none)},
+ * 							then the band encoded by telem_EncodeBand up to the end of the payload
+ * TELEM__MSG_AUDIO:		u32 blockTime, u32 blockIndex, u16 blockFrames, u8 chunk, u8 nbChunks,
+ * 							blockFrames/nbChunks frames of 4 x i16 samples (right, left, back, front), see micCapture.h
+ * Times are in system ticks.
+ */
+#define TELEM__MSG_SPECTRUM					1
+#define TELEM__MSG_SOURCES					2
+#define TELEM__MSG_DESTINATION				3
+#define TELEM__MSG_CONTROLLER				4
+#define TELEM__MSG_SENSORS					5
+#define TELEM__MSG_BAND						6
+#define TELEM__MSG_AUDIO						7
+#define TELEM__NB_MSG_TYPES					8			//types are below this, used for the stream mask
+
+#define TELEM__SPECTRUM_SCALE				16			//spectrum magnitudes are divided by this before being sent on 16 bits
+#define TELEM__ANGLE_UNKNOWN					INT16_MIN
+
+/* @note Band quantization and compression
+ * Each magnitude of the band is sent on 8 bits, in steps of 1/TELEM__BAND_STEPS_PER_OCTAVE octave (0.75dB):
+ * value = TELEM__BAND_STEPS_PER_OCTAVE*log2(magnitude), so magnitude = 2^(value/TELEM__BAND_STEPS_PER_OCTAVE).
+ * The values are sent as differences with the previous band frame (with zeros for a key frame, flag
+ * TELEM__BAND_KEY_FRAME), where runs of unchanged values are compressed. bandIndex counts the band frames,
+ * a receiver that misses one must wait for the next key frame. */
+#define TELEM__BAND_STEPS_PER_OCTAVE			8
+#define TELEM__BAND_KEY_FRAME				0x01
+#define TELEM__BAND_MAX_ENCODED(nbBins)		(2*(nbBins))		//worst case of telem_EncodeBand
+
+#define TELEM__AUDIO_HEADER_SIZE				12			//payload of TELEM__MSG_AUDIO before the samples
+
+#define TELEM__MAX_PAYLOAD					400
+#define TELEM__HEADER_SIZE					3			//type and sequence
+#define TELEM__CRC_SIZE						2
+#define TELEM__MAX_FRAME						(TELEM__HEADER_SIZE+TELEM__MAX_PAYLOAD+TELEM__CRC_SIZE)
+#define TELEM__MAX_ENCODED					(TELEM__MAX_FRAME + TELEM__MAX_FRAME/254 + 3)	//COBS overhead and both delimiters
+
+//Results of telem_DecoderPush
+#define TELEM__DECODE_NONE					0			//byte stored, nothing complete yet
+#define TELEM__DECODE_FRAME					1			//a valid frame was decoded
+#define TELEM__DECODE_TEXT					2			//the bytes received are text, in decoder->buffer, decoder->textLength bytes long
+#define TELEM__DECODE_OVERFLOW				3			//too many bytes without delimiter that are not text, they were dropped
+
+
+/*===========================================================================*/
+/* Structures						 			                            */
+/*===========================================================================*/
+
+/*
+ * Decoded frame
+ */
+typedef struct TelemFrames {
+	uint8_t type;
+	uint16_t sequence;
+	uint16_t size;
+	uint8_t payload[TELEM__MAX_PAYLOAD];
+} TelemFrame;
+
+/*
+ * Streaming decoder state, bytes are given one by one to telem_DecoderPush
+ */
+typedef struct TelemDecoders {
+	uint8_t buffer[TELEM__MAX_ENCODED];
+	uint8_t decoded[TELEM__MAX_FRAME];
+	uint16_t length;
+	uint16_t textLength;
+	bool pending;						//a byte received while the buffer was handed out as text
+	uint8_t pendingByte;
+	uint32_t crcErrors;
+	uint32_t overflows;
+} TelemDecoder;
+
+
+/*===========================================================================*/
+/* Public functions definitions            									 */
+/*===========================================================================*/
+
+/*
+ * @brief	Calculates the CRC16-CCITT of data
+ *
+ *  @param[in] data		bytes to process
+ *  @param[in] size		number of bytes
+ *  @param[in] crc		previous crc, 0xFFFF to start
+ *
+ * @return	updated crc
+ */
+uint16_t telem_Crc16(const uint8_t *data, size_t size, uint16_t crc);
+
+/*
+ * @brief	Builds a complete frame: header, payload and crc, COBS encoded between two delimiters
+ *
+ *  @param[in] type			TELEM__MSG_XXX
+ *  @param[in] sequence		sequence number of the frame
+ *  @param[in] payload		payload bytes
+ *  @param[in] size			payload size, at most TELEM__MAX_PAYLOAD
+ *  @param[out] encoded		buffer of at least TELEM__MAX_ENCODED bytes
+ *
+ * @return	number of bytes written in encoded, 0 if the payload is too big
+ */
+size_t telem_EncodeFrame(uint8_t type, uint16_t sequence, const uint8_t *payload, size_t size, uint8_t *encoded);
+
+/*
+ * @brief	Resets a decoder
+ */
+void telem_DecoderInit(TelemDecoder *decoder);
+
+/*
+ * @brief	Gives the next received byte to the decoder
+ *
+ *  @param[out] decoder		decoder state
+ *  @param[in] byte			received byte
+ *  @param[out] frame		filled when TELEM__DECODE_FRAME is returned
+ *
+ * @return	TELEM__DECODE_XXX
+ * @note 	Text stays in decoder->buffer only until the next call. Text after the last frame is only
+ * 			returned by the next delimiter, so call telem_DecoderFlush at the end of a stream.
+ */
+uint8_t telem_DecoderPush(TelemDecoder *decoder, uint8_t byte, TelemFrame *frame);
+
+/*
+ * @brief	Hands out the bytes received since the last delimiter, at the end of a stream
+ *
+ * @return	TELEM__DECODE_TEXT if there were text bytes, TELEM__DECODE_NONE otherwise
+ */
+uint8_t telem_DecoderFlush(TelemDecoder *decoder);
+
+/*
+ * @brief	Encodes a band of 8 bit values as differences with a reference band
+ * @note 	A difference of 0 is never sent alone: the byte 0 starts a run, followed by the number of unchanged values.
+ * 			Any other byte is the difference modulo 256.
+ *
+ *  @param[in] band			values to send
+ *  @param[in] reference	values of the previous band frame, zeros for a key frame
+ *  @param[in] nbBins		number of values
+ *  @param[out] encoded		at least TELEM__BAND_MAX_ENCODED(nbBins) bytes
+ *
+ * @return	number of bytes written in encoded
+ */
+size_t telem_EncodeBand(const uint8_t *band, const uint8_t *reference, uint8_t nbBins, uint8_t *encoded);
+
+/*
+ * @brief	Decodes a band encoded by telem_EncodeBand
+ *
+ *  @param[in] encoded		encoded bytes
+ *  @param[in] size			number of encoded bytes
+ *  @param[out] band		holds the reference band (previous values or zeros), replaced by the new values
+ *  @param[in] nbBins		number of values
+ *
+ * @return	false if the encoded bytes do not describe exactly nbBins values
+ */
+bool telem_DecodeBand(const uint8_t *encoded, size_t size, uint8_t *band, uint8_t nbBins);
+
+
+/*===========================================================================*/
+/* Payload helpers, little endian					 			            */
+/*===========================================================================*/
+
+static inline uint8_t *telem_PutU8(uint8_t *buffer, uint8_t value)
+{
+	buffer[0] = value;
+	return buffer + 1;
+}
+
+static inline uint8_t *telem_PutU16(uint8_t *buffer, uint16_t value)
+{
+	buffer[0] = (uint8_t) value;
+	buffer[1] = (uint8_t) (value >> 8);
+	return buffer + 2;
+}
+
+static inline uint8_t *telem_PutU32(uint8_t *buffer, uint32_t value)
+{
+	buffer[0] = (uint8_t) value;
+	buffer[1] = (uint8_t) (value >> 8);
+	buffer[2] = (uint8_t) (value >> 16);
+	buffer[3] = (uint8_t) (value >> 24);
+	return buffer + 4;
+}
+
+static inline uint8_t *telem_PutF32(uint8_t *buffer, float value)
+{
+	union { float f; uint32_t u; } convert = { .f = value };
+	return telem_PutU32(buffer, convert.u);
+}
+
+static inline const uint8_t *telem_GetU8(const uint8_t *buffer, uint8_t *value)
+{
+	*value = buffer[0];
+	return buffer + 1;
+}
+
+static inline const uint8_t *telem_GetU16(const uint8_t *buffer, uint16_t *value)
+{
+	*value = (uint16_t) (buffer[0] | (buffer[1] << 8));
+	return buffer + 2;
+}
+
+static inline const uint8_t *telem_GetU32(const uint8_t *buffer, uint32_t *value)
+{
+	*value = (uint32_t) buffer[0] | ((uint32_t) buffer[1] << 8) | ((uint32_t) buffer[2] << 16) | ((uint32_t) buffer[3] << 24);
+	return buffer + 4;
+}
+
+static inline const uint8_t *telem_GetF32(const uint8_t *buffer, float *value)
+{
+	union { float f; uint32_t u; } convert;
+	buffer = telem_GetU32(buffer, &convert.u);
+	*value = convert.f;
+	return buffer;
+}
+
+
+#endif /* TELEMETRYFRAME_H_ */
@@ -11,14 +11,22 @@
  * Functions prefix for public functions in this file: travCtrl_
  */
 
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
 #include <ch.h> 							//for chibios threads functionality
 #include <msgbus/messagebus.h> 			//for IR sensors thread functionality
 
 #include <motors.h>
-#include <sensors/VL53L0X/VL53L0X.h>		//Time of flight sensor library
-#include <sensors/proximity.h>			//infrared sensors
 
 #include <travelController.h>
+#include <obstacleSensor.h>
+#include <numeric.h>
+#include <telemetry.h>
+#include <profiling.h>
+#include <latencyTrace.h>
+#include <systemMonitor.h>
 
 
 /*===========================================================================*/
@@ -42,47 +50,89 @@
 #define MOT_MIN_SPEED_SPS 					150
 
 #define MAX_DISTANCE_VALUE_MM 				350 			//how far, in mm, from an obstacle should the robot start to slow down
-#define STOP_DISTANCE_VALUE_MM				35			//how far, in mm, from an obstacle should the robot stop moving
-#define INIT_DISTANCE_VALUE_MM				80
+#define STOP_DISTANCE_VALUE_MM				OBSTSENS__STOP_DISTANCE_MM	//how far, in mm, from an obstacle should the robot stop moving
 
 #define MOT_MAX_ANGLE_TO_CORRECT 			40			//in degrees, if angle is bigger robot only turns at a constant rotating speed
+#define MOT_MAX_ANGLE_TO_CORRECT_LIMIT		180			//bound of the angle given to travCtrl_setPropGains
+
+/* @note PID heading controller (TRAVCTRL__MODE_PID)
+ * The differential speed is kp*error + ki*integral(error) + kd*d(error)/dt, in steps/s with the error in degrees.
+ * The derivative is taken on the measured heading only, so that a new audio angle does not kick the output.
+ * MOT_MAX_DIFF_SPS_PID respects MOTOR_SPEED_LIMIT (=1100) - MOT_MAX_NEEDED_SPS - MOT_MIN_SPEED_SPS. */
+#define MOT_PID_DEFAULT_KP					6.0f			//[steps/s/deg]
+#define MOT_PID_DEFAULT_KI					0.5f			//[steps/s/(deg*s)]
+#define MOT_PID_DEFAULT_KD					0.3f			//[steps/s/(deg/s)]
+#define MOT_MAX_DIFF_SPS_PID					400
+#define MOT_PID_INTEGRAL_LIMIT				(MOT_MAX_DIFF_SPS_PID/2)	//anti windup, max contribution of the integral in steps/s
+
+/* @note Motion profile (TRAVCTRL__MODE_PID)
+ * Wheel speeds follow their targets with limited acceleration and jerk (trapezoidal/S-curve profile),
+ * which replaces the exponential moving average of the proportional mode.
+ * While turning the robot keeps driving at cos(error) of its forward speed, but never less than
+ * MOT_TURN_DRIVE_MIN_RATIO of it, so big angles are corrected on an arc instead of by spinning in place. */
+#define MOT_MAX_ACCEL_SPS2					2000.0f		//[steps/s^2], 0 to MOT_MAX_NEEDED_SPS in 0.25s
+#define MOT_MAX_JERK_SPS3					40000.0f		//[steps/s^3], full acceleration reached in 50ms
+#define MOT_TURN_DRIVE_MIN_RATIO				0.25f
+#define MOT_MIN_DT_S							0.001f		//bounds of the time step used by the controller, in s
+#define MOT_MAX_DT_S							0.05f
+
+/* @note Obstacle classification and go around
+ * An obstacle is the source when the source is loud enough and the obstacle bearing (from the IR geometry)
+ * is within MOT_SOURCE_BEARING_TOLERANCE of the source bearing. Otherwise the robot turns away from the
+ * obstacle until it is not in front anymore, drives along it for MOT_AVOID_BYPASS_MS and then heads back
+ * towards the source. After MOT_AVOID_MAX_ATTEMPTS obstacles in the same run it gives up. */
+#define MOT_SOURCE_BEARING_TOLERANCE			45			//in degrees
+#define MOT_AVOID_TURN_SPS					300
+#define MOT_AVOID_TURN_MAX_MS				3000			//turning longer than this counts as a failed attempt
+#define MOT_AVOID_BYPASS_SPS					MOT_MAX_NEEDED_SPS
+#define MOT_AVOID_BYPASS_MS					800
+#define MOT_AVOID_MAX_ATTEMPTS				5
+
+//Go around states
+#define MOT_AVOID_NONE						0
+#define MOT_AVOID_TURN						1
+#define MOT_AVOID_BYPASS						2
 
 #define MOT_CONTROLLER_PERIOD 				10 			//in ms, will be the interval at which controller thread will re-adjust motor speeds
-#define MOT_CONTROLLER_WORKING_AREA_SIZE 	1024 		//1024 because it was found to be enough: less results in seg faults
+#define MOT_COMMAND_QUEUE_SIZE				TRAVCTRL__COMMAND_QUEUE_SIZE
+#define MOT_TELEMETRY_DIVIDER				5			//the controller state is sent every 5 ticks, so at 20Hz
+
+/* @note Odometry constants
+ * The heading is integrated from the motor step counters. One wheel turn is MOT_STEPS_PER_TURN steps
+ * and MOT_WHEEL_PERIMETER_MM, the wheels are MOT_WHEEL_DISTANCE_MM apart (e-puck2 values).
+ * The heading is positive to the right, as are the direction angles. */
+#define MOT_STEPS_PER_TURN					1000.0f
+#define MOT_WHEEL_PERIMETER_MM				130.0f
+#define MOT_WHEEL_DISTANCE_MM				53.5f
+#define MOT_STEP_TO_DEG						(NUM__RAD_TO_DEG_F*MOT_WHEEL_PERIMETER_MM/(MOT_STEPS_PER_TURN*MOT_WHEEL_DISTANCE_MM))
+#define MOT_HEADING_HISTORY_SIZE				TRAVCTRL__HEADING_HISTORY_SIZE
+
+//Command types exchanged through the controller mailbox, in MotCommand
+#define MOT_COMMAND_GO_TO_ANGLE				0
+#define MOT_COMMAND_STOP						1
+#define MOT_COMMAND_BACKWARDS				2
+#define MOT_COMMAND_SET_MODE					3
+#define MOT_COMMAND_SET_GAINS				4
+#define MOT_COMMAND_SET_PROP_GAINS			5
 
 /* @note EMA_WEIGHT_XXX
  * We use this to calculate exponential moving averages (ema) of some values, in order to reduce
  * impact of fluctuations that are too quick to represent real changes.
  * If faster response time overall is needed, reduce EMA_WEIGHT_XXX.
  */
-#define EMA_WEIGHT_MOT 						0.9
-#define EMA_WEIGHT_TOF 						0.8
-
-/* @note DISCARD_FIRST_N_TOF_MEASURES
- * The time of flight sensor returns 0 values for approx 30 cycles, so we set 50 to have a margin and discard those first cycles
- */
-#define DISCARD_FIRST_N_TOF_MEASURES 		50
+#define EMA_WEIGHT_MOT 						0.9f
 
-#define IR_STOP_VALUE						300	//IR threshold for source proximity detection
-#define IR_LEFT 								6	//EPUCK IR-seonsor IR7
-#define IR_RIGHT								1	//EPUCK IR-seonsor IR2
-#define IR_FRONT_LEFT 						7	//EPUCK IR-seonsor IR8
-#define IR_FRONT_RIGHT 						0	//EPUCK IR-seonsor IR1
+//Weight of the newest sample in Q15, for the integer fixed-point ema (folded at compile time)
+#define EMA_NEW_WEIGHT_MOT_Q15				NUM__Q15(1.0f-EMA_WEIGHT_MOT)
 
 
 /*===========================================================================*/
 /* Static variables definitions 		 			                            */
 /*===========================================================================*/
 
-static int16_t destAngle = 0; 			//from -180° to +180°
-
-static uint16_t emaPastDistances = 0;	//Exponential moving average (must be ema otherwise it is too jumpy)
-
-static bool robShouldMove = false;		//the motor controller will only update speeds when this is true
-
-/* @note obstacleReachedCallBack
- * pointer to function that is provided upon initialization, which we call when we arrive at an obstacle */
-static travCtrl_obstacleReached obstacleReachedCallBack;
+/* @note mainCtx
+ * Controller of the robot, with its motors and obstacle sensors, used by the functions without a context */
+static travCtrl_ctx mainCtx;
 
 
 /*===========================================================================*/
@@ -98,15 +148,117 @@ CONDVAR_DECL(bus_condvar);
 /*===========================================================================*/
 
 /**
- * @brief   Updates the measured distance to first object in sight
+ * @brief   Posts a command to the controller thread
+ * @note 	Blocks only if MOT_COMMAND_QUEUE_SIZE commands are already waiting
+ *
+ * @parameter[in] command		command to post, it is copied so it can be a local variable
+*/
+void motControllerPostCommand(travCtrl_ctx *ctx, const MotCommand *command);
+
+/**
+ * @brief   Executes a command received by the controller thread
+ *
+ * @parameter[in] command	command fetched from the mailbox
+ *
+ * @return	true if the controller should run immediately, false otherwise
+*/
+bool motControllerExecuteCommand(travCtrl_ctx *ctx, const MotCommand *command);
+
+/**
+ * @brief   Integrates the motor step counters into robHeading, and records it in headingHistory
+*/
+void motControllerUpdateOdometry(travCtrl_ctx *ctx);
+
+/**
+ * @brief   Looks up the heading of the robot at a given time in headingHistory
+ * @note 	If time is older than the history, the oldest heading is returned
+ *
+ * @parameter[in] time		system time to look for
+ *
+ * @return	heading in degrees at time
+*/
+float motControllerHeadingAt(travCtrl_ctx *ctx, systime_t time);
+
+/**
+ * @brief   Sets both motor speeds, the only place where the motors are written to
+*/
+void motControllerSetSpeeds(travCtrl_ctx *ctx, int16_t rightSpeed, int16_t leftSpeed);
+
+/**
+ * @brief   Sends the controller state as TELEM__MSG_CONTROLLER, if this stream is enabled
+*/
+void motControllerSendTelemetry(travCtrl_ctx *ctx);
+
+/**
+ * @brief   Updates obstacleState with the latest state published by the obstacle sensor thread
  * @return  true if obstacle is reached, false otherwise
 */
-bool updateIsObstacleReached(void);
+bool updateIsObstacleReached(travCtrl_ctx *ctx);
+
+/**
+ * @brief   Decides what to do when an obstacle is reached: stop at the source or start going around
+*/
+void motControllerObstacleReached(travCtrl_ctx *ctx);
+
+/**
+ * @brief   Runs one tick of the go around behaviour, while avoidState is not MOT_AVOID_NONE
+*/
+void motControllerAvoidStep(travCtrl_ctx *ctx);
+
+/**
+ * @brief   Stops the robot and calls the callback given on initialization
+ *
+ * @parameter[in] reason		TRAVCTRL__AT_SOURCE or TRAVCTRL__BLOCKED
+*/
+void motControllerStopAndNotify(travCtrl_ctx *ctx, uint8_t reason);
 
 /**
  * @brief   Updates the speeds of the motors based on distance and angle to obstace
+ *
+ * @parameter[in] dt		time since last update in seconds
+*/
+void motControllerUpdateSpeeds(travCtrl_ctx *ctx, float dt);
+
+/**
+ * @brief   Calculates the wheel speeds (before the minimum speed offset) in proportional mode, filtered with ema
+ *
+ * @parameter[out] rightSpeed		right wheel speed in steps/s
+ * @parameter[out] leftSpeed		left wheel speed in steps/s
+*/
+void motControllerProportionalSpeeds(travCtrl_ctx *ctx, int16_t *rightSpeed, int16_t *leftSpeed);
+
+/**
+ * @brief   Calculates the wheel speeds (before the minimum speed offset) in PID mode, with the motion profile
+ *
+ * @parameter[in] dt				time since last update in seconds
+ * @parameter[out] rightSpeed		right wheel speed in steps/s
+ * @parameter[out] leftSpeed		left wheel speed in steps/s
+*/
+void motControllerPidSpeeds(travCtrl_ctx *ctx, float dt, int16_t *rightSpeed, int16_t *leftSpeed);
+
+/**
+ * @brief   calculates the speed differential (rotational speed) of the motors with the PID heading controller
+ * @note 	Same sign convention as motControllerCalculatetRotationSpeed
+ *
+ * @parameter[in] dt		time since last update in seconds
+ *
+ * @return	differential speed in steps/s, between -MOT_MAX_DIFF_SPS_PID and MOT_MAX_DIFF_SPS_PID
+*/
+float motControllerCalculatePidRotationSpeed(travCtrl_ctx *ctx, float dt);
+
+/**
+ * @brief   Moves the speed of one wheel towards its target, with limited acceleration and jerk
+ *
+ * @parameter[in] target			speed to reach in steps/s
+ * @parameter[in] dt				time since last update in seconds
+ * @parameter[out] profile		state of the wheel profile, updated
+*/
+void motControllerProfileStep(float target, float dt, WheelProfile *profile);
+
+/**
+ * @brief   Resets the PID and the motion profiles, when the robot starts from standstill
 */
-void motControllerUpdateSpeeds(void);
+void motControllerResetProfile(travCtrl_ctx *ctx);
 
 /**
  * @brief   calculates the speed differential (rotational speed) of the motors based on direction angle
@@ -118,40 +270,103 @@ void motControllerUpdateSpeeds(void);
  * @return	The calculated value for the new speed differential, in steps per second,
  * 			between -MOT_MAX_DIFF_SPS_FOR_CORRECTION and MOT_MAX_DIFF_SPS_FOR_CORRECTION
 */
-int16_t motControllerCalculatetRotationSpeed(void);
+int16_t motControllerCalculatetRotationSpeed(travCtrl_ctx *ctx);
 
 /**
  * @brief   calculates the common speed for the motors motors based on distance
  * @return 	The calculated speed for the motors in steps per second, between 0 and MOT_MAX_NEEDED_SPS
 */
-uint16_t motControllerCalculateForwardSpeed(void);
+uint16_t motControllerCalculateForwardSpeed(travCtrl_ctx *ctx);
+
+/**
+ * @brief   Hooks of the e-puck2 (TravCtrlIo): motors.h and the obstacle sensor thread, arg is not used
+*/
+void motControllerEpuckSetSpeeds(void *arg, int16_t rightSpeed, int16_t leftSpeed);
+void motControllerEpuckGetPositions(void *arg, int32_t *rightPos, int32_t *leftPos);
+void motControllerEpuckGetObstacleState(void *arg, ObstacleState *state);
 
 
 /*===========================================================================*/
 /* Threads used in travelController                  							*/
 /*===========================================================================*/
 
-/* Working area for the motor controller thread */
-static THD_WORKING_AREA(waMotControllerThd, MOT_CONTROLLER_WORKING_AREA_SIZE);
-/* Motor controller thread. */
+/* Motor controller thread, one per context (given as arg), its working area is in the context.
+ * @note It sleeps on the command mailbox. When the robot is stopped it waits for a command without timeout,
+ * 			when it moves it waits at most until the next MOT_CONTROLLER_PERIOD tick, where the controller runs. */
 static THD_FUNCTION(MotControllerThd, arg)
 {
-	(void)arg; 									// silence warning about unused argument
+	chRegSetThreadName(__FUNCTION__);
+
+	travCtrl_ctx *ctx 			= (travCtrl_ctx *) arg;
+	systime_t lastTime 			= chVTGetSystemTime();	//time at which the controller ran for the last time
+	systime_t now				= 0;
+	systime_t timeout 			= TIME_INFINITE;
+	systime_t elapsed			= 0;
+	msg_t commandMsg				= 0;
+	uint8_t telemetryTicks		= 0;
+	bool scheduled				= false;		//the controller runs because its period elapsed, not for a command
+	MotCommand command;
+
 	while (true) {
-		systime_t time = chVTGetSystemTime();	//time to restart it MOT_CONTROLLER_PERIOD milliseconds later
+		motControllerUpdateOdometry(ctx);
+
+		timeout = TIME_INFINITE;
+		if(ctx->robShouldMove){
+			elapsed = chVTGetSystemTime() - lastTime;
+			timeout = (elapsed >= MS2ST(MOT_CONTROLLER_PERIOD)) ? TIME_IMMEDIATE : MS2ST(MOT_CONTROLLER_PERIOD) - elapsed;
+		}
 
-		if(robShouldMove){
+		scheduled = true;
+		if(chMBFetch(&ctx->commandMailbox, &commandMsg, timeout) == MSG_OK){
+			scheduled = false;
+			//copy the command and give it back to the pool before executing it
+			command = *((MotCommand *) commandMsg);
+			chPoolFree(&ctx->commandPool, (void *) commandMsg);
+			chSemSignal(&ctx->commandPoolFree);
 
-			//when an obstacle is reached we stop moving and use the callback provided on initialization
-			if(updateIsObstacleReached() == true){
-				travCtrl_stopMoving();
-				obstacleReachedCallBack();
+			if(motControllerExecuteCommand(ctx, &command) == false){
+				continue;
 			}
-			else{
-				motControllerUpdateSpeeds();		//when the obstacle isn't reached, we run the controller
+		}
+		else if(ctx->robShouldMove == false){
+			continue;
+		}
+
+		//controller tick: either the period elapsed or a new direction was received
+		now = chVTGetSystemTime();
+		elapsed = now - lastTime;
+		lastTime = now;
+		if(ctx == &mainCtx){						//systemMonitor.h watches the loop of the robot only
+			sysmon_loopRun(SYSMON__LOOP_MOT_CONTROLLER, MOT_CONTROLLER_PERIOD*1000, scheduled);
+		}
+
+		//predict the direction relative to where the robot is heading now
+		ctx->destAngle = (int16_t) num_WrapDeg180F(ctx->destHeading - ctx->robHeading);
+
+		//when going around an obstacle, the go around behaviour drives the motors instead of the controller
+		if(ctx->avoidState != MOT_AVOID_NONE){
+			motControllerAvoidStep(ctx);
+		}
+		//when an obstacle is reached we either stop at the source or start going around it
+		else if(updateIsObstacleReached(ctx) == true){
+			motControllerObstacleReached(ctx);
+		}
+		else{
+			PROF__BEGIN(PROF__STAGE_MOT_UPDATE);
+			motControllerUpdateSpeeds(ctx, num_ClampF(ST2MS(elapsed)/1000.0f, MOT_MIN_DT_S, MOT_MAX_DT_S));		//when the obstacle isn't reached, we run the controller
+			PROF__END(PROF__STAGE_MOT_UPDATE);
+
+			//the first speeds computed with a new angle end its latency trace
+			if(ctx->tracePending){
+				trace_record(&ctx->traceStamp, chVTGetSystemTime());
+				ctx->tracePending = false;
 			}
 		}
-		chThdSleepUntilWindowed(time, time + MS2ST(MOT_CONTROLLER_PERIOD));	//the thread runs every MOT_CONTROLLER_PERIOD milliseconds
+
+		if(++telemetryTicks >= MOT_TELEMETRY_DIVIDER){
+			telemetryTicks = 0;
+			motControllerSendTelemetry(ctx);
+		}
 	}
 }
 
@@ -163,47 +378,154 @@ static THD_FUNCTION(MotControllerThd, arg)
 
 void travCtrl_init(travCtrl_obstacleReached obstacleReachedCallBackPointer)
 {
-	//Start chibiOS modules: motor & time of flight (TOF) sensor
+	//Start chibiOS modules: motors, and the messagebus needed by the sensors
 	motors_init();
-	VL53L0X_start();
-
-	//Start and calibrate the infrared proximity sensors
 	messagebus_init(&bus, &bus_lock, &bus_condvar);
-	proximity_start();
-	calibrate_ir();
 
-	// Update file level function pointer to callback provided for when destination is reached
-	obstacleReachedCallBack = obstacleReachedCallBackPointer;
+	//Start the time of flight (TOF) and infrared proximity sensors, fused in their own thread
+	obstSens_start();
+
+	travCtrl_ctxInit(&mainCtx, NULL, obstacleReachedCallBackPointer);
+	travCtrl_ctxStart(&mainCtx);
+
+	return;
+}
+
+void travelCtrl_goToAngle(int16_t directionAngle, const TraceStamp *stamp, bool sourceIsClose)
+{
+	travCtrl_ctxGoToAngle(&mainCtx, directionAngle, stamp, sourceIsClose);
+}
+
+void travCtrl_stopMoving()
+{
+	travCtrl_ctxStopMoving(&mainCtx);
+}
+
+void travCtrl_moveBackwards(void)
+{
+	travCtrl_ctxMoveBackwards(&mainCtx);
+}
+
+void travCtrl_setMode(uint8_t mode)
+{
+	travCtrl_ctxSetMode(&mainCtx, mode);
+}
+
+void travCtrl_setPidGains(float kp, float ki, float kd)
+{
+	travCtrl_ctxSetPidGains(&mainCtx, kp, ki, kd);
+}
+
+void travCtrl_setPropGains(int16_t maxAngleToCorrect, float emaWeight)
+{
+	travCtrl_ctxSetPropGains(&mainCtx, maxAngleToCorrect, emaWeight);
+}
+
+void travCtrl_ctxInit(travCtrl_ctx *ctx, const TravCtrlIo *io, travCtrl_obstacleReached obstacleReachedCallBackPointer)
+{
+	memset(ctx, 0, sizeof(travCtrl_ctx));
+
+	//Without hooks the context drives the e-puck2, its obstacle sensors must have been started
+	ctx->io.setSpeeds = motControllerEpuckSetSpeeds;
+	ctx->io.getPositions = motControllerEpuckGetPositions;
+	ctx->io.getObstacleState = motControllerEpuckGetObstacleState;
+	if(io != NULL){
+		ctx->io = *io;
+	}
+	ctx->io.getObstacleState(ctx->io.arg, &ctx->obstacleState);
+
+	// Update the callback provided for when destination is reached
+	ctx->obstacleReachedCallBack = obstacleReachedCallBackPointer;
+
+	//Controller mode and gains at start
+	ctx->avoidTurnDirection = 1;
+	ctx->controllerMode = TRAVCTRL__MODE_PID;
+	ctx->pidKp = MOT_PID_DEFAULT_KP;
+	ctx->pidKi = MOT_PID_DEFAULT_KI;
+	ctx->pidKd = MOT_PID_DEFAULT_KD;
+	ctx->propMaxAngle = MOT_MAX_ANGLE_TO_CORRECT;
+	ctx->propEmaNewWeightQ15 = EMA_NEW_WEIGHT_MOT_Q15;
+
+	//Fill the command pool, commands are then exchanged with the controller thread through the mailbox
+	chMBObjectInit(&ctx->commandMailbox, ctx->commandMailboxBuffer, MOT_COMMAND_QUEUE_SIZE);
+	chPoolObjectInit(&ctx->commandPool, sizeof(MotCommand), NULL);
+	chSemObjectInit(&ctx->commandPoolFree, MOT_COMMAND_QUEUE_SIZE);
+	chPoolLoadArray(&ctx->commandPool, ctx->commandBuffer, MOT_COMMAND_QUEUE_SIZE);
+
+	//Start odometry from the current step counters
+	ctx->io.getPositions(ctx->io.arg, &ctx->lastRightPos, &ctx->lastLeftPos);
+	for(uint8_t i = 0; i < MOT_HEADING_HISTORY_SIZE; i++){
+		ctx->headingHistory[i].time = chVTGetSystemTime();
+		ctx->headingHistory[i].heading = 0;
+	}
+}
 
-	/* Start of the controller thread here. We never stop the thread, only skip some code inside
-	 * it when not needed. Therefore, we do not remember the pointer to the thread.
+void travCtrl_ctxStart(travCtrl_ctx *ctx)
+{
+	/* Start of the controller thread here. We never stop the thread, it sleeps on its mailbox
+	 * when not needed. Therefore, we do not remember the pointer to the thread.
 	 * The priority is set to NORMALPRIO even though it is a critical task, because
 	 * other running threads must also run for the controller to be useful, so
 	 * all threads should have the same priority as  MotControllerThd*/
-	chThdCreateStatic(waMotControllerThd, sizeof(waMotControllerThd), NORMALPRIO, MotControllerThd, NULL);
+	chThdCreateStatic(ctx->waMotControllerThd, sizeof(ctx->waMotControllerThd), NORMALPRIO, MotControllerThd, ctx);
+}
 
-	return;
+void travCtrl_ctxGoToAngle(travCtrl_ctx *ctx, int16_t directionAngle, const TraceStamp *stamp, bool sourceIsClose)
+{
+	MotCommand command = {0};
+
+	command.type = MOT_COMMAND_GO_TO_ANGLE;
+	command.angle = directionAngle;
+	command.stamp = *stamp;
+	command.stamp.command = chVTGetSystemTime();
+	command.sourceIsClose = sourceIsClose;
+	motControllerPostCommand(ctx, &command);
 }
 
-void travelCtrl_goToAngle(int16_t directionAngle)
+void travCtrl_ctxStopMoving(travCtrl_ctx *ctx)
 {
-	destAngle = directionAngle;
-	robShouldMove=true;
+	MotCommand command = {0};
+
+	command.type = MOT_COMMAND_STOP;
+	motControllerPostCommand(ctx, &command);
 }
 
-void travCtrl_stopMoving()
+void travCtrl_ctxMoveBackwards(travCtrl_ctx *ctx)
 {
-	robShouldMove=false;			// This file variable makes the thread skip controller functions if false
+	MotCommand command = {0};
+
+	command.type = MOT_COMMAND_BACKWARDS;
+	motControllerPostCommand(ctx, &command);
+}
 
-	right_motor_set_speed(0);	//We need to actually stop the motors, or they will keep the last values set.
-	left_motor_set_speed(0);
+void travCtrl_ctxSetMode(travCtrl_ctx *ctx, uint8_t mode)
+{
+	MotCommand command = {0};
 
+	command.type = MOT_COMMAND_SET_MODE;
+	command.mode = mode;
+	motControllerPostCommand(ctx, &command);
 }
 
-void travCtrl_moveBackwards(void)
+void travCtrl_ctxSetPidGains(travCtrl_ctx *ctx, float kp, float ki, float kd)
+{
+	MotCommand command = {0};
+
+	command.type = MOT_COMMAND_SET_GAINS;
+	command.kp = kp;
+	command.ki = ki;
+	command.kd = kd;
+	motControllerPostCommand(ctx, &command);
+}
+
+void travCtrl_ctxSetPropGains(travCtrl_ctx *ctx, int16_t maxAngleToCorrect, float emaWeight)
 {
-	right_motor_set_speed(-MOT_MAX_NEEDED_SPS);
-	left_motor_set_speed(-MOT_MAX_NEEDED_SPS);
+	MotCommand command = {0};
+
+	command.type = MOT_COMMAND_SET_PROP_GAINS;
+	command.maxAngle = maxAngleToCorrect;
+	command.emaWeight = emaWeight;
+	motControllerPostCommand(ctx, &command);
 }
 
 
@@ -211,70 +533,227 @@ void travCtrl_moveBackwards(void)
 /* Private functions	 code												   */
 /*===========================================================================*/
 
-bool updateIsObstacleReached(void)
+void motControllerPostCommand(travCtrl_ctx *ctx, const MotCommand *command)
+{
+	MotCommand *pooledCommand = NULL;
+
+	chSemWait(&ctx->commandPoolFree);						//there is always a free command after this
+	pooledCommand = (MotCommand *) chPoolAlloc(&ctx->commandPool);
+
+	*pooledCommand = *command;
+
+	chMBPost(&ctx->commandMailbox, (msg_t) pooledCommand, TIME_INFINITE);
+}
+
+bool motControllerExecuteCommand(travCtrl_ctx *ctx, const MotCommand *command)
 {
-	static uint8_t discardStartMeasurements 	= 0;
+	switch(command->type){
+		case MOT_COMMAND_GO_TO_ANGLE:
+			//rebase the angle in the odometry frame, with the heading the robot had when it was measured
+			ctx->destHeading = motControllerHeadingAt(ctx, command->stamp.capture) + command->angle;
+			ctx->sourceIsClose = command->sourceIsClose;
+			ctx->traceStamp = command->stamp;
+			ctx->tracePending = true;
+			if(ctx->robShouldMove == false){
+				motControllerResetProfile(ctx);
+				ctx->avoidAttempts = 0;
+			}
+			ctx->robShouldMove = true;
+			return true;						//react to the new direction now instead of at the next tick
+
+		case MOT_COMMAND_STOP:
+			ctx->robShouldMove = false;			// This context field makes the thread skip controller functions if false
+			ctx->avoidState = MOT_AVOID_NONE;
+			motControllerSetSpeeds(ctx, 0, 0);	//We need to actually stop the motors, or they will keep the last values set.
+			return false;
+
+		case MOT_COMMAND_BACKWARDS:
+			ctx->robShouldMove = false;
+			ctx->avoidState = MOT_AVOID_NONE;
+			motControllerSetSpeeds(ctx, -MOT_MAX_NEEDED_SPS, -MOT_MAX_NEEDED_SPS);
+			return false;
+
+		case MOT_COMMAND_SET_MODE:
+			if(command->mode == TRAVCTRL__MODE_PROPORTIONAL || command->mode == TRAVCTRL__MODE_PID){
+				ctx->controllerMode = command->mode;
+				motControllerResetProfile(ctx);
+			}
+			return false;
+
+		case MOT_COMMAND_SET_GAINS:
+			ctx->pidKp = command->kp;
+			ctx->pidKi = command->ki;
+			ctx->pidKd = command->kd;
+			ctx->pidIntegral = 0;
+			return false;
+
+		case MOT_COMMAND_SET_PROP_GAINS:
+			ctx->propMaxAngle = (int16_t) num_ClampI32(command->maxAngle, 1, MOT_MAX_ANGLE_TO_CORRECT_LIMIT);
+			ctx->propEmaNewWeightQ15 = NUM__Q15(1.0f-num_ClampF(command->emaWeight, 0.0f, 1.0f));
+			return false;
+
+		default:
+			return false;
+	}
+}
 
-	int emaPastValueLeft 					= 0;
-	int emaPastValueRight 					= 0;
-	int emaPastValueFrontLeft				= 0;
-	int emaPastValueFrontRight				= 0;
+void motControllerUpdateOdometry(travCtrl_ctx *ctx)
+{
+	int32_t rightPos 	= 0;
+	int32_t leftPos 		= 0;
 
-	bool isDestinationReached = false;
+	ctx->io.getPositions(ctx->io.arg, &rightPos, &leftPos);
 
-	// update filtered emaPastDistances value with newest value
-	emaPastDistances = (int16_t) (EMA_WEIGHT_TOF*emaPastDistances+(1-EMA_WEIGHT_TOF)*VL53L0X_get_dist_mm() );
+	//turning right means the left wheel goes further than the right one
+	ctx->robHeading += MOT_STEP_TO_DEG * (float) ((leftPos-ctx->lastLeftPos) - (rightPos-ctx->lastRightPos));
+	ctx->lastRightPos = rightPos;
+	ctx->lastLeftPos = leftPos;
 
-	emaPastValueLeft=get_calibrated_prox(IR_LEFT);
-	emaPastValueRight=get_calibrated_prox(IR_RIGHT);
-	emaPastValueFrontLeft=get_calibrated_prox(IR_FRONT_LEFT);
-	emaPastValueFrontRight=get_calibrated_prox(IR_FRONT_RIGHT);
+	ctx->headingHistoryIndex = (ctx->headingHistoryIndex+1) % MOT_HEADING_HISTORY_SIZE;
+	ctx->headingHistory[ctx->headingHistoryIndex].time = chVTGetSystemTime();
+	ctx->headingHistory[ctx->headingHistoryIndex].heading = ctx->robHeading;
+}
 
-	//Set isDestinationReached to true when an object is detected from the FOT-seonsor or the IR-sensor
-	if(emaPastDistances<=STOP_DISTANCE_VALUE_MM || emaPastValueLeft>IR_STOP_VALUE || emaPastValueRight>IR_STOP_VALUE ||
-												emaPastValueFrontLeft>IR_STOP_VALUE || emaPastValueFrontRight>IR_STOP_VALUE){
+float motControllerHeadingAt(travCtrl_ctx *ctx, systime_t time)
+{
+	uint8_t index = ctx->headingHistoryIndex;
 
-		emaPastDistances = INIT_DISTANCE_VALUE_MM;		//Reinitialize TOF-distance for further use
-		isDestinationReached = true;
+	//go back from the newest sample until one is not newer than time
+	for(uint8_t i = 0; i < MOT_HEADING_HISTORY_SIZE-1; i++){
+		if((int32_t) (ctx->headingHistory[index].time - time) <= 0){
+			break;
+		}
+		index = (index + MOT_HEADING_HISTORY_SIZE - 1) % MOT_HEADING_HISTORY_SIZE;
 	}
 
-	//For approx. the first DISCARD_FIRST_N_TOF_MEASURES times VL53L0X_get_dist_mm() is called it returns 0.
-	//We check if we are in the first DISCARD_FIRST_N_TOF_MEASURES cycles and discard these cycles
-	if(discardStartMeasurements<DISCARD_FIRST_N_TOF_MEASURES){
-		isDestinationReached = false;
-		discardStartMeasurements++;
-		emaPastDistances = INIT_DISTANCE_VALUE_MM;
+	return ctx->headingHistory[index].heading;
+}
+
+void motControllerSetSpeeds(travCtrl_ctx *ctx, int16_t rightSpeed, int16_t leftSpeed)
+{
+	ctx->io.setSpeeds(ctx->io.arg, rightSpeed, leftSpeed);
+	ctx->rightSpeedSet = rightSpeed;
+	ctx->leftSpeedSet = leftSpeed;
+}
+
+void motControllerSendTelemetry(travCtrl_ctx *ctx)
+{
+	uint8_t payload[sizeof(uint32_t)+3*sizeof(uint8_t)+sizeof(int16_t)+sizeof(float)+2*sizeof(int16_t)];
+	uint8_t *write = payload;
+
+	if(telem_isStreaming(TELEM__MSG_CONTROLLER) == false){
+		return;
 	}
 
-	return isDestinationReached;
+	write = telem_PutU32(write, (uint32_t) chVTGetSystemTime());
+	write = telem_PutU8(write, ctx->controllerMode);
+	write = telem_PutU8(write, ctx->robShouldMove);
+	write = telem_PutU8(write, ctx->avoidState);
+	write = telem_PutU16(write, (uint16_t) ctx->destAngle);
+	write = telem_PutF32(write, ctx->robHeading);
+	write = telem_PutU16(write, (uint16_t) ctx->rightSpeedSet);
+	write = telem_PutU16(write, (uint16_t) ctx->leftSpeedSet);
+	telem_send(TELEM__MSG_CONTROLLER, payload, (uint16_t) (write - payload));
+}
+
+bool updateIsObstacleReached(travCtrl_ctx *ctx)
+{
+	//the sensors are filtered in their own thread, here we only take the latest fused state
+	ctx->io.getObstacleState(ctx->io.arg, &ctx->obstacleState);
+
+	return ctx->obstacleState.obstacleNear;
 }
 
 
-void motControllerUpdateSpeeds(void)
+void motControllerObstacleReached(travCtrl_ctx *ctx)
 {
-	static int16_t ema_rightMotSpeed 	= 0;
-	static int16_t ema_leftMotSpeed 		= 0;
+	int16_t bearingDifference = (int16_t) num_WrapDeg180F(ctx->obstacleState.obstacleBearing - ctx->destAngle);
 
-	int16_t rightMotSpeed 				= 0;						// In steps per second
-	int16_t leftMotSpeed 				= 0;						// In steps per second
+	if(ctx->sourceIsClose && abs(bearingDifference) <= MOT_SOURCE_BEARING_TOLERANCE){
+		motControllerStopAndNotify(ctx, TRAVCTRL__AT_SOURCE);
+		return;
+	}
 
-	// We first obtain the rotational (differential) speed (based on angle).
-	int16_t motSpeedDiff = motControllerCalculatetRotationSpeed();
+	if(ctx->avoidAttempts >= MOT_AVOID_MAX_ATTEMPTS){
+		motControllerStopAndNotify(ctx, TRAVCTRL__BLOCKED);
+		return;
+	}
 
-	//Then we obtain the forward speed (based on distance)
-	uint16_t robForwardSpeed 			= 0;
+	//Something else is in the way: turn away from it, on the side where it is not
+	ctx->avoidAttempts++;
+	ctx->avoidTurnDirection = (ctx->obstacleState.obstacleBearing >= 0) ? -1 : 1;
+	ctx->avoidState = MOT_AVOID_TURN;
+	ctx->avoidStartTime = chVTGetSystemTime();
+	motControllerAvoidStep(ctx);
+}
+
+void motControllerAvoidStep(travCtrl_ctx *ctx)
+{
+	systime_t elapsed = chVTGetSystemTime() - ctx->avoidStartTime;
+
+	ctx->io.getObstacleState(ctx->io.arg, &ctx->obstacleState);
+
+	switch(ctx->avoidState){
+		case MOT_AVOID_TURN:
+			//turn on the spot until the obstacle is not in front anymore, then drive along it
+			if(ctx->obstacleState.obstacleNear == false){
+				ctx->avoidState = MOT_AVOID_BYPASS;
+				ctx->avoidStartTime = chVTGetSystemTime();
+				elapsed = 0;
+			}
+			else if(elapsed > MS2ST(MOT_AVOID_TURN_MAX_MS)){
+				ctx->avoidState = MOT_AVOID_NONE;
+				motControllerStopAndNotify(ctx, TRAVCTRL__BLOCKED);
+				return;
+			}
+			else{
+				motControllerSetSpeeds(ctx, -ctx->avoidTurnDirection*MOT_AVOID_TURN_SPS, ctx->avoidTurnDirection*MOT_AVOID_TURN_SPS);
+				return;
+			}
+			//start driving along the obstacle now
+			/* fall through */
+		case MOT_AVOID_BYPASS:
+			if(ctx->obstacleState.obstacleNear){
+				ctx->avoidState = MOT_AVOID_NONE;
+				motControllerObstacleReached(ctx);			//new obstacle (or the same one) in the way, counts as a new attempt
+			}
+			else if(elapsed > MS2ST(MOT_AVOID_BYPASS_MS)){
+				ctx->avoidState = MOT_AVOID_NONE;				//obstacle passed, head back towards the source
+				motControllerResetProfile(ctx);
+			}
+			else{
+				motControllerSetSpeeds(ctx, MOT_AVOID_BYPASS_SPS, MOT_AVOID_BYPASS_SPS);
+			}
+			break;
 
-	if(-MOT_MAX_ANGLE_TO_CORRECT<destAngle && destAngle<MOT_MAX_ANGLE_TO_CORRECT){
-		robForwardSpeed = motControllerCalculateForwardSpeed();
+		default:
+			ctx->avoidState = MOT_AVOID_NONE;
+			break;
 	}
+}
 
-	//The motor speeds (before filtering) are calculated with the forward speed and differential speed.
-	rightMotSpeed = (int16_t) robForwardSpeed - (int16_t) motSpeedDiff;
-	leftMotSpeed = (int16_t) robForwardSpeed + (int16_t) motSpeedDiff;
+void motControllerStopAndNotify(travCtrl_ctx *ctx, uint8_t reason)
+{
+	ctx->robShouldMove = false;
+	motControllerSetSpeeds(ctx, 0, 0);
+	ctx->obstacleReachedCallBack(reason);
+}
 
-	//We use exponential moving average values because speeds must not be changed to fast or motors make grinding noises
-	ema_rightMotSpeed = (int16_t) (EMA_WEIGHT_MOT*ema_rightMotSpeed+(1-EMA_WEIGHT_MOT)*rightMotSpeed);
-	ema_leftMotSpeed = (int16_t) (EMA_WEIGHT_MOT*ema_leftMotSpeed+(1-EMA_WEIGHT_MOT)*leftMotSpeed);
+void motControllerUpdateSpeeds(travCtrl_ctx *ctx, float dt)
+{
+	int16_t ema_rightMotSpeed 			= 0;						// Filtered speeds, in steps per second
+	int16_t ema_leftMotSpeed 			= 0;
+
+	int16_t rightMotSpeed 				= 0;						// In steps per second
+	int16_t leftMotSpeed 				= 0;						// In steps per second
+
+	//Speeds must not be changed to fast or motors make grinding noises, each mode filters them its own way
+	if(ctx->controllerMode == TRAVCTRL__MODE_PID){
+		motControllerPidSpeeds(ctx, dt, &ema_rightMotSpeed, &ema_leftMotSpeed);
+	}
+	else{
+		motControllerProportionalSpeeds(ctx, &ema_rightMotSpeed, &ema_leftMotSpeed);
+	}
 
 	/*We saw that when speeds were below MOT_MIN_SPEED_SPS steps per second,
 	 * the motors were vibrating, so here we offset xxxMotSpeed values,
@@ -303,35 +782,108 @@ void motControllerUpdateSpeeds(void)
 	}
 
 	//Set the motor speeds
-	right_motor_set_speed(rightMotSpeed);
-	left_motor_set_speed(leftMotSpeed);
+	motControllerSetSpeeds(ctx, rightMotSpeed, leftMotSpeed);
 }
 
-int16_t motControllerCalculatetRotationSpeed(void)
+void motControllerProportionalSpeeds(travCtrl_ctx *ctx, int16_t *rightSpeed, int16_t *leftSpeed)
 {
-	int16_t motSpeedDiff 	= 0;				// to store the rotational (differential) motor speed in steps/s
+	// We first obtain the rotational (differential) speed (based on angle).
+	int16_t motSpeedDiff = motControllerCalculatetRotationSpeed(ctx);
 
-	int16_t tempDestAngle 	= destAngle;		//we do not want to modify destAngle, so just copy it
+	//Then we obtain the forward speed (based on distance)
+	uint16_t robForwardSpeed 			= 0;
 
-	/* Our controller only changes values for angles up to MOT_MAX_ANGLE_TO_CORRECT,
-	 * otherwise it applies the max correction*/
-	if(tempDestAngle > MOT_MAX_ANGLE_TO_CORRECT){
-		tempDestAngle = MOT_MAX_ANGLE_TO_CORRECT;
+	if(-ctx->propMaxAngle<ctx->destAngle && ctx->destAngle<ctx->propMaxAngle){
+		robForwardSpeed = motControllerCalculateForwardSpeed(ctx);
 	}
-	else if(tempDestAngle < (- (int16_t) MOT_MAX_ANGLE_TO_CORRECT) ){
-		tempDestAngle = (- (int16_t) MOT_MAX_ANGLE_TO_CORRECT);
+
+	//The motor speeds (before filtering) are calculated with the forward speed and differential speed.
+	//We use exponential moving average values because speeds must not be changed to fast or motors make grinding noises
+	ctx->propRightSpeed = (int16_t) num_EmaQ15(ctx->propRightSpeed, (int16_t) robForwardSpeed - motSpeedDiff, ctx->propEmaNewWeightQ15);
+	ctx->propLeftSpeed = (int16_t) num_EmaQ15(ctx->propLeftSpeed, (int16_t) robForwardSpeed + motSpeedDiff, ctx->propEmaNewWeightQ15);
+
+	*rightSpeed = ctx->propRightSpeed;
+	*leftSpeed = ctx->propLeftSpeed;
+}
+
+void motControllerPidSpeeds(travCtrl_ctx *ctx, float dt, int16_t *rightSpeed, int16_t *leftSpeed)
+{
+	float motSpeedDiff 		= motControllerCalculatePidRotationSpeed(ctx, dt);
+
+	//Turn and drive at the same time: the forward speed is reduced with the angle, but never down to 0
+	float turnDriveRatio 	= num_ClampF(cosf(num_DegToRad(ctx->destAngle)), MOT_TURN_DRIVE_MIN_RATIO, 1.0f);
+	float robForwardSpeed 	= turnDriveRatio * motControllerCalculateForwardSpeed(ctx);
+
+	motControllerProfileStep(robForwardSpeed - motSpeedDiff, dt, &ctx->rightProfile);
+	motControllerProfileStep(robForwardSpeed + motSpeedDiff, dt, &ctx->leftProfile);
+
+	*rightSpeed = (int16_t) ctx->rightProfile.speed;
+	*leftSpeed = (int16_t) ctx->leftProfile.speed;
+}
+
+float motControllerCalculatePidRotationSpeed(travCtrl_ctx *ctx, float dt)
+{
+	float error 			= ctx->destAngle;
+	float headingRate 	= (ctx->robHeading - ctx->pidLastHeading)/dt;		//d(error)/dt = -headingRate between two audio angles
+
+	ctx->pidLastHeading = ctx->robHeading;
+
+	ctx->pidIntegral = num_ClampF(ctx->pidIntegral + ctx->pidKi*error*dt, -MOT_PID_INTEGRAL_LIMIT, MOT_PID_INTEGRAL_LIMIT);
+
+	return num_ClampF(ctx->pidKp*error + ctx->pidIntegral - ctx->pidKd*headingRate, -MOT_MAX_DIFF_SPS_PID, MOT_MAX_DIFF_SPS_PID);
+}
+
+void motControllerProfileStep(float target, float dt, WheelProfile *profile)
+{
+	float speedError 	= target - profile->speed;
+	float direction 		= (speedError >= 0) ? 1.0f : -1.0f;
+
+	/* Wanted acceleration: limited by MOT_MAX_ACCEL_SPS2, by what is needed to reach the target in this step,
+	 * and by sqrt(2*jerk*error) so that the acceleration can come back to 0 when the target is reached */
+	float wantedAccel = fminf(fabsf(speedError)/dt, MOT_MAX_ACCEL_SPS2);
+	wantedAccel = direction * fminf(wantedAccel, sqrtf(2.0f*MOT_MAX_JERK_SPS3*fabsf(speedError)));
+
+	//The acceleration itself changes at most by the jerk limit
+	profile->accel = num_ClampF(wantedAccel, profile->accel - MOT_MAX_JERK_SPS3*dt, profile->accel + MOT_MAX_JERK_SPS3*dt);
+	profile->speed += profile->accel*dt;
+
+	//Do not overshoot the target
+	if((direction > 0 && profile->speed > target) || (direction < 0 && profile->speed < target)){
+		profile->speed = target;
+		profile->accel = 0;
 	}
+}
+
+void motControllerResetProfile(travCtrl_ctx *ctx)
+{
+	ctx->rightProfile.speed = 0;
+	ctx->rightProfile.accel = 0;
+	ctx->leftProfile.speed = 0;
+	ctx->leftProfile.accel = 0;
+	ctx->pidIntegral = 0;
+	ctx->pidLastHeading = ctx->robHeading;
+}
+
+int16_t motControllerCalculatetRotationSpeed(travCtrl_ctx *ctx)
+{
+	int16_t motSpeedDiff 	= 0;				// to store the rotational (differential) motor speed in steps/s
+
+	int16_t tempDestAngle 	= ctx->destAngle;		//we do not want to modify ctx->destAngle, so just copy it
+
+	/* Our controller only changes values for angles up to ctx->propMaxAngle (MOT_MAX_ANGLE_TO_CORRECT at start),
+	 * otherwise it applies the max correction*/
+	tempDestAngle = (int16_t) num_ClampI32(tempDestAngle, -ctx->propMaxAngle, ctx->propMaxAngle);
 
 	/* Here we calculate the differential, in steps per second, which will always
 	 * 	between -MOT_MAX_DIFF_SPS_FOR_CORRECTION and MOT_MAX_DIFF_SPS_FOR_CORRECTION.
 	 * 	Rounding to integer value is wanted, and not a problem as speed is in integer steps/s */
-	motSpeedDiff = MOT_MAX_DIFF_SPS_FOR_CORRECTION * tempDestAngle / MOT_MAX_ANGLE_TO_CORRECT;
+	motSpeedDiff = MOT_MAX_DIFF_SPS_FOR_CORRECTION * tempDestAngle / ctx->propMaxAngle;
 
 	return motSpeedDiff;
 }
 
 
-uint16_t motControllerCalculateForwardSpeed(void)
+uint16_t motControllerCalculateForwardSpeed(travCtrl_ctx *ctx)
 {
 	uint16_t robSpeed = 0;					//to store the forward (common speed for both motors) in steps/s
 
@@ -339,12 +891,12 @@ uint16_t motControllerCalculateForwardSpeed(void)
 	 * controller. Otherwise if further than max distance, we just set max speed, or else leave
 	 * 0 speed as it means that an object is reached.
 	 * Rounding to integer value is wanted, and not a problem as speed is in integer steps/s */
-	if(STOP_DISTANCE_VALUE_MM <= emaPastDistances && emaPastDistances <= MAX_DISTANCE_VALUE_MM){
+	if(STOP_DISTANCE_VALUE_MM <= ctx->obstacleState.tofDistanceMm && ctx->obstacleState.tofDistanceMm <= MAX_DISTANCE_VALUE_MM){
 
-		robSpeed = ( MOT_MAX_NEEDED_SPS * (emaPastDistances-STOP_DISTANCE_VALUE_MM) )/(MAX_DISTANCE_VALUE_MM-STOP_DISTANCE_VALUE_MM);
+		robSpeed = ( MOT_MAX_NEEDED_SPS * (ctx->obstacleState.tofDistanceMm-STOP_DISTANCE_VALUE_MM) )/(MAX_DISTANCE_VALUE_MM-STOP_DISTANCE_VALUE_MM);
 
 	}
-	else if(emaPastDistances > MAX_DISTANCE_VALUE_MM){
+	else if(ctx->obstacleState.tofDistanceMm > MAX_DISTANCE_VALUE_MM){
 
 		robSpeed = MOT_MAX_NEEDED_SPS;
 
@@ -353,3 +905,23 @@ uint16_t motControllerCalculateForwardSpeed(void)
 
 	return robSpeed;
 }
+
+void motControllerEpuckSetSpeeds(void *arg, int16_t rightSpeed, int16_t leftSpeed)
+{
+	(void)arg;
+	right_motor_set_speed(rightSpeed);
+	left_motor_set_speed(leftSpeed);
+}
+
+void motControllerEpuckGetPositions(void *arg, int32_t *rightPos, int32_t *leftPos)
+{
+	(void)arg;
+	*rightPos = right_motor_get_pos();
+	*leftPos = left_motor_get_pos();
+}
+
+void motControllerEpuckGetObstacleState(void *arg, ObstacleState *state)
+{
+	(void)arg;
+	obstSens_getState(state);
+}
@@ -11,6 +11,26 @@
 #ifndef TRAVELCONTROLLER_H_
 #define TRAVELCONTROLLER_H_
 
+#include <latencyTrace.h>
+#include <obstacleSensor.h>
+
+/*===========================================================================*/
+/* Constants definition for this library						               */
+/*===========================================================================*/
+
+//Reasons given to the travCtrl_obstacleReached callback
+#define TRAVCTRL__AT_SOURCE					0		//the obstacle is the source the robot was going to
+#define TRAVCTRL__BLOCKED					1		//the obstacle could not be gone around, the robot gave up
+
+//Controller modes, see travCtrl_setMode
+#define TRAVCTRL__MODE_PROPORTIONAL			0		//proportional on the angle, speeds filtered with an exponential moving average
+#define TRAVCTRL__MODE_PID					1		//PID on the heading, acceleration/jerk limited speeds, turns while driving
+
+//Sizes of the buffers of travCtrl_ctx
+#define TRAVCTRL__WORKING_AREA_SIZE			1024		//1024 because it was found to be enough: less results in seg faults
+#define TRAVCTRL__COMMAND_QUEUE_SIZE			8		//how many commands can wait in the mailbox before the caller blocks
+#define TRAVCTRL__HEADING_HISTORY_SIZE		32		//heading of the last 32 controller runs, must cover an audio frame and its analysis
+
 
 /*===========================================================================*/
 /* Types								 			                            */
@@ -19,29 +39,147 @@
 /*
  * @brief type for callback function when obstacle is reached
  * @note is used to declare a pointer to a function that will be called when an obstacle has been reached.
+ * 			When the obstacle is not the source, the robot first tries to go around it and the callback is only
+ * 			called with TRAVCTRL__BLOCKED if it did not manage to.
+ *
+ * @parameter[in] reason		TRAVCTRL__AT_SOURCE or TRAVCTRL__BLOCKED
+ */
+typedef void (*travCtrl_obstacleReached)(uint8_t reason);
+
+/*
+ * Hooks through which a context drives its motors and reads its sensors, arg is given back to each of them
+ * @note the functions without a context use the motors.h functions and the obstacle sensor thread (obstacleSensor.h)
+ */
+typedef struct TravCtrlIos {
+	void (*setSpeeds)(void *arg, int16_t rightSpeed, int16_t leftSpeed);		//in steps/s
+	void (*getPositions)(void *arg, int32_t *rightPos, int32_t *leftPos);		//step counters of the wheels
+	void (*getObstacleState)(void *arg, ObstacleState *state);
+	void *arg;
+} TravCtrlIo;
+
+/*
+ * Command sent to the controller thread. A command is filled completely by the caller
+ * before its pointer is posted in the mailbox, and only the controller thread reads it
+ * afterwards, so it can never be read half-updated.
  */
-typedef void (*travCtrl_obstacleReached)(void);
+typedef struct MotCommands {
+	uint8_t type;			//MOT_COMMAND_XXX
+	int16_t angle;			//only for MOT_COMMAND_GO_TO_ANGLE, from -180° to +180°
+	TraceStamp stamp;		//only for MOT_COMMAND_GO_TO_ANGLE, frame and times at which angle was measured and given
+	bool sourceIsClose;		//only for MOT_COMMAND_GO_TO_ANGLE
+	uint8_t mode;			//only for MOT_COMMAND_SET_MODE, TRAVCTRL__MODE_XXX
+	float kp;				//only for MOT_COMMAND_SET_GAINS
+	float ki;
+	float kd;
+	int16_t maxAngle;		//only for MOT_COMMAND_SET_PROP_GAINS
+	float emaWeight;
+} MotCommand;
+
+/*
+ * State of the speed profile of one wheel, in steps/s, steps/s^2
+ */
+typedef struct WheelProfiles {
+	float speed;
+	float accel;
+} WheelProfile;
+
+/*
+ * Heading of the robot at a given time, for the odometry history
+ */
+typedef struct HeadingSamples {
+	systime_t time;
+	float heading;			//in degrees, not wrapped
+} HeadingSample;
+
+/*
+ * Motor controller: its thread, command mailbox, odometry, obstacle handling and controller state
+ * @note the fields are private to travelController.c, a context is only used through the travCtrl_ctxXxx functions
+ * @note each context runs its own thread, several of them can drive different (e.g. simulated) robots at once
+ */
+typedef struct TravCtrlContexts {
+	TravCtrlIo io;
+	travCtrl_obstacleReached obstacleReachedCallBack;	//called from the controller thread when an obstacle is reached
+
+	int16_t destAngle; 						//from -180° to +180°, relative to the current heading, predicted at each tick
+	float destHeading;						//direction to go to in the odometry (world) frame, in degrees
+
+	//Odometry: heading integrated from the motor step counters, and its history to rebase audio angles
+	float robHeading;						//in degrees, not wrapped
+	int32_t lastRightPos;
+	int32_t lastLeftPos;
+	HeadingSample headingHistory[TRAVCTRL__HEADING_HISTORY_SIZE];
+	uint8_t headingHistoryIndex;				//index of the newest sample
+
+	ObstacleState obstacleState;				//latest fused state of the obstacle sensors, read at each tick
+
+	//Obstacle classification and go around state
+	bool sourceIsClose;
+	uint8_t avoidState;
+	uint8_t avoidAttempts;
+	int8_t avoidTurnDirection;				//1 turns right, -1 turns left
+	systime_t avoidStartTime;
+
+	bool robShouldMove;						//the motor controller will only update speeds when this is true
+
+	//Controller mode, gains and state, only used by the controller thread (changed through commands)
+	uint8_t controllerMode;
+	float pidKp;
+	float pidKi;
+	float pidKd;
+	int16_t propMaxAngle;
+	int32_t propEmaNewWeightQ15;
+	int16_t propRightSpeed;					//filtered speeds of the proportional mode, in steps/s
+	int16_t propLeftSpeed;
+	float pidIntegral;						//in steps/s, already multiplied by ki
+	float pidLastHeading;
+	WheelProfile rightProfile;
+	WheelProfile leftProfile;
+	int16_t rightSpeedSet;					//last speeds written to the motors, for telemetry
+	int16_t leftSpeedSet;
+	TraceStamp traceStamp;					//stamp of the last angle, recorded once the speeds were updated for it
+	bool tracePending;
+
+	/* Commands are taken from commandPool, filled and posted in commandMailbox. The controller thread
+	 * frees them after executing. commandPoolFree counts the free commands so that callers wait
+	 * (instead of getting NULL from the pool) in the rare case where the queue is full. */
+	MotCommand commandBuffer[TRAVCTRL__COMMAND_QUEUE_SIZE];
+	msg_t commandMailboxBuffer[TRAVCTRL__COMMAND_QUEUE_SIZE];
+	mailbox_t commandMailbox;
+	memory_pool_t commandPool;
+	semaphore_t commandPoolFree;
+
+	THD_WORKING_AREA(waMotControllerThd, TRAVCTRL__WORKING_AREA_SIZE);
+} travCtrl_ctx;
 
 
 /*===========================================================================*/
 /* Public functions															*/
+/* @note The movement functions only post a command to the controller thread and	*/
+/* 		return immediately, the thread executes them in order.				*/
 /*===========================================================================*/
 
 /*
  * @brief   To start the whole controller, for later moving towards destination.
  *
  * @parameter[in] obstacleReachedCallBackPointer callback for when an obstacle
- * 						is reached and the robot stops.
+ * 						is reached and the robot stops. It is called from the controller thread.
 */
 void travCtrl_init(travCtrl_obstacleReached obstacleReachedCallBackPointer);
 
 /*
  * @brief   Sets the robot moving towards provided angle, or if already moving
  * 				it will just update the direction of movement
+ * @note		The angle is rebased with the wheel odometry heading at its capture time, and the controller
+ * 				then predicts the relative direction at every tick until the next angle is given.
+ * @note		When an obstacle is reached, it is the source if sourceIsClose and the obstacle is in the
+ * 				direction of the source, otherwise the robot goes around it.
  *
- * @parameter[in] directionAngle 	direction to go to, between -180° and 180°
+ * @parameter[in] directionAngle 	direction to go to, between -180° and 180°, relative to the heading of the robot at stamp->capture
+ * @parameter[in] stamp 				stamp of the audio frame directionAngle was measured in, it gets the command time here and is
+ * 									recorded in the latency traces when the controller updates the speeds for it
+ * @parameter[in] sourceIsClose 		true if the sound level says the source is close to the robot
 */
-void travelCtrl_goToAngle(int16_t directionAngle);
+void travelCtrl_goToAngle(int16_t directionAngle, const TraceStamp *stamp, bool sourceIsClose);
 
 /*
  * @brief   stops all movements until a new angle is given with travelCtrl_goToAngle
@@ -53,5 +191,55 @@ void travCtrl_stopMoving(void);
 */
 void travCtrl_moveBackwards(void);
 
+/*
+ * @brief   selects the controller used to follow the direction, TRAVCTRL__MODE_PID by default
+ *
+ * @parameter[in] mode 	TRAVCTRL__MODE_PROPORTIONAL or TRAVCTRL__MODE_PID, other values are ignored
+*/
+void travCtrl_setMode(uint8_t mode);
+
+/*
+ * @brief   sets the gains of the PID heading controller (TRAVCTRL__MODE_PID), the integral is reset
+ *
+ * @parameter[in] kp 	proportional gain in steps/s per degree
+ * @parameter[in] ki 	integral gain in steps/s per degree*second
+ * @parameter[in] kd 	derivative gain in steps/s per degree/second
+*/
+void travCtrl_setPidGains(float kp, float ki, float kd);
+
+/*
+ * @brief   sets the gains of the proportional controller (TRAVCTRL__MODE_PROPORTIONAL)
+ *
+ * @parameter[in] maxAngleToCorrect 	angle in degrees (1 to 180) over which the robot only turns, the turn is proportional
+ * 									below it, 40 at start
+ * @parameter[in] emaWeight 			weight of the past speeds in their moving average, range [0,1], 0.9 at start
+*/
+void travCtrl_setPropGains(int16_t maxAngleToCorrect, float emaWeight);
+
+/*
+ * @brief   initialises a context, stopped, with the mode and gains at start. Commands can be posted once it is
+ * 				initialised, they are executed when it is started
+ *
+ * @parameter[in] io 								hooks of the robot to drive, copied. NULL for the e-puck2, whose
+ * 												obstacle sensors must then be started (obstSens_start)
+ * @parameter[in] obstacleReachedCallBackPointer 	same as for travCtrl_init
+*/
+void travCtrl_ctxInit(travCtrl_ctx *ctx, const TravCtrlIo *io, travCtrl_obstacleReached obstacleReachedCallBackPointer);
+
+/*
+ * @brief   starts the controller thread of an initialised context, a context is started only once
+*/
+void travCtrl_ctxStart(travCtrl_ctx *ctx);
+
+/*
+ * @brief   same as the functions without a context, on the controller of ctx
+*/
+void travCtrl_ctxGoToAngle(travCtrl_ctx *ctx, int16_t directionAngle, const TraceStamp *stamp, bool sourceIsClose);
+void travCtrl_ctxStopMoving(travCtrl_ctx *ctx);
+void travCtrl_ctxMoveBackwards(travCtrl_ctx *ctx);
+void travCtrl_ctxSetMode(travCtrl_ctx *ctx, uint8_t mode);
+void travCtrl_ctxSetPidGains(travCtrl_ctx *ctx, float kp, float ki, float kd);
+void travCtrl_ctxSetPropGains(travCtrl_ctx *ctx, int16_t maxAngleToCorrect, float emaWeight);
+
 
 #endif /* TRAVELCONTROLLER_H_ */